@@ -50,19 +50,63 @@ std::vector<transport::SocketAddress> gatherInterfaces(const config::Config& con
     return interfaces;
 }
 
+std::unique_ptr<transport::RtcePoll> createNetwork(const config::Config& config,
+    memory::PacketPoolAllocator& allocator)
+{
+    const auto threadCount = std::max(1u, config.ice.networkThreads.get());
+    std::vector<std::unique_ptr<transport::RtcePoll>> polls;
+    const char* backend = "epoll";
+    if (config.ice.networkBackend.get() == "io_uring")
+    {
+        backend = "io_uring";
+        for (uint32_t i = 0; i < threadCount; ++i)
+        {
+            auto poll = transport::createIoUringPoll(allocator);
+            if (!poll)
+            {
+                logger::warn("io_uring not available, using epoll", "Bridge");
+                backend = "epoll";
+                polls.clear();
+                break;
+            }
+            polls.push_back(std::move(poll));
+        }
+    }
+
+    if (polls.empty())
+    {
+        for (uint32_t i = 0; i < threadCount; ++i)
+        {
+            polls.push_back(transport::createRtcePoll());
+        }
+    }
+
+    logger::info("using %s network backend with %u threads", "Bridge", backend, threadCount);
+    return transport::createRtcePollGroup(std::move(polls));
+}
+
 Bridge::Bridge(const config::Config& config)
     : _initialized(false),
       _config(config),
       _idGenerator(std::make_unique<utils::IdGenerator>()),
       _ssrcGenerator(std::make_unique<utils::SsrcGenerator>()),
-      _jobManager(std::make_unique<jobmanager::JobManager>()),
+      _jobManager(std::make_unique<jobmanager::JobManager>(config.parkIdleWorkers
+              ? jobmanager::JobManager::IdleStrategy::SpinThenPark
+              : jobmanager::JobManager::IdleStrategy::Backoff)),
       _sslDtls(std::make_unique<transport::SslDtls>()),
-      _network(transport::createRtcePoll()),
-      _mainPacketAllocator(std::make_unique<memory::PacketPoolAllocator>(32 * 1024, "main")),
-      _sendPacketAllocator(std::make_unique<memory::PacketPoolAllocator>(128 * 1024, "send")),
-      _audioPacketAllocator(std::make_unique<memory::AudioPacketPoolAllocator>(4 * 1024, "audio")),
-      _engine(std::make_unique<bridge::Engine>(config))
+      _mainPacketAllocator(std::make_unique<memory::PacketPoolAllocator>(config.packetPool.mainCeiling,
+          "main",
+          config.packetPool.mainCeiling / 8,
+          config.packetPool.threadCache)),
+      _sendPacketAllocator(std::make_unique<memory::PacketPoolAllocator>(config.packetPool.sendCeiling,
+          "send",
+          config.packetPool.sendCeiling / 3,
+          config.packetPool.threadCache)),
+      _audioPacketAllocator(
+          std::make_unique<memory::AudioPacketPoolAllocator>(config.packetPool.audioCeiling, "audio")),
+      _network(createNetwork(config, *_mainPacketAllocator))
 {
+    startEngines();
 }
 
 Bridge::~Bridge()
@@ -72,7 +116,10 @@ Bridge::~Bridge()
         _mixerManager->stop();
     }
 
-    _engine->stop();
+    for (auto& engine : _engines)
+    {
+        engine->stop();
+    }
 
     _transportFactory.reset(nullptr);
 
@@ -152,11 +199,17 @@ void Bridge::initialize()
         return;
     }
 
+    std::vector<bridge::Engine*> engines;
+    for (auto& engine : _engines)
+    {
+        engines.push_back(engine.get());
+    }
+
     _mixerManager = std::make_unique<bridge::MixerManager>(*_idGenerator,
         *_ssrcGenerator,
         *_jobManager,
         *_transportFactory,
-        *_engine,
+        engines,
         _config,
         *_mainPacketAllocator,
         *_sendPacketAllocator,
@@ -196,4 +249,15 @@ void Bridge::startWorkerThreads()
         _workerThreads.push_back(std::make_unique<jobmanager::WorkerThread>(*_jobManager));
     }
 }
+
+void Bridge::startEngines()
+{
+    const auto numShards = std::max(_config.engine.shards.get(), 1U);
+    logger::info("Starting %u engine shards", "main", numShards);
+
+    for (uint32_t i = 0; i < numShards; ++i)
+    {
+        _engines.push_back(std::make_unique<bridge::Engine>(_config, i));
+    }
+}
 } // namespace bridge
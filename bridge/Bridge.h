@@ -63,16 +63,18 @@ private:
     std::vector<transport::SocketAddress> _localInterfaces;
     const std::unique_ptr<transport::SslDtls> _sslDtls;
     std::unique_ptr<transport::SrtpClientFactory> _srtpClientFactory;
-    const std::unique_ptr<transport::RtcePoll> _network;
     const std::unique_ptr<memory::PacketPoolAllocator> _mainPacketAllocator;
     const std::unique_ptr<memory::PacketPoolAllocator> _sendPacketAllocator;
     const std::unique_ptr<memory::AudioPacketPoolAllocator> _audioPacketAllocator;
+    // io_uring backend holds packets from the main allocator and must go before it
+    const std::unique_ptr<transport::RtcePoll> _network;
     std::unique_ptr<transport::TransportFactory> _transportFactory;
-    const std::unique_ptr<bridge::Engine> _engine;
+    std::vector<std::unique_ptr<bridge::Engine>> _engines;
     std::unique_ptr<bridge::MixerManager> _mixerManager;
     std::unique_ptr<bridge::ApiRequestHandler> _requestHandler;
     std::unique_ptr<httpd::Httpd> _httpd;
 
     void startWorkerThreads();
+    void startEngines();
 };
 } // namespace bridge
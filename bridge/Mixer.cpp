@@ -10,6 +10,7 @@
 #include "bridge/engine/EngineRecordingStream.h"
 #include "bridge/engine/EngineVideoStream.h"
 #include "bridge/engine/PacketCache.h"
+#include "bridge/engine/VideoPacketCache.h"
 #include "config/Config.h"
 #include "jobmanager/JobManager.h"
 #include "logger/Logger.h"
@@ -928,7 +929,7 @@ void Mixer::allocateVideoPacketCache(const uint32_t ssrc, const size_t endpointI
 
     logger::info("Allocating videoPacketCache for ssrc %u, %lu", _loggableId.c_str(), ssrc, endpointIdHash);
 
-    auto videoPacketCache = std::make_unique<PacketCache>("VideoPacketCache", ssrc);
+    auto videoPacketCache = std::make_shared<VideoPacketCache>("VideoPacketCache", ssrc);
     {
         EngineCommand::Command command(EngineCommand::Type::AddVideoPacketCache);
         command._command.addVideoPacketCache._mixer = &_engineMixer;
@@ -940,13 +941,13 @@ void Mixer::allocateVideoPacketCache(const uint32_t ssrc, const size_t endpointI
     videoPacketCaches.emplace(ssrc, std::move(videoPacketCache));
 }
 
-void Mixer::freeVideoPacketCache(const uint32_t ssrc, const size_t endpointIdHash)
+void Mixer::freeVideoPacketCache(const uint32_t ssrc, const size_t endpointIdHash, VideoPacketCache* videoPacketCache)
 {
     std::lock_guard<std::mutex> locker(_configurationLock);
 
     auto& videoPacketCaches = _videoPacketCaches[endpointIdHash];
     auto findResult = videoPacketCaches.find(ssrc);
-    if (findResult == videoPacketCaches.cend())
+    if (findResult == videoPacketCaches.cend() || findResult->second.get() != videoPacketCache)
     {
         return;
     }
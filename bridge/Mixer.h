@@ -47,6 +47,7 @@ struct TransportDescription;
 struct EngineDataStream;
 struct EngineRecordingStream;
 class PacketCache;
+class VideoPacketCache;
 struct AudioStream;
 struct DataStream;
 struct RecordingDescription;
@@ -205,7 +206,7 @@ public:
         TransportDescription& outTransportDescription);
 
     void allocateVideoPacketCache(const uint32_t ssrc, const size_t endpointIdHash);
-    void freeVideoPacketCache(const uint32_t ssrc, const size_t endpointIdHash);
+    void freeVideoPacketCache(const uint32_t ssrc, const size_t endpointIdHash, VideoPacketCache* videoPacketCache);
 
     bool addOrUpdateRecording(const std::string& conferenceId,
         const std::vector<api::RecordingChannel>& channels,
@@ -263,7 +264,7 @@ private:
     std::unordered_map<std::string, std::unique_ptr<EngineRecordingStream>> _recordingEngineStreams;
 
     std::unordered_map<std::string, BundleTransport> _bundleTransports;
-    std::unordered_map<size_t, std::unordered_map<uint32_t, std::unique_ptr<PacketCache>>> _videoPacketCaches;
+    std::unordered_map<size_t, std::unordered_map<uint32_t, std::shared_ptr<VideoPacketCache>>> _videoPacketCaches;
     std::unordered_map<size_t, std::unordered_map<uint32_t, std::unique_ptr<PacketCache>>> _recordingRtpPacketCaches;
     std::unordered_map<size_t, std::unique_ptr<PacketCache>> _recordingEventPacketCache;
 
@@ -21,6 +21,7 @@
 #include "utils/SsrcGenerator.h"
 #include "utils/Time.h"
 #include "webrtc/DataChannel.h"
+#include <algorithm>
 #include <vector>
 
 namespace
@@ -29,6 +30,23 @@ namespace
 const auto intervalNs = 10000000UL;
 const uint32_t maxLastN = 16;
 
+std::vector<bridge::Stats::PacketPoolStats> getPacketPoolStats(const memory::PacketPoolAllocator& allocator)
+{
+    std::vector<bridge::Stats::PacketPoolStats> result;
+    for (size_t i = 0; i < memory::PacketPoolAllocator::SIZE_CLASS_COUNT; ++i)
+    {
+        const auto sizeClass = static_cast<memory::PacketPoolAllocator::SizeClass>(i);
+        bridge::Stats::PacketPoolStats classStats;
+        classStats.packetSize = memory::PacketPoolAllocator::getPacketCapacity(sizeClass);
+        classStats.allocated = allocator.countAllocatedItems(sizeClass);
+        classStats.count = allocator.getElementCount(sizeClass);
+        classStats.committed = allocator.getCommittedCount(sizeClass);
+        classStats.pageSize = allocator.getPageSize(sizeClass);
+        result.push_back(classStats);
+    }
+    return result;
+}
+
 } // namespace
 
 namespace bridge
@@ -38,7 +56,7 @@ MixerManager::MixerManager(utils::IdGenerator& idGenerator,
     utils::SsrcGenerator& ssrcGenerator,
     jobmanager::JobManager& jobManager,
     transport::TransportFactory& transportFactory,
-    Engine& engine,
+    const std::vector<Engine*>& engines,
     const config::Config& config,
     memory::PacketPoolAllocator& mainAllocator,
     memory::PacketPoolAllocator& sendAllocator,
@@ -47,15 +65,20 @@ MixerManager::MixerManager(utils::IdGenerator& idGenerator,
       _ssrcGenerator(ssrcGenerator),
       _jobManager(jobManager),
       _transportFactory(transportFactory),
-      _engine(engine),
+      _engines(engines),
       _config(config),
       _threadRunning(true),
       _engineMessages(16 * 1024),
       _mainAllocator(mainAllocator),
       _sendAllocator(sendAllocator),
-      _audioAllocator(audioAllocator)
+      _audioAllocator(audioAllocator),
+      _poolReclaimTime(utils::Time::getAbsoluteTime())
 {
-    _engine.setMessageListener(this);
+    assert(!_engines.empty());
+    for (auto engine : _engines)
+    {
+        engine->setMessageListener(this);
+    }
 
     // thread must initialize last to ensure the thread observes other members fully initialized
     _managerThread = std::make_unique<std::thread>([this] { this->run(); });
@@ -79,6 +102,7 @@ Mixer* MixerManager::create(uint32_t lastN)
     std::lock_guard<std::mutex> locker(_configurationLock);
     const auto id = std::to_string(_idGenerator.next());
     const auto localVideoSsrc = _ssrcGenerator.next();
+    auto& engine = selectEngine();
 
     std::vector<uint32_t> audioSsrcs;
     std::vector<SimulcastLevel> videoSsrcs;
@@ -120,7 +144,7 @@ Mixer* MixerManager::create(uint32_t lastN)
     auto mixerEmplaceResult = _mixers.emplace(id,
         std::make_unique<Mixer>(id,
             _transportFactory,
-            _engine,
+            engine,
             *(engineMixerEmplaceResult.first->second),
             _idGenerator,
             _ssrcGenerator,
@@ -135,10 +159,13 @@ Mixer* MixerManager::create(uint32_t lastN)
         return nullptr;
     }
 
+    _mixerEngines.emplace(id, &engine);
+    logger::info("Mixer %s placed on engine shard %u", "MixerManager", id.c_str(), engine.getShardId());
+
     {
         EngineCommand::Command addMixerCommand = {EngineCommand::Type::AddMixer};
         addMixerCommand._command.addMixer._mixer = engineMixerEmplaceResult.first->second.get();
-        _engine.pushCommand(std::move(addMixerCommand));
+        engine.pushCommand(std::move(addMixerCommand));
     }
 
     return mixerEmplaceResult.first->second.get();
@@ -153,11 +180,18 @@ void MixerManager::remove(const std::string& id)
         return;
     }
 
+    auto engine = findEngine(id);
+    if (!engine)
+    {
+        logger::error("no engine serves mixer %s", "MixerManager", id.c_str());
+        return;
+    }
+
     findResult->second->markForDeletion();
 
     EngineCommand::Command command(EngineCommand::Type::RemoveMixer);
     command._command.removeMixer._mixer = _engineMixers[id].get();
-    _engine.pushCommand(std::move(command));
+    engine->pushCommand(std::move(command));
 }
 
 std::vector<std::string> MixerManager::getMixerIds()
@@ -200,13 +234,22 @@ void MixerManager::stop()
         std::lock_guard<std::mutex> locker(_configurationLock);
         for (auto it = _mixers.begin(); it != _mixers.end(); ++it)
         {
-            if (!it->second->isMarkedForDeletion())
+            if (it->second->isMarkedForDeletion())
             {
-                it->second->markForDeletion();
-                EngineCommand::Command command(EngineCommand::Type::RemoveMixer);
-                command._command.removeMixer._mixer = _engineMixers[it->first].get();
-                _engine.pushCommand(std::move(command));
+                continue;
             }
+
+            auto engine = findEngine(it->first);
+            if (!engine)
+            {
+                logger::error("no engine serves mixer %s", "MixerManager", it->first.c_str());
+                continue;
+            }
+
+            it->second->markForDeletion();
+            EngineCommand::Command command(EngineCommand::Type::RemoveMixer);
+            command._command.removeMixer._mixer = _engineMixers[it->first].get();
+            engine->pushCommand(std::move(command));
         }
     }
 
@@ -307,6 +350,7 @@ void MixerManager::run()
             {
                 _transportFactory.maintenance(timestamp);
                 updateStats();
+                reclaimPacketPools(timestamp);
             }
         }
         catch (std::exception e)
@@ -361,6 +405,7 @@ void MixerManager::engineMessageMixerRemoved(const EngineMessage::Message& messa
         logger::info("Removing EngineMixer %s", "MixerManager", command._mixer->getLoggableId().c_str());
         // This will sweep the PacketPoolAllocator. Any pending jobs may crash or corrupt memory.
         _engineMixers.erase(mixerId);
+        _mixerEngines.erase(mixerId);
 
         auto mixerAudioBuffers = _audioBuffers.find(mixerId);
         if (mixerAudioBuffers != _audioBuffers.cend())
@@ -385,6 +430,12 @@ void MixerManager::engineMessageAllocateAudioBuffer(const EngineMessage::Message
 {
     std::lock_guard<std::mutex> locker(_configurationLock);
 
+    auto engine = findEngine(message._command.allocateAudioBuffer._mixer->getId());
+    if (!engine)
+    {
+        return;
+    }
+
     auto& mixerAudioBuffers = _audioBuffers[message._command.allocateAudioBuffer._mixer->getId()];
     auto findResult = mixerAudioBuffers.find(message._command.allocateAudioBuffer._ssrc);
     if (findResult != mixerAudioBuffers.cend())
@@ -403,7 +454,7 @@ void MixerManager::engineMessageAllocateAudioBuffer(const EngineMessage::Message
         command._command.addAudioBuffer._mixer = message._command.allocateAudioBuffer._mixer;
         command._command.addAudioBuffer._ssrc = message._command.allocateAudioBuffer._ssrc;
         command._command.addAudioBuffer._audioBuffer = audioBuffer.get();
-        _engine.pushCommand(std::move(command));
+        engine->pushCommand(std::move(command));
     }
     mixerAudioBuffers.emplace(message._command.allocateAudioBuffer._ssrc, std::move(audioBuffer));
 }
@@ -539,7 +590,7 @@ void MixerManager::engineMessageFreeVideoPacketCache(const EngineMessage::Messag
         return;
     }
 
-    mixerItr->second->freeVideoPacketCache(command._ssrc, command._endpointIdHash);
+    mixerItr->second->freeVideoPacketCache(command._ssrc, command._endpointIdHash, command._videoPacketCache);
 }
 
 void MixerManager::engineMessageSctp(EngineMessage::Message&& message)
@@ -551,12 +602,19 @@ void MixerManager::engineMessageSctp(EngineMessage::Message&& message)
     {
         // create command with this packet to send the binary data -> engine -> WebRtcDataStream belonging to this
         // transport
+        std::lock_guard<std::mutex> locker(_configurationLock);
+        auto engine = findEngine(sctpMessage._mixer->getId());
+        if (!engine)
+        {
+            return;
+        }
+
         EngineCommand::Command command{EngineCommand::Type::SctpControl};
         auto& sctpControl = command._command.sctpControl;
         command._packet.swap(message._packet);
         sctpControl._mixer = sctpMessage._mixer;
         sctpControl._endpointIdHash = sctpMessage._endpointIdHash;
-        _engine.pushCommand(std::move(command));
+        engine->pushCommand(std::move(command));
         return; // do not free packet as we passed it on
     }
     else if (sctpHeader.payloadProtocol == webrtc::DataChannelPpid::WEBRTC_STRING)
@@ -683,6 +741,34 @@ void MixerManager::engineMessageRemoveRecordingTransport(const EngineMessage::Me
     mixerItr->second->removeRecordingTransport(command._streamId, command._endpointIdHash);
 }
 
+// Picks the engine shard with the least load. Load is estimated from the number of transports in the mixers
+// already placed on each shard, plus one per mixer so that empty conferences are spread too.
+// Must be called with _configurationLock held.
+Engine& MixerManager::selectEngine()
+{
+    std::vector<uint32_t> shardLoad(_engines.size(), 0);
+    for (const auto& mixerEngine : _mixerEngines)
+    {
+        auto mixerItr = _mixers.find(mixerEngine.first);
+        const uint32_t mixerLoad = 1 + (mixerItr != _mixers.cend() ? mixerItr->second->getStats().transports : 0);
+        shardLoad[mixerEngine.second->getShardId()] += mixerLoad;
+    }
+
+    const auto minItr = std::min_element(shardLoad.cbegin(), shardLoad.cend());
+    return *_engines[std::distance(shardLoad.cbegin(), minItr)];
+}
+
+// Must be called with _configurationLock held.
+Engine* MixerManager::findEngine(const std::string& mixerId)
+{
+    auto engineItr = _mixerEngines.find(mixerId);
+    if (engineItr == _mixerEngines.cend())
+    {
+        return nullptr;
+    }
+    return engineItr->second;
+}
+
 // This method may block up to 1s to collect the statistics
 Stats::MixerManagerStats MixerManager::getStats()
 {
@@ -704,11 +790,30 @@ Stats::MixerManagerStats MixerManager::getStats()
     EndpointMetrics udpMetrics = _transportFactory.getSharedUdpEndpointsMetrics();
 
     result._jobQueueLength = _jobManager.getCount();
+    const auto jobManagerMetrics = _jobManager.getMetrics();
+    result._jobWorkerWakeups = jobManagerMetrics.wakeups;
+    result._jobWorkerParkTimeMs = jobManagerMetrics.parkTimeNs / utils::Time::ms;
+    result._serialJobCells = jobManagerMetrics.serialJobCells;
     result._receivePoolSize = _mainAllocator.size();
     result._sendPoolSize = _sendAllocator.size();
+    result._receivePoolClasses = getPacketPoolStats(_mainAllocator);
+    result._sendPoolClasses = getPacketPoolStats(_sendAllocator);
     result._udpSharedEndpointsSendQueue = udpMetrics.sendQueue;
     result._udpSharedEndpointsReceiveKbps = static_cast<uint32_t>(udpMetrics.receiveKbps);
     result._udpSharedEndpointsSendKbps = static_cast<uint32_t>(udpMetrics.sendKbps);
+    result._udpSharedEndpointsSendCalls = udpMetrics.sendCalls;
+    result._udpSharedEndpointsSentDatagrams = udpMetrics.sentDatagrams;
+    result._udpSharedEndpointsReceiveCalls = udpMetrics.receiveCalls;
+    result._udpSharedEndpointsReceivedDatagrams = udpMetrics.receivedDatagrams;
+    result._udpSharedEndpointsSocketDrops = udpMetrics.socketDrops;
+    result._udpSharedEndpointsForwardLatency = udpMetrics.forwardLatency;
+    for (const auto& threadMetrics : _transportFactory.getNetworkThreadMetrics())
+    {
+        Stats::NetworkThreadStats threadStats;
+        threadStats.sockets = threadMetrics.sockets;
+        threadStats.eventsPerSecond = static_cast<uint32_t>(threadMetrics.eventsPerSecond);
+        result._networkThreads.push_back(threadStats);
+    }
 
     return result;
 }
@@ -732,7 +837,11 @@ void MixerManager::updateStats()
         _stats.largestConference = std::max(stats.transports, _stats.largestConference);
     }
 
-    _stats.engine = _engine.getStats();
+    _stats.engine = EngineStats::EngineStats();
+    for (auto engine : _engines)
+    {
+        _stats.engine += engine->getStats();
+    }
     _stats.ticksSinceLastUpdate = 0;
 
     if (_mainAllocator.size() < 512)
@@ -741,4 +850,20 @@ void MixerManager::updateStats()
     }
 }
 
+void MixerManager::reclaimPacketPools(const uint64_t timestamp)
+{
+    if (utils::Time::diffLT(_poolReclaimTime, timestamp, _config.packetPool.reclaimIntervalMs * utils::Time::ms))
+    {
+        return;
+    }
+    _poolReclaimTime = timestamp;
+
+    const auto releasedChunks =
+        _mainAllocator.reclaimIdleChunks() + _sendAllocator.reclaimIdleChunks() + _audioAllocator.reclaimIdleChunks();
+    if (releasedChunks > 0)
+    {
+        logger::debug("released %zu idle packet pool chunks", "MixerManager", releasedChunks);
+    }
+}
+
 } // namespace bridge
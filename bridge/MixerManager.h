@@ -50,7 +50,7 @@ public:
         utils::SsrcGenerator& ssrcGenerator,
         jobmanager::JobManager& jobManager,
         transport::TransportFactory& transportFactory,
-        bridge::Engine& engine,
+        const std::vector<bridge::Engine*>& engines,
         const config::Config& config,
         memory::PacketPoolAllocator& mainAllocator,
         memory::PacketPoolAllocator& sendAllocator,
@@ -85,11 +85,12 @@ private:
     utils::SsrcGenerator& _ssrcGenerator;
     jobmanager::JobManager& _jobManager;
     transport::TransportFactory& _transportFactory;
-    Engine& _engine;
+    const std::vector<Engine*> _engines;
     const config::Config& _config;
 
     std::unordered_map<std::string, std::unique_ptr<Mixer>> _mixers;
     std::unordered_map<std::string, std::unique_ptr<EngineMixer>> _engineMixers;
+    std::unordered_map<std::string, Engine*> _mixerEngines;
     std::unordered_map<std::string, std::unordered_map<uint32_t, std::unique_ptr<EngineMixer::AudioBuffer>>>
         _audioBuffers;
 
@@ -103,6 +104,7 @@ private:
     memory::PacketPoolAllocator& _mainAllocator;
     memory::PacketPoolAllocator& _sendAllocator;
     memory::AudioPacketPoolAllocator& _audioAllocator;
+    uint64_t _poolReclaimTime;
 
     void engineMessageMixerRemoved(const EngineMessage::Message& message);
     void engineMessageAllocateAudioBuffer(const EngineMessage::Message& message);
@@ -120,7 +122,10 @@ private:
     void engineMessageFreeRecordingRtpPacketCache(const EngineMessage::Message& message);
     void engineMessageRemoveRecordingTransport(const EngineMessage::Message& message);
 
+    Engine& selectEngine();
+    Engine* findEngine(const std::string& mixerId);
     void updateStats();
+    void reclaimPacketPools(uint64_t timestamp);
 };
 
 } // namespace bridge
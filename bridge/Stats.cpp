@@ -24,6 +24,14 @@ json to_json(const T (&data)[N])
     }
     return v;
 }
+
+json to_json(const utils::LatencyHistogram::Snapshot& histogram)
+{
+    return json{{"p50", histogram.getPercentile(0.5)},
+        {"p99", histogram.getPercentile(0.99)},
+        {"p999", histogram.getPercentile(0.999)},
+        {"count", histogram.getCount()}};
+}
 } // namespace nlohmann
 
 namespace bridge
@@ -73,6 +81,23 @@ uint64_t toMicroSeconds(const struct timeval& a)
 
 SystemStats::SystemStats() {}
 
+namespace
+{
+nlohmann::json toJson(const std::vector<PacketPoolStats>& poolClasses)
+{
+    auto result = nlohmann::json::array();
+    for (const auto& poolClass : poolClasses)
+    {
+        result.push_back({{"packet_size", poolClass.packetSize},
+            {"allocated", poolClass.allocated},
+            {"count", poolClass.count},
+            {"committed", poolClass.committed},
+            {"page_size", poolClass.pageSize}});
+    }
+    return result;
+}
+} // namespace
+
 std::string MixerManagerStats::describe()
 {
     nlohmann::json result;
@@ -108,6 +133,9 @@ std::string MixerManagerStats::describe()
     result["outbound_video_streams"] = _engineStats.activeMixers.outbound.video.activeStreamCount;
 
     result["job_queue"] = _jobQueueLength;
+    result["job_worker_wakeups"] = _jobWorkerWakeups;
+    result["job_worker_park_time_ms"] = _jobWorkerParkTimeMs;
+    result["serial_job_cells"] = _serialJobCells;
     result["loss_upload"] = _engineStats.activeMixers.outbound.total().getSendLossRatio();
     result["loss_download"] = _engineStats.activeMixers.inbound.total().getReceiveLossRatio();
 
@@ -117,14 +145,41 @@ std::string MixerManagerStats::describe()
     result["shared_udp_send_queue"] = _udpSharedEndpointsSendQueue;
     result["shared_udp_receive_rate"] = _udpSharedEndpointsReceiveKbps;
     result["shared_udp_send_rate"] = _udpSharedEndpointsSendKbps;
+    result["shared_udp_send_calls"] = _udpSharedEndpointsSendCalls;
+    result["shared_udp_sent_datagrams"] = _udpSharedEndpointsSentDatagrams;
+    result["shared_udp_datagrams_per_send"] = _udpSharedEndpointsSendCalls
+        ? static_cast<double>(_udpSharedEndpointsSentDatagrams) / _udpSharedEndpointsSendCalls
+        : 0.0;
+    result["shared_udp_receive_calls"] = _udpSharedEndpointsReceiveCalls;
+    result["shared_udp_received_datagrams"] = _udpSharedEndpointsReceivedDatagrams;
+    result["shared_udp_datagrams_per_receive"] = _udpSharedEndpointsReceiveCalls
+        ? static_cast<double>(_udpSharedEndpointsReceivedDatagrams) / _udpSharedEndpointsReceiveCalls
+        : 0.0;
+
+    result["shared_udp_socket_drops"] = _udpSharedEndpointsSocketDrops;
+    result["shared_udp_forward_latency_us"] = nlohmann::to_json(_udpSharedEndpointsForwardLatency);
+
+    auto networkThreads = nlohmann::json::array();
+    for (const auto& thread : _networkThreads)
+    {
+        networkThreads.push_back({{"sockets", thread.sockets}, {"events_per_second", thread.eventsPerSecond}});
+    }
+    result["rtce_threads"] = networkThreads;
 
     result["send_pool"] = _sendPoolSize;
     result["receive_pool"] = _receivePoolSize;
+    result["send_pool_classes"] = toJson(_sendPoolClasses);
+    result["receive_pool_classes"] = toJson(_receivePoolClasses);
 
     result["loss_upload_hist"] = nlohmann::to_json(_engineStats.activeMixers.outbound.transport.lossGroup);
     result["loss_download_hist"] = nlohmann::to_json(_engineStats.activeMixers.inbound.transport.lossGroup);
     result["bwe_download_hist"] = nlohmann::to_json(_engineStats.activeMixers.inbound.transport.bandwidthEstimateGroup);
     result["rtt_download_hist"] = nlohmann::to_json(_engineStats.activeMixers.inbound.transport.rttGroup);
+    result["srtp_profile_hist"] = nlohmann::to_json(_engineStats.activeMixers.inbound.transport.srtpProfileGroup);
+
+    result["forward_latency_us"] = nlohmann::to_json(_engineStats.activeMixers.forwardLatency);
+    result["max_mixer_forward_latency_p99_us"] = _engineStats.activeMixers.maxMixerForwardLatencyP99;
+    result["max_transport_forward_latency_p99_us"] = _engineStats.activeMixers.maxTransportForwardLatencyP99;
 
     result["engine_slips"] = _engineStats.timeSlipCount;
 
@@ -277,13 +332,15 @@ SystemStats SystemStatsCollector::collect(uint16_t httpPort, uint16_t tcpRtpPort
         }
         else if (!std::strcmp(taskSample.name, "(Rtce)"))
         {
-            stats.rtceCpu =
-                cpuCount * static_cast<double>(taskSample.utime + taskSample.stime) / (1 + systemDiff.totalJiffies());
+            // busiest network thread
+            stats.rtceCpu = std::max(stats.rtceCpu,
+                cpuCount * static_cast<double>(taskSample.utime + taskSample.stime) / (1 + systemDiff.totalJiffies()));
         }
         else if (!std::strcmp(taskSample.name, "(Engine)"))
         {
-            stats.engineCpu =
-                cpuCount * static_cast<double>(taskSample.utime + taskSample.stime) / (1 + systemDiff.totalJiffies());
+            // report the busiest engine shard as that is the one that will slip first
+            stats.engineCpu = std::max(stats.engineCpu,
+                cpuCount * static_cast<double>(taskSample.utime + taskSample.stime) / (1 + systemDiff.totalJiffies()));
         }
         else if (!std::strcmp(taskSample.name, "(MixerManager)"))
         {
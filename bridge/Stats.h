@@ -4,6 +4,7 @@
 #include "concurrency/MpmcPublish.h"
 #include <array>
 #include <inttypes.h>
+#include <vector>
 
 namespace bridge
 {
@@ -50,6 +51,21 @@ struct SystemStats
     struct ConnectionsStats connections;
 };
 
+struct PacketPoolStats
+{
+    uint32_t packetSize = 0;
+    uint32_t allocated = 0;
+    uint32_t count = 0;
+    uint32_t committed = 0;
+    uint32_t pageSize = 0;
+};
+
+struct NetworkThreadStats
+{
+    uint32_t sockets = 0;
+    uint32_t eventsPerSecond = 0;
+};
+
 struct MixerManagerStats
 {
     SystemStats _systemStats;
@@ -60,12 +76,25 @@ struct MixerManagerStats
     uint32_t _largestConference = 0;
     EngineStats::EngineStats _engineStats;
     uint32_t _jobQueueLength = 0;
+    uint64_t _jobWorkerWakeups = 0;
+    uint64_t _jobWorkerParkTimeMs = 0;
+    uint32_t _serialJobCells = 0;
 
     uint32_t _receivePoolSize = 0;
     uint32_t _sendPoolSize = 0;
+    // per size class, smallest first
+    std::vector<PacketPoolStats> _receivePoolClasses;
+    std::vector<PacketPoolStats> _sendPoolClasses;
     uint32_t _udpSharedEndpointsSendQueue = 0;
     uint32_t _udpSharedEndpointsReceiveKbps = 0;
     uint32_t _udpSharedEndpointsSendKbps = 0;
+    uint64_t _udpSharedEndpointsSendCalls = 0;
+    uint64_t _udpSharedEndpointsSentDatagrams = 0;
+    uint64_t _udpSharedEndpointsReceiveCalls = 0;
+    uint64_t _udpSharedEndpointsReceivedDatagrams = 0;
+    std::vector<NetworkThreadStats> _networkThreads;
+    std::vector<uint32_t> _udpSharedEndpointsSocketDrops;
+    utils::LatencyHistogram::Snapshot _udpSharedEndpointsForwardLatency;
 
     std::string describe();
 };
@@ -43,7 +43,7 @@ namespace bridge
 
 AudioForwarderRewriteAndSendJob::AudioForwarderRewriteAndSendJob(SsrcOutboundContext& outboundContext,
     SsrcInboundContext& senderInboundContext,
-    memory::UniquePacket packet,
+    memory::SharedPacket packet,
     const uint32_t extendedSequenceNumber,
     transport::Transport& transport)
     : jobmanager::CountedJob(transport.getJobCounter()),
@@ -59,7 +59,14 @@ AudioForwarderRewriteAndSendJob::AudioForwarderRewriteAndSendJob(SsrcOutboundCon
 
 void AudioForwarderRewriteAndSendJob::run()
 {
-    auto header = rtp::RtpHeader::fromPacket(*_packet);
+    auto packet = memory::makeUniquePacket(_outboundContext._allocator, std::move(_packet));
+    if (!packet)
+    {
+        logger::warn("send allocator depleted FwdSend", "AudioForwarderRewriteAndSendJob");
+        return;
+    }
+
+    auto header = rtp::RtpHeader::fromPacket(*packet);
     if (!header)
     {
         return;
@@ -99,7 +106,7 @@ void AudioForwarderRewriteAndSendJob::run()
     }
 
     rewriteHeaderExtensions(header, _senderInboundContext, _outboundContext);
-    _transport.protectAndSend(std::move(_packet));
+    _transport.protectAndSend(std::move(packet));
 }
 
 } // namespace bridge
@@ -1,7 +1,7 @@
 #pragma once
 
 #include "jobmanager/Job.h"
-#include "memory/PacketPoolAllocator.h"
+#include "memory/SharedPacket.h"
 #include <cstdint>
 
 namespace transport
@@ -20,7 +20,7 @@ class AudioForwarderRewriteAndSendJob : public jobmanager::CountedJob
 public:
     AudioForwarderRewriteAndSendJob(SsrcOutboundContext& outboundContext,
         SsrcInboundContext& senderInboundContext,
-        memory::UniquePacket packet,
+        memory::SharedPacket packet,
         const uint32_t extendedSequenceNumber,
         transport::Transport& transport);
 
@@ -29,7 +29,7 @@ public:
 private:
     SsrcOutboundContext& _outboundContext;
     SsrcInboundContext& _senderInboundContext;
-    memory::UniquePacket _packet;
+    memory::SharedPacket _packet;
     uint32_t _extendedSequenceNumber;
     transport::Transport& _transport;
 };
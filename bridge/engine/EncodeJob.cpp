@@ -12,12 +12,14 @@ namespace bridge
 EncodeJob::EncodeJob(memory::UniqueAudioPacket packet,
     SsrcOutboundContext& outboundContext,
     transport::Transport& transport,
-    const uint64_t rtpTimestamp)
+    const uint64_t rtpTimestamp,
+    const utils::Optional<int>& audioLevel)
     : jobmanager::CountedJob(transport.getJobCounter()),
       _packet(std::move(packet)),
       _outboundContext(outboundContext),
       _transport(transport),
-      _rtpTimestamp(rtpTimestamp)
+      _rtpTimestamp(rtpTimestamp),
+      _audioLevel(audioLevel)
 {
     assert(_packet);
     assert(_packet->getLength() > 0);
@@ -39,33 +41,15 @@ void EncodeJob::run()
             _outboundContext._opusEncoder.reset(new codec::OpusEncoder());
         }
 
-        auto opusPacket = memory::makeUniquePacket(_outboundContext._allocator);
+        const auto audioLevel = _audioLevel.isSet() ? _audioLevel.get() : codec::computeAudioLevel(*_packet);
+        auto opusPacket = createRtpPacket(_outboundContext, audioLevel);
         if (!opusPacket)
         {
             logger::error("failed to make packet for opus encoded data", "OpusEncodeJob");
             return;
         }
 
-        auto opusHeader = rtp::RtpHeader::create(*opusPacket);
-
-        rtp::RtpHeaderExtension extensionHead(opusHeader->getExtensionHeader());
-        auto cursor = extensionHead.extensions().begin();
-        if (_outboundContext._rtpMap._absSendTimeExtId.isSet())
-        {
-            rtp::GeneralExtension1Byteheader absSendTime(_outboundContext._rtpMap._absSendTimeExtId.get(), 3);
-            extensionHead.addExtension(cursor, absSendTime);
-        }
-        if (_outboundContext._rtpMap._audioLevelExtId.isSet())
-        {
-            rtp::GeneralExtension1Byteheader audioLevel(_outboundContext._rtpMap._audioLevelExtId.get(), 1);
-            audioLevel.data[0] = codec::computeAudioLevel(*_packet);
-            extensionHead.addExtension(cursor, audioLevel);
-        }
-        if (!extensionHead.empty())
-        {
-            opusHeader->setExtensions(extensionHead);
-            opusPacket->setLength(opusHeader->headerLength());
-        }
+        auto opusHeader = rtp::RtpHeader::fromPacket(*opusPacket);
 
         const uint32_t payloadLength = _packet->getLength() - pcm16Header->headerLength();
         const size_t frames = payloadLength / EngineMixer::bytesPerSample / EngineMixer::channelsPerFrame;
@@ -96,4 +80,36 @@ void EncodeJob::run()
     }
 }
 
+memory::UniquePacket EncodeJob::createRtpPacket(SsrcOutboundContext& outboundContext, const int audioLevel)
+{
+    auto packet = memory::makeUniquePacket(outboundContext._allocator);
+    if (!packet)
+    {
+        return packet;
+    }
+
+    auto rtpHeader = rtp::RtpHeader::create(*packet);
+
+    rtp::RtpHeaderExtension extensionHead(rtpHeader->getExtensionHeader());
+    auto cursor = extensionHead.extensions().begin();
+    if (outboundContext._rtpMap._absSendTimeExtId.isSet())
+    {
+        rtp::GeneralExtension1Byteheader absSendTime(outboundContext._rtpMap._absSendTimeExtId.get(), 3);
+        extensionHead.addExtension(cursor, absSendTime);
+    }
+    if (outboundContext._rtpMap._audioLevelExtId.isSet())
+    {
+        rtp::GeneralExtension1Byteheader audioLevelExtension(outboundContext._rtpMap._audioLevelExtId.get(), 1);
+        audioLevelExtension.data[0] = audioLevel;
+        extensionHead.addExtension(cursor, audioLevelExtension);
+    }
+    if (!extensionHead.empty())
+    {
+        rtpHeader->setExtensions(extensionHead);
+    }
+
+    packet->setLength(rtpHeader->headerLength());
+    return packet;
+}
+
 } // namespace bridge
@@ -2,6 +2,8 @@
 
 #include "jobmanager/Job.h"
 #include "memory/AudioPacketPoolAllocator.h"
+#include "memory/PacketPoolAllocator.h"
+#include "utils/Optional.h"
 #include <cstdint>
 
 namespace transport
@@ -20,15 +22,24 @@ public:
     EncodeJob(memory::UniqueAudioPacket packet,
         SsrcOutboundContext& outboundContext,
         transport::Transport& transport,
-        const uint64_t rtpTimestamp);
+        const uint64_t rtpTimestamp,
+        const utils::Optional<int>& audioLevel = utils::Optional<int>());
 
     void run() override;
 
+    /**
+     * Creates an outbound audio RTP packet with the header extensions negotiated for the outbound context.
+     * The packet length covers the header. Ssrc, sequence number, timestamp and payload are left to the caller.
+     */
+    static memory::UniquePacket createRtpPacket(SsrcOutboundContext& outboundContext, const int audioLevel);
+
 private:
     memory::UniqueAudioPacket _packet;
     SsrcOutboundContext& _outboundContext;
     transport::Transport& _transport;
     uint64_t _rtpTimestamp;
+    // computed from the packet when not set
+    utils::Optional<int> _audioLevel;
 };
 
 } // namespace bridge
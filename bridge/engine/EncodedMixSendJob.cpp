@@ -0,0 +1,55 @@
+#include "bridge/engine/EncodedMixSendJob.h"
+#include "bridge/engine/EncodeJob.h"
+#include "bridge/engine/SsrcOutboundContext.h"
+#include "logger/Logger.h"
+#include "memory/Packet.h"
+#include "rtp/RtpHeader.h"
+#include "transport/Transport.h"
+#include <cstring>
+
+namespace bridge
+{
+
+EncodedMixSendJob::EncodedMixSendJob(memory::SharedPacket encodedPayload,
+    SsrcOutboundContext& outboundContext,
+    transport::Transport& transport,
+    const uint64_t rtpTimestamp,
+    const int audioLevel)
+    : jobmanager::CountedJob(transport.getJobCounter()),
+      _encodedPayload(std::move(encodedPayload)),
+      _outboundContext(outboundContext),
+      _transport(transport),
+      _rtpTimestamp(rtpTimestamp),
+      _audioLevel(audioLevel)
+{
+    assert(_encodedPayload);
+    assert(_encodedPayload->getLength() > 0);
+}
+
+void EncodedMixSendJob::run()
+{
+    auto packet = EncodeJob::createRtpPacket(_outboundContext, _audioLevel);
+    if (!packet)
+    {
+        logger::error("failed to make packet for shared encoded mix", "EncodedMixSendJob");
+        return;
+    }
+
+    auto rtpHeader = rtp::RtpHeader::fromPacket(*packet);
+    const auto headerLength = rtpHeader->headerLength();
+    if (headerLength + _encodedPayload->getLength() > memory::Packet::size)
+    {
+        return;
+    }
+
+    std::memcpy(rtpHeader->getPayload(), _encodedPayload->get(), _encodedPayload->getLength());
+    packet->setLength(headerLength + _encodedPayload->getLength());
+
+    rtpHeader->ssrc = _outboundContext._ssrc;
+    rtpHeader->timestamp = (_rtpTimestamp * 48llu) & 0xFFFFFFFFllu;
+    rtpHeader->sequenceNumber = _outboundContext._sequenceCounter++ & 0xFFFFu;
+    rtpHeader->payloadType = _outboundContext._rtpMap._payloadType;
+    _transport.protectAndSend(std::move(packet));
+}
+
+} // namespace bridge
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "jobmanager/Job.h"
+#include "memory/SharedPacket.h"
+#include <cstdint>
+
+namespace transport
+{
+class Transport;
+}
+
+namespace bridge
+{
+
+class SsrcOutboundContext;
+
+/**
+ * Sends a mix that has already been encoded for several listeners. Only the RTP header is written per receiver,
+ * the encoded payload is shared by reference between the send jobs.
+ */
+class EncodedMixSendJob : public jobmanager::CountedJob
+{
+public:
+    EncodedMixSendJob(memory::SharedPacket encodedPayload,
+        SsrcOutboundContext& outboundContext,
+        transport::Transport& transport,
+        const uint64_t rtpTimestamp,
+        const int audioLevel);
+
+    void run() override;
+
+private:
+    memory::SharedPacket _encodedPayload;
+    SsrcOutboundContext& _outboundContext;
+    transport::Transport& _transport;
+    uint64_t _rtpTimestamp;
+    int _audioLevel;
+};
+
+} // namespace bridge
@@ -21,8 +21,9 @@ const auto intervalNs = 1000000UL * bridge::EngineMixer::iterationDurationMs;
 namespace bridge
 {
 
-Engine::Engine(const config::Config& config)
+Engine::Engine(const config::Config& config, uint32_t shardId)
     : _config(config),
+      _shardId(shardId),
       _messageListener(nullptr),
       _running(true),
       _pendingCommands(1024),
@@ -31,7 +32,7 @@ Engine::Engine(const config::Config& config)
 {
     if (concurrency::setPriority(_thread, concurrency::Priority::RealTime))
     {
-        logger::info("Successfully set thread priority to realtime.", "Engine");
+        logger::info("Successfully set thread priority to realtime, shard %u.", "Engine", _shardId);
     }
 }
 
@@ -44,12 +45,12 @@ void Engine::stop()
 {
     _running = false;
     _thread.join();
-    logger::debug("Engine stopped", "Engine");
+    logger::debug("Engine stopped, shard %u", "Engine", _shardId);
 }
 
 void Engine::run()
 {
-    logger::debug("Engine started", "Engine");
+    logger::debug("Engine started, shard %u", "Engine", _shardId);
     concurrency::setThreadName("Engine");
     utils::Pacer pacer(intervalNs);
     EngineStats::EngineStats currentStatSample;
@@ -19,7 +19,7 @@ class EngineMessageListener;
 class Engine
 {
 public:
-    Engine(const config::Config& config);
+    Engine(const config::Config& config, uint32_t shardId);
 
     void setMessageListener(EngineMessageListener* messageListener);
     void stop();
@@ -28,12 +28,14 @@ public:
     void pushCommand(EngineCommand::Command&& command);
 
     EngineStats::EngineStats getStats();
+    uint32_t getShardId() const { return _shardId; }
 
 private:
     static const size_t maxMixers = 4096;
     static const uint32_t STATS_UPDATE_TICKS = 200;
 
     const config::Config& _config;
+    const uint32_t _shardId;
     EngineMessageListener* _messageListener;
     std::atomic<bool> _running;
 
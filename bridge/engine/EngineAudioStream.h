@@ -30,7 +30,9 @@ struct EngineAudioStream
           _transport(transport),
           _audioMixed(audioMixed),
           _rtpMap(rtpMap),
-          _ssrcRewrite(ssrcRewrite)
+          _ssrcRewrite(ssrcRewrite),
+          _sharedMixEncoding(false),
+          _sharedMixHandOver(false)
     {
     }
 
@@ -45,6 +47,11 @@ struct EngineAudioStream
 
     bridge::RtpMap _rtpMap;
     bool _ssrcRewrite;
+
+    // Engine thread only. Set when the stream is added if it receives the shared mix, cleared for good once it starts
+    // sending audio, which sets _sharedMixHandOver until its own encoder has taken over the shared encoder state.
+    bool _sharedMixEncoding;
+    bool _sharedMixHandOver;
 };
 
 } // namespace bridge
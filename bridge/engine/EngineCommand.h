@@ -20,6 +20,7 @@ struct EngineAudioStream;
 struct EngineVideoStream;
 struct EngineDataStream;
 class PacketCache;
+class VideoPacketCache;
 
 namespace EngineCommand
 {
@@ -104,7 +105,7 @@ struct AddVideoPacketCache
     EngineMixer* _mixer;
     uint32_t _ssrc;
     size_t _endpointIdHash;
-    PacketCache* _videoPacketCache;
+    VideoPacketCache* _videoPacketCache;
 };
 
 struct SctpControl
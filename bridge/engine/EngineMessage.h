@@ -18,6 +18,7 @@ struct EngineVideoStream;
 struct EngineDataStream;
 struct EngineRecordingStream;
 struct RecordingDescription;
+class VideoPacketCache;
 
 namespace EngineMessage
 {
@@ -81,6 +82,8 @@ struct FreeVideoPacketCache
     EngineMixer* _mixer;
     uint32_t _ssrc;
     size_t _endpointIdHash;
+    // only this cache is freed. A cache still on its way to the engine is not freed if nullptr.
+    VideoPacketCache* _videoPacketCache;
 };
 
 struct SctpMessage
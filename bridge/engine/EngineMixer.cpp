@@ -26,7 +26,10 @@
 #include "bridge/engine/VideoForwarderRewriteAndSendJob.h"
 #include "bridge/engine/VideoForwarderRtxReceiveJob.h"
 #include "bridge/engine/VideoNackReceiveJob.h"
+#include "codec/AudioLevel.h"
+#include "codec/MixKernels.h"
 #include "codec/Opus.h"
+#include "codec/OpusEncoder.h"
 #include "config/Config.h"
 #include "logger/Logger.h"
 #include "rtp/RtcpFeedback.h"
@@ -168,11 +171,14 @@ EngineMixer::EngineMixer(const std::string& id,
       _engineVideoStreams(maxStreamsPerModality),
       _engineDataStreams(maxStreamsPerModality),
       _engineRecordingStreams(maxRecordingStreams),
+      _audioStreamRegistry(maxStreamsPerModality),
+      _videoStreamRegistry(maxStreamsPerModality),
       _ssrcInboundContexts(maxSsrcs),
       _localVideoSsrc(localVideoSsrc),
       _rtpTimestampSource(1000),
       _sendAllocator(sendAllocator),
       _audioAllocator(audioAllocator),
+      _sharedPacketAllocator(maxSharedPackets, "SharedPacketPool"),
       _lastReceiveTime(utils::Time::getAbsoluteTime()),
       _noTicks(0),
       _ticksPerSSRCCheck(ticksPerSSRCCheck),
@@ -191,7 +197,17 @@ EngineMixer::EngineMixer(const std::string& id,
     assert(audioSsrcs.size() <= SsrcRewrite::ssrcArraySize);
     assert(videoSsrcs.size() <= SsrcRewrite::ssrcArraySize);
 
+    memset(_mixAccumulator, 0, samplesPerIteration * sizeof(int32_t));
     memset(_mixedData, 0, samplesPerIteration * sizeof(int16_t));
+
+    if (config.audio.sharedEncoding)
+    {
+        _sharedMixEncoder = std::make_unique<SharedMixEncoder>(jobManager,
+            audioAllocator,
+            sendAllocator,
+            _sharedPacketAllocator,
+            maxStreamsPerModality);
+    }
 }
 
 EngineMixer::~EngineMixer() {}
@@ -210,7 +226,12 @@ void EngineMixer::addAudioStream(EngineAudioStream* engineAudioStream)
         endpointIdHash,
         engineAudioStream->_audioMixed ? 't' : 'f');
 
+    // listeners that do not send audio hear the full mix and stay on the shared encoder until they start sending
+    engineAudioStream->_sharedMixEncoding = _sharedMixEncoder && engineAudioStream->_audioMixed &&
+        engineAudioStream->_rtpMap._format == RtpMap::Format::OPUS && !engineAudioStream->_remoteSsrc.isSet();
+
     _engineAudioStreams.emplace(endpointIdHash, engineAudioStream);
+    _audioStreamRegistry.add(engineAudioStream, engineAudioStream->_audioMixed);
     if (engineAudioStream->_audioMixed)
     {
         _numMixedAudioStreams++;
@@ -220,6 +241,7 @@ void EngineMixer::addAudioStream(EngineAudioStream* engineAudioStream)
     {
         sendUserMediaMapMessageToAll();
     }
+    _videoForwardingTable.invalidate();
     updateBandwidthFloor();
 
     sendAudioStreamToRecording(*engineAudioStream, true);
@@ -233,6 +255,7 @@ void EngineMixer::removeAudioStream(EngineAudioStream* engineAudioStream)
     {
         sendUserMediaMapMessageToAll();
     }
+    _videoForwardingTable.invalidate();
     updateBandwidthFloor();
 
     if (engineAudioStream->_transport.isConnected())
@@ -268,6 +291,7 @@ void EngineMixer::removeAudioStream(EngineAudioStream* engineAudioStream)
     }
 
     _engineAudioStreams.erase(endpointIdHash);
+    _audioStreamRegistry.remove(engineAudioStream);
 
     EngineMessage::Message message(EngineMessage::Type::AudioStreamRemoved);
     message._command.audioStreamRemoved._mixer = this;
@@ -302,6 +326,7 @@ void EngineMixer::addVideoStream(EngineVideoStream* engineVideoStream)
     }
 
     _engineVideoStreams.emplace(endpointIdHash, engineVideoStream);
+    _videoStreamRegistry.add(engineVideoStream, false);
     if (engineVideoStream->_simulcastStream._numLevels > 0)
     {
         _engineStreamDirector->addParticipant(endpointIdHash, engineVideoStream->_simulcastStream);
@@ -313,6 +338,7 @@ void EngineMixer::addVideoStream(EngineVideoStream* engineVideoStream)
     {
         _engineStreamDirector->addParticipant(endpointIdHash);
     }
+    _videoForwardingTable.invalidate();
     updateBandwidthFloor();
     sendLastNListMessageToAll();
     sendUserMediaMapMessageToAll();
@@ -390,6 +416,8 @@ void EngineMixer::removeVideoStream(EngineVideoStream* engineVideoStream)
         endpointIdHash);
 
     _engineVideoStreams.erase(endpointIdHash);
+    _videoStreamRegistry.remove(engineVideoStream);
+    _videoForwardingTable.clear();
 
     EngineMessage::Message message(EngineMessage::Type::VideoStreamRemoved);
     message._command.videoStreamRemoved._mixer = this;
@@ -524,6 +552,11 @@ void EngineMixer::reconfigureAudioStream(const transport::RtcTransport* transpor
     {
         engineAudioStream->_remoteSsrc.set(remoteSsrc);
         sendAudioStreamToRecording(*engineAudioStream, true);
+        if (engineAudioStream->_sharedMixEncoding)
+        {
+            engineAudioStream->_sharedMixEncoding = false;
+            engineAudioStream->_sharedMixHandOver = true;
+        }
     }
     else
     {
@@ -605,6 +638,7 @@ void EngineMixer::reconfigureVideoStream(const transport::RtcTransport* transpor
     sendVideoStreamToRecording(*engineVideoStream, true);
 
     memcpy(&engineVideoStream->_ssrcWhitelist, &ssrcWhitelist, sizeof(SsrcWhitelist));
+    _videoForwardingTable.invalidate();
 
     for (auto& videoStreamEntry : _engineVideoStreams)
     {
@@ -617,21 +651,28 @@ void EngineMixer::reconfigureVideoStream(const transport::RtcTransport* transpor
     }
 }
 
-void EngineMixer::addVideoPacketCache(const uint32_t ssrc, const size_t endpointIdHash, PacketCache* videoPacketCache)
+void EngineMixer::addVideoPacketCache(const uint32_t ssrc,
+    const size_t endpointIdHash,
+    VideoPacketCache* videoPacketCache)
 {
-    auto videoStreamItr = _engineVideoStreams.find(endpointIdHash);
-    if (videoStreamItr == _engineVideoStreams.end())
-    {
-        return;
-    }
-
-    auto* ssrcOutboundContext = getOutboundSsrcContext(*videoStreamItr->second, ssrc);
-    if (!ssrcOutboundContext || (ssrcOutboundContext->_packetCache.isSet() && ssrcOutboundContext->_packetCache.get()))
-    {
+    auto inboundContextItr = _ssrcInboundContexts.find(ssrc);
+    if (inboundContextItr == _ssrcInboundContexts.end() ||
+        inboundContextItr->second._sender->getEndpointIdHash() != endpointIdHash ||
+        inboundContextItr->second._packetCache.load())
+    {
+        // the inbound context went away or already has a cache, hand the cache back to be freed
+        EngineMessage::Message message(EngineMessage::Type::FreeVideoPacketCache);
+        message._command.freeVideoPacketCache._mixer = this;
+        message._command.freeVideoPacketCache._ssrc = ssrc;
+        message._command.freeVideoPacketCache._endpointIdHash = endpointIdHash;
+        message._command.freeVideoPacketCache._videoPacketCache = videoPacketCache;
+        _messageListener.onMessage(std::move(message));
         return;
     }
 
-    ssrcOutboundContext->_packetCache.set(videoPacketCache);
+    auto& inboundContext = inboundContextItr->second;
+    inboundContext._packetCacheReference = videoPacketCache->shared_from_this();
+    inboundContext._packetCache.store(videoPacketCache, std::memory_order_release);
 }
 
 void EngineMixer::addAudioBuffer(const uint32_t ssrc, AudioBuffer* audioBuffer)
@@ -784,6 +825,7 @@ void EngineMixer::clear()
         engineAudioStream.second->_transport.setDataReceiver(nullptr);
     }
     _engineAudioStreams.clear();
+    _audioStreamRegistry.clear();
 }
 
 void EngineMixer::flush()
@@ -802,6 +844,8 @@ void EngineMixer::forwardPackets(const uint64_t engineTimestamp)
 void EngineMixer::run(const uint64_t engineIterationStartTimestamp)
 {
     _rtpTimestampSource += framesPerIteration1kHz;
+    _audioStreamRegistry.refreshConnected();
+    _videoStreamRegistry.refreshConnected();
 
     // 1. Process all incoming packets
     forwardPackets(engineIterationStartTimestamp);
@@ -863,6 +907,11 @@ void EngineMixer::runDominantSpeakerCheck(const uint64_t engineIterationStartTim
     bool userMediaMapChanged = false;
     _activeMediaList->process(engineIterationStartTimestamp / 1000000ULL, dominantSpeakerChanged, userMediaMapChanged);
 
+    if (dominantSpeakerChanged || userMediaMapChanged)
+    {
+        _videoForwardingTable.invalidate();
+    }
+
     if (dominantSpeakerChanged)
     {
         const auto dominantSpeaker = _activeMediaList->getDominantSpeaker();
@@ -943,6 +992,17 @@ void EngineMixer::tryRemoveInboundSsrc(uint32_t ssrc)
 
         logger::info("Removing idle inbound context ssrc %u", _loggableId.c_str(), contextIt->first);
 
+        // Receivers have had the same idle period to finish retransmissions from the cache.
+        if (contextIt->second._packetCacheRequested)
+        {
+            EngineMessage::Message message(EngineMessage::Type::FreeVideoPacketCache);
+            message._command.freeVideoPacketCache._mixer = this;
+            message._command.freeVideoPacketCache._ssrc = ssrc;
+            message._command.freeVideoPacketCache._endpointIdHash = contextIt->second._sender->getEndpointIdHash();
+            message._command.freeVideoPacketCache._videoPacketCache = contextIt->second._packetCache.load();
+            _messageListener.onMessage(std::move(message));
+        }
+
         EngineMessage::Message message(EngineMessage::Type::InboundSsrcRemoved);
         message._command.ssrcInboundRemoved._mixer = this;
         message._command.ssrcInboundRemoved._ssrc = ssrc;
@@ -1057,16 +1117,6 @@ void EngineMixer::checkPacketCounters(const uint64_t timestamp)
                     videoStreamEntry.second->_ssrcOutboundContexts.erase(feedbackSsrc);
                 }
 
-                // Pending jobs with reference to this ssrc context has had 30s to complete.
-                // Removing the video packet cache can crash unfinished jobs.
-                {
-                    EngineMessage::Message message(EngineMessage::Type::FreeVideoPacketCache);
-                    message._command.freeVideoPacketCache._mixer = this;
-                    message._command.freeVideoPacketCache._ssrc = outboundContextEntry.first;
-                    message._command.freeVideoPacketCache._endpointIdHash = videoStreamEntry.first;
-                    _messageListener.onMessage(std::move(message));
-                }
-
                 logger::info("Removing idle outbound context ssrc %u, endpointIdHash %lu",
                     _loggableId.c_str(),
                     outboundContextEntry.first,
@@ -1133,6 +1183,7 @@ EngineStats::MixerStats EngineMixer::gatherStats(const uint64_t iterationStartTi
         const auto videoSendCounters = audioStreamEntry.second->_transport.getVideoSendCounters(idleTimestamp);
         const auto pacingQueueCount = audioStreamEntry.second->_transport.getPacingQueueCount();
         const auto rtxPacingQueueCount = audioStreamEntry.second->_transport.getRtxPacingQueueCount();
+        const auto forwardLatency = audioStreamEntry.second->_transport.collectForwardLatency();
 
         stats.inbound.audio += audioRecvCounters;
         stats.outbound.audio += audioSendCounters;
@@ -1140,10 +1191,15 @@ EngineStats::MixerStats EngineMixer::gatherStats(const uint64_t iterationStartTi
         stats.outbound.video += videoSendCounters;
         stats.inbound.transport.addBandwidthGroup(audioStreamEntry.second->_transport.getDownlinkEstimateKbps());
         stats.inbound.transport.addRttGroup(audioStreamEntry.second->_transport.getRtt() / utils::Time::ms);
+        stats.inbound.transport.addSrtpProfileGroup(
+            static_cast<size_t>(audioStreamEntry.second->_transport.getSrtpProfile()));
         stats.inbound.transport.addLossGroup((audioRecvCounters + videoRecvCounters).getReceiveLossRatio());
         stats.outbound.transport.addLossGroup((audioSendCounters + videoSendCounters).getSendLossRatio());
         stats.pacingQueue += pacingQueueCount;
         stats.rtxPacingQueue += rtxPacingQueueCount;
+        stats.forwardLatency += forwardLatency;
+        stats.maxTransportForwardLatencyP99 =
+            std::max(stats.maxTransportForwardLatencyP99, forwardLatency.getPercentile(0.99));
     }
 
     for (auto& videoStreamEntry : _engineVideoStreams)
@@ -1154,17 +1210,24 @@ EngineStats::MixerStats EngineMixer::gatherStats(const uint64_t iterationStartTi
             const auto videoSendCounters = videoStreamEntry.second->_transport.getVideoSendCounters(idleTimestamp);
             const auto pacingQueueCount = videoStreamEntry.second->_transport.getPacingQueueCount();
             const auto rtxPacingQueueCount = videoStreamEntry.second->_transport.getRtxPacingQueueCount();
+            const auto forwardLatency = videoStreamEntry.second->_transport.collectForwardLatency();
 
             stats.inbound.video += videoRecvCounters;
             stats.outbound.video += videoSendCounters;
             stats.inbound.transport.addBandwidthGroup(videoStreamEntry.second->_transport.getDownlinkEstimateKbps());
             stats.inbound.transport.addRttGroup(videoStreamEntry.second->_transport.getRtt() / utils::Time::ms);
+            stats.inbound.transport.addSrtpProfileGroup(
+                static_cast<size_t>(videoStreamEntry.second->_transport.getSrtpProfile()));
             stats.inbound.transport.addLossGroup(videoRecvCounters.getReceiveLossRatio());
             stats.outbound.transport.addLossGroup(videoSendCounters.getSendLossRatio());
             stats.pacingQueue += pacingQueueCount;
             stats.rtxPacingQueue += rtxPacingQueueCount;
+            stats.forwardLatency += forwardLatency;
+            stats.maxTransportForwardLatencyP99 =
+                std::max(stats.maxTransportForwardLatencyP99, forwardLatency.getPercentile(0.99));
         }
     }
+    stats.maxMixerForwardLatencyP99 = stats.forwardLatency.getPercentile(0.99);
 
     {
         stats.audioInQueues = 0;
@@ -1276,6 +1339,14 @@ void EngineMixer::onVideoRtpRtxPacketReceived(SsrcInboundContext* ssrcContext,
         ssrcContext->_videoMissingPacketsTracker = mainSsrcContext._videoMissingPacketsTracker;
     }
 
+    // recovered packets are cached under the main ssrc, so retransmissions of them are found there
+    auto mainPacketCache = mainSsrcContext._packetCache.load(std::memory_order_acquire);
+    if (mainPacketCache && !ssrcContext->_packetCache.load(std::memory_order_relaxed))
+    {
+        ssrcContext->_packetCacheReference = mainSsrcContext._packetCacheReference;
+        ssrcContext->_packetCache.store(mainPacketCache, std::memory_order_release);
+    }
+
     const auto isSenderInLastNList = _activeMediaList->isInActiveVideoList(endpointIdHash);
     if (!_engineStreamDirector->isSsrcUsed(mainSsrc,
             videoStream->_endpointIdHash,
@@ -1377,6 +1448,7 @@ void EngineMixer::pinEndpoint(const size_t endpointIdHash, const size_t targetEn
                     newPinSsrc._ssrc);
             }
         }
+        _videoForwardingTable.invalidate();
     }
 
     sendLastNListMessage(endpointIdHash);
@@ -1665,6 +1737,11 @@ SsrcOutboundContext* EngineMixer::obtainOutboundSsrcContext(EngineVideoStream& v
         return nullptr;
     }
 
+    if (rtpMap._format == RtpMap::Format::VP8)
+    {
+        emplaceResult.first->second._rewriteHistory = std::make_unique<VideoRewriteHistory>();
+    }
+
     logger::info("Created new outbound context for video stream, endpointIdHash %lu, ssrc %u",
         _loggableId.c_str(),
         videoStream._endpointIdHash,
@@ -1847,48 +1924,48 @@ void EngineMixer::processIncomingRtpPackets(const uint64_t timestamp)
             continue;
         }
 
-        for (auto& audioStreamEntry : _engineAudioStreams)
+        const auto sharedPacket = memory::makeSharedPacket(_sharedPacketAllocator, std::move(packetInfo.packet()));
+        if (!sharedPacket)
+        {
+            logger::warn("shared packet allocator depleted FwdSend", _loggableId.c_str());
+            continue;
+        }
+
+        for (size_t i = 0; i < _audioStreamRegistry.size(); ++i)
         {
-            auto audioStream = audioStreamEntry.second;
-            if (!audioStream || &audioStream->_transport == packetInfo.transport() || audioStream->_audioMixed)
+            if (!_audioStreamRegistry.isConnected(i) || _audioStreamRegistry.isMixed(i) ||
+                _audioStreamRegistry.getTransport(i) == packetInfo.transport())
             {
                 continue;
             }
 
-            if (audioStream->_transport.isConnected())
+            auto ssrc = packetInfo.inboundContext()->_ssrc;
+            if (_audioStreamRegistry.isSsrcRewrite(i))
             {
-                auto ssrc = packetInfo.inboundContext()->_ssrc;
-                if (audioStream->_ssrcRewrite)
+                const auto& audioSsrcRewriteMap = _activeMediaList->getAudioSsrcRewriteMap();
+                const auto rewriteMapItr = audioSsrcRewriteMap.find(packetInfo.transport()->getEndpointIdHash());
+                if (rewriteMapItr == audioSsrcRewriteMap.end())
                 {
-                    const auto& audioSsrcRewriteMap = _activeMediaList->getAudioSsrcRewriteMap();
-                    const auto rewriteMapItr = audioSsrcRewriteMap.find(packetInfo.transport()->getEndpointIdHash());
-                    if (rewriteMapItr == audioSsrcRewriteMap.end())
-                    {
-                        continue;
-                    }
-                    ssrc = rewriteMapItr->second;
+                    continue;
                 }
+                ssrc = rewriteMapItr->second;
+            }
 
-                auto* ssrcOutboundContext = obtainOutboundSsrcContext(*audioStream, ssrc);
+            auto* ssrcOutboundContext = _audioStreamRegistry.findOutboundContext(i, ssrc);
+            if (!ssrcOutboundContext)
+            {
+                ssrcOutboundContext = obtainOutboundSsrcContext(*_audioStreamRegistry.getStream(i), ssrc);
                 if (!ssrcOutboundContext)
                 {
                     continue;
                 }
-
-                auto packet = memory::makeUniquePacket(_sendAllocator, *packetInfo.packet());
-                if (packet)
-                {
-                    audioStream->_transport.getJobQueue().addJob<AudioForwarderRewriteAndSendJob>(*ssrcOutboundContext,
-                        *(packetInfo.inboundContext()),
-                        std::move(packet),
-                        packetInfo.extendedSequenceNumber(),
-                        audioStream->_transport);
-                }
-                else
-                {
-                    logger::warn("send allocator depleted FwdSend", _loggableId.c_str());
-                }
             }
+
+            _audioStreamRegistry.getJobQueue(i).addJob<AudioForwarderRewriteAndSendJob>(*ssrcOutboundContext,
+                *(packetInfo.inboundContext()),
+                sharedPacket,
+                packetInfo.extendedSequenceNumber(),
+                *_audioStreamRegistry.getTransport(i));
         }
 
         for (auto& recordingStreams : _engineRecordingStreams)
@@ -1911,7 +1988,7 @@ void EngineMixer::processIncomingRtpPackets(const uint64_t timestamp)
             for (const auto& transportEntry : recordingStream->_transports)
             {
                 ssrcOutboundContext->onRtpSent(timestamp);
-                auto packet = memory::makeUniquePacket(_sendAllocator, *packetInfo.packet());
+                auto packet = memory::makeUniquePacket(_sendAllocator, *sharedPacket);
                 if (packet)
                 {
                     transportEntry.second.getJobQueue().addJob<RecordingAudioForwarderSendJob>(*ssrcOutboundContext,
@@ -1999,114 +2076,138 @@ void EngineMixer::processIncomingRtpPackets(const uint64_t timestamp)
     }
 }
 
-uint32_t EngineMixer::processIncomingVideoRtpPackets(const uint64_t timestamp)
+/**
+ * Evaluates director, active media list and whitelist for every video stream. This is only done when the entry is
+ * missing or stale, see VideoForwardingTable.
+ */
+const VideoForwardingTable::Entry& EngineMixer::getVideoForwardingEntry(const SsrcInboundContext& inboundContext,
+    const size_t senderEndpointIdHash)
 {
-    auto numRtpPackets = 0;
+    const auto directorVersion = _engineStreamDirector->getVersion();
+    auto& entry = _videoForwardingTable.getEntry(inboundContext._ssrc);
+    if (_videoForwardingTable.isValid(entry, directorVersion))
+    {
+        return entry;
+    }
 
-    for (IncomingPacketInfo packetInfo; _incomingForwarderVideoRtp.pop(packetInfo);)
+    _videoForwardingTable.startRebuild(entry, directorVersion);
+    for (size_t slot = 0; slot < _videoStreamRegistry.size(); ++slot)
     {
-        ++numRtpPackets;
-        auto rtpHeader = rtp::RtpHeader::fromPacket(*packetInfo.packet());
-        if (!rtpHeader)
+        const auto endpointIdHash = _videoStreamRegistry.getEndpointIdHash(slot);
+        auto videoStream = _videoStreamRegistry.getStream(slot);
+
+        if (!_engineStreamDirector->shouldForwardSsrc(endpointIdHash, inboundContext._ssrc))
         {
             continue;
         }
-        const auto senderEndpointIdHash = packetInfo.transport()->getEndpointIdHash();
 
-        for (auto& videoStreamEntry : _engineVideoStreams)
+        if (shouldSkipBecauseOfWhitelist(*videoStream, inboundContext._ssrc))
         {
-            const auto endpointIdHash = videoStreamEntry.first;
-            auto videoStream = videoStreamEntry.second;
-            if (!videoStream)
-            {
-                continue;
-            }
-
-            if (!_engineStreamDirector->shouldForwardSsrc(endpointIdHash, packetInfo.inboundContext()->_ssrc))
-            {
-                continue;
-            }
+            continue;
+        }
 
-            if (shouldSkipBecauseOfWhitelist(*videoStream, packetInfo.inboundContext()->_ssrc))
+        auto ssrc = inboundContext._rewriteSsrc;
+        if (_videoStreamRegistry.isSsrcRewrite(slot))
+        {
+            const auto& screenShareSsrcMapping = _activeMediaList->getVideoScreenShareSsrcMapping();
+            if (screenShareSsrcMapping.isSet() && screenShareSsrcMapping.get().first == senderEndpointIdHash &&
+                screenShareSsrcMapping.get().second._ssrc == ssrc)
             {
-                continue;
+                ssrc = screenShareSsrcMapping.get().second._rewriteSsrc;
             }
-
-            auto ssrc = packetInfo.inboundContext()->_rewriteSsrc;
-            if (videoStream->_ssrcRewrite)
+            else if (_engineStreamDirector->getPinTarget(endpointIdHash) == senderEndpointIdHash &&
+                !_activeMediaList->isInUserActiveVideoList(senderEndpointIdHash))
             {
-                const auto& screenShareSsrcMapping = _activeMediaList->getVideoScreenShareSsrcMapping();
-                if (screenShareSsrcMapping.isSet() && screenShareSsrcMapping.get().first == senderEndpointIdHash &&
-                    screenShareSsrcMapping.get().second._ssrc == ssrc)
+                if (videoStream->_pinSsrc.isSet())
                 {
-                    ssrc = screenShareSsrcMapping.get().second._rewriteSsrc;
-                }
-                else if (_engineStreamDirector->getPinTarget(endpointIdHash) == senderEndpointIdHash &&
-                    !_activeMediaList->isInUserActiveVideoList(senderEndpointIdHash))
-                {
-                    if (videoStream->_pinSsrc.isSet())
-                    {
-                        ssrc = videoStream->_pinSsrc.get()._ssrc;
-                    }
-                    else
-                    {
-                        assert(false);
-                        continue;
-                    }
+                    ssrc = videoStream->_pinSsrc.get()._ssrc;
                 }
                 else
                 {
-                    const auto& videoSsrcRewriteMap = _activeMediaList->getVideoSsrcRewriteMap();
-                    const auto rewriteMapItr = videoSsrcRewriteMap.find(senderEndpointIdHash);
-                    if (rewriteMapItr == videoSsrcRewriteMap.end())
-                    {
-                        continue;
-                    }
-                    ssrc = rewriteMapItr->second._ssrc;
+                    assert(false);
+                    continue;
                 }
             }
             else
             {
-                uint32_t fbSsrc = 0;
-                _engineStreamDirector->getFeedbackSsrc(ssrc, fbSsrc);
+                const auto& videoSsrcRewriteMap = _activeMediaList->getVideoSsrcRewriteMap();
+                const auto rewriteMapItr = videoSsrcRewriteMap.find(senderEndpointIdHash);
+                if (rewriteMapItr == videoSsrcRewriteMap.end())
+                {
+                    continue;
+                }
+                ssrc = rewriteMapItr->second._ssrc;
             }
+        }
 
-            auto* ssrcOutboundContext = obtainOutboundSsrcContext(*videoStream, ssrc, videoStream->_rtpMap);
-            if (!ssrcOutboundContext)
+        entry._targets.push_back({static_cast<uint32_t>(slot), ssrc});
+    }
+
+    return entry;
+}
+
+uint32_t EngineMixer::processIncomingVideoRtpPackets(const uint64_t timestamp)
+{
+    auto numRtpPackets = 0;
+
+    for (IncomingPacketInfo packetInfo; _incomingForwarderVideoRtp.pop(packetInfo);)
+    {
+        ++numRtpPackets;
+        auto rtpHeader = rtp::RtpHeader::fromPacket(*packetInfo.packet());
+        if (!rtpHeader)
+        {
+            continue;
+        }
+        const auto senderEndpointIdHash = packetInfo.transport()->getEndpointIdHash();
+
+        const auto sharedPacket = memory::makeSharedPacket(_sharedPacketAllocator, std::move(packetInfo.packet()));
+        if (!sharedPacket)
+        {
+            logger::warn("shared packet allocator depleted FwdRewrite", _loggableId.c_str());
+            continue;
+        }
+
+        auto& inboundContext = *packetInfo.inboundContext();
+        const auto& forwardingEntry = getVideoForwardingEntry(inboundContext, senderEndpointIdHash);
+        if (!forwardingEntry._targets.empty() && !inboundContext._packetCacheRequested &&
+            inboundContext._rtpMap._format != RtpMap::Format::VP8RTX)
+        {
+            logger::debug("Forwarding ssrc %u, sending request to add videoPacketCache",
+                _loggableId.c_str(),
+                inboundContext._ssrc);
+
+            inboundContext._packetCacheRequested = true;
             {
-                continue;
+                EngineMessage::Message message(EngineMessage::Type::AllocateVideoPacketCache);
+                message._command.allocateVideoPacketCache._mixer = this;
+                message._command.allocateVideoPacketCache._ssrc = inboundContext._ssrc;
+                message._command.allocateVideoPacketCache._endpointIdHash = senderEndpointIdHash;
+                _messageListener.onMessage(std::move(message));
             }
+        }
 
-            if (!ssrcOutboundContext->_packetCache.isSet())
+        for (const auto& target : forwardingEntry._targets)
+        {
+            const auto slot = target._slot;
+            auto* ssrcOutboundContext = _videoStreamRegistry.findOutboundContext(slot, target._ssrc);
+            if (!ssrcOutboundContext)
             {
-                logger::debug("New ssrc %u seen, sending request to add videoPacketCache", _loggableId.c_str(), ssrc);
-
-                ssrcOutboundContext->_packetCache.set(nullptr);
+                auto videoStream = _videoStreamRegistry.getStream(slot);
+                ssrcOutboundContext = obtainOutboundSsrcContext(*videoStream, target._ssrc, videoStream->_rtpMap);
+                if (!ssrcOutboundContext)
                 {
-                    EngineMessage::Message message(EngineMessage::Type::AllocateVideoPacketCache);
-                    message._command.allocateVideoPacketCache._mixer = this;
-                    message._command.allocateVideoPacketCache._ssrc = ssrc;
-                    message._command.allocateVideoPacketCache._endpointIdHash = endpointIdHash;
-                    _messageListener.onMessage(std::move(message));
+                    continue;
                 }
             }
 
-            if (videoStream->_transport.isConnected())
+            if (_videoStreamRegistry.isConnected(slot))
             {
                 ssrcOutboundContext->onRtpSent(timestamp); // marks that we have active jobs on this ssrc context
-                auto packet = memory::makeUniquePacket(_sendAllocator, *packetInfo.packet());
-                if (packet)
-                {
-                    videoStream->_transport.getJobQueue().addJob<VideoForwarderRewriteAndSendJob>(*ssrcOutboundContext,
-                        *(packetInfo.inboundContext()),
-                        std::move(packet),
-                        videoStream->_transport,
-                        packetInfo.extendedSequenceNumber());
-                }
-                else
-                {
-                    logger::warn("send allocator depleted FwdRewrite", _loggableId.c_str());
-                }
+                _videoStreamRegistry.getJobQueue(slot).addJob<VideoForwarderRewriteAndSendJob>(*ssrcOutboundContext,
+                    inboundContext,
+                    sharedPacket,
+                    *_videoStreamRegistry.getTransport(slot),
+                    packetInfo.extendedSequenceNumber());
             }
         }
 
@@ -2136,19 +2237,11 @@ uint32_t EngineMixer::processIncomingVideoRtpPackets(const uint64_t timestamp)
             for (const auto& transportEntry : recordingStream->_transports)
             {
                 ssrcOutboundContext->onRtpSent(timestamp); // active jobs on this ssrc context
-                auto packet = memory::makeUniquePacket(_sendAllocator, *packetInfo.packet());
-                if (packet)
-                {
-                    transportEntry.second.getJobQueue().addJob<VideoForwarderRewriteAndSendJob>(*ssrcOutboundContext,
-                        *(packetInfo.inboundContext()),
-                        std::move(packet),
-                        transportEntry.second,
-                        packetInfo.extendedSequenceNumber());
-                }
-                else
-                {
-                    logger::warn("send allocator depleted FwdRewrite", _loggableId.c_str());
-                }
+                transportEntry.second.getJobQueue().addJob<VideoForwarderRewriteAndSendJob>(*ssrcOutboundContext,
+                    *(packetInfo.inboundContext()),
+                    sharedPacket,
+                    transportEntry.second,
+                    packetInfo.extendedSequenceNumber());
             }
         }
     }
@@ -2269,8 +2362,7 @@ void EngineMixer::processIncomingTransportFbRtcpPacket(const transport::RtcTrans
     auto rtcpSenderVideoStream = rtcpSenderVideoStreamItr->second;
 
     auto* mediaSsrcOutboundContext = getOutboundSsrcContext(*rtcpSenderVideoStream, mediaSsrc);
-    if (!mediaSsrcOutboundContext || !mediaSsrcOutboundContext->_packetCache.isSet() ||
-        !mediaSsrcOutboundContext->_packetCache.get())
+    if (!mediaSsrcOutboundContext || !mediaSsrcOutboundContext->_rewriteHistory)
     {
         return;
     }
@@ -2300,7 +2392,7 @@ void EngineMixer::processIncomingTransportFbRtcpPacket(const transport::RtcTrans
         rtcpSenderVideoStream->_transport.getJobQueue().addJob<bridge::VideoNackReceiveJob>(
             *feedbackSsrcOutboundContext,
             rtcpSenderVideoStream->_transport,
-            *(mediaSsrcOutboundContext->_packetCache.get()),
+            *mediaSsrcOutboundContext,
             pid,
             blp,
             feedbackSsrc,
@@ -2311,7 +2403,7 @@ void EngineMixer::processIncomingTransportFbRtcpPacket(const transport::RtcTrans
 
 void EngineMixer::mixSsrcBuffers()
 {
-    memset(_mixedData, 0, samplesPerIteration * codec::Opus::bytesPerSample);
+    memset(_mixAccumulator, 0, samplesPerIteration * sizeof(int32_t));
     for (auto& mixerAudioBufferEntry : _mixerSsrcAudioBuffers)
     {
         if (!mixerAudioBufferEntry.second)
@@ -2334,15 +2426,20 @@ void EngineMixer::mixSsrcBuffers()
             mixerAudioBufferEntry.second->insertSilence(samplesPerIteration);
         }
 
-        mixerAudioBufferEntry.second->addToMix(_mixedData, samplesPerIteration, mixSampleScaleFactor);
+        codec::addToMix(*mixerAudioBufferEntry.second, _mixAccumulator, samplesPerIteration);
     }
+
+    codec::mixLimit(_mixAccumulator, _mixedData, samplesPerIteration, mixSampleScaleFactor);
+    _mixedDataAudioLevel.clear();
 }
 
 inline void EngineMixer::processAudioStreams()
 {
-    for (auto& audioStreamEntry : _engineAudioStreams)
+    _sharedMixListeners.clear();
+
+    for (size_t i = 0; i < _audioStreamRegistry.size(); ++i)
     {
-        auto audioStream = audioStreamEntry.second;
+        auto audioStream = _audioStreamRegistry.getStream(i);
         auto isContributingToMix = false;
         AudioBuffer* audioBuffer = nullptr;
 
@@ -2356,7 +2453,7 @@ inline void EngineMixer::processAudioStreams()
 
             isContributingToMix = audioBuffer && !audioBuffer->isPreBuffering();
 
-            if (!audioStream->_audioMixed || !audioStream->_transport.isConnected())
+            if (!_audioStreamRegistry.isMixed(i) || !_audioStreamRegistry.isConnected(i))
             {
                 if (isContributingToMix)
                 {
@@ -2366,42 +2463,117 @@ inline void EngineMixer::processAudioStreams()
             }
         }
 
-        if (!audioStream->_audioMixed)
+        if (!_audioStreamRegistry.isMixed(i))
         {
             continue;
         }
 
-        auto audioPacket = memory::makeUniquePacket(_audioAllocator);
-        if (!audioPacket)
+        if (audioStream->_sharedMixEncoding)
         {
-            return;
+            _sharedMixListeners.push_back(audioStream);
+            continue;
         }
 
-        auto rtpHeader = rtp::RtpHeader::create(*audioPacket);
-        rtpHeader->ssrc = audioStream->_localSsrc;
+        encodeMixForStream(*audioStream, isContributingToMix ? audioBuffer : nullptr);
+    }
+
+    if (!_sharedMixListeners.empty())
+    {
+        encodeSharedMix();
+    }
+}
+
+void EngineMixer::encodeMixForStream(EngineAudioStream& audioStream, AudioBuffer* contributingAudioBuffer)
+{
+    auto audioPacket = memory::makeUniquePacket(_audioAllocator);
+    if (!audioPacket)
+    {
+        return;
+    }
+
+    auto rtpHeader = rtp::RtpHeader::create(*audioPacket);
+    rtpHeader->ssrc = audioStream._localSsrc;
+
+    auto payloadStart = rtpHeader->getPayload();
+    const auto headerLength = rtpHeader->headerLength();
+    audioPacket->setLength(headerLength + samplesPerIteration * bytesPerSample);
 
-        auto payloadStart = rtpHeader->getPayload();
-        const auto headerLength = rtpHeader->headerLength();
-        audioPacket->setLength(headerLength + samplesPerIteration * bytesPerSample);
+    if (contributingAudioBuffer)
+    {
+        if (!codec::removeFromMix(*contributingAudioBuffer,
+                _mixAccumulator,
+                reinterpret_cast<int16_t*>(payloadStart),
+                samplesPerIteration,
+                mixSampleScaleFactor))
+        {
+            logger::debug("contributing audio buffer underrun, sending silence", _loggableId.c_str());
+            memset(payloadStart, 0, samplesPerIteration * bytesPerSample);
+        }
+        contributingAudioBuffer->drop(samplesPerIteration);
+    }
+    else
+    {
         memcpy(payloadStart, _mixedData, samplesPerIteration * bytesPerSample);
+    }
 
-        if (isContributingToMix && audioBuffer)
+    auto* ssrcContext = obtainOutboundSsrcContext(audioStream, audioStream._localSsrc);
+    if (ssrcContext)
+    {
+        // non contributing listeners all get the full mix, so its level is computed once per tick
+        const auto audioLevel =
+            contributingAudioBuffer ? utils::Optional<int>() : utils::Optional<int>(getMixedDataAudioLevel());
+        if (!_sharedMixEncoder)
         {
-            audioBuffer->removeFromMix(reinterpret_cast<int16_t*>(payloadStart),
-                samplesPerIteration,
-                mixSampleScaleFactor);
-            audioBuffer->drop(samplesPerIteration);
+            audioStream._transport.getJobQueue().addJob<EncodeJob>(std::move(audioPacket),
+                *ssrcContext,
+                audioStream._transport,
+                _rtpTimestampSource,
+                audioLevel);
         }
+        else if (_sharedMixEncoder->postOwnFrame(std::move(audioPacket),
+                     *ssrcContext,
+                     audioStream._transport,
+                     _rtpTimestampSource,
+                     audioLevel,
+                     audioStream._sharedMixHandOver))
+        {
+            audioStream._sharedMixHandOver = false;
+        }
+    }
+}
+
+/**
+ * All listeners in _sharedMixListeners hear the unmodified mix. It is encoded once by the SharedMixEncoder, which fans
+ * the encoded payload out to the listeners' transports where each only gets its own RTP header and SRTP protection.
+ * The listeners skip this frame if the encoder is too far behind, rather than switching encoder.
+ */
+void EngineMixer::encodeSharedMix()
+{
+    if (!_sharedMixEncoder->beginFrame())
+    {
+        logger::warn("shared mix encoding is behind, skipping frame", _loggableId.c_str());
+        return;
+    }
 
+    for (auto* audioStream : _sharedMixListeners)
+    {
         auto* ssrcContext = obtainOutboundSsrcContext(*audioStream, audioStream->_localSsrc);
         if (ssrcContext)
         {
-            audioStream->_transport.getJobQueue().addJob<EncodeJob>(std::move(audioPacket),
-                *ssrcContext,
-                audioStream->_transport,
-                _rtpTimestampSource);
+            _sharedMixEncoder->addListener(*ssrcContext, audioStream->_transport);
         }
     }
+
+    _sharedMixEncoder->encodeFrame(_mixedData, samplesPerIteration, _rtpTimestampSource, getMixedDataAudioLevel());
+}
+
+int EngineMixer::getMixedDataAudioLevel()
+{
+    if (!_mixedDataAudioLevel.isSet())
+    {
+        _mixedDataAudioLevel.set(codec::computeAudioLevel(_mixedData, samplesPerIteration));
+    }
+    return _mixedDataAudioLevel.get();
 }
 
 void EngineMixer::sendPliForUsedSsrcs(EngineVideoStream& videoStream)
@@ -1,13 +1,18 @@
 #pragma once
 
 #include "bridge/engine/EngineStats.h"
+#include "bridge/engine/EngineStreamRegistry.h"
+#include "bridge/engine/SharedMixEncoder.h"
 #include "bridge/engine/SimulcastStream.h"
 #include "bridge/engine/SsrcInboundContext.h"
+#include "bridge/engine/VideoForwardingTable.h"
 #include "concurrency/MpmcHashmap.h"
 #include "memory/AudioPacketPoolAllocator.h"
 #include "memory/PacketPoolAllocator.h"
 #include "memory/RingBuffer.h"
+#include "memory/SharedPacket.h"
 #include "transport/RtcTransport.h"
+#include "utils/Optional.h"
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
@@ -34,6 +39,7 @@ namespace bridge
 class EngineStreamDirector;
 class ActiveMediaList;
 class PacketCache;
+class VideoPacketCache;
 struct SsrcWhitelist;
 struct RecordingDescription;
 class EngineMessageListener;
@@ -95,7 +101,7 @@ public:
         const SsrcWhitelist& ssrcWhitelist,
         const SimulcastStream& simulcastStream,
         const SimulcastStream* secondarySimulcastStream = nullptr);
-    void addVideoPacketCache(const uint32_t ssrc, const size_t endpointIdHash, PacketCache* videoPacketCache);
+    void addVideoPacketCache(const uint32_t ssrc, const size_t endpointIdHash, VideoPacketCache* videoPacketCache);
     void handleSctpControl(const size_t endpointIdHash, const memory::Packet& packet);
     void pinEndpoint(const size_t endpointIdHash, const size_t targetEndpointIdHash);
     void sendEndpointMessage(const size_t toEndpointIdHash, const size_t fromEndpointIdHash, const char* message);
@@ -166,6 +172,7 @@ public:
 private:
     static const size_t maxPendingPackets = 4096;
     static const size_t maxPendingRtcpPackets = 2048;
+    static const size_t maxSharedPackets = 8192;
     static const size_t maxSsrcs = 8192;
     static const size_t maxStreamsPerModality = 4096;
     static const size_t maxRecordingStreams = 8;
@@ -299,15 +306,24 @@ private:
     concurrency::MpmcHashmap32<size_t, EngineDataStream*> _engineDataStreams;
     concurrency::MpmcHashmap32<size_t, EngineRecordingStream*> _engineRecordingStreams;
 
+    // Receivers in the order the fan-out loops visit them
+    EngineStreamRegistry<EngineAudioStream> _audioStreamRegistry;
+    EngineStreamRegistry<EngineVideoStream> _videoStreamRegistry;
+
     concurrency::MpmcHashmap32<uint32_t, SsrcInboundContext> _ssrcInboundContexts;
 
     uint32_t _localVideoSsrc;
 
+    // Sum of all contributors. _mixedData is the scaled and limited full mix.
+    int32_t _mixAccumulator[samplesPerIteration];
     int16_t _mixedData[samplesPerIteration];
+    utils::Optional<int> _mixedDataAudioLevel;
     uint64_t _rtpTimestampSource; // 1kHz. it works with wrapping since it is truncated to uint32.
 
     memory::PacketPoolAllocator& _sendAllocator;
     memory::AudioPacketPoolAllocator& _audioAllocator;
+    // Inbound packets in flight to several receivers. Must outlive the forwarding jobs, as the inbound contexts do.
+    memory::SharedPacketPoolAllocator _sharedPacketAllocator;
 
     uint64_t _lastReceiveTime;
 
@@ -322,9 +338,17 @@ private:
     uint32_t _numMixedAudioStreams;
 
     uint64_t _lastVideoBandwidthCheck;
+    VideoForwardingTable _videoForwardingTable;
+
+    // Listeners that hear the full mix this iteration and share one encoded packet
+    std::vector<EngineAudioStream*> _sharedMixListeners;
+    // only created if shared encoding is configured
+    std::unique_ptr<SharedMixEncoder> _sharedMixEncoder;
 
     void processIncomingRtpPackets(const uint64_t timestamp);
     uint32_t processIncomingVideoRtpPackets(const uint64_t timestamp);
+    const VideoForwardingTable::Entry& getVideoForwardingEntry(const SsrcInboundContext& inboundContext,
+        const size_t senderEndpointIdHash);
     void processIncomingRtcpPackets(const uint64_t timestamp);
     void processIncomingPayloadSpecificRtcpPacket(const size_t rtcpSenderEndpointIdHash,
         const rtp::RtcpHeader& rtcpPacket);
@@ -336,6 +360,9 @@ private:
 
     void mixSsrcBuffers();
     void processAudioStreams();
+    void encodeMixForStream(EngineAudioStream& audioStream, AudioBuffer* contributingAudioBuffer);
+    void encodeSharedMix();
+    int getMixedDataAudioLevel();
     void runDominantSpeakerCheck(const uint64_t engineIterationStartTimestamp);
     void updateDirectorUplinkEstimates(const uint64_t engineIterationStartTimestamp);
     void processMissingPackets(const uint64_t timestamp);
@@ -2,6 +2,7 @@
 
 #include "transport/PacketCounters.h"
 #include "transport/TransportStats.h"
+#include "utils/LatencyHistogram.h"
 #include <algorithm>
 #include <cstdint>
 
@@ -33,6 +34,11 @@ struct MixerStats
     uint32_t pacingQueue = 0;
     uint32_t rtxPacingQueue = 0;
 
+    // receive to send of forwarded RTP since the previous sample, and the worst p99 of a single mixer and transport
+    utils::LatencyHistogram::Snapshot forwardLatency;
+    uint64_t maxMixerForwardLatencyP99 = 0;
+    uint64_t maxTransportForwardLatencyP99 = 0;
+
     MixerStats& operator+=(const MixerStats& b)
     {
         audioInQueueSamples += b.audioInQueueSamples;
@@ -50,6 +56,10 @@ struct MixerStats
         pacingQueue += b.pacingQueue;
         rtxPacingQueue += b.rtxPacingQueue;
 
+        forwardLatency += b.forwardLatency;
+        maxMixerForwardLatencyP99 = std::max(maxMixerForwardLatencyP99, b.maxMixerForwardLatencyP99);
+        maxTransportForwardLatencyP99 = std::max(maxTransportForwardLatencyP99, b.maxTransportForwardLatencyP99);
+
         return *this;
     }
 
@@ -63,6 +73,15 @@ struct EngineStats
     uint32_t pollPeriodMs = 1;
 
     MixerStats activeMixers;
+
+    EngineStats& operator+=(const EngineStats& b)
+    {
+        timeSlipCount += b.timeSlipCount;
+        pollPeriodMs = std::max(pollPeriodMs, b.pollPeriodMs);
+        activeMixers += b.activeMixers;
+
+        return *this;
+    }
 };
 
 } // namespace EngineStats
@@ -7,6 +7,7 @@
 #include "logger/Logger.h"
 #include "utils/Optional.h"
 #include "utils/Time.h"
+#include <atomic>
 #include <cstdint>
 
 #define DEBUG_DIRECTOR 0
@@ -44,10 +45,17 @@ public:
           _midQualitySsrcs(maxParticipants),
           _bandwidthFloor(0),
           _requiredMidLevelBandwidth(0),
-          _maxDefaultLevelBandwidthKbps(config.maxDefaultLevelBandwidthKbps)
+          _maxDefaultLevelBandwidthKbps(config.maxDefaultLevelBandwidthKbps),
+          _version(0)
     {
     }
 
+    /**
+     * Incremented on every change that can alter the result of shouldForwardSsrc and getPinTarget. Used to
+     * invalidate forwarding decisions cached by the mixer.
+     */
+    uint32_t getVersion() const { return _version.load(std::memory_order_acquire); }
+
     void addParticipant(const size_t endpointIdHash)
     {
         if (_participantStreams.find(endpointIdHash) != _participantStreams.end())
@@ -64,6 +72,7 @@ public:
         memset(&emptyStream, 0, sizeof(SimulcastStream));
         _participantStreams.emplace(endpointIdHash,
             makeParticipantStreams(emptyStream, utils::Optional<SimulcastStream>()));
+        onStateChanged();
     }
 
     void addParticipant(const size_t endpointIdHash,
@@ -115,6 +124,7 @@ public:
             _participantStreams.emplace(endpointIdHash,
                 makeParticipantStreams(primary, utils::Optional<SimulcastStream>()));
         }
+        onStateChanged();
     }
 
     void removeParticipant(const size_t endpointIdHash)
@@ -141,6 +151,7 @@ public:
             _requiredMidLevelBandwidth -= bwe::BandwidthUtils::getSimulcastLevelKbps(midQuality);
         }
         _participantStreams.erase(endpointIdHash);
+        onStateChanged();
 
         logger::info("removeParticipant, endpointIdHash %lu", "EngineStreamDirector", endpointIdHash);
         return;
@@ -179,6 +190,7 @@ public:
                 _pinMap.erase(pinMapEntry.second);
             }
         }
+        onStateChanged();
     }
 
     size_t pin(const size_t endpointIdHash, const size_t targetEndpointIdHash)
@@ -202,6 +214,7 @@ public:
             _reversePinMap.emplace(targetEndpointIdHash, count);
             _pinMap.emplace(endpointIdHash, targetEndpointIdHash);
         }
+        onStateChanged();
 
         logger::info("pin, endpointIdHash %lu, targetEndpointIdHash %lu, oldTarget %lu",
             "EngineStreamDirector",
@@ -226,6 +239,7 @@ public:
     void updateBandwidthFloor(const uint32_t lastN, const uint32_t audioStreams, const uint32_t videoStreams)
     {
         _bandwidthFloor = bwe::BandwidthUtils::calcBandwidthFloor(lowQuality, lastN, audioStreams, videoStreams);
+        onStateChanged();
         logger::debug("updateBandwidthFloor lastN %u, audioStreams %u, videoStreams %u -> %u",
             "EngineStreamDirector",
             lastN,
@@ -247,7 +261,12 @@ public:
         }
         auto& participantStream = participantStreamsItr->second;
 
+        const auto oldWantedDefaultLevelQuality = getWantedDefaultLevelQuality(participantStream);
         participantStream._defaultLevelBandwidthLimit = std::min(uplinkEstimateKbps, _maxDefaultLevelBandwidthKbps);
+        if (getWantedDefaultLevelQuality(participantStream) != oldWantedDefaultLevelQuality)
+        {
+            onStateChanged();
+        }
         participantStream._desiredHighestEstimatedPinnedLevel =
             bwe::BandwidthUtils::calcPinnedHighestSimulcastLevel(lowQuality, _bandwidthFloor, uplinkEstimateKbps);
 
@@ -267,6 +286,7 @@ public:
 
             participantStream._highestEstimatedPinnedLevel = participantStream._desiredHighestEstimatedPinnedLevel;
             participantStream._lowEstimateTimestamp = timestamp;
+            onStateChanged();
             return true;
         }
 
@@ -290,6 +310,7 @@ public:
 
             participantStream._highestEstimatedPinnedLevel = participantStream._desiredHighestEstimatedPinnedLevel;
             participantStream._lowEstimateTimestamp = timestamp;
+            onStateChanged();
             return true;
         }
 
@@ -447,7 +468,9 @@ public:
             if (ssrc == primary._levels[i]._ssrc)
             {
                 primary._levels[i]._mediaActive = active;
-                return setHighestActiveIndex(endpointIdHash, primary);
+                const auto result = setHighestActiveIndex(endpointIdHash, primary);
+                onStateChanged();
+                return result;
             }
         }
 
@@ -458,7 +481,9 @@ public:
                 if (ssrc == secondary.get()._levels[i]._ssrc)
                 {
                     secondary.get()._levels[i]._mediaActive = active;
-                    return setHighestActiveIndex(endpointIdHash, secondary.get());
+                    const auto result = setHighestActiveIndex(endpointIdHash, secondary.get());
+                    onStateChanged();
+                    return result;
                 }
             }
         }
@@ -571,6 +596,11 @@ private:
     /** Bandwidth cap for sending default levels to participants without pin targets */
     uint32_t _maxDefaultLevelBandwidthKbps;
 
+    /** Stream state is also changed from transport threads, see streamActiveStateChanged */
+    std::atomic_uint32_t _version;
+
+    inline void onStateChanged() { _version.fetch_add(1, std::memory_order_release); }
+
     inline bool isParticipantHighestActiveQuality(const size_t endpointIdHash,
         const size_t viewedByEndpointIdHash,
         const uint32_t ssrc)
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "bridge/engine/SsrcOutboundContext.h"
+#include "concurrency/MpmcHashmap.h"
+#include "transport/RtcTransport.h"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bridge
+{
+
+/**
+ * Dense registry of the receiving audio or video streams of a mixer. The fields read for every forwarded packet and
+ * every tick are kept in parallel arrays indexed by slot, so fan-out loops stream through memory instead of visiting
+ * hashmap entries and dereferencing stream and transport objects.
+ * Streams are added to the end and removed by moving the last stream into the freed slot, which means slots are only
+ * stable until the next remove. The connected state is sampled in refreshConnected, once per tick.
+ * Only used from the engine thread.
+ */
+template <typename StreamT>
+class EngineStreamRegistry
+{
+public:
+    using OutboundContexts = concurrency::MpmcHashmap32<uint32_t, SsrcOutboundContext>;
+
+    explicit EngineStreamRegistry(const size_t capacity)
+    {
+        _streams.reserve(capacity);
+        _endpointIdHashes.reserve(capacity);
+        _transports.reserve(capacity);
+        _jobQueues.reserve(capacity);
+        _outboundContexts.reserve(capacity);
+        _flags.reserve(capacity);
+    }
+
+    void add(StreamT* stream, const bool mixed)
+    {
+        assert(find(stream) == size());
+        _streams.push_back(stream);
+        _endpointIdHashes.push_back(stream->_endpointIdHash);
+        _transports.push_back(&stream->_transport);
+        _jobQueues.push_back(&stream->_transport.getJobQueue());
+        _outboundContexts.push_back(&stream->_ssrcOutboundContexts);
+        _flags.push_back((stream->_transport.isConnected() ? CONNECTED : 0) | (mixed ? MIXED : 0) |
+            (stream->_ssrcRewrite ? SSRC_REWRITE : 0));
+    }
+
+    bool remove(const StreamT* stream)
+    {
+        const auto slot = find(stream);
+        if (slot == size())
+        {
+            return false;
+        }
+
+        const auto last = size() - 1;
+        _streams[slot] = _streams[last];
+        _endpointIdHashes[slot] = _endpointIdHashes[last];
+        _transports[slot] = _transports[last];
+        _jobQueues[slot] = _jobQueues[last];
+        _outboundContexts[slot] = _outboundContexts[last];
+        _flags[slot] = _flags[last];
+
+        _streams.pop_back();
+        _endpointIdHashes.pop_back();
+        _transports.pop_back();
+        _jobQueues.pop_back();
+        _outboundContexts.pop_back();
+        _flags.pop_back();
+        return true;
+    }
+
+    void clear()
+    {
+        _streams.clear();
+        _endpointIdHashes.clear();
+        _transports.clear();
+        _jobQueues.clear();
+        _outboundContexts.clear();
+        _flags.clear();
+    }
+
+    void refreshConnected()
+    {
+        for (size_t i = 0; i < _flags.size(); ++i)
+        {
+            _flags[i] = (_transports[i]->isConnected() ? _flags[i] | CONNECTED : _flags[i] & ~CONNECTED);
+        }
+    }
+
+    size_t size() const { return _streams.size(); }
+
+    /** @return slot of the stream or size() if it is not registered */
+    size_t find(const StreamT* stream) const
+    {
+        for (size_t i = 0; i < _streams.size(); ++i)
+        {
+            if (_streams[i] == stream)
+            {
+                return i;
+            }
+        }
+        return _streams.size();
+    }
+
+    StreamT* getStream(const size_t slot) const { return _streams[slot]; }
+    size_t getEndpointIdHash(const size_t slot) const { return _endpointIdHashes[slot]; }
+    transport::RtcTransport* getTransport(const size_t slot) const { return _transports[slot]; }
+    jobmanager::JobQueue& getJobQueue(const size_t slot) const { return *_jobQueues[slot]; }
+
+    bool isConnected(const size_t slot) const { return _flags[slot] & CONNECTED; }
+    bool isMixed(const size_t slot) const { return _flags[slot] & MIXED; }
+    bool isSsrcRewrite(const size_t slot) const { return _flags[slot] & SSRC_REWRITE; }
+
+    /** @return existing outbound context for ssrc, or nullptr if it has not been created yet */
+    SsrcOutboundContext* findOutboundContext(const size_t slot, const uint32_t ssrc) const
+    {
+        auto* outboundContexts = _outboundContexts[slot];
+        auto it = outboundContexts->find(ssrc);
+        return it != outboundContexts->end() ? &it->second : nullptr;
+    }
+
+private:
+    enum Flags : uint8_t
+    {
+        CONNECTED = 1,
+        MIXED = 2,
+        SSRC_REWRITE = 4
+    };
+
+    std::vector<StreamT*> _streams;
+    std::vector<size_t> _endpointIdHashes;
+    std::vector<transport::RtcTransport*> _transports;
+    std::vector<jobmanager::JobQueue*> _jobQueues;
+    std::vector<OutboundContexts*> _outboundContexts;
+    std::vector<uint8_t> _flags;
+};
+
+} // namespace bridge
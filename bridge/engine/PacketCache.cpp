@@ -73,6 +73,7 @@ bool PacketCache::add(const memory::Packet& packet, const uint16_t sequenceNumbe
     {
         return false;
     }
+    cachedPacket->setReceiveTime(0); // retransmissions are not forwarded packets
 
     _cache.emplace(sequenceNumber, std::move(cachedPacket));
     _arrivalQueue.push(sequenceNumber);
@@ -0,0 +1,100 @@
+#include "bridge/engine/SharedMixEncodeJob.h"
+#include "bridge/engine/EncodedMixSendJob.h"
+#include "bridge/engine/EngineMixer.h"
+#include "bridge/engine/SsrcOutboundContext.h"
+#include "codec/OpusEncoder.h"
+#include "jobmanager/JobQueue.h"
+#include "logger/Logger.h"
+#include "memory/Packet.h"
+#include "rtp/RtpHeader.h"
+#include "transport/Transport.h"
+
+namespace
+{
+// room left in the packet for abs-send-time and audio level header extensions
+const size_t maxAudioHeaderExtensionsSize = 4 + 4 + 4;
+} // namespace
+
+namespace bridge
+{
+
+void SharedMixFanOut::add(SsrcOutboundContext& outboundContext, transport::Transport& transport)
+{
+    ++transport.getJobCounter();
+    outboundContext._framesOnSharedMixQueue.fetch_add(1, std::memory_order_relaxed);
+    targets.push_back(Target{&outboundContext, &transport});
+}
+
+void SharedMixFanOut::release()
+{
+    for (auto& target : targets)
+    {
+        target.outboundContext->_framesOnSharedMixQueue.fetch_sub(1, std::memory_order_release);
+        --target.transport->getJobCounter();
+    }
+    targets.clear();
+    pending.store(false, std::memory_order_release);
+}
+
+SharedMixEncodeJob::SharedMixEncodeJob(memory::UniqueAudioPacket pcmPacket,
+    codec::OpusEncoder& encoder,
+    SharedMixFanOut& fanOut,
+    memory::PacketPoolAllocator& allocator,
+    memory::SharedPacketPoolAllocator& sharedAllocator,
+    const uint64_t rtpTimestamp,
+    const int audioLevel)
+    : _pcmPacket(std::move(pcmPacket)),
+      _encoder(encoder),
+      _fanOut(fanOut),
+      _allocator(allocator),
+      _sharedAllocator(sharedAllocator),
+      _rtpTimestamp(rtpTimestamp),
+      _audioLevel(audioLevel)
+{
+    assert(_pcmPacket);
+    assert(_pcmPacket->getLength() > 0);
+}
+
+SharedMixEncodeJob::~SharedMixEncodeJob()
+{
+    _fanOut.release();
+}
+
+void SharedMixEncodeJob::run()
+{
+    auto encodedPayload = memory::makeUniquePacket(_allocator);
+    if (!encodedPayload)
+    {
+        logger::error("failed to make packet for shared encoded mix", "SharedMixEncodeJob");
+        return;
+    }
+
+    const size_t frames = _pcmPacket->getLength() / EngineMixer::bytesPerSample / EngineMixer::channelsPerFrame;
+    const auto encodedBytes = _encoder.encode(reinterpret_cast<const int16_t*>(_pcmPacket->get()),
+        frames,
+        encodedPayload->get(),
+        memory::Packet::size - rtp::MIN_RTP_HEADER_SIZE - maxAudioHeaderExtensionsSize);
+    if (encodedBytes <= 0)
+    {
+        logger::error("Failed to encode shared mix, %d", "SharedMixEncodeJob", encodedBytes);
+        return;
+    }
+    encodedPayload->setLength(encodedBytes);
+
+    const auto sharedPayload = memory::makeSharedPacket(_sharedAllocator, std::move(encodedPayload));
+    if (!sharedPayload)
+    {
+        return;
+    }
+
+    for (auto& target : _fanOut.targets)
+    {
+        target.transport->getJobQueue().addJob<EncodedMixSendJob>(sharedPayload,
+            *target.outboundContext,
+            *target.transport,
+            _rtpTimestamp,
+            _audioLevel);
+    }
+}
+
+} // namespace bridge
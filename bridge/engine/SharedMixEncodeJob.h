@@ -0,0 +1,78 @@
+#pragma once
+
+#include "jobmanager/Job.h"
+#include "memory/AudioPacketPoolAllocator.h"
+#include "memory/PacketPoolAllocator.h"
+#include "memory/SharedPacket.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace codec
+{
+class OpusEncoder;
+}
+
+namespace transport
+{
+class Transport;
+}
+
+namespace bridge
+{
+
+class SsrcOutboundContext;
+
+/**
+ * Receivers of one shared mix frame. Filled on the engine thread, which holds a job count on each transport until the
+ * encode job has posted the send jobs, so the transports and their outbound contexts stay alive meanwhile. The frame
+ * is also counted in each outbound context's _framesOnSharedMixQueue until then.
+ */
+struct SharedMixFanOut
+{
+    struct Target
+    {
+        SsrcOutboundContext* outboundContext;
+        transport::Transport* transport;
+    };
+
+    explicit SharedMixFanOut(const size_t capacity) : pending(false) { targets.reserve(capacity); }
+
+    void add(SsrcOutboundContext& outboundContext, transport::Transport& transport);
+    void release();
+
+    std::vector<Target> targets;
+    std::atomic_bool pending;
+};
+
+/**
+ * Encodes the mix for all listeners in a SharedMixFanOut and posts an EncodedMixSendJob with the shared encoded
+ * payload to each of their transports. The encoder keeps state between frames, so these jobs are run on one serial
+ * queue in tick order.
+ */
+class SharedMixEncodeJob : public jobmanager::Job
+{
+public:
+    SharedMixEncodeJob(memory::UniqueAudioPacket pcmPacket,
+        codec::OpusEncoder& encoder,
+        SharedMixFanOut& fanOut,
+        memory::PacketPoolAllocator& allocator,
+        memory::SharedPacketPoolAllocator& sharedAllocator,
+        const uint64_t rtpTimestamp,
+        const int audioLevel);
+
+    ~SharedMixEncodeJob();
+
+    void run() override;
+
+private:
+    memory::UniqueAudioPacket _pcmPacket;
+    codec::OpusEncoder& _encoder;
+    SharedMixFanOut& _fanOut;
+    memory::PacketPoolAllocator& _allocator;
+    memory::SharedPacketPoolAllocator& _sharedAllocator;
+    uint64_t _rtpTimestamp;
+    int _audioLevel;
+};
+
+} // namespace bridge
@@ -0,0 +1,100 @@
+#include "bridge/engine/SharedMixEncoder.h"
+#include "bridge/engine/EncodeJob.h"
+#include "bridge/engine/SharedMixHandoverJob.h"
+#include "bridge/engine/SsrcOutboundContext.h"
+#include "logger/Logger.h"
+#include "transport/Transport.h"
+#include <cstring>
+
+namespace bridge
+{
+
+SharedMixEncoder::SharedMixEncoder(jobmanager::JobManager& jobManager,
+    memory::AudioPacketPoolAllocator& audioAllocator,
+    memory::PacketPoolAllocator& sendAllocator,
+    memory::SharedPacketPoolAllocator& sharedPacketAllocator,
+    const size_t maxListeners)
+    : _audioAllocator(audioAllocator),
+      _sendAllocator(sendAllocator),
+      _sharedPacketAllocator(sharedPacketAllocator),
+      _frameCount(0),
+      _queue(jobManager)
+{
+    for (auto& fanOut : _fanOuts)
+    {
+        fanOut = std::make_unique<SharedMixFanOut>(maxListeners);
+    }
+}
+
+bool SharedMixEncoder::beginFrame()
+{
+    auto& fanOut = *_fanOuts[_frameCount % maxFramesInFlight];
+    return !fanOut.pending.load(std::memory_order_acquire);
+}
+
+void SharedMixEncoder::addListener(SsrcOutboundContext& outboundContext, transport::Transport& transport)
+{
+    _fanOuts[_frameCount % maxFramesInFlight]->add(outboundContext, transport);
+}
+
+void SharedMixEncoder::encodeFrame(const int16_t* pcmData,
+    const size_t samples,
+    const uint64_t rtpTimestamp,
+    const int audioLevel)
+{
+    auto& fanOut = *_fanOuts[_frameCount % maxFramesInFlight];
+    auto pcmPacket = memory::makeUniquePacket(_audioAllocator);
+    if (!pcmPacket)
+    {
+        fanOut.release();
+        return;
+    }
+    std::memcpy(pcmPacket->get(), pcmData, samples * sizeof(int16_t));
+    pcmPacket->setLength(samples * sizeof(int16_t));
+
+    fanOut.pending.store(true, std::memory_order_relaxed);
+    if (!_queue.addJob<SharedMixEncodeJob>(std::move(pcmPacket),
+            _encoder,
+            fanOut,
+            _sendAllocator,
+            _sharedPacketAllocator,
+            rtpTimestamp,
+            audioLevel))
+    {
+        fanOut.release();
+        return;
+    }
+    ++_frameCount;
+}
+
+bool SharedMixEncoder::postOwnFrame(memory::UniqueAudioPacket packet,
+    SsrcOutboundContext& outboundContext,
+    transport::Transport& transport,
+    const uint64_t rtpTimestamp,
+    const utils::Optional<int>& audioLevel,
+    const bool handOver)
+{
+    if (!handOver && outboundContext._framesOnSharedMixQueue.load(std::memory_order_acquire) == 0)
+    {
+        return transport.getJobQueue().addJob<EncodeJob>(std::move(packet),
+            outboundContext,
+            transport,
+            rtpTimestamp,
+            audioLevel);
+    }
+
+    outboundContext._framesOnSharedMixQueue.fetch_add(1, std::memory_order_relaxed);
+    if (!_queue.addJob<SharedMixHandoverJob>(std::move(packet),
+            outboundContext,
+            transport,
+            rtpTimestamp,
+            audioLevel,
+            handOver ? &_encoder : nullptr))
+    {
+        outboundContext._framesOnSharedMixQueue.fetch_sub(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+} // namespace bridge
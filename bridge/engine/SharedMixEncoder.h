@@ -0,0 +1,73 @@
+#pragma once
+
+#include "bridge/engine/SharedMixEncodeJob.h"
+#include "codec/OpusEncoder.h"
+#include "jobmanager/JobQueue.h"
+#include "memory/AudioPacketPoolAllocator.h"
+#include "memory/PacketPoolAllocator.h"
+#include "memory/SharedPacket.h"
+#include "utils/Optional.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace transport
+{
+class Transport;
+}
+
+namespace bridge
+{
+
+class SsrcOutboundContext;
+
+/**
+ * Encodes the full mix once for the listeners that do not contribute to it. Encoding and fan-out to the listeners'
+ * transports run in SharedMixEncodeJobs on one serial queue, so the shared encoder sees the frames in tick order.
+ * A listener keeps the encode path it starts on, except that it may leave the shared mix once. Its own encoder then
+ * takes over the shared encoder state and its frames pass through the shared queue until no shared frame for it is
+ * queued, so encoder state, sequence numbers and timestamps continue in order. See SharedMixHandoverJob.
+ * Only used from the engine thread.
+ */
+class SharedMixEncoder
+{
+public:
+    SharedMixEncoder(jobmanager::JobManager& jobManager,
+        memory::AudioPacketPoolAllocator& audioAllocator,
+        memory::PacketPoolAllocator& sendAllocator,
+        memory::SharedPacketPoolAllocator& sharedPacketAllocator,
+        const size_t maxListeners);
+
+    /** @return false if encoding is too far behind, in which case this frame is skipped for all shared listeners */
+    bool beginFrame();
+    void addListener(SsrcOutboundContext& outboundContext, transport::Transport& transport);
+    void encodeFrame(const int16_t* pcmData, const size_t samples, const uint64_t rtpTimestamp, const int audioLevel);
+
+    /**
+     * Posts a frame that the listener encodes on its own. handOver is set for the first frame after the listener left
+     * the shared mix. @return false if the frame was dropped
+     */
+    bool postOwnFrame(memory::UniqueAudioPacket packet,
+        SsrcOutboundContext& outboundContext,
+        transport::Transport& transport,
+        const uint64_t rtpTimestamp,
+        const utils::Optional<int>& audioLevel,
+        const bool handOver);
+
+private:
+    static const size_t maxFramesInFlight = 4;
+
+    memory::AudioPacketPoolAllocator& _audioAllocator;
+    memory::PacketPoolAllocator& _sendAllocator;
+    memory::SharedPacketPoolAllocator& _sharedPacketAllocator;
+
+    codec::OpusEncoder _encoder;
+    std::array<std::unique_ptr<SharedMixFanOut>, maxFramesInFlight> _fanOuts;
+    size_t _frameCount;
+
+    // declared last so it runs its pending jobs before the encoder and fan-outs they use are destroyed
+    jobmanager::JobQueue _queue;
+};
+
+} // namespace bridge
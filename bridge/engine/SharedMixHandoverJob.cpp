@@ -0,0 +1,58 @@
+#include "bridge/engine/SharedMixHandoverJob.h"
+#include "bridge/engine/EncodeJob.h"
+#include "bridge/engine/SsrcOutboundContext.h"
+#include "codec/OpusEncoder.h"
+#include "jobmanager/JobQueue.h"
+#include "logger/Logger.h"
+#include "transport/Transport.h"
+
+namespace bridge
+{
+
+SharedMixHandoverJob::SharedMixHandoverJob(memory::UniqueAudioPacket packet,
+    SsrcOutboundContext& outboundContext,
+    transport::Transport& transport,
+    const uint64_t rtpTimestamp,
+    const utils::Optional<int>& audioLevel,
+    const codec::OpusEncoder* sharedEncoder)
+    : jobmanager::CountedJob(transport.getJobCounter()),
+      _packet(std::move(packet)),
+      _outboundContext(outboundContext),
+      _transport(transport),
+      _rtpTimestamp(rtpTimestamp),
+      _audioLevel(audioLevel),
+      _sharedEncoder(sharedEncoder)
+{
+    assert(_packet);
+}
+
+SharedMixHandoverJob::~SharedMixHandoverJob()
+{
+    _outboundContext._framesOnSharedMixQueue.fetch_sub(1, std::memory_order_release);
+}
+
+void SharedMixHandoverJob::run()
+{
+    if (_sharedEncoder)
+    {
+        // no job for this stream uses its encoder while it is in the shared mix
+        if (!_outboundContext._opusEncoder)
+        {
+            _outboundContext._opusEncoder.reset(new codec::OpusEncoder());
+        }
+        if (!_outboundContext._opusEncoder->copyState(*_sharedEncoder))
+        {
+            logger::warn("failed to take over shared encoder state, ssrc %u",
+                "SharedMixHandoverJob",
+                _outboundContext._ssrc);
+        }
+    }
+
+    _transport.getJobQueue().addJob<EncodeJob>(std::move(_packet),
+        _outboundContext,
+        _transport,
+        _rtpTimestamp,
+        _audioLevel);
+}
+
+} // namespace bridge
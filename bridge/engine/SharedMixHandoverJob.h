@@ -0,0 +1,52 @@
+#pragma once
+
+#include "jobmanager/Job.h"
+#include "memory/AudioPacketPoolAllocator.h"
+#include "utils/Optional.h"
+#include <cstdint>
+
+namespace codec
+{
+class OpusEncoder;
+}
+
+namespace transport
+{
+class Transport;
+}
+
+namespace bridge
+{
+
+class SsrcOutboundContext;
+
+/**
+ * Passes a frame that a listener encodes on its own through the mixer's shared encode queue. A listener's frames take
+ * this way while earlier shared frames for it are still queued, so its packets reach the transport in tick order.
+ * The first frame after a listener has left the shared mix also carries the shared encoder, whose state the
+ * listener's own encoder takes over before the EncodeJob is posted.
+ */
+class SharedMixHandoverJob : public jobmanager::CountedJob
+{
+public:
+    SharedMixHandoverJob(memory::UniqueAudioPacket packet,
+        SsrcOutboundContext& outboundContext,
+        transport::Transport& transport,
+        const uint64_t rtpTimestamp,
+        const utils::Optional<int>& audioLevel,
+        const codec::OpusEncoder* sharedEncoder);
+
+    ~SharedMixHandoverJob();
+
+    void run() override;
+
+private:
+    memory::UniqueAudioPacket _packet;
+    SsrcOutboundContext& _outboundContext;
+    transport::Transport& _transport;
+    uint64_t _rtpTimestamp;
+    utils::Optional<int> _audioLevel;
+    const codec::OpusEncoder* _sharedEncoder;
+};
+
+} // namespace bridge
@@ -7,6 +7,7 @@
 #include "jobmanager/JobQueue.h"
 #include "transport/RtpReceiveState.h"
 #include "utils/Optional.h"
+#include <atomic>
 #include <cstdint>
 #include <memory>
 
@@ -24,6 +25,7 @@ namespace bridge
 {
 
 struct RtpMap;
+class VideoPacketCache;
 
 /**
  * Maintains state and media graph for an inbound SSRC media stream
@@ -48,7 +50,9 @@ public:
           _markedForDeletion(false),
           _idle(false),
           _shouldDropPackets(false),
-          _inactiveCount(0)
+          _inactiveCount(0),
+          _packetCacheRequested(false),
+          _packetCache(nullptr)
     {
     }
 
@@ -86,6 +90,14 @@ public:
 
     std::shared_ptr<VideoMissingPacketsTracker> _videoMissingPacketsTracker;
 
+    /** Retransmission cache shared by all receivers of this video ssrc. Requested by the engine when the ssrc is first
+     * forwarded, filled by the sender's transport jobs and read by the receivers' transport jobs.
+     * RTX ssrcs share the cache of their main ssrc. _packetCacheReference is set before _packetCache is published
+     * and is not changed after that. */
+    bool _packetCacheRequested;
+    std::atomic<VideoPacketCache*> _packetCache;
+    std::shared_ptr<VideoPacketCache> _packetCacheReference;
+
     PliScheduler _pliScheduler;
 };
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "bridge/RtpMap.h"
+#include "bridge/engine/VideoPacketCache.h"
 #include "codec/OpusEncoder.h"
 #include "memory/PacketPoolAllocator.h"
 #include "utils/Optional.h"
@@ -25,6 +26,7 @@ public:
           _allocator(packetAllocator),
           _rtpMap(rtpMap),
           _sequenceCounter(0),
+          _framesOnSharedMixQueue(0),
           _lastExtendedSequenceNumber(0xFFFFFFFF),
           _lastSentPicId(0xFFFFFFFF),
           _lastSentTl0PicIdx(0xFFFFFFFF),
@@ -60,6 +62,8 @@ public:
 
     // This is the highest sent outbound sequence number
     uint32_t _sequenceCounter;
+    // Mixed audio frames for this stream still queued on the mixer's shared encode queue
+    std::atomic_uint32_t _framesOnSharedMixQueue;
 
     // These are used by the VP8 forwarder
     uint32_t _lastExtendedSequenceNumber;
@@ -83,6 +87,7 @@ public:
     uint64_t _lastRespondedNackTimestamp;
 
     utils::Optional<PacketCache*> _packetCache;
+    std::unique_ptr<VideoRewriteHistory> _rewriteHistory;
     uint64_t _lastSendTime;
     bool _markedForDeletion;
     bool _idle;
@@ -1,6 +1,7 @@
 #include "bridge/engine/VideoForwarderReceiveJob.h"
 #include "bridge/engine/EngineMixer.h"
 #include "bridge/engine/SendPliJob.h"
+#include "bridge/engine/VideoPacketCache.h"
 #include "codec/Vp8Header.h"
 #include "logger/Logger.h"
 #include "memory/Packet.h"
@@ -244,6 +245,13 @@ void VideoForwarderReceiveJob::run()
     }
 
     assert(rtpHeader->payloadType == utils::checkedCast<uint16_t>(_ssrcContext._rtpMap._payloadType));
+
+    auto packetCache = _ssrcContext._packetCache.load(std::memory_order_acquire);
+    if (packetCache)
+    {
+        packetCache->add(*_packet, _extendedSequenceNumber);
+    }
+
     _engineMixer.onForwarderVideoRtpPacketDecrypted(_ssrcContext, std::move(_packet), _extendedSequenceNumber);
 }
 
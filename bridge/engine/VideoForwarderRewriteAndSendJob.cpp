@@ -1,45 +1,17 @@
 #include "bridge/engine/VideoForwarderRewriteAndSendJob.h"
-#include "bridge/engine/PacketCache.h"
 #include "bridge/engine/SsrcInboundContext.h"
 #include "bridge/engine/SsrcOutboundContext.h"
+#include "bridge/engine/VideoPacketCache.h"
 #include "bridge/engine/Vp8Rewriter.h"
 #include "transport/Transport.h"
 #include "utils/OutboundSequenceNumber.h"
 
-namespace
-{
-
-inline void rewriteHeaderExtensions(rtp::RtpHeader* rtpHeader,
-    const bridge::SsrcInboundContext& senderInboundContext,
-    const bridge::SsrcOutboundContext& receiverOutboundContext)
-{
-    assert(rtpHeader);
-
-    const auto headerExtensions = rtpHeader->getExtensionHeader();
-    if (!headerExtensions)
-    {
-        return;
-    }
-
-    for (auto& rtpHeaderExtension : headerExtensions->extensions())
-    {
-        if (senderInboundContext._rtpMap._absSendTimeExtId.isSet() &&
-            rtpHeaderExtension.getId() == senderInboundContext._rtpMap._absSendTimeExtId.get())
-        {
-            rtpHeaderExtension.setId(receiverOutboundContext._rtpMap._absSendTimeExtId.get());
-            return;
-        }
-    }
-}
-
-} // namespace
-
 namespace bridge
 {
 
 VideoForwarderRewriteAndSendJob::VideoForwarderRewriteAndSendJob(SsrcOutboundContext& outboundContext,
     SsrcInboundContext& senderInboundContext,
-    memory::UniquePacket packet,
+    memory::SharedPacket packet,
     transport::Transport& transport,
     const uint32_t extendedSequenceNumber)
     : jobmanager::CountedJob(transport.getJobCounter()),
@@ -55,8 +27,8 @@ VideoForwarderRewriteAndSendJob::VideoForwarderRewriteAndSendJob(SsrcOutboundCon
 
 void VideoForwarderRewriteAndSendJob::run()
 {
-    auto rtpHeader = rtp::RtpHeader::fromPacket(*_packet);
-    if (!rtpHeader)
+    const auto sharedRtpHeader = rtp::RtpHeader::fromPacket(*_packet);
+    if (!sharedRtpHeader)
     {
         return;
     }
@@ -67,11 +39,11 @@ void VideoForwarderRewriteAndSendJob::run()
         isRetransmittedPacket = true;
     }
 
-    const bool isKeyFrame = codec::Vp8Header::isKeyFrame(rtpHeader->getPayload(),
-        codec::Vp8Header::getPayloadDescriptorSize(rtpHeader->getPayload(),
-            _packet->getLength() - rtpHeader->headerLength()));
+    const bool isKeyFrame = codec::Vp8Header::isKeyFrame(sharedRtpHeader->getPayload(),
+        codec::Vp8Header::getPayloadDescriptorSize(sharedRtpHeader->getPayload(),
+            _packet->getLength() - sharedRtpHeader->headerLength()));
 
-    const auto ssrc = rtpHeader->ssrc.get();
+    const auto ssrc = sharedRtpHeader->ssrc.get();
     if (ssrc != _outboundContext._lastRewrittenSsrc)
     {
         if (isRetransmittedPacket)
@@ -97,9 +69,17 @@ void VideoForwarderRewriteAndSendJob::run()
         }
     }
 
+    auto packet = memory::makeUniquePacket(_outboundContext._allocator, std::move(_packet));
+    if (!packet)
+    {
+        logger::warn("send allocator depleted FwdRewrite", "VideoForwarderRewriteAndSendJob");
+        return;
+    }
+    auto rtpHeader = rtp::RtpHeader::fromPacket(*packet);
+
     uint32_t rewrittenExtendedSequenceNumber = 0;
     if (!Vp8Rewriter::rewrite(_outboundContext,
-            *_packet,
+            *packet,
             _outboundContext._ssrc,
             _extendedSequenceNumber,
             _transport.getLoggableId().c_str(),
@@ -122,14 +102,21 @@ void VideoForwarderRewriteAndSendJob::run()
         _outboundContext._lastKeyFrameSequenceNumber = nextSequenceNumber;
     }
     rtpHeader->payloadType = _outboundContext._rtpMap._payloadType;
-    rewriteHeaderExtensions(rtpHeader, _senderInboundContext, _outboundContext);
+    const uint8_t absSendTimeExtId = _senderInboundContext._rtpMap._absSendTimeExtId.isSet()
+        ? _senderInboundContext._rtpMap._absSendTimeExtId.get()
+        : 0;
+    Vp8Rewriter::rewriteHeaderExtensions(rtpHeader, absSendTimeExtId, _outboundContext._rtpMap);
 
-    if (_outboundContext._packetCache.isSet() && _outboundContext._packetCache.get())
+    if (_senderInboundContext._packetCache.load(std::memory_order_acquire) && _outboundContext._rewriteHistory)
     {
-        if (!_outboundContext._packetCache.get()->add(*_packet, nextSequenceNumber))
-        {
-            return;
-        }
+        const auto payload = rtpHeader->getPayload();
+        _outboundContext._rewriteHistory->add({_senderInboundContext._packetCacheReference,
+            _extendedSequenceNumber,
+            rtpHeader->timestamp.get(),
+            nextSequenceNumber,
+            codec::Vp8Header::getPicId(payload),
+            codec::Vp8Header::getTl0PicIdx(payload),
+            absSendTimeExtId});
     }
 
     if (!_transport.isConnected())
@@ -148,7 +135,7 @@ void VideoForwarderRewriteAndSendJob::run()
         return;
     }
 
-    _transport.protectAndSend(std::move(_packet));
+    _transport.protectAndSend(std::move(packet));
 }
 
 } // namespace bridge
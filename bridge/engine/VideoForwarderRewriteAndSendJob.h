@@ -1,7 +1,7 @@
 #pragma once
 
 #include "jobmanager/Job.h"
-#include "memory/PacketPoolAllocator.h"
+#include "memory/SharedPacket.h"
 
 namespace transport
 {
@@ -14,12 +14,16 @@ namespace bridge
 class SsrcOutboundContext;
 class SsrcInboundContext;
 
+/**
+ * Forwards an inbound video packet that is shared by all receivers. The receiver's private copy is only made once
+ * the packet is known to be sent, and is then rewritten in place and protected.
+ */
 class VideoForwarderRewriteAndSendJob : public jobmanager::CountedJob
 {
 public:
     VideoForwarderRewriteAndSendJob(SsrcOutboundContext& outboundContext,
         SsrcInboundContext& senderInboundContext,
-        memory::UniquePacket packet,
+        memory::SharedPacket packet,
         transport::Transport& transport,
         const uint32_t extendedSequenceNumber);
 
@@ -28,7 +32,7 @@ public:
 private:
     SsrcOutboundContext& _outboundContext;
     SsrcInboundContext& _senderInboundContext;
-    memory::UniquePacket _packet;
+    memory::SharedPacket _packet;
     transport::Transport& _transport;
     uint32_t _extendedSequenceNumber;
 };
@@ -1,5 +1,6 @@
 #include "bridge/engine/VideoForwarderRtxReceiveJob.h"
 #include "bridge/engine/EngineMixer.h"
+#include "bridge/engine/VideoPacketCache.h"
 #include "bridge/engine/Vp8Rewriter.h"
 #include "logger/Logger.h"
 #include "memory/Packet.h"
@@ -80,6 +81,13 @@ void VideoForwarderRtxReceiveJob::run()
         return;
     }
 
+    // the RTX context shares the cache of the main ssrc
+    auto packetCache = _ssrcContext._packetCache.load(std::memory_order_acquire);
+    if (packetCache)
+    {
+        packetCache->add(*_packet, extendedSequenceNumber);
+    }
+
     _engineMixer.onForwarderVideoRtpPacketDecrypted(_ssrcContext, std::move(_packet), extendedSequenceNumber);
 }
 
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace bridge
+{
+
+/**
+ * Forwarding decisions for inbound video ssrcs, compiled from EngineStreamDirector, ActiveMediaList and the video
+ * streams' whitelists and pin ssrcs. Each entry lists the video stream registry slots an inbound ssrc is forwarded to
+ * and the ssrc each of them receives it as. Entries are stamped with the director version and the table generation
+ * they were built for and are rebuilt on first use after either has changed. Only used from the engine thread.
+ */
+class VideoForwardingTable
+{
+public:
+    struct Target
+    {
+        uint32_t _slot; // in the video EngineStreamRegistry
+        uint32_t _ssrc;
+    };
+
+    struct Entry
+    {
+        Entry() : _directorVersion(0), _generation(0) {}
+
+        uint32_t _directorVersion;
+        uint32_t _generation;
+        std::vector<Target> _targets;
+    };
+
+    VideoForwardingTable() : _generation(1) {}
+
+    /**
+     * @return entry for the inbound ssrc. Use isValid to check if it has to be rebuilt.
+     */
+    Entry& getEntry(const uint32_t inboundSsrc) { return _entries[inboundSsrc]; }
+
+    bool isValid(const Entry& entry, const uint32_t directorVersion) const
+    {
+        return entry._generation == _generation && entry._directorVersion == directorVersion;
+    }
+
+    void startRebuild(Entry& entry, const uint32_t directorVersion)
+    {
+        entry._targets.clear();
+        entry._directorVersion = directorVersion;
+        entry._generation = _generation;
+    }
+
+    /** Call when mixer state that affects forwarding has changed. */
+    void invalidate() { ++_generation; }
+
+    /** Call when video streams are removed. Entries may refer to the removed streams or to slots that have moved. */
+    void clear()
+    {
+        _entries.clear();
+        ++_generation;
+    }
+
+private:
+    uint32_t _generation;
+    std::unordered_map<uint32_t, Entry> _entries;
+};
+
+} // namespace bridge
@@ -1,6 +1,8 @@
 #include "bridge/engine/VideoNackReceiveJob.h"
-#include "bridge/engine/PacketCache.h"
 #include "bridge/engine/SsrcOutboundContext.h"
+#include "bridge/engine/VideoPacketCache.h"
+#include "bridge/engine/Vp8Rewriter.h"
+#include "codec/Vp8Header.h"
 #include "rtp/RtpHeader.h"
 #include "transport/RtcTransport.h"
 
@@ -11,7 +13,7 @@ namespace bridge
 
 VideoNackReceiveJob::VideoNackReceiveJob(SsrcOutboundContext& ssrcOutboundContext,
     transport::RtcTransport& sender,
-    PacketCache& videoPacketCache,
+    const SsrcOutboundContext& mediaSsrcOutboundContext,
     const uint16_t pid,
     const uint16_t blp,
     const uint32_t feedbackSsrc,
@@ -20,7 +22,7 @@ VideoNackReceiveJob::VideoNackReceiveJob(SsrcOutboundContext& ssrcOutboundContex
     : jobmanager::CountedJob(sender.getJobCounter()),
       _ssrcOutboundContext(ssrcOutboundContext),
       _sender(sender),
-      _videoPacketCache(videoPacketCache),
+      _mediaSsrcOutboundContext(mediaSsrcOutboundContext),
       _pid(pid),
       _blp(blp),
       _feedbackSsrc(feedbackSsrc),
@@ -90,34 +92,36 @@ void VideoNackReceiveJob::sendIfCached(const uint16_t sequenceNumber)
         return;
     }
 
-    const auto cachedPacket = _videoPacketCache.get(sequenceNumber);
-    if (!cachedPacket)
+    assert(_mediaSsrcOutboundContext._rewriteHistory);
+    const auto record = _mediaSsrcOutboundContext._rewriteHistory->get(sequenceNumber);
+    if (!record)
     {
         return;
     }
 
-    const auto cachedRtpHeader = rtp::RtpHeader::fromPacket(*cachedPacket);
-    if (!cachedRtpHeader)
+    auto packet = record->packetCache->get(record->extendedSequenceNumber, _ssrcOutboundContext._allocator);
+    if (!packet || packet->getLength() + sizeof(uint16_t) > packet->getCapacity())
     {
         return;
     }
 
-    auto packet = memory::makeUniquePacket(_ssrcOutboundContext._allocator);
-    if (!packet)
+    const auto cachedRtpHeader = rtp::RtpHeader::fromPacket(*packet);
+    if (!cachedRtpHeader)
     {
         return;
     }
 
+    // Re-apply the rewrite the receiver got the packet with, then prepend the original sequence number for RTX.
     const auto cachedRtpHeaderLength = cachedRtpHeader->headerLength();
-    const auto cachedPayload = cachedRtpHeader->getPayload();
-    const auto cachedSequenceNumber = cachedRtpHeader->sequenceNumber.get();
-
-    memcpy(packet->get(), cachedPacket->get(), cachedRtpHeaderLength);
-    auto copyHead = packet->get() + cachedRtpHeaderLength;
-    reinterpret_cast<uint16_t*>(copyHead)[0] = hton<uint16_t>(cachedSequenceNumber);
-    copyHead += sizeof(uint16_t);
-    memcpy(copyHead, cachedPayload, cachedPacket->getLength() - cachedRtpHeaderLength);
-    packet->setLength(cachedPacket->getLength() + sizeof(uint16_t));
+    const auto payload = cachedRtpHeader->getPayload();
+    cachedRtpHeader->timestamp = record->timestamp;
+    codec::Vp8Header::setPicId(payload, record->picId);
+    codec::Vp8Header::setTl0PicIdx(payload, record->tl0PicIdx);
+    Vp8Rewriter::rewriteHeaderExtensions(cachedRtpHeader, record->absSendTimeExtId, _mediaSsrcOutboundContext._rtpMap);
+
+    memmove(payload + sizeof(uint16_t), payload, packet->getLength() - cachedRtpHeaderLength);
+    reinterpret_cast<uint16_t*>(payload)[0] = hton<uint16_t>(sequenceNumber);
+    packet->setLength(packet->getLength() + sizeof(uint16_t));
 
     NACK_LOG("Sending cached packet seq %u, feedbackSsrc %u, seq %u",
         "VideoNackReceiveJob",
@@ -12,14 +12,13 @@ namespace bridge
 {
 
 class SsrcOutboundContext;
-class PacketCache;
 
 class VideoNackReceiveJob : public jobmanager::CountedJob
 {
 public:
     VideoNackReceiveJob(SsrcOutboundContext& ssrcOutboundContext,
         transport::RtcTransport& sender,
-        PacketCache& videoPacketCache,
+        const SsrcOutboundContext& mediaSsrcOutboundContext,
         const uint16_t pid,
         const uint16_t blp,
         const uint32_t feedbackSsrc,
@@ -31,7 +30,7 @@ public:
 private:
     SsrcOutboundContext& _ssrcOutboundContext;
     transport::RtcTransport& _sender;
-    PacketCache& _videoPacketCache;
+    const SsrcOutboundContext& _mediaSsrcOutboundContext;
     uint16_t _pid;
     uint16_t _blp;
     uint32_t _feedbackSsrc;
@@ -0,0 +1,48 @@
+#include "bridge/engine/VideoPacketCache.h"
+#include "concurrency/ScopedSpinLocker.h"
+#include <cstring>
+
+namespace bridge
+{
+
+VideoPacketCache::VideoPacketCache(const char* loggableId, const uint32_t ssrc)
+    : _loggableId(loggableId),
+      _packetAllocator(maxPackets, _loggableId.c_str())
+{
+    logger::info("Creating cache for ssrc %u", _loggableId.c_str(), ssrc);
+}
+
+void VideoPacketCache::add(const memory::Packet& packet, const uint32_t extendedSequenceNumber)
+{
+    concurrency::ScopedSpinLocker locker(_lock);
+
+    auto& entry = _entries[extendedSequenceNumber % maxPackets];
+    if (!entry.packet)
+    {
+        entry.packet = memory::makeUniquePacket(_packetAllocator);
+        if (!entry.packet)
+        {
+            return;
+        }
+    }
+
+    std::memcpy(entry.packet->get(), packet.get(), packet.getLength());
+    entry.packet->setLength(packet.getLength());
+    entry.extendedSequenceNumber = extendedSequenceNumber;
+}
+
+memory::UniquePacket VideoPacketCache::get(const uint32_t extendedSequenceNumber,
+    memory::PacketPoolAllocator& allocator)
+{
+    concurrency::ScopedSpinLocker locker(_lock);
+
+    const auto& entry = _entries[extendedSequenceNumber % maxPackets];
+    if (!entry.packet || entry.extendedSequenceNumber != extendedSequenceNumber)
+    {
+        return memory::UniquePacket();
+    }
+
+    return memory::makeUniquePacket(allocator, *entry.packet);
+}
+
+} // namespace bridge
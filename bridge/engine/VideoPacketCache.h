@@ -0,0 +1,85 @@
+#pragma once
+
+#include "logger/Logger.h"
+#include "memory/PacketPoolAllocator.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace bridge
+{
+
+/**
+ * Retransmission cache for an inbound video ssrc. Holds the packets as they were received, so one cache serves all
+ * receivers of the ssrc. Receivers keep a VideoRewriteHistory of how they rewrote each packet and re-apply that on
+ * retransmit. Packets are added from the sender's transport job context and copied out from the receivers' transport
+ * job contexts. Shared ownership keeps the cache alive for as long as a receiver's history refers to it.
+ */
+class VideoPacketCache : public std::enable_shared_from_this<VideoPacketCache>
+{
+public:
+    static const size_t maxPackets = 512;
+
+    VideoPacketCache(const char* loggableId, const uint32_t ssrc);
+
+    void add(const memory::Packet& packet, const uint32_t extendedSequenceNumber);
+
+    /**
+     * @return copy of the cached packet allocated from allocator, empty if the packet is no longer cached.
+     */
+    memory::UniquePacket get(const uint32_t extendedSequenceNumber, memory::PacketPoolAllocator& allocator);
+
+private:
+    struct Entry
+    {
+        Entry() : extendedSequenceNumber(0) {}
+
+        uint32_t extendedSequenceNumber;
+        memory::UniquePacket packet;
+    };
+
+    logger::LoggableId _loggableId;
+    // declared before _entries so cached packets are returned before the allocator goes away
+    memory::PacketPoolAllocator _packetAllocator;
+    std::atomic_flag _lock = ATOMIC_FLAG_INIT;
+    std::array<Entry, maxPackets> _entries;
+};
+
+/**
+ * Per outbound video ssrc record of the rewrite applied to each forwarded packet, indexed by outbound sequence
+ * number. Only accessed from the receiver's transport job context.
+ */
+class VideoRewriteHistory
+{
+public:
+    struct Record
+    {
+        std::shared_ptr<VideoPacketCache> packetCache;
+        uint32_t extendedSequenceNumber;
+        uint32_t timestamp;
+        uint16_t sequenceNumber;
+        uint16_t picId;
+        uint8_t tl0PicIdx;
+        uint8_t absSendTimeExtId;
+    };
+
+    VideoRewriteHistory() { _records.fill(Record{nullptr, 0, 0, 0, 0, 0, 0}); }
+
+    void add(Record&& record) { _records[record.sequenceNumber % _records.size()] = std::move(record); }
+
+    const Record* get(const uint16_t sequenceNumber) const
+    {
+        const auto& record = _records[sequenceNumber % _records.size()];
+        if (!record.packetCache || record.sequenceNumber != sequenceNumber)
+        {
+            return nullptr;
+        }
+        return &record;
+    }
+
+private:
+    std::array<Record, VideoPacketCache::maxPackets> _records;
+};
+
+} // namespace bridge
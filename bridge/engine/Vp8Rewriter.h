@@ -156,6 +156,32 @@ inline bool rewrite(SsrcOutboundContext& ssrcOutboundContext,
     return true;
 }
 
+/**
+ * Maps the abs-send-time extension id negotiated with the sender to the one negotiated with the receiver.
+ * inboundAbsSendTimeExtId 0 means the sender has no abs-send-time extension.
+ */
+inline void rewriteHeaderExtensions(rtp::RtpHeader* rtpHeader,
+    const uint8_t inboundAbsSendTimeExtId,
+    const bridge::RtpMap& outboundRtpMap)
+{
+    assert(rtpHeader);
+
+    const auto headerExtensions = rtpHeader->getExtensionHeader();
+    if (!headerExtensions || inboundAbsSendTimeExtId == 0)
+    {
+        return;
+    }
+
+    for (auto& rtpHeaderExtension : headerExtensions->extensions())
+    {
+        if (rtpHeaderExtension.getId() == inboundAbsSendTimeExtId)
+        {
+            rtpHeaderExtension.setId(outboundRtpMap._absSendTimeExtId.get());
+            return;
+        }
+    }
+}
+
 inline uint16_t rewriteRtxPacket(memory::Packet& packet, const uint32_t mainSsrc)
 {
     auto rtpHeader = rtp::RtpHeader::fromPacket(packet);
@@ -1,4 +1,5 @@
 #include "AudioLevel.h"
+#include "codec/MixKernels.h"
 #include "memory/AudioPacketPoolAllocator.h"
 #include "rtp/RtpHeader.h"
 #include <cmath>
@@ -6,20 +7,55 @@
 namespace codec
 {
 
+namespace
+{
+const int maxAudioLevel = 127;
+
+/**
+ * Mean square sample value at each dBov level, where full scale is 0x8000. The level of a frame is the highest level
+ * whose threshold is not below the frame's mean square. Avoids sqrt and log10 per packet.
+ */
+struct AudioLevelTable
+{
+    AudioLevelTable()
+    {
+        const double overload = 0x8000;
+        for (int level = 0; level <= maxAudioLevel; ++level)
+        {
+            meanSquareThresholds[level] = overload * overload * std::pow(10.0, -level / 10.0);
+        }
+    }
+
+    double meanSquareThresholds[maxAudioLevel + 1];
+};
+
+const AudioLevelTable audioLevelTable;
+} // namespace
+
 int computeAudioLevel(const int16_t* payload, int count)
 {
-    const double overload = 0x8000;
-    double rms = 0;
-    for (int i = 0; i < count; ++i)
+    if (count <= 0)
     {
-        double sample = double(payload[i]);
-        rms += sample * sample;
+        return maxAudioLevel;
     }
-    rms /= (overload * overload);
-    rms = count ? std::sqrt(rms / count) : 0;
-    rms = std::max(rms, 1e-9);
 
-    return -std::max(-127, static_cast<int>(20 * std::log10(rms)));
+    const double meanSquare = static_cast<double>(sumOfSquares(payload, count)) / count;
+    const auto& thresholds = audioLevelTable.meanSquareThresholds;
+    int low = 0;
+    int high = maxAudioLevel;
+    while (low < high)
+    {
+        const int level = (low + high + 1) / 2;
+        if (meanSquare <= thresholds[level])
+        {
+            low = level;
+        }
+        else
+        {
+            high = level - 1;
+        }
+    }
+    return low;
 }
 
 int computeAudioLevel(const memory::AudioPacket& packet)
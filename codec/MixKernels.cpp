@@ -0,0 +1,409 @@
+#include "codec/MixKernels.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MIX_KERNELS_X86 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace codec
+{
+
+namespace
+{
+
+void scalarAdd(int32_t* mix, const int16_t* samples, const size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        mix[i] += samples[i];
+    }
+}
+
+void scalarLimit(const int32_t* mix, int16_t* outSamples, const size_t count, const float scale)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        outSamples[i] = softLimit(static_cast<float>(mix[i]) * scale);
+    }
+}
+
+void scalarSubtractAndLimit(const int32_t* mix,
+    const int16_t* samples,
+    int16_t* outSamples,
+    const size_t count,
+    const float scale)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        outSamples[i] = softLimit(static_cast<float>(mix[i] - samples[i]) * scale);
+    }
+}
+
+uint64_t scalarSumOfSquares(const int16_t* samples, const size_t count)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        sum += static_cast<uint32_t>(samples[i] * samples[i]);
+    }
+    return sum;
+}
+
+#if defined(MIX_KERNELS_X86) && defined(__SSE2__)
+
+inline __m128 sse2SoftLimit(const __m128 sample)
+{
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 knee = _mm_set1_ps(mixLimiterKnee);
+    const __m128 headroom = _mm_set1_ps(mixLimiterCeiling - mixLimiterKnee);
+
+    const __m128 sign = _mm_and_ps(sample, signMask);
+    const __m128 magnitude = _mm_andnot_ps(signMask, sample);
+    const __m128 over = _mm_max_ps(_mm_sub_ps(magnitude, knee), _mm_setzero_ps());
+    const __m128 linear = _mm_min_ps(magnitude, knee);
+    const __m128 limited =
+        _mm_add_ps(linear, _mm_div_ps(_mm_mul_ps(over, headroom), _mm_add_ps(over, headroom)));
+    return _mm_or_ps(limited, sign);
+}
+
+inline __m128i sse2LimitToInt16(const __m128i low, const __m128i high, const __m128 scale)
+{
+    const __m128i lowOut = _mm_cvttps_epi32(sse2SoftLimit(_mm_mul_ps(_mm_cvtepi32_ps(low), scale)));
+    const __m128i highOut = _mm_cvttps_epi32(sse2SoftLimit(_mm_mul_ps(_mm_cvtepi32_ps(high), scale)));
+    return _mm_packs_epi32(lowOut, highOut);
+}
+
+inline __m128i sse2LowToInt32(const __m128i samples)
+{
+    return _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+}
+
+inline __m128i sse2HighToInt32(const __m128i samples)
+{
+    return _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16);
+}
+
+void sse2Add(int32_t* mix, const int16_t* samples, const size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&samples[i]));
+        auto mixLow = reinterpret_cast<__m128i*>(&mix[i]);
+        auto mixHigh = reinterpret_cast<__m128i*>(&mix[i + 4]);
+        _mm_storeu_si128(mixLow, _mm_add_epi32(_mm_loadu_si128(mixLow), sse2LowToInt32(in)));
+        _mm_storeu_si128(mixHigh, _mm_add_epi32(_mm_loadu_si128(mixHigh), sse2HighToInt32(in)));
+    }
+    scalarAdd(&mix[i], &samples[i], count - i);
+}
+
+void sse2Limit(const int32_t* mix, int16_t* outSamples, const size_t count, const float scale)
+{
+    const __m128 scaleVector = _mm_set1_ps(scale);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&mix[i]));
+        const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&mix[i + 4]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&outSamples[i]), sse2LimitToInt16(low, high, scaleVector));
+    }
+    scalarLimit(&mix[i], &outSamples[i], count - i, scale);
+}
+
+void sse2SubtractAndLimit(const int32_t* mix,
+    const int16_t* samples,
+    int16_t* outSamples,
+    const size_t count,
+    const float scale)
+{
+    const __m128 scaleVector = _mm_set1_ps(scale);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&samples[i]));
+        const __m128i low =
+            _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&mix[i])), sse2LowToInt32(in));
+        const __m128i high =
+            _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&mix[i + 4])), sse2HighToInt32(in));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&outSamples[i]), sse2LimitToInt16(low, high, scaleVector));
+    }
+    scalarSubtractAndLimit(&mix[i], &samples[i], &outSamples[i], count - i, scale);
+}
+
+// madd sums two squares, which only fits in 32 bits unsigned. Widen to 64 bit before accumulating.
+uint64_t sse2SumOfSquares(const int16_t* samples, const size_t count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i sum = zero;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&samples[i]));
+        const __m128i squares = _mm_madd_epi16(in, in);
+        sum = _mm_add_epi64(sum, _mm_unpacklo_epi32(squares, zero));
+        sum = _mm_add_epi64(sum, _mm_unpackhi_epi32(squares, zero));
+    }
+
+    uint64_t lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), sum);
+    return lanes[0] + lanes[1] + scalarSumOfSquares(&samples[i], count - i);
+}
+
+#endif
+
+#if defined(MIX_KERNELS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define MIX_KERNELS_AVX2 1
+
+__attribute__((target("avx2"))) inline __m256 avx2SoftLimit(const __m256 sample)
+{
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    const __m256 knee = _mm256_set1_ps(mixLimiterKnee);
+    const __m256 headroom = _mm256_set1_ps(mixLimiterCeiling - mixLimiterKnee);
+
+    const __m256 sign = _mm256_and_ps(sample, signMask);
+    const __m256 magnitude = _mm256_andnot_ps(signMask, sample);
+    const __m256 over = _mm256_max_ps(_mm256_sub_ps(magnitude, knee), _mm256_setzero_ps());
+    const __m256 linear = _mm256_min_ps(magnitude, knee);
+    const __m256 limited =
+        _mm256_add_ps(linear, _mm256_div_ps(_mm256_mul_ps(over, headroom), _mm256_add_ps(over, headroom)));
+    return _mm256_or_ps(limited, sign);
+}
+
+// Packs two vectors of 8 samples to 16 samples in order. packs_epi32 interleaves 128 bit lanes.
+__attribute__((target("avx2"))) inline __m256i avx2LimitToInt16(const __m256i low,
+    const __m256i high,
+    const __m256 scale)
+{
+    const __m256i lowOut = _mm256_cvttps_epi32(avx2SoftLimit(_mm256_mul_ps(_mm256_cvtepi32_ps(low), scale)));
+    const __m256i highOut = _mm256_cvttps_epi32(avx2SoftLimit(_mm256_mul_ps(_mm256_cvtepi32_ps(high), scale)));
+    return _mm256_permute4x64_epi64(_mm256_packs_epi32(lowOut, highOut), 0xD8);
+}
+
+__attribute__((target("avx2"))) void avx2Add(int32_t* mix, const int16_t* samples, const size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256i in =
+            _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&samples[i])));
+        auto mixVector = reinterpret_cast<__m256i*>(&mix[i]);
+        _mm256_storeu_si256(mixVector, _mm256_add_epi32(_mm256_loadu_si256(mixVector), in));
+    }
+    scalarAdd(&mix[i], &samples[i], count - i);
+}
+
+__attribute__((target("avx2"))) void avx2Limit(const int32_t* mix,
+    int16_t* outSamples,
+    const size_t count,
+    const float scale)
+{
+    const __m256 scaleVector = _mm256_set1_ps(scale);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&mix[i]));
+        const __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&mix[i + 8]));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&outSamples[i]), avx2LimitToInt16(low, high, scaleVector));
+    }
+    scalarLimit(&mix[i], &outSamples[i], count - i, scale);
+}
+
+__attribute__((target("avx2"))) void avx2SubtractAndLimit(const int32_t* mix,
+    const int16_t* samples,
+    int16_t* outSamples,
+    const size_t count,
+    const float scale)
+{
+    const __m256 scaleVector = _mm256_set1_ps(scale);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m256i inLow = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&samples[i])));
+        const __m256i inHigh =
+            _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&samples[i + 8])));
+        const __m256i low =
+            _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&mix[i])), inLow);
+        const __m256i high =
+            _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&mix[i + 8])), inHigh);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&outSamples[i]), avx2LimitToInt16(low, high, scaleVector));
+    }
+    scalarSubtractAndLimit(&mix[i], &samples[i], &outSamples[i], count - i, scale);
+}
+
+__attribute__((target("avx2"))) uint64_t avx2SumOfSquares(const int16_t* samples, const size_t count)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i sum = zero;
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&samples[i]));
+        const __m256i squares = _mm256_madd_epi16(in, in);
+        sum = _mm256_add_epi64(sum, _mm256_unpacklo_epi32(squares, zero));
+        sum = _mm256_add_epi64(sum, _mm256_unpackhi_epi32(squares, zero));
+    }
+
+    uint64_t lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), sum);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + scalarSumOfSquares(&samples[i], count - i);
+}
+
+#endif
+
+#if defined(__ARM_NEON)
+
+inline float32x4_t neonDivide(const float32x4_t dividend, const float32x4_t divisor)
+{
+#if defined(__aarch64__)
+    return vdivq_f32(dividend, divisor);
+#else
+    // 32 bit NEON has no divide. Refine the reciprocal estimate with two Newton-Raphson steps.
+    float32x4_t reciprocal = vrecpeq_f32(divisor);
+    reciprocal = vmulq_f32(vrecpsq_f32(divisor, reciprocal), reciprocal);
+    reciprocal = vmulq_f32(vrecpsq_f32(divisor, reciprocal), reciprocal);
+    return vmulq_f32(dividend, reciprocal);
+#endif
+}
+
+inline float32x4_t neonSoftLimit(const float32x4_t sample)
+{
+    const float32x4_t knee = vdupq_n_f32(mixLimiterKnee);
+    const float32x4_t headroom = vdupq_n_f32(mixLimiterCeiling - mixLimiterKnee);
+
+    const float32x4_t magnitude = vabsq_f32(sample);
+    const float32x4_t over = vmaxq_f32(vsubq_f32(magnitude, knee), vdupq_n_f32(0.0f));
+    const float32x4_t linear = vminq_f32(magnitude, knee);
+    const float32x4_t limited = vaddq_f32(linear, neonDivide(vmulq_f32(over, headroom), vaddq_f32(over, headroom)));
+    const uint32x4_t signMask = vdupq_n_u32(0x80000000u);
+    return vbslq_f32(signMask, sample, limited);
+}
+
+inline int16x8_t neonLimitToInt16(const int32x4_t low, const int32x4_t high, const float scale)
+{
+    const int32x4_t lowOut = vcvtq_s32_f32(neonSoftLimit(vmulq_n_f32(vcvtq_f32_s32(low), scale)));
+    const int32x4_t highOut = vcvtq_s32_f32(neonSoftLimit(vmulq_n_f32(vcvtq_f32_s32(high), scale)));
+    return vcombine_s16(vqmovn_s32(lowOut), vqmovn_s32(highOut));
+}
+
+void neonAdd(int32_t* mix, const int16_t* samples, const size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const int16x8_t in = vld1q_s16(&samples[i]);
+        vst1q_s32(&mix[i], vaddw_s16(vld1q_s32(&mix[i]), vget_low_s16(in)));
+        vst1q_s32(&mix[i + 4], vaddw_s16(vld1q_s32(&mix[i + 4]), vget_high_s16(in)));
+    }
+    scalarAdd(&mix[i], &samples[i], count - i);
+}
+
+void neonLimit(const int32_t* mix, int16_t* outSamples, const size_t count, const float scale)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        vst1q_s16(&outSamples[i], neonLimitToInt16(vld1q_s32(&mix[i]), vld1q_s32(&mix[i + 4]), scale));
+    }
+    scalarLimit(&mix[i], &outSamples[i], count - i, scale);
+}
+
+void neonSubtractAndLimit(const int32_t* mix,
+    const int16_t* samples,
+    int16_t* outSamples,
+    const size_t count,
+    const float scale)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const int16x8_t in = vld1q_s16(&samples[i]);
+        const int32x4_t low = vsubw_s16(vld1q_s32(&mix[i]), vget_low_s16(in));
+        const int32x4_t high = vsubw_s16(vld1q_s32(&mix[i + 4]), vget_high_s16(in));
+        vst1q_s16(&outSamples[i], neonLimitToInt16(low, high, scale));
+    }
+    scalarSubtractAndLimit(&mix[i], &samples[i], &outSamples[i], count - i, scale);
+}
+
+uint64_t neonSumOfSquares(const int16_t* samples, const size_t count)
+{
+    uint64x2_t sum = vdupq_n_u64(0);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const int16x8_t in = vld1q_s16(&samples[i]);
+        const int16x4_t low = vget_low_s16(in);
+        const int16x4_t high = vget_high_s16(in);
+        sum = vpadalq_u32(sum, vreinterpretq_u32_s32(vmull_s16(low, low)));
+        sum = vpadalq_u32(sum, vreinterpretq_u32_s32(vmull_s16(high, high)));
+    }
+    return vgetq_lane_u64(sum, 0) + vgetq_lane_u64(sum, 1) + scalarSumOfSquares(&samples[i], count - i);
+}
+
+#endif
+
+struct MixKernels
+{
+    const char* name;
+    void (*add)(int32_t*, const int16_t*, size_t);
+    void (*limit)(const int32_t*, int16_t*, size_t, float);
+    void (*subtractAndLimit)(const int32_t*, const int16_t*, int16_t*, size_t, float);
+    uint64_t (*sumOfSquares)(const int16_t*, size_t);
+};
+
+MixKernels selectMixKernels()
+{
+#ifdef MIX_KERNELS_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return {"avx2", avx2Add, avx2Limit, avx2SubtractAndLimit, avx2SumOfSquares};
+    }
+#endif
+#if defined(MIX_KERNELS_X86) && defined(__SSE2__)
+    return {"sse2", sse2Add, sse2Limit, sse2SubtractAndLimit, sse2SumOfSquares};
+#elif defined(__ARM_NEON)
+    return {"neon", neonAdd, neonLimit, neonSubtractAndLimit, neonSumOfSquares};
+#else
+    return {"scalar", scalarAdd, scalarLimit, scalarSubtractAndLimit, scalarSumOfSquares};
+#endif
+}
+
+const MixKernels& getMixKernels()
+{
+    static const MixKernels kernels = selectMixKernels();
+    return kernels;
+}
+
+} // namespace
+
+void mixAdd(int32_t* mix, const int16_t* samples, const size_t count)
+{
+    getMixKernels().add(mix, samples, count);
+}
+
+void mixLimit(const int32_t* mix, int16_t* outSamples, const size_t count, const int32_t scaleFactor)
+{
+    getMixKernels().limit(mix, outSamples, count, 1.0f / scaleFactor);
+}
+
+void mixSubtractAndLimit(const int32_t* mix,
+    const int16_t* samples,
+    int16_t* outSamples,
+    const size_t count,
+    const int32_t scaleFactor)
+{
+    getMixKernels().subtractAndLimit(mix, samples, outSamples, count, 1.0f / scaleFactor);
+}
+
+uint64_t sumOfSquares(const int16_t* samples, const size_t count)
+{
+    return getMixKernels().sumOfSquares(samples, count);
+}
+
+const char* getMixKernelName()
+{
+    return getMixKernels().name;
+}
+
+} // namespace codec
@@ -0,0 +1,101 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace codec
+{
+
+/**
+ * Audio mixing kernels. Participants are summed into a 32 bit accumulator, so the mix never wraps and a participant
+ * can be removed exactly. The result is scaled down and passed through a soft limiter when converted back to 16 bit.
+ * Uses AVX2 when the cpu supports it, otherwise SSE2 or NEON, with a scalar fallback.
+ */
+
+/** Adds count samples to mix. */
+void mixAdd(int32_t* mix, const int16_t* samples, size_t count);
+
+/** Writes mix divided by scaleFactor and soft limited to outSamples. */
+void mixLimit(const int32_t* mix, int16_t* outSamples, size_t count, int32_t scaleFactor);
+
+/** Writes mix minus samples, divided by scaleFactor and soft limited, to outSamples. */
+void mixSubtractAndLimit(const int32_t* mix,
+    const int16_t* samples,
+    int16_t* outSamples,
+    size_t count,
+    int32_t scaleFactor);
+
+/** Sum of the squared samples. Used for audio level. */
+uint64_t sumOfSquares(const int16_t* samples, size_t count);
+
+/**
+ * Samples below the knee pass unchanged. Above it the level approaches full scale asymptotically.
+ */
+constexpr float mixLimiterKnee = 24576.0f;
+constexpr float mixLimiterCeiling = 32767.0f;
+
+inline int16_t softLimit(const float sample)
+{
+    const float headroom = mixLimiterCeiling - mixLimiterKnee;
+    const float magnitude = sample < 0 ? -sample : sample;
+    const float over = magnitude > mixLimiterKnee ? magnitude - mixLimiterKnee : 0.0f;
+    const float linear = magnitude < mixLimiterKnee ? magnitude : mixLimiterKnee;
+    const float limited = linear + over * headroom / (over + headroom);
+    return static_cast<int16_t>(sample < 0 ? -limited : limited);
+}
+
+/**
+ * Adds count samples at the read head of an int16_t memory::RingBuffer to mix. Does not move the read head.
+ * @return false if the buffer holds fewer than count samples
+ */
+template <typename RingBufferT>
+bool addToMix(RingBufferT& ringBuffer, int32_t* mix, const size_t count)
+{
+    const int16_t* first = nullptr;
+    const int16_t* second = nullptr;
+    size_t firstCount = 0;
+    size_t secondCount = 0;
+    if (!ringBuffer.peek(first, firstCount, second, secondCount, count))
+    {
+        return false;
+    }
+
+    mixAdd(mix, first, firstCount);
+    if (secondCount > 0)
+    {
+        mixAdd(mix + firstCount, second, secondCount);
+    }
+    return true;
+}
+
+/**
+ * Writes mix minus count samples at the read head of an int16_t memory::RingBuffer, divided by scaleFactor and soft
+ * limited, to outSamples. Does not move the read head.
+ * @return false if the buffer holds fewer than count samples
+ */
+template <typename RingBufferT>
+bool removeFromMix(RingBufferT& ringBuffer,
+    const int32_t* mix,
+    int16_t* outSamples,
+    const size_t count,
+    const int32_t scaleFactor)
+{
+    const int16_t* first = nullptr;
+    const int16_t* second = nullptr;
+    size_t firstCount = 0;
+    size_t secondCount = 0;
+    if (!ringBuffer.peek(first, firstCount, second, secondCount, count))
+    {
+        return false;
+    }
+
+    mixSubtractAndLimit(mix, first, outSamples, firstCount, scaleFactor);
+    if (secondCount > 0)
+    {
+        mixSubtractAndLimit(mix + firstCount, second, outSamples + firstCount, secondCount, scaleFactor);
+    }
+    return true;
+}
+
+const char* getMixKernelName();
+
+} // namespace codec
@@ -1,6 +1,7 @@
 #include "codec/OpusEncoder.h"
 #include "codec/Opus.h"
 #include "utils/CheckedCast.h"
+#include <cstring>
 #include <opus/opus.h>
 
 namespace codec
@@ -36,6 +37,18 @@ OpusEncoder::~OpusEncoder()
     delete _state;
 }
 
+bool OpusEncoder::copyState(const OpusEncoder& source)
+{
+    if (!_initialized || !source._initialized)
+    {
+        return false;
+    }
+
+    // the encoder state is one allocation without internal pointers, both were created with the same channel count
+    std::memcpy(_state->_state, source._state->_state, opus_encoder_get_size(Opus::channelsPerFrame));
+    return true;
+}
+
 int32_t OpusEncoder::encode(const int16_t* decodedData,
     const size_t frames,
     unsigned char* payloadStart,
@@ -15,6 +15,9 @@ public:
 
     bool isInitialized() const { return _initialized; }
 
+    // Takes over the state of source, so the next frame is encoded as source would have encoded it
+    bool copyState(const OpusEncoder& source);
+
     int32_t encode(const int16_t* decodedData,
         const size_t frames,
         unsigned char* payloadStart,
@@ -0,0 +1,89 @@
+#include "concurrency/EventCount.h"
+#include <chrono>
+#ifndef __APPLE__
+#include <climits>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#ifndef __APPLE__
+long futex(std::atomic_uint32_t& word, int op, uint32_t value, const timespec* timeout)
+{
+    static_assert(sizeof(std::atomic_uint32_t) == sizeof(uint32_t), "futex word must be 32 bit");
+    return syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), op, value, timeout, nullptr, 0);
+}
+#endif
+} // namespace
+
+namespace concurrency
+{
+
+bool EventCount::commitWait(const uint32_t key, const uint64_t timeoutNs)
+{
+    bool notified = true;
+#ifdef __APPLE__
+    {
+        std::unique_lock<std::mutex> locker(_mutex);
+        notified = _condition.wait_for(locker, std::chrono::nanoseconds(timeoutNs), [this, key]() {
+            return _epoch.load(std::memory_order_acquire) != key;
+        });
+    }
+#else
+    const timespec timeout = {static_cast<time_t>(timeoutNs / 1000000000UL),
+        static_cast<long>(timeoutNs % 1000000000UL)};
+    if (_epoch.load(std::memory_order_acquire) == key)
+    {
+        futex(_epoch, FUTEX_WAIT_PRIVATE, key, &timeout);
+        notified = (_epoch.load(std::memory_order_acquire) != key);
+    }
+#endif
+    _waiters.fetch_sub(1);
+    return notified;
+}
+
+bool EventCount::notifyOne()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_waiters.load(std::memory_order_relaxed) == 0)
+    {
+        return false;
+    }
+
+#ifdef __APPLE__
+    {
+        std::lock_guard<std::mutex> locker(_mutex);
+        _epoch.fetch_add(1, std::memory_order_release);
+    }
+    _condition.notify_one();
+#else
+    _epoch.fetch_add(1, std::memory_order_release);
+    futex(_epoch, FUTEX_WAKE_PRIVATE, 1, nullptr);
+#endif
+    return true;
+}
+
+void EventCount::notifyAll()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_waiters.load(std::memory_order_relaxed) == 0)
+    {
+        return;
+    }
+
+#ifdef __APPLE__
+    {
+        std::lock_guard<std::mutex> locker(_mutex);
+        _epoch.fetch_add(1, std::memory_order_release);
+    }
+    _condition.notify_all();
+#else
+    _epoch.fetch_add(1, std::memory_order_release);
+    futex(_epoch, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr);
+#endif
+}
+
+} // namespace concurrency
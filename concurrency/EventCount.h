@@ -0,0 +1,51 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#ifdef __APPLE__
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace concurrency
+{
+
+/**
+ * Lets threads park until an event is posted without losing wake ups.
+ * A waiter calls prepareWait, rechecks its condition and then either cancelWait or commitWait.
+ * A notifier makes its state change visible before calling notifyOne / notifyAll.
+ * Notify is cheap when nobody is waiting. Linux uses futex, other platforms a condition variable.
+ */
+class EventCount
+{
+public:
+    EventCount() : _epoch(0), _waiters(0) {}
+    EventCount(const EventCount&) = delete;
+
+    uint32_t prepareWait()
+    {
+        _waiters.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return _epoch.load(std::memory_order_acquire);
+    }
+
+    void cancelWait() { _waiters.fetch_sub(1); }
+
+    // returns false on timeout
+    bool commitWait(uint32_t key, uint64_t timeoutNs);
+
+    // returns true if there was a waiter to wake
+    bool notifyOne();
+    void notifyAll();
+
+    uint32_t getWaiterCount() const { return _waiters.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic_uint32_t _epoch;
+    std::atomic_uint32_t _waiters;
+#ifdef __APPLE__
+    std::mutex _mutex;
+    std::condition_variable _condition;
+#endif
+};
+
+} // namespace concurrency
@@ -1,9 +1,9 @@
 #pragma once
 #include "LockFreeList.h"
+#include "memory/PageMapping.h"
 #include <algorithm>
 #include <atomic>
 #include <functional>
-#include <sys/mman.h>
 #include <unistd.h>
 #include <vector>
 namespace concurrency
@@ -70,7 +70,7 @@ private:
 
     void updateSpread(uint32_t i);
 
-    std::vector<Entry> _index;
+    std::vector<Entry, memory::PageAllocator<Entry>> _index;
     std::atomic_uint32_t _maxSpread;
 };
 
@@ -164,14 +164,9 @@ public:
 
     explicit MpmcHashmap32(size_t maxElements) : _end(0), _capacity(maxElements), _index(maxElements * 4)
     {
-        void* mem = mmap(nullptr,
-            blockSizeFor(_capacity, sizeof(Entry)),
-            (PROT_READ | PROT_WRITE),
-            (MAP_PRIVATE | MAP_ANONYMOUS),
-            -1,
-            0);
+        void* mem = memory::mapPages(blockSizeFor(_capacity, sizeof(Entry)));
         _elements = reinterpret_cast<Entry*>(mem);
-        assert(reinterpret_cast<intptr_t>(_elements) != -1);
+        assert(_elements);
         assert(reinterpret_cast<intptr_t>(&_elements[1]) != -1);
         std::memset(mem, 0, blockSizeFor(_capacity, sizeof(Entry)));
         for (size_t i = 0; i < _capacity; ++i)
@@ -190,7 +185,7 @@ public:
                 _elements[i].~Entry();
             }
         }
-        munmap(_elements, blockSizeFor(_capacity, sizeof(Entry)));
+        memory::unmapPages(_elements, blockSizeFor(_capacity, sizeof(Entry)));
     }
 
     template <typename... Args>
@@ -1,8 +1,8 @@
 #pragma once
+#include "memory/PageMapping.h"
 #include <algorithm>
 #include <atomic>
 #include <cassert>
-#include <sys/mman.h>
 #include <unistd.h>
 namespace concurrency
 {
@@ -36,9 +36,8 @@ public:
         _cacheLineSeparator1[0] = 0;
         _cacheLineSeparator2[0] = 0;
 
-        _elements = reinterpret_cast<Entry*>(
-            mmap(nullptr, _blockSize, (PROT_READ | PROT_WRITE), (MAP_PRIVATE | MAP_ANONYMOUS), -1, 0));
-        assert(reinterpret_cast<intptr_t>(_elements) != -1);
+        _elements = reinterpret_cast<Entry*>(memory::mapPages(_blockSize));
+        assert(_elements);
 
         for (uint32_t i = 0; i < _maxElements; ++i)
         {
@@ -52,7 +51,7 @@ public:
         {
             _elements[i].~Entry();
         }
-        munmap(_elements, _blockSize);
+        memory::unmapPages(_elements, _blockSize);
     }
 
     // return false if empty
@@ -8,8 +8,29 @@
 #include <sys/types.h>
 #endif
 #include "logger/Logger.h"
+#include <atomic>
 namespace concurrency
 {
+namespace
+{
+const uint32_t unassignedSlot = ~0u;
+std::atomic_uint64_t threadSlotMask(0);
+thread_local uint32_t threadSlot = unassignedSlot;
+
+// Destroyed on thread exit. The slot is not reassigned to this thread if it is needed again after that.
+struct ThreadSlotRelease
+{
+    ~ThreadSlotRelease()
+    {
+        if (threadSlot < maxThreadSlots)
+        {
+            threadSlotMask.fetch_and(~(1ull << threadSlot));
+        }
+        threadSlot = maxThreadSlots;
+    }
+};
+} // namespace
+
 bool setPriority(std::thread& thread, Priority priority)
 {
     if (priority == Priority::Normal)
@@ -100,4 +121,28 @@ void setThreadName(const char* name)
     pthread_setname_np(pthread_self(), name);
 #endif
 }
-} // namespace concurrency
\ No newline at end of file
+
+uint32_t getThreadSlot()
+{
+    if (threadSlot != unassignedSlot)
+    {
+        return threadSlot;
+    }
+
+    static_assert(maxThreadSlots == 64, "slot mask is 64 bit");
+    threadSlot = maxThreadSlots;
+    for (auto mask = threadSlotMask.load(); mask != ~0ull;)
+    {
+        const auto slot = static_cast<uint32_t>(__builtin_ctzll(~mask));
+        if (threadSlotMask.compare_exchange_weak(mask, mask | (1ull << slot)))
+        {
+            threadSlot = slot;
+            break;
+        }
+    }
+
+    static thread_local ThreadSlotRelease release;
+    (void)release;
+    return threadSlot;
+}
+} // namespace concurrency
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <thread>
 namespace concurrency
 {
@@ -9,4 +10,9 @@ enum class Priority
 };
 bool setPriority(std::thread& thread, Priority priority);
 void setThreadName(const char* name);
+
+const uint32_t maxThreadSlots = 64;
+// Small index of the calling thread, handed to the next thread created after this one exits.
+// Returns maxThreadSlots when all slots are taken.
+uint32_t getThreadSlot();
 }
\ No newline at end of file
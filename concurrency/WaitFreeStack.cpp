@@ -30,6 +30,34 @@ void WaitFreeStack::push(StackItem* item)
     }
 }
 
+void WaitFreeStack::push(StackItem* const* items, const size_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    // the items are private until the head is updated, so they can be linked up front
+    auto firstNode = makeVersionedPointer(items[0], getVersion(items[0]->_next.load(std::memory_order_relaxed)) + 1);
+    for (size_t i = 1; i < count; ++i)
+    {
+        const auto versionedNext = items[i]->_next.load(std::memory_order_relaxed);
+        assert(getPointer(versionedNext) == nullptr);
+        items[i - 1]->_next.store(makeVersionedPointer(items[i], getVersion(versionedNext) + 1),
+            std::memory_order_relaxed);
+    }
+
+    auto lastItem = items[count - 1];
+    for (StackItem* currentNode = _head.load(std::memory_order_consume);;)
+    {
+        lastItem->_next.store(currentNode, std::memory_order_relaxed);
+        if (_head.compare_exchange_weak(currentNode, firstNode))
+        {
+            return;
+        }
+    }
+}
+
 bool WaitFreeStack::pop(StackItem*& item)
 {
     for (StackItem* currentNode = _head.load(std::memory_order_consume);;)
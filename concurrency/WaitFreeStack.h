@@ -1,6 +1,7 @@
 #pragma once
 #include "VersionedPointer.h"
 #include <atomic>
+#include <cstddef>
 
 namespace concurrency
 {
@@ -31,6 +32,8 @@ public:
     ~WaitFreeStack() = default;
 
     void push(StackItem* item);
+    // pushes the items with a single update of the head, items[0] ends up on top
+    void push(StackItem* const* items, size_t count);
     bool pop(StackItem*& item);
 
     bool empty() const { return getPointer(_head.load()) == nullptr; }
@@ -17,6 +17,8 @@ public:
     // If mixer does not receive any packets during this timeout, it's considered abandoned and is garbage collected.
     CFG_PROP(int, mixerInactivityTimeoutMs, 2 * 60 * 1000);
     CFG_PROP(int, numWorkerTreads, 0);
+    // Idle workers park until a job is posted instead of polling with sleep
+    CFG_PROP(bool, parkIdleWorkers, true);
     CFG_PROP(std::string, logFile, "/tmp/smb.log");
 
     CFG_PROP(uint32_t, defaultLastN, 5);
@@ -24,11 +26,35 @@ public:
     CFG_PROP(uint32_t, maxDefaultLevelBandwidthKbps, 3000);
     CFG_PROP(uint32_t, rtpForwardInterval, 10); // ms
 
+    CFG_GROUP()
+    // Most packets in each pool. Memory is committed in chunks on demand and idle chunks are returned to the system.
+    CFG_PROP(uint32_t, mainCeiling, 64 * 1024);
+    CFG_PROP(uint32_t, sendCeiling, 192 * 1024);
+    CFG_PROP(uint32_t, audioCeiling, 8 * 1024);
+    CFG_PROP(uint32_t, reclaimIntervalMs, 10 * 1000);
+    // Per thread caches of free packets in the main and send packet pools. Off by default, as packets cached by one
+    // thread are not handed out to others and a pool can run dry while they are held.
+    CFG_PROP(bool, threadCache, false);
+    CFG_GROUP_END(packetPool)
+
+    CFG_GROUP()
+    // "off", "transparent" for madvise(MADV_HUGEPAGE) or "explicit" for MAP_HUGETLB, falling back to transparent.
+    // Applies to the packet pools, queues and hash maps that span at least one huge page.
+    CFG_PROP(std::string, hugePages, "off");
+    CFG_PROP(int32_t, numaNode, -1); // mbind those mappings to this node
+    CFG_GROUP_END(memoryMapping)
+
+    CFG_GROUP()
+    // Number of engine threads. Each shard runs its own set of mixers on a separate real time thread.
+    CFG_PROP(uint32_t, shards, 1);
+    CFG_GROUP_END(engine)
+
     CFG_GROUP()
     // Value between 0 and 127, where 127 is the lowest audio level and 0 the highest.
     CFG_PROP(int32_t, silenceThresholdLevel, 127);
     CFG_PROP(uint32_t, lastN, 3);
     CFG_PROP(uint32_t, lastNextra, 2);
+    CFG_PROP(bool, sharedEncoding, true); // encode the full mix once for all listeners that do not send audio
     CFG_GROUP_END(audio);
 
     CFG_GROUP()
@@ -46,6 +72,20 @@ public:
     CFG_PROP(uint16_t, udpPortRangeLow, 10006);
     CFG_PROP(uint16_t, udpPortRangeHigh, 26000);
     CFG_PROP(uint32_t, sharedPorts, 1);
+    // SO_REUSEPORT sockets per shared port. Each remote sticks to one socket and each socket has its own receive queue.
+    CFG_PROP(uint32_t, sharedPortSockets, 1);
+    CFG_PROP(bool, udpSegmentationOffload, false); // UDP GSO on shared ports
+    CFG_PROP(bool, udpReceiveOffload, false); // UDP GRO on shared ports
+    // Kernel receive timestamps (SO_TIMESTAMPING) on media ports, so forward latency includes socket queueing
+    CFG_PROP(bool, receiveTimestamps, true);
+    // "epoll" or "io_uring". io_uring falls back to epoll if the kernel does not support it.
+    CFG_PROP(std::string, networkBackend, "epoll");
+    // Number of Rtce threads polling sockets. New sockets go to the least busy thread.
+    CFG_PROP(uint32_t, networkThreads, 1);
+    // AF_XDP on the interface of each shared port, falling back to the UDP socket where it is not supported.
+    // Only datagrams arriving on xdpQueue bypass the kernel, so steer the port to that queue with ethtool.
+    CFG_PROP(bool, xdp, false);
+    CFG_PROP(uint32_t, xdpQueue, 0);
     CFG_PROP(uint32_t, maxCandidateCount, 5 * 3);
 
     CFG_GROUP()
@@ -0,0 +1,308 @@
+#include "jobmanager/JobManager.h"
+#include "logger/Logger.h"
+#include <thread>
+
+namespace jobmanager
+{
+
+const uint32_t JobManager::maxWorkers;
+const uint32_t JobManager::localQueueSize;
+const uint32_t JobManager::maxConsecutiveLifoRuns;
+const uint32_t JobManager::maxSpinningWorkers;
+const uint64_t JobManager::spinTimeNs;
+const uint64_t JobManager::parkTimeoutNs;
+
+thread_local JobManager::WorkerIdentity JobManager::_currentWorker;
+
+JobManager::~JobManager()
+{
+    for (auto& workerQueue : _workerQueues)
+    {
+        delete workerQueue.load();
+    }
+}
+
+void JobManager::registerWorkerThread()
+{
+    const auto index = _workerCount.fetch_add(1);
+    if (index >= maxWorkers)
+    {
+        logger::warn("Too many worker threads. Worker %u will only use the shared queue", "JobManager", index);
+        return;
+    }
+
+    auto workerQueue = new WorkerQueue();
+    _workerQueues[index].store(workerQueue, std::memory_order_release);
+
+    _currentWorker.owner = this;
+    _currentWorker.queue = workerQueue;
+    _currentWorker.index = index;
+    _currentWorker.consecutiveLifoRuns = 0;
+}
+
+JobManager::WorkerIdentity* JobManager::getCurrentWorker()
+{
+    if (_currentWorker.owner == this)
+    {
+        return &_currentWorker;
+    }
+    return nullptr;
+}
+
+bool JobManager::addJobItem(Job* job)
+{
+    auto worker = getCurrentWorker();
+    if (!(worker && worker->queue->jobs.push(job)) && !_jobQueue.push(job))
+    {
+        assert(false);
+        freeJob(job);
+        return false;
+    }
+
+    notifyWorker();
+    return true;
+}
+
+bool JobManager::addLifoJobItem(Job* job)
+{
+    auto worker = getCurrentWorker();
+    if (!worker)
+    {
+        return addJobItem(job);
+    }
+
+    auto previousJob = worker->queue->lifoSlot.exchange(job);
+    if (previousJob)
+    {
+        return addJobItem(previousJob);
+    }
+
+    // the posting job may keep this worker busy for a while, so let another worker be around to steal the slot
+    notifyWorker();
+    return true;
+}
+
+Job* JobManager::popJob(WorkerIdentity& worker)
+{
+    Job* job = nullptr;
+    if (worker.consecutiveLifoRuns < maxConsecutiveLifoRuns)
+    {
+        job = worker.queue->lifoSlot.exchange(nullptr);
+        if (job)
+        {
+            ++worker.consecutiveLifoRuns;
+            return job;
+        }
+    }
+
+    // The LIFO slot has had its share. Let queued jobs run before it is served again.
+    worker.consecutiveLifoRuns = 0;
+    if (worker.queue->jobs.pop(job) || _jobQueue.pop(job))
+    {
+        return job;
+    }
+
+    job = worker.queue->lifoSlot.exchange(nullptr);
+    if (job)
+    {
+        return job;
+    }
+
+    return stealJob(worker.index);
+}
+
+// Visits the other workers starting after the thief to spread the stealing. The LIFO slot is only taken when
+// the victim has nothing queued, as the victim is likely to run it shortly.
+Job* JobManager::stealJob(const uint32_t thiefIndex)
+{
+    const auto workerCount = std::min(_workerCount.load(std::memory_order_acquire), maxWorkers);
+    Job* job = nullptr;
+    for (uint32_t i = 0; i < workerCount; ++i)
+    {
+        const auto victimIndex = (thiefIndex + 1 + i) % workerCount;
+        auto victim = _workerQueues[victimIndex].load(std::memory_order_acquire);
+        if (!victim || victimIndex == thiefIndex)
+        {
+            continue;
+        }
+
+        if (victim->jobs.pop(job))
+        {
+            return job;
+        }
+    }
+
+    for (uint32_t i = 0; i < workerCount; ++i)
+    {
+        const auto victimIndex = (thiefIndex + 1 + i) % workerCount;
+        auto victim = _workerQueues[victimIndex].load(std::memory_order_acquire);
+        if (!victim || victimIndex == thiefIndex)
+        {
+            continue;
+        }
+
+        job = victim->lifoSlot.exchange(nullptr);
+        if (job)
+        {
+            return job;
+        }
+    }
+
+    return nullptr;
+}
+
+Job* JobManager::findJob(WorkerIdentity* worker)
+{
+    if (worker)
+    {
+        return popJob(*worker);
+    }
+
+    Job* job = nullptr;
+    if (_jobQueue.pop(job))
+    {
+        return job;
+    }
+    return stealJob(maxWorkers);
+}
+
+Job* JobManager::wait()
+{
+    if (_idleStrategy == IdleStrategy::Backoff)
+    {
+        return waitWithBackoff();
+    }
+    return waitWithParking();
+}
+
+Job* JobManager::waitWithBackoff()
+{
+    auto worker = getCurrentWorker();
+    const int maxWait2ms = 15;
+    for (int i = 0; _running.load(std::memory_order::memory_order_relaxed); i = std::min(maxWait2ms, i + 1))
+    {
+        auto job = findJob(worker);
+        if (job)
+        {
+            return job;
+        }
+
+        utils::Time::nanoSleep(int64_t(64) << i);
+    }
+    return nullptr;
+}
+
+Job* JobManager::waitWithParking()
+{
+    auto worker = getCurrentWorker();
+    bool spinning = false;
+    uint64_t spinStart = 0;
+
+    while (_running.load(std::memory_order::memory_order_relaxed))
+    {
+        auto job = findJob(worker);
+        if (job)
+        {
+            if (spinning && _spinningWorkers.fetch_sub(1) == 1 && getCount() > 0)
+            {
+                // The last spinner found work. There is more queued, so bring in another worker.
+                notifyWorker();
+            }
+            return job;
+        }
+
+        if (!spinning)
+        {
+            if (tryStartSpinning())
+            {
+                spinning = true;
+                spinStart = utils::Time::getAbsoluteTime();
+                continue;
+            }
+        }
+        else if (utils::Time::diffLT(spinStart, utils::Time::getAbsoluteTime(), spinTimeNs))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        else
+        {
+            _spinningWorkers.fetch_sub(1);
+            spinning = false;
+        }
+
+        const auto key = _jobEvent.prepareWait();
+        job = findJob(worker);
+        if (job)
+        {
+            _jobEvent.cancelWait();
+            return job;
+        }
+
+        const auto parkStart = utils::Time::getAbsoluteTime();
+        _jobEvent.commitWait(key, parkTimeoutNs);
+        _parkTimeNs.fetch_add(utils::Time::getAbsoluteTime() - parkStart, std::memory_order_relaxed);
+        _parks.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (spinning)
+    {
+        _spinningWorkers.fetch_sub(1);
+    }
+    return nullptr;
+}
+
+bool JobManager::tryStartSpinning()
+{
+    auto spinningWorkers = _spinningWorkers.load();
+    while (spinningWorkers < maxSpinningWorkers)
+    {
+        if (_spinningWorkers.compare_exchange_weak(spinningWorkers, spinningWorkers + 1))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// A spinning worker will pick up the job. Otherwise wake one parked worker.
+void JobManager::notifyWorker()
+{
+    if (_idleStrategy != IdleStrategy::SpinThenPark)
+    {
+        return;
+    }
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_spinningWorkers.load(std::memory_order_relaxed) == 0 && _jobEvent.notifyOne())
+    {
+        _wakeups.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+JobManager::Metrics JobManager::getMetrics() const
+{
+    Metrics metrics;
+    metrics.wakeups = _wakeups.load(std::memory_order_relaxed);
+    metrics.parks = _parks.load(std::memory_order_relaxed);
+    metrics.parkTimeNs = _parkTimeNs.load(std::memory_order_relaxed);
+    metrics.serialJobCells = _serialJobSlab.getAllocatedCount();
+    return metrics;
+}
+
+int32_t JobManager::getCount() const
+{
+    int32_t count = _jobQueue.size();
+    const auto workerCount = std::min(_workerCount.load(std::memory_order_acquire), maxWorkers);
+    for (uint32_t i = 0; i < workerCount; ++i)
+    {
+        auto workerQueue = _workerQueues[i].load(std::memory_order_acquire);
+        if (workerQueue)
+        {
+            count += workerQueue->jobs.size() + (workerQueue->lifoSlot.load(std::memory_order_relaxed) ? 1 : 0);
+        }
+    }
+    return count;
+}
+
+} // namespace jobmanager
@@ -1,9 +1,12 @@
 #pragma once
 
 #include "TimerQueue.h"
+#include "concurrency/EventCount.h"
 #include "jobmanager/Job.h"
+#include "jobmanager/JobSlab.h"
 #include "memory/PoolAllocator.h"
 #include "utils/Trackers.h"
+#include <array>
 #include <list>
 #include <memory>
 #include <unistd.h>
@@ -11,13 +14,55 @@
 namespace jobmanager
 {
 
+/**
+ * Work stealing job scheduler. Jobs posted from a worker thread go to that worker's local queue. Jobs posted
+ * from other threads go to the shared injection queue. An idle worker takes jobs from its local queue, then the
+ * injection queue and finally steals from the other workers' local queues.
+ * A serial JobQueue's RunJob posted from a worker is placed in that worker's LIFO slot so the queue continues on
+ * the same core while its data is still in cache.
+ * Idle workers either poll with an increasing sleep (Backoff) or spin briefly and then park until a job is posted
+ * (SpinThenPark). In the latter mode only a few workers spin at a time and posting a job wakes one parked worker
+ * if no worker is spinning.
+ * Jobs of serial JobQueues are stored in a slab shared by all queues of the JobManager.
+ */
 class JobManager
 {
 public:
-    JobManager() : _jobQueue(poolSize), _jobPool(poolSize, "JobManagerPool"), _running(true), _timers(*this, 4096 * 8)
+    enum class IdleStrategy
     {
+        Backoff,
+        SpinThenPark
+    };
+
+    struct Metrics
+    {
+        uint64_t wakeups = 0;
+        uint64_t parks = 0;
+        uint64_t parkTimeNs = 0;
+        uint32_t serialJobCells = 0;
+    };
+
+    explicit JobManager(IdleStrategy idleStrategy = IdleStrategy::SpinThenPark)
+        : _idleStrategy(idleStrategy),
+          _jobQueue(poolSize),
+          _jobPool(poolSize, "JobManagerPool"),
+          _running(true),
+          _workerCount(0),
+          _spinningWorkers(0),
+          _wakeups(0),
+          _parks(0),
+          _parkTimeNs(0),
+          _serialJobSlab(serialJobSlabSize),
+          _timers(*this, 4096 * 8)
+    {
+        for (auto& workerQueue : _workerQueues)
+        {
+            workerQueue.store(nullptr);
+        }
     }
 
+    ~JobManager();
+
     template <typename JOB_TYPE, typename... U>
     JOB_TYPE* allocateJob(U&&... args)
     {
@@ -78,17 +123,22 @@ public:
         return true;
     }
 
-    bool addJobItem(Job* job)
+    // Posts the job to the LIFO slot of the current worker thread. The job previously in the slot is moved to the
+    // worker's local queue. Falls back to addJobItem if not called from a worker thread.
+    template <typename JOB_TYPE, typename... U>
+    bool addLifoJob(U&&... args)
     {
-        if (!_jobQueue.push(job))
+        auto job = allocateJob<JOB_TYPE>(std::forward<U>(args)...);
+        if (!job)
         {
-            assert(false);
-            freeJob(job);
             return false;
         }
-        return true;
+        return addLifoJobItem(job);
     }
 
+    bool addJobItem(Job* job);
+    bool addLifoJobItem(Job* job);
+
     void freeJob(Job* job)
     {
         assert(job);
@@ -96,44 +146,86 @@ public:
         _jobPool.free(job);
     }
 
-    Job* wait()
-    {
-        const int maxWait2ms = 15;
-        for (int i = 0; _running.load(std::memory_order::memory_order_relaxed); i = std::min(maxWait2ms, i + 1))
-        {
-            Job* job;
-            if (_jobQueue.pop(job))
-            {
-                return job;
-            }
-            else
-            {
-                utils::Time::nanoSleep(int64_t(64) << i);
-            }
-        }
-        return nullptr;
-    }
+    // Makes the calling thread a worker of this JobManager with its own local queue.
+    void registerWorkerThread();
+    Job* wait();
 
     void stop()
     {
         _timers.stop();
         _running = false;
+        _jobEvent.notifyAll();
     }
 
-    int32_t getCount() const { return _jobQueue.size(); }
+    int32_t getCount() const;
+    Metrics getMetrics() const;
 
     void abortTimedJobs(const uint64_t groupId) { _timers.abortTimers(groupId); }
     void abortTimedJob(const uint64_t groupId, const uint32_t id) { _timers.abortTimer(groupId, id); }
 
     static const auto poolSize = 4096 * 8;
     static const auto maxJobSize = 14 * 8;
+    static const uint32_t maxWorkers = 64;
+    static const auto serialJobSlabSize = 4096 * 16;
+    // serial job queues may always hold this many jobs, beyond that they must leave the reserve to other queues
+    static const size_t guaranteedSerialJobs = 256;
+    static const size_t serialJobSlabReserve = serialJobSlabSize / 4;
+
+    using SerialJobSlab = JobSlab<maxJobSize>;
+    SerialJobSlab& getSerialJobSlab() { return _serialJobSlab; }
 
 private:
+    static const uint32_t localQueueSize = 1024;
+    static const uint32_t maxConsecutiveLifoRuns = 8;
+    static const uint32_t maxSpinningWorkers = 2;
+    static const uint64_t spinTimeNs = 50 * utils::Time::us;
+    static const uint64_t parkTimeoutNs = 100 * utils::Time::ms;
+
+    struct WorkerQueue
+    {
+        WorkerQueue() : jobs(localQueueSize), lifoSlot(nullptr) {}
+
+        concurrency::MpmcQueue<Job*> jobs;
+        std::atomic<Job*> lifoSlot;
+    };
+
+    struct WorkerIdentity
+    {
+        JobManager* owner = nullptr;
+        WorkerQueue* queue = nullptr;
+        uint32_t index = 0;
+        uint32_t consecutiveLifoRuns = 0;
+    };
+
+    Job* findJob(WorkerIdentity* worker);
+    Job* popJob(WorkerIdentity& worker);
+    Job* stealJob(uint32_t thiefIndex);
+    WorkerIdentity* getCurrentWorker();
+
+    Job* waitWithBackoff();
+    Job* waitWithParking();
+    bool tryStartSpinning();
+    void notifyWorker();
+
+    const IdleStrategy _idleStrategy;
     concurrency::MpmcQueue<Job*> _jobQueue;
     memory::PoolAllocator<maxJobSize> _jobPool;
     std::atomic<bool> _running;
 
+    std::array<std::atomic<WorkerQueue*>, maxWorkers> _workerQueues;
+    std::atomic_uint32_t _workerCount;
+
+    concurrency::EventCount _jobEvent;
+    std::atomic_uint32_t _spinningWorkers;
+    std::atomic_uint64_t _wakeups;
+    std::atomic_uint64_t _parks;
+    std::atomic_uint64_t _parkTimeNs;
+
+    SerialJobSlab _serialJobSlab;
+
     TimerQueue _timers;
+
+    static thread_local WorkerIdentity _currentWorker;
 };
 
 } // namespace jobmanager
@@ -4,7 +4,6 @@
 #include "jobmanager/Job.h"
 #include "jobmanager/JobManager.h"
 #include "logger/Logger.h"
-#include "memory/PoolAllocator.h"
 #include "utils/Trackers.h"
 #include <list>
 #include <memory>
@@ -12,16 +11,28 @@
 namespace jobmanager
 {
 
+/**
+ * Runs jobs one at a time in the order they were added. Job storage comes from the JobManager's shared slab and
+ * queued jobs are linked through their cells, so the queue itself only holds a few pointers.
+ * Besides its own poolSize limit, a queue holding more than JobManager::guaranteedSerialJobs jobs is refused new jobs
+ * once the shared slab is down to its reserve. A single backed up queue can then not starve the other queues.
+ */
 class JobQueue
 {
+    using JobCell = JobManager::SerialJobSlab::Cell;
+
 public:
     explicit JobQueue(JobManager& jobManager, size_t poolSize = 4096)
         : _jobManager(jobManager),
+          _slab(jobManager.getSerialJobSlab()),
           _running(true),
-          _jobQueue(poolSize),
-          _jobPool(poolSize - 1, "SerialJobPool")
+          _maxCount(poolSize - 1),
+          _count(0),
+          _head(&_stub),
+          _tail(&_stub)
     {
         _runJobPosted.clear();
+        _stub.next.store(nullptr);
     }
 
     template <typename JOB_TYPE, typename... U>
@@ -29,34 +40,37 @@ public:
     {
         static_assert(sizeof(JOB_TYPE) <= maxJobSize, "JOB_TYPE has to be <= JobQueue::maxJobSize");
 
-        auto jobArea = _jobPool.allocate();
-        if (!jobArea)
-        {
-            ensurePosted();
-            return false;
-        }
-        auto job = new (jobArea) JOB_TYPE(std::forward<U>(args)...);
-        if (!_jobQueue.push(job))
+        const auto count = _count.fetch_add(1);
+        if (count >= _maxCount ||
+            (count >= JobManager::guaranteedSerialJobs && _slab.getFreeCount() <= JobManager::serialJobSlabReserve))
         {
-            job->~Job();
-            _jobPool.free(job);
+            _count.fetch_sub(1);
             ensurePosted();
             return false;
         }
 
-        ensurePosted();
-        return true;
+        return emplaceJob<JOB_TYPE>(std::forward<U>(args)...);
     }
 
     ~JobQueue()
     {
         concurrency::Semaphore sema;
-        addJob<StopJob>(sema, _running);
+        // the stop job ignores the queue limits but still needs a cell from the shared slab
+        _count.fetch_add(1);
+        for (uint32_t i = 0; !emplaceJob<StopJob>(sema, _running); ++i)
+        {
+            if (i == 0)
+            {
+                logger::warn("serial job slab depleted, waiting to stop job queue", "JobQueue");
+            }
+            _count.fetch_add(1);
+            usleep(1000);
+        }
         sema.wait();
     }
 
     JobManager& getJobManager() { return _jobManager; }
-    size_t getCount() const { return _jobQueue.size(); }
+    size_t getCount() const { return _count.load(std::memory_order_relaxed); }
 
 private:
     struct RunJob : public jobmanager::Job
@@ -81,38 +95,107 @@ private:
 
     void run(RunJob& runJob)
     {
-        Job* job;
-
-        for (int jobCount = 0; jobCount < 10 && _jobQueue.pop(job); ++jobCount)
+        for (int jobCount = 0; jobCount < 10; ++jobCount)
         {
+            auto cell = pop();
+            if (!cell)
+            {
+                break;
+            }
+
+            auto job = reinterpret_cast<Job*>(cell->jobArea);
             job->run();
+            _count.fetch_sub(1);
             if (_running)
             {
                 job->~Job();
-                _jobPool.free(job);
+                _slab.free(cell);
             }
             else
             {
-                assert(_jobQueue.empty());
-                _jobPool.free(job);
+                assert(_count.load() == 0);
+                auto& slab = _slab;
                 job->~Job(); // semaphore is set and we cannot touch JobQueue anymore
+                slab.free(cell);
                 return;
             }
         }
 
         _runJobPosted.clear();
-        if (!_jobQueue.empty())
+        if (_count.load() > 0)
         {
             ensurePosted();
         }
     }
 
+    // Intrusive multi producer single consumer list. Producers link cells at _head, the RunJob unlinks from _tail.
+    void push(JobCell* cell)
+    {
+        cell->next.store(nullptr, std::memory_order_relaxed);
+        auto previous = _head.exchange(cell, std::memory_order_acq_rel);
+        previous->next.store(cell, std::memory_order_release);
+    }
+
+    JobCell* pop()
+    {
+        auto tail = _tail;
+        auto next = tail->next.load(std::memory_order_acquire);
+        if (tail == &_stub)
+        {
+            if (!next)
+            {
+                return nullptr;
+            }
+            _tail = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+
+        if (next)
+        {
+            _tail = next;
+            return tail;
+        }
+
+        if (tail != _head.load(std::memory_order_acquire))
+        {
+            return nullptr; // a producer has not linked its cell yet
+        }
+
+        push(&_stub);
+        next = tail->next.load(std::memory_order_acquire);
+        if (next)
+        {
+            _tail = next;
+            return tail;
+        }
+        return nullptr;
+    }
+
 private:
+    // _count must already include the job
+    template <typename JOB_TYPE, typename... U>
+    bool emplaceJob(U&&... args)
+    {
+        auto cell = _slab.allocate();
+        if (!cell)
+        {
+            _count.fetch_sub(1);
+            ensurePosted();
+            return false;
+        }
+        new (cell->jobArea) JOB_TYPE(std::forward<U>(args)...);
+        push(cell);
+
+        ensurePosted();
+        return true;
+    }
+
     void ensurePosted()
     {
         if (!_runJobPosted.test_and_set())
         {
-            if (!_jobManager.addJob<RunJob>(this))
+            if (!_jobManager.addLifoJob<RunJob>(this))
             {
                 _runJobPosted.clear();
                 // no RunJob posted!
@@ -124,12 +207,16 @@ private:
     static const auto maxJobSize = JobManager::maxJobSize;
 
     JobManager& _jobManager;
+    JobManager::SerialJobSlab& _slab;
 
     std::atomic_flag _runJobPosted;
     bool _running;
 
-    concurrency::MpmcQueue<Job*> _jobQueue;
-    memory::PoolAllocator<maxJobSize> _jobPool;
+    const size_t _maxCount;
+    std::atomic<size_t> _count;
+    std::atomic<JobCell*> _head;
+    JobCell* _tail;
+    JobCell _stub;
 };
 
 } // namespace jobmanager
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "memory/PoolAllocator.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace jobmanager
+{
+
+/**
+ * Job storage shared by all serial JobQueues of a JobManager. A JobQueue only holds the head and tail of an
+ * intrusive list of cells, so an idle queue costs a few cache lines instead of a private pool.
+ * Cells are spread over shards to avoid all threads contending on the same free lists. A thread allocates from
+ * its own shard and a cell is returned to the shard it came from.
+ */
+template <size_t JOB_SIZE>
+class JobSlab
+{
+public:
+    struct Cell
+    {
+        std::atomic<Cell*> next;
+        uint32_t shard;
+        alignas(8) uint8_t jobArea[JOB_SIZE];
+    };
+
+    static const uint32_t shardCount = 8;
+
+    explicit JobSlab(size_t cellCount) : _capacity(0)
+    {
+        for (uint32_t i = 0; i < shardCount; ++i)
+        {
+            _shards[i].pool =
+                std::make_unique<memory::PoolAllocator<sizeof(Cell)>>(cellCount / shardCount, "SerialJobSlab");
+            _shards[i].allocated = 0;
+            _capacity += _shards[i].pool->size();
+        }
+    }
+
+    Cell* allocate()
+    {
+        const auto startShard = getThreadShard();
+        for (uint32_t i = 0; i < shardCount; ++i)
+        {
+            const auto shardIndex = (startShard + i) % shardCount;
+            auto& shard = _shards[shardIndex];
+            auto pointer = shard.pool->allocate();
+            if (pointer)
+            {
+                shard.allocated.fetch_add(1, std::memory_order_relaxed);
+                auto cell = reinterpret_cast<Cell*>(pointer);
+                cell->next.store(nullptr, std::memory_order_relaxed);
+                cell->shard = shardIndex;
+                return cell;
+            }
+        }
+        return nullptr;
+    }
+
+    void free(Cell* cell)
+    {
+        auto& shard = _shards[cell->shard];
+        shard.allocated.fetch_sub(1, std::memory_order_relaxed);
+        shard.pool->free(cell);
+    }
+
+    size_t getAllocatedCount() const
+    {
+        size_t count = 0;
+        for (const auto& shard : _shards)
+        {
+            count += shard.allocated.load(std::memory_order_relaxed);
+        }
+        return count;
+    }
+
+    size_t getCapacity() const { return _capacity; }
+    size_t getFreeCount() const { return _capacity - std::min(_capacity, getAllocatedCount()); }
+
+private:
+    struct Shard
+    {
+        std::unique_ptr<memory::PoolAllocator<sizeof(Cell)>> pool;
+        std::atomic_uint32_t allocated;
+        uint64_t cacheLineSeparator[6];
+    };
+
+    static uint32_t getThreadShard()
+    {
+        static std::atomic_uint32_t nextShard(0);
+        static thread_local const uint32_t threadShard = nextShard.fetch_add(1) % shardCount;
+        return threadShard;
+    }
+
+    std::array<Shard, shardCount> _shards;
+    size_t _capacity;
+};
+
+} // namespace jobmanager
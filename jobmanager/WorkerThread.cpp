@@ -21,6 +21,7 @@ void WorkerThread::stop()
 void WorkerThread::run()
 {
     concurrency::setThreadName("Worker");
+    _jobManager.registerWorkerThread();
 
     try
     {
@@ -3,6 +3,7 @@
 #include "concurrency/ThreadUtils.h"
 #include "config/Config.h"
 #include "logger/Logger.h"
+#include "memory/PageMapping.h"
 #include "utils/Time.h"
 #include <execinfo.h>
 #include <iostream>
@@ -81,6 +82,20 @@ static logger::Level parseLogLevel(const std::string& level)
     return logger::Level::INFO;
 }
 
+static memory::HugePages parseHugePages(const std::string& hugePages)
+{
+    if (isEqualCaseInsensitive(hugePages, "transparent"))
+    {
+        return memory::HugePages::TRANSPARENT;
+    }
+    if (isEqualCaseInsensitive(hugePages, "explicit"))
+    {
+        return memory::HugePages::EXPLICIT;
+    }
+
+    return memory::HugePages::OFF;
+}
+
 int main(int argc, char** argv)
 {
     running = std::make_unique<concurrency::Semaphore>();
@@ -146,6 +161,11 @@ int main(int argc, char** argv)
         config->ice.udpPortRangeHigh.get());
     logger::logAlways("log level %s", "main", config->logLevel.get().c_str());
 
+    memory::MappingPolicy mappingPolicy;
+    mappingPolicy.hugePages = parseHugePages(config->memoryMapping.hugePages);
+    mappingPolicy.numaNode = config->memoryMapping.numaNode;
+    memory::setMappingPolicy(mappingPolicy);
+
     {
         bridge::Bridge environment(*config);
         environment.initialize();
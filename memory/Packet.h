@@ -2,16 +2,41 @@
 
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 
 namespace memory
 {
 
+// The data is last so that a pool slot shorter than the class can hold a packet of smaller capacity
 template <size_t PacketSize>
 class FixedPacket
 {
 public:
-    FixedPacket() : _length(0) { _data[0] = 0; }
+    FixedPacket() : _length(0), _receiveTime(0), _capacity(PacketSize) { _data[0] = 0; }
+    explicit FixedPacket(const size_t capacity) : _length(0), _receiveTime(0), _capacity(capacity)
+    {
+        assert(capacity <= PacketSize);
+        _data[0] = 0;
+    }
+
+    // copies only the data, as either packet may sit in a pool slot shorter than size
+    FixedPacket(const FixedPacket& other)
+        : _length(other._length),
+          _receiveTime(other._receiveTime),
+          _capacity(PacketSize)
+    {
+        std::memcpy(_data, other._data, _length);
+    }
+
+    FixedPacket& operator=(const FixedPacket& other)
+    {
+        assert(other._length <= _capacity);
+        _length = (other._length > _capacity ? _capacity : other._length);
+        _receiveTime = other._receiveTime;
+        std::memmove(_data, other._data, _length);
+        return *this;
+    }
 
     static const size_t size = PacketSize;
     static_assert(PacketSize % 8 == 0, "packet size must be 8B aligned");
@@ -19,38 +44,52 @@ public:
     unsigned char* get() { return _data; }
     const unsigned char* get() const { return _data; }
 
+    // bytes that can be written to get(), less than size for packets from a smaller pool size class
+    size_t getCapacity() const { return _capacity; }
+
     void setLength(const size_t length)
     {
-        assert(length <= size);
-        _length = (length > size ? size : length);
+        assert(length <= _capacity);
+        _length = (length > _capacity ? _capacity : length);
     }
 
     size_t getLength() const { return _length; }
 
+    // utils::Time when the datagram this packet was derived from arrived at the socket, 0 if not received
+    uint64_t getReceiveTime() const { return _receiveTime; }
+    void setReceiveTime(uint64_t timestamp) { _receiveTime = timestamp; }
+
     void copyTo(FixedPacket<PacketSize>& dst)
     {
+        assert(getLength() <= dst.getCapacity());
         std::memcpy(dst.get(), get(), getLength());
         dst.setLength(getLength());
+        dst.setReceiveTime(_receiveTime);
     }
 
     void append(const void* data, size_t length)
     {
-        if (length + _length <= size)
+        if (length + _length <= _capacity)
         {
             std::memcpy(_data + _length, data, length);
             _length += length;
         }
     }
 
-    void clear() { std::memset(_data, 0, size); }
+    void clear() { std::memset(_data, 0, _capacity); }
 
 private:
-    unsigned char _data[size];
     size_t _length;
+    uint64_t _receiveTime;
+    size_t _capacity;
+    unsigned char _data[size];
 };
 
 class Packet : public FixedPacket<1504>
 {
+public:
+    Packet() = default;
+    explicit Packet(const size_t capacity) : FixedPacket<1504>(capacity) {}
 };
 
 } // namespace memory
@@ -3,13 +3,228 @@
 #include "logger/Logger.h"
 #include "memory/Packet.h"
 #include "memory/PoolAllocator.h"
+#include <memory>
+#include <string>
 
 namespace memory
 {
 
 const size_t packetPoolSize = 2048 * 4;
 
-using PacketPoolAllocator = PoolAllocator<sizeof(Packet)>;
+/**
+ * Packet pool with size classes. Packets made from data of known length come from the smallest class that holds the
+ * data plus growthHeadroom, which covers SRTP and SRTCP trailers and the RTX original sequence number. A class that is
+ * depleted passes the allocation on to the next larger class. Packets allocated without a length, e.g. for receiving,
+ * always have the full Packet::size capacity. The deleter finds the class that owns a packet by its address.
+ */
+class PacketPoolAllocator
+{
+    static const size_t packetHeaderSize = sizeof(Packet) - Packet::size;
+
+public:
+    enum SizeClass
+    {
+        SMALL = 0,
+        MEDIUM,
+        FULL,
+        SIZE_CLASS_COUNT
+    };
+    static const size_t smallCapacity = 256;
+    static const size_t mediumCapacity = 512;
+    static const size_t growthHeadroom = 64;
+
+    class Deleter
+    {
+    public:
+        Deleter() : _allocator(nullptr) {}
+        Deleter(PacketPoolAllocator* allocator) : _allocator(allocator) {}
+
+        template <typename T>
+        void operator()(T* r)
+        {
+            assert(_allocator);
+            if (_allocator)
+            {
+                _allocator->free(r);
+            }
+        }
+
+        PacketPoolAllocator* _allocator;
+    };
+
+    /**
+     * @param elementCount most full size packets, memory is committed on demand
+     * @param sizeClassElementCount number of packets in each smaller class, 0 for full size packets only
+     * @param threadCache keep per thread magazines of free packets in every class, see PoolAllocator
+     */
+    PacketPoolAllocator(size_t elementCount,
+        const std::string&& name,
+        size_t sizeClassElementCount = 0,
+        bool threadCache = false)
+        : _deleter(this),
+          _full(elementCount, std::string(name), threadCache),
+          _small(sizeClassElementCount ? new SmallPool(sizeClassElementCount, name + "-256", threadCache) : nullptr),
+          _medium(sizeClassElementCount ? new MediumPool(sizeClassElementCount, name + "-512", threadCache) : nullptr)
+    {
+    }
+
+    PacketPoolAllocator(const PacketPoolAllocator&) = delete;
+    PacketPoolAllocator& operator=(const PacketPoolAllocator&) = delete;
+
+    Deleter& getDeleter() { return _deleter; }
+    const std::string& getName() const { return _full.getName(); }
+
+    void logAllocatedElements()
+    {
+        _full.logAllocatedElements();
+        if (_small)
+        {
+            _small->logAllocatedElements();
+            _medium->logAllocatedElements();
+        }
+    }
+
+    // free full size packets
+    size_t size() const { return _full.size(); }
+    size_t countAllocatedItems() const
+    {
+        return countAllocatedItems(SMALL) + countAllocatedItems(MEDIUM) + countAllocatedItems(FULL);
+    }
+    size_t countAllocatedItems(SizeClass sizeClass) const
+    {
+        switch (sizeClass)
+        {
+        case SMALL:
+            return _small ? _small->countAllocatedItems() : 0;
+        case MEDIUM:
+            return _medium ? _medium->countAllocatedItems() : 0;
+        default:
+            return _full.countAllocatedItems();
+        }
+    }
+    size_t getElementCount(SizeClass sizeClass) const
+    {
+        switch (sizeClass)
+        {
+        case SMALL:
+            return _small ? _small->countAllocatedItems() + _small->size() : 0;
+        case MEDIUM:
+            return _medium ? _medium->countAllocatedItems() + _medium->size() : 0;
+        default:
+            return _full.countAllocatedItems() + _full.size();
+        }
+    }
+    size_t getCommittedCount(SizeClass sizeClass) const
+    {
+        switch (sizeClass)
+        {
+        case SMALL:
+            return _small ? _small->getCommittedCount() : 0;
+        case MEDIUM:
+            return _medium ? _medium->getCommittedCount() : 0;
+        default:
+            return _full.getCommittedCount();
+        }
+    }
+    size_t getPageSize(SizeClass sizeClass) const
+    {
+        switch (sizeClass)
+        {
+        case SMALL:
+            return _small ? _small->getPageSize() : 0;
+        case MEDIUM:
+            return _medium ? _medium->getPageSize() : 0;
+        default:
+            return _full.getPageSize();
+        }
+    }
+    static size_t getPacketCapacity(SizeClass sizeClass)
+    {
+        return sizeClass == SMALL ? smallCapacity : (sizeClass == MEDIUM ? mediumCapacity : Packet::size);
+    }
+
+    // page aligned memory holding the full size packets, e.g. for registering the pool as an AF_XDP UMEM
+    uint8_t* getRegion() const { return _full.getRegion(); }
+    size_t getRegionSize() const { return _full.getRegionSize(); }
+    void commitRegion() { _full.commitRegion(); }
+
+    // @return number of chunks released in all classes
+    size_t reclaimIdleChunks()
+    {
+        size_t count = _full.reclaimIdleChunks();
+        if (_small)
+        {
+            count += _small->reclaimIdleChunks() + _medium->reclaimIdleChunks();
+        }
+        return count;
+    }
+
+    // @return memory for a full size packet
+    void* allocate() { return _full.allocate(); }
+
+    // @return memory for a packet that can hold length + growthHeadroom bytes. capacity is set to the packet capacity.
+    void* allocate(const size_t length, size_t& capacity)
+    {
+        if (_small && length + growthHeadroom <= smallCapacity)
+        {
+            if (auto pointer = _small->allocate())
+            {
+                capacity = smallCapacity;
+                return pointer;
+            }
+        }
+        if (_medium && length + growthHeadroom <= mediumCapacity)
+        {
+            if (auto pointer = _medium->allocate())
+            {
+                capacity = mediumCapacity;
+                return pointer;
+            }
+        }
+        capacity = Packet::size;
+        return _full.allocate();
+    }
+
+    void free(void* pointer)
+    {
+        if (_small && _small->contains(pointer))
+        {
+            _small->free(pointer);
+        }
+        else if (_medium && _medium->contains(pointer))
+        {
+            _medium->free(pointer);
+        }
+        else
+        {
+            _full.free(pointer);
+        }
+    }
+
+    static bool isCorrupt(const Packet* packet)
+    {
+        void* pointer = const_cast<Packet*>(packet);
+        switch (packet->getCapacity())
+        {
+        case smallCapacity:
+            return SmallPool::isCorrupt(pointer);
+        case mediumCapacity:
+            return MediumPool::isCorrupt(pointer);
+        default:
+            return FullPool::isCorrupt(pointer);
+        }
+    }
+
+private:
+    using SmallPool = PoolAllocator<packetHeaderSize + smallCapacity>;
+    using MediumPool = PoolAllocator<packetHeaderSize + mediumCapacity>;
+    using FullPool = PoolAllocator<sizeof(Packet)>;
+
+    Deleter _deleter;
+    FullPool _full;
+    std::unique_ptr<SmallPool> _small;
+    std::unique_ptr<MediumPool> _medium;
+};
 
 // Be very careful with reset as the deleter is not changed if already set. You may try to deallocate
 // packet in the wrong pool.
@@ -32,6 +247,7 @@ inline UniquePacket makeUniquePacket(PacketPoolAllocator& allocator)
     return UniquePacket(reinterpret_cast<Packet*>(pointer), allocator.getDeleter());
 }
 
+// The packet comes from the smallest size class that leaves growthHeadroom after the data
 inline UniquePacket makeUniquePacket(PacketPoolAllocator& allocator, const void* data, size_t length)
 {
     assert(length <= memory::Packet::size);
@@ -40,21 +256,32 @@ inline UniquePacket makeUniquePacket(PacketPoolAllocator& allocator, const void*
         return UniquePacket();
     }
 
-    auto packet = makeUniquePacket(allocator);
-    if (!packet)
+    size_t capacity = 0;
+    auto pointer = allocator.allocate(length, capacity);
+    assert(pointer);
+    if (!pointer)
     {
+        logger::error("Unable to allocate packet, no space left in pool %s",
+            "PacketPoolAllocator",
+            allocator.getName().c_str());
         return UniquePacket();
     }
 
+    auto packet = new (pointer) memory::Packet(capacity);
     std::memcpy(packet->get(), data, length);
     packet->setLength(length);
 
-    return packet;
+    return UniquePacket(packet, allocator.getDeleter());
 }
 
 inline UniquePacket makeUniquePacket(PacketPoolAllocator& allocator, const Packet& packet)
 {
-    return makeUniquePacket(allocator, packet.get(), packet.getLength());
+    auto copy = makeUniquePacket(allocator, packet.get(), packet.getLength());
+    if (copy)
+    {
+        copy->setReceiveTime(packet.getReceiveTime());
+    }
+    return copy;
 }
 
 } // namespace memory
@@ -0,0 +1,200 @@
+#include "PageMapping.h"
+#include "logger/Logger.h"
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#endif
+
+namespace memory
+{
+
+namespace
+{
+std::atomic<HugePages> hugePagesPolicy(HugePages::OFF);
+std::atomic_int32_t numaNodePolicy(-1);
+
+size_t alignSize(size_t size, size_t pageSize)
+{
+    const auto remaining = size % pageSize;
+    return size + (remaining > 0 ? pageSize - remaining : 0);
+}
+
+#ifdef __linux__
+// default huge page size for MAP_HUGETLB
+size_t readHugeTlbPageSize()
+{
+    std::ifstream meminfo("/proc/meminfo");
+    for (std::string line; std::getline(meminfo, line);)
+    {
+        size_t sizeKb = 0;
+        if (std::sscanf(line.c_str(), "Hugepagesize: %zu kB", &sizeKb) == 1 && sizeKb > 0)
+        {
+            return sizeKb * 1024;
+        }
+    }
+    return 2 * 1024 * 1024;
+}
+
+// transparent huge page size, or 0 if transparent huge pages are disabled
+size_t readTransparentPageSize()
+{
+    std::ifstream enabled("/sys/kernel/mm/transparent_hugepage/enabled");
+    std::string mode;
+    std::getline(enabled, mode);
+    if (mode.find("[never]") != std::string::npos || mode.empty())
+    {
+        return 0;
+    }
+
+    size_t pageSize = 0;
+    std::ifstream("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size") >> pageSize;
+    return pageSize > 0 ? pageSize : 2 * 1024 * 1024;
+}
+#else
+// Huge pages and numa binding are only supported on Linux. Mappings use base pages elsewhere.
+size_t readHugeTlbPageSize()
+{
+    return getpagesize();
+}
+
+size_t readTransparentPageSize()
+{
+    return 0;
+}
+#endif
+
+size_t getHugeTlbPageSize()
+{
+    static const size_t pageSize = readHugeTlbPageSize();
+    return pageSize;
+}
+
+size_t getTransparentPageSize()
+{
+    static const size_t pageSize = readTransparentPageSize();
+    return pageSize;
+}
+
+void bindToNode(void* address, size_t size, int32_t node)
+{
+#ifdef __linux__
+    if (node < 0 || node >= 64)
+    {
+        return;
+    }
+
+    const unsigned long nodeMask = 1ul << node;
+    if (0 != syscall(SYS_mbind, address, size, MPOL_BIND, &nodeMask, sizeof(nodeMask) * 8, 0))
+    {
+        logger::warn("mbind to numa node %d failed, err %d", "PageMapping", node, errno);
+    }
+#else
+    if (node >= 0)
+    {
+        logger::warn("numa node %d ignored, binding is not supported on this platform", "PageMapping", node);
+    }
+#endif
+}
+} // namespace
+
+void setMappingPolicy(const MappingPolicy& policy)
+{
+    hugePagesPolicy = policy.hugePages;
+    numaNodePolicy = policy.numaNode;
+}
+
+MappingPolicy getMappingPolicy()
+{
+    MappingPolicy policy;
+    policy.hugePages = hugePagesPolicy.load();
+    policy.numaNode = numaNodePolicy.load();
+    return policy;
+}
+
+size_t getHugePageSize()
+{
+    return getHugeTlbPageSize();
+}
+
+size_t getMappedSize(size_t size)
+{
+    const auto hugePageSize = getHugeTlbPageSize();
+    return alignSize(size, size >= hugePageSize ? hugePageSize : getpagesize());
+}
+
+void* mapPages(size_t size, bool reserveOnly, size_t* pageSize)
+{
+    const auto mappedSize = getMappedSize(size);
+    const auto policy = getMappingPolicy();
+    const auto hugePageSize = getHugeTlbPageSize();
+    const bool useHugePages = policy.hugePages != HugePages::OFF && size >= hugePageSize &&
+        hugePageSize > static_cast<size_t>(getpagesize());
+
+    void* address = MAP_FAILED;
+    size_t effectivePageSize = getpagesize();
+#ifdef __linux__
+    if (useHugePages && policy.hugePages == HugePages::EXPLICIT)
+    {
+        address = mmap(nullptr,
+            mappedSize,
+            (PROT_READ | PROT_WRITE),
+            (MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB),
+            -1,
+            0);
+        if (address != MAP_FAILED)
+        {
+            effectivePageSize = getHugeTlbPageSize();
+        }
+        else
+        {
+            logger::info("no reserved huge pages for %zu bytes, err %d", "PageMapping", mappedSize, errno);
+        }
+    }
+#endif
+
+    if (address == MAP_FAILED)
+    {
+        address = mmap(nullptr,
+            mappedSize,
+            (PROT_READ | PROT_WRITE),
+            (MAP_PRIVATE | MAP_ANONYMOUS | (reserveOnly ? MAP_NORESERVE : 0)),
+            -1,
+            0);
+        if (address == MAP_FAILED)
+        {
+            logger::error("failed to map %zu bytes, err %d", "PageMapping", mappedSize, errno);
+            return nullptr;
+        }
+
+#ifdef MADV_HUGEPAGE
+        if (useHugePages && getTransparentPageSize() > 0 && 0 == madvise(address, mappedSize, MADV_HUGEPAGE))
+        {
+            effectivePageSize = getTransparentPageSize();
+        }
+#endif
+    }
+
+    bindToNode(address, mappedSize, policy.numaNode);
+    if (pageSize)
+    {
+        *pageSize = effectivePageSize;
+    }
+    return address;
+}
+
+void unmapPages(void* address, size_t size)
+{
+    if (address)
+    {
+        munmap(address, getMappedSize(size));
+    }
+}
+
+} // namespace memory
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace memory
+{
+
+enum class HugePages
+{
+    OFF,
+    TRANSPARENT, // madvise(MADV_HUGEPAGE)
+    EXPLICIT // MAP_HUGETLB from the reserved huge page pool, falling back to TRANSPARENT
+};
+
+struct MappingPolicy
+{
+    HugePages hugePages = HugePages::OFF;
+    int32_t numaNode = -1; // mbind to this node, -1 for the default policy
+};
+
+// Applies to mappings made after the call, so set it before any pools and queues are created.
+void setMappingPolicy(const MappingPolicy& policy);
+MappingPolicy getMappingPolicy();
+
+// Default huge page size, or the base page size on platforms without huge pages
+size_t getHugePageSize();
+
+// Sizes of at least one huge page are rounded to whole huge pages regardless of policy
+size_t getMappedSize(size_t size);
+
+/**
+ * Anonymous private read write mapping of getMappedSize(size) bytes following the mapping policy.
+ * Only mappings of at least one huge page use huge pages.
+ * @param reserveOnly map without swap reservation for memory that is committed on demand. Explicit huge pages are
+ * always reserved up front, as a fault on a missing huge page is fatal.
+ * @param pageSize set to the page size backing the mapping, as far as the kernel lets us know
+ * @return nullptr on failure
+ */
+void* mapPages(size_t size, bool reserveOnly = false, size_t* pageSize = nullptr);
+void unmapPages(void* address, size_t size);
+
+// For containers with large backing arrays, e.g. std::vector<T, PageAllocator<T>>
+template <typename T>
+class PageAllocator
+{
+public:
+    typedef T value_type;
+
+    PageAllocator() = default;
+    template <typename U>
+    PageAllocator(const PageAllocator<U>&)
+    {
+    }
+
+    T* allocate(size_t count)
+    {
+        auto* pointer = mapPages(count * sizeof(T));
+        if (!pointer)
+        {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(pointer);
+    }
+
+    void deallocate(T* pointer, size_t count) { unmapPages(pointer, count * sizeof(T)); }
+
+    template <typename U>
+    bool operator==(const PageAllocator<U>&) const
+    {
+        return true;
+    }
+    template <typename U>
+    bool operator!=(const PageAllocator<U>&) const
+    {
+        return false;
+    }
+};
+
+} // namespace memory
@@ -1,14 +1,21 @@
 #pragma once
 
 #include "concurrency/LockFreeList.h"
+#include "concurrency/ThreadUtils.h"
 #include "concurrency/WaitFreeStack.h"
 #include "logger/Logger.h"
+#include "memory/PageMapping.h"
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <iterator>
+#include <memory>
+#include <mutex>
 #include <numeric>
 #include <string>
 #include <sys/mman.h>
+#include <type_traits>
+#include <vector>
 #include <unistd.h>
 
 #if !defined(ENABLE_ALLOCATOR_METRICS)
@@ -25,11 +32,25 @@ namespace memory
 /**
     @brief
         Manages a pool of S elements of type T. PoolAllocator is thread safe.
+        With threadCache each thread keeps up to MAGAZINE_SIZE free elements of its own, refilled from and flushed
+        to the shared stacks MAGAZINE_BATCH at a time. Elements held by other threads are not handed out, so the
+        pool reports depletion while at most maxThreadSlots * MAGAZINE_SIZE elements are still cached.
+
+        The address space for all elements is reserved up front, but elements are constructed and pushed to the free
+        stacks a small batch at a time, when the pool runs dry. Each chunk counts its elements that are out of the
+        shared stacks. reclaimIdleChunks releases the memory of chunks whose elements are all back in the stacks, as
+        long as the remaining chunks hold the recent peak of elements in use. size() counts elements that have not
+        been constructed as free.
 */
 template <size_t ELEMENT_SIZE>
 class PoolAllocator
 {
     static const size_t QCOUNT = 8;
+    static const size_t MAGAZINE_SIZE = 32;
+    static const size_t MAGAZINE_BATCH = MAGAZINE_SIZE / 2;
+    static const size_t CHUNK_TARGET_SIZE = 1024 * 1024;
+    static const size_t GROW_TARGET_SIZE = 64 * 1024;
+    static const size_t WATERMARK_WINDOW = 8; // reclaimIdleChunks calls
     static size_t calculateNeededSpace(size_t desiredCount)
     {
         auto finalSize = desiredCount * sizeof(Entry);
@@ -38,6 +59,24 @@ class PoolAllocator
         return finalSize + (remaining != 0 ? pageSize - remaining : 0);
     }
 
+    // Chunks are whole system pages and span several huge pages if those back the pool, as only the huge pages
+    // entirely within a chunk are released.
+    static size_t calculateChunkElementCount(size_t elementCount, size_t mappingPageSize)
+    {
+        const size_t pageSize = getpagesize();
+        size_t divisor = pageSize;
+        for (size_t remainder = sizeof(Entry) % divisor, value = divisor; remainder != 0;)
+        {
+            divisor = remainder;
+            remainder = value % remainder;
+            value = divisor;
+        }
+        const size_t pageAlignedCount = pageSize / divisor;
+        const size_t chunkCount =
+            std::max(size_t(1), std::max(CHUNK_TARGET_SIZE, 4 * mappingPageSize) / (pageAlignedCount * sizeof(Entry)));
+        return std::max(size_t(1), std::min(elementCount, chunkCount * pageAlignedCount));
+    }
+
 public:
     class Deleter
     {
@@ -58,36 +97,60 @@ public:
         PoolAllocator<ELEMENT_SIZE>* _allocator;
     };
 
-    PoolAllocator(size_t elementCount, const std::string&& name)
+    PoolAllocator(size_t elementCount, const std::string&& name, bool threadCache = false)
         : _deleter(this),
           _name(std::move(name)),
           _size(calculateNeededSpace(elementCount)),
-          _originalElementCount(_size / sizeof(Entry))
+          _originalElementCount(_size / sizeof(Entry)),
+          _magazines(nullptr),
+          _pageSize(getpagesize()),
+          _chunkElementCount(1),
+          _committedChunkCount(0),
+          _constructedCount(0),
+          _growPeak(0),
+          _reclaimCount(0),
+          _reclaimable(true)
     {
-        _count = _originalElementCount;
+        if (threadCache)
+        {
+            // operator new does not honour the cache line alignment in C++14
+            _magazines = reinterpret_cast<Magazine*>(mapPages(sizeof(Magazine) * concurrency::maxThreadSlots));
+            assert(_magazines);
+            for (size_t i = 0; i < concurrency::maxThreadSlots; ++i)
+            {
+                new (&_magazines[i]) Magazine();
+            }
+        }
         _popIndex = 0;
         _pushIndex = 0;
         _cacheLineSeparator1[0] = 0;
         _cacheLineSeparator2[0] = 0;
         _cacheLineSeparator3[0] = 0;
 
-        _elements = reinterpret_cast<Entry*>(
-            mmap(nullptr, _size, (PROT_READ | PROT_WRITE), (MAP_PRIVATE | MAP_ANONYMOUS), -1, 0));
-        assert(reinterpret_cast<intptr_t>(_elements) != -1);
+        _elements = reinterpret_cast<Entry*>(mapPages(_size, true, &_pageSize));
+        assert(_elements);
 
         static_assert(sizeof(Entry) % 8 == 0, "ELEMENT_SIZE must be multiple of alignment");
 
-        for (size_t i = 0; i < _originalElementCount; ++i)
+        _chunkElementCount = calculateChunkElementCount(_originalElementCount, _pageSize);
+        const size_t chunkCount = (_originalElementCount + _chunkElementCount - 1) / _chunkElementCount;
+        _committedChunks.assign(chunkCount, false);
+        _constructedCounts.assign(chunkCount, 0);
+        _chunkUseCounts.reset(new std::atomic_uint32_t[chunkCount]);
+        for (size_t i = 0; i < chunkCount; ++i)
         {
-            new (&_elements[i]) Entry();
-            _freeQueue[i % QCOUNT].push(&(_elements[i]));
+            _chunkUseCounts[i] = 0;
         }
+        std::fill(std::begin(_inUsePeaks), std::end(_inUsePeaks), 0);
+
+        constructElements(0, getGrowElementCount());
     }
 
     ~PoolAllocator()
     {
         logAllocatedElements();
-        munmap(_elements, _size);
+        unmapPages(_elements, _size);
+        unmapPages(_magazines, sizeof(Magazine) * concurrency::maxThreadSlots);
     }
 
     Deleter& getDeleter() { return _deleter; }
@@ -117,14 +180,134 @@ public:
     PoolAllocator& operator=(PoolAllocator&&) = delete;
     const std::string& getName() const { return _name; }
 
-    size_t size() const { return _count.load(std::memory_order_relaxed); }
+    // Free elements, derived from the per chunk use counts that every build maintains. Elements in threads' caches
+    // are free, and the counts are read without synchronisation, so the result is approximate under load.
+    size_t size() const
+    {
+        size_t count = _originalElementCount - getInUseCount();
+        for (size_t i = 0; _magazines && i < concurrency::maxThreadSlots; ++i)
+        {
+            count += _magazines[i].count.load(std::memory_order_relaxed);
+        }
+        return std::min(count, _originalElementCount);
+    }
     size_t countAllocatedItems() const { return _originalElementCount - size(); }
-    void* allocate()
+
+    // elements that have been constructed in memory that is currently committed
+    size_t getCommittedCount() const { return _constructedCount.load(); }
+    size_t getChunkSize() const { return _chunkElementCount; }
+
+    // page size backing the elements, larger than the system page size if huge pages are in effect
+    size_t getPageSize() const { return _pageSize; }
+
+    // page aligned memory holding all elements, e.g. for registering the pool as an AF_XDP UMEM
+    uint8_t* getRegion() const { return reinterpret_cast<uint8_t*>(_elements); }
+    size_t getRegionSize() const { return _size; }
+
+    // Commits all chunks for good, for memory that has to stay in place like a registered UMEM
+    void commitRegion()
     {
-        concurrency::StackItem* item = nullptr;
-        const auto index = _popIndex.fetch_add(1);
+        std::lock_guard<std::mutex> lock(_chunkLock);
+        _reclaimable = false;
+        for (size_t i = 0; i < _committedChunks.size(); ++i)
+        {
+            constructElements(i, getChunkElementCount(i));
+        }
+    }
 
-        if (!_freeQueue[index % QCOUNT].pop(item))
+    /**
+     * Call periodically from one thread, e.g. every few seconds. The watermark is the peak of elements in use, in
+     * threads' caches included, over the last WATERMARK_WINDOW calls. Chunks above the watermark and a quarter more
+     * are released with MADV_DONTNEED if all their elements are back in the shared stacks. Finding those elements
+     * briefly holds back the free elements of one stack at a time from other threads. The search holds the chunk
+     * lock, so an allocation that finds the stacks empty meanwhile waits in grow until they are refilled, rather than
+     * committing more memory or reporting the pool depleted.
+     * @return number of chunks released
+     */
+    size_t reclaimIdleChunks()
+    {
+        std::lock_guard<std::mutex> lock(_chunkLock);
+        if (!_reclaimable)
+        {
+            return 0;
+        }
+
+        // the highest chunks are the candidates, as the lowest are committed again first
+        std::vector<size_t> candidates;
+        _inUsePeaks[_reclaimCount++ % WATERMARK_WINDOW] = std::max(getInUseCount(), _growPeak.exchange(0));
+        const size_t watermark = *std::max_element(std::begin(_inUsePeaks), std::end(_inUsePeaks));
+        const size_t keepChunkCount =
+            std::max(size_t(1), (watermark + watermark / 4 + _chunkElementCount - 1) / _chunkElementCount);
+        size_t committedChunkCount = _committedChunkCount.load();
+        for (size_t i = _committedChunks.size(); i > 0 && committedChunkCount > keepChunkCount; --i)
+        {
+            const auto chunk = i - 1;
+            if (_committedChunks[chunk] && _constructedCounts[chunk] == getChunkElementCount(chunk) &&
+                _chunkUseCounts[chunk].load() == 0)
+            {
+                candidates.push_back(chunk);
+                --committedChunkCount;
+            }
+        }
+        if (candidates.empty())
+        {
+            return 0;
+        }
+
+        // The elements taken out of the stacks here are not counted as in use. A candidate that was allocated from
+        // meanwhile is not found complete and put back.
+        std::vector<std::vector<concurrency::StackItem*>> candidateItems(candidates.size());
+        std::vector<concurrency::StackItem*> keep;
+        for (auto& stack : _freeQueue)
+        {
+            concurrency::StackItem* item = nullptr;
+            for (size_t i = 0; i < _originalElementCount && stack.pop(item); ++i)
+            {
+                const auto chunk = getChunkIndex(item);
+                const auto candidate = std::find(candidates.begin(), candidates.end(), chunk);
+                if (candidate != candidates.end())
+                {
+                    candidateItems[candidate - candidates.begin()].push_back(item);
+                }
+                else
+                {
+                    keep.push_back(item);
+                }
+            }
+            stack.push(keep.data(), keep.size());
+            keep.clear();
+        }
+
+        size_t releasedCount = 0;
+        for (size_t i = 0; i < candidates.size(); ++i)
+        {
+            if (candidateItems[i].size() == getChunkElementCount(candidates[i]))
+            {
+                releaseChunk(candidates[i]);
+                ++releasedCount;
+            }
+            else
+            {
+                _freeQueue[i % QCOUNT].push(candidateItems[i].data(), candidateItems[i].size());
+            }
+        }
+        return releasedCount;
+    }
+    bool contains(const void* pointer) const
+    {
+        const auto address = reinterpret_cast<uintptr_t>(pointer);
+        return address >= reinterpret_cast<uintptr_t>(_elements) &&
+            address < reinterpret_cast<uintptr_t>(_elements) + _size;
+    }
+    void* allocate()
+    {
+        auto* magazine = getMagazine();
+        concurrency::StackItem* item = (magazine ? popMagazine(*magazine) : popShared());
+        if (!item && grow())
+        {
+            item = (magazine ? popMagazine(*magazine) : popShared());
+        }
+        if (!item)
         {
 #if DEBUG
             logger::errorImmediate("pool depleted", _name.c_str());
@@ -132,9 +315,6 @@ public:
 #endif
             return nullptr;
         }
-#if ENABLE_ALLOCATOR_METRICS
-        _count.fetch_sub(1, std::memory_order_relaxed);
-#endif
         auto entry = reinterpret_cast<Entry*>(item);
 #ifdef DEBUG
         assert(entry->_beginGuard == 0xABABABABABABABABLLU);
@@ -162,11 +342,16 @@ public:
         entry->_beginGuard = 0xABABABABABABABABLLU;
         entry->_endGuard = 0xBABABABABABABABALLU;
 #endif
+        auto* magazine = getMagazine();
+        if (magazine)
+        {
+            pushMagazine(*magazine, entry);
+            return;
+        }
+
         const auto index = _pushIndex.fetch_add(1) % QCOUNT;
         _freeQueue[index].push(entry);
-#if ENABLE_ALLOCATOR_METRICS
-        _count.fetch_add(1, std::memory_order_relaxed);
-#endif
+        countReturned(entry);
     }
 
     static bool isCorrupt(void* pointer)
@@ -205,6 +390,221 @@ private:
 #endif
     };
 
+    // Only the thread holding the slot touches the items. The count is read by size().
+    // Cache line aligned so that neighbouring slots never share a line.
+    struct alignas(64) Magazine
+    {
+        Magazine() : count(0) { items[0] = nullptr; }
+
+        concurrency::StackItem* items[MAGAZINE_SIZE];
+        std::atomic_uint32_t count;
+    };
+    static_assert(std::is_trivially_destructible<Magazine>::value, "magazines are unmapped without destruction");
+
+    Magazine* getMagazine()
+    {
+        if (!_magazines)
+        {
+            return nullptr;
+        }
+        const auto slot = concurrency::getThreadSlot();
+        return slot < concurrency::maxThreadSlots ? &_magazines[slot] : nullptr;
+    }
+
+    // moves on to the next stack when one runs dry, as grow only adds elements once all stacks are empty
+    concurrency::StackItem* popShared()
+    {
+        concurrency::StackItem* item = nullptr;
+        const auto index = _popIndex.fetch_add(1);
+        for (size_t i = 0; i < QCOUNT && !item; ++i)
+        {
+            _freeQueue[(index + i) % QCOUNT].pop(item);
+        }
+        if (!item)
+        {
+            return nullptr;
+        }
+        countTaken(item);
+        return item;
+    }
+
+    concurrency::StackItem* popMagazine(Magazine& magazine)
+    {
+        auto count = magazine.count.load(std::memory_order_relaxed);
+        if (count == 0)
+        {
+            count = refillMagazine(magazine);
+            if (count == 0)
+            {
+                return nullptr;
+            }
+        }
+        magazine.count.store(--count, std::memory_order_relaxed);
+        return magazine.items[count];
+    }
+
+    void pushMagazine(Magazine& magazine, concurrency::StackItem* item)
+    {
+        auto count = magazine.count.load(std::memory_order_relaxed);
+        if (count == MAGAZINE_SIZE)
+        {
+            count = flushMagazine(magazine);
+        }
+        magazine.items[count] = item;
+        magazine.count.store(count + 1, std::memory_order_relaxed);
+    }
+
+    // takes up to MAGAZINE_BATCH elements, moving on to the next stack when one runs dry
+    uint32_t refillMagazine(Magazine& magazine)
+    {
+        uint32_t count = 0;
+        const auto index = _popIndex.fetch_add(1);
+        for (size_t i = 0; i < QCOUNT && count < MAGAZINE_BATCH; ++i)
+        {
+            auto& stack = _freeQueue[(index + i) % QCOUNT];
+            while (count < MAGAZINE_BATCH && stack.pop(magazine.items[count]))
+            {
+                countTaken(magazine.items[count]);
+                ++count;
+            }
+        }
+        magazine.count.store(count, std::memory_order_relaxed);
+        return count;
+    }
+
+    // returns the least recently freed half of the magazine in one push
+    uint32_t flushMagazine(Magazine& magazine)
+    {
+        const auto index = _pushIndex.fetch_add(1) % QCOUNT;
+        _freeQueue[index].push(magazine.items, MAGAZINE_BATCH);
+        for (size_t i = 0; i < MAGAZINE_BATCH; ++i)
+        {
+            countReturned(magazine.items[i]);
+        }
+        std::copy(magazine.items + MAGAZINE_BATCH, magazine.items + MAGAZINE_SIZE, magazine.items);
+        const uint32_t count = MAGAZINE_SIZE - MAGAZINE_BATCH;
+        magazine.count.store(count, std::memory_order_relaxed);
+        return count;
+    }
+
+    size_t getChunkIndex(const concurrency::StackItem* item) const
+    {
+        return (static_cast<const Entry*>(item) - _elements) / _chunkElementCount;
+    }
+
+    size_t getChunkElementCount(size_t chunk) const
+    {
+        return std::min(_chunkElementCount, _originalElementCount - chunk * _chunkElementCount);
+    }
+
+    // elements out of the shared stacks, i.e. allocated or held in threads' caches
+    size_t getInUseCount() const
+    {
+        size_t count = 0;
+        for (size_t i = 0; i < _committedChunks.size(); ++i)
+        {
+            count += _chunkUseCounts[i].load(std::memory_order_relaxed);
+        }
+        return count;
+    }
+
+    void countTaken(const concurrency::StackItem* item)
+    {
+        _chunkUseCounts[getChunkIndex(item)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // after the item has been pushed, so a chunk counting zero has all its elements in the stacks or about to be
+    void countReturned(const concurrency::StackItem* item)
+    {
+        _chunkUseCounts[getChunkIndex(item)].fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    static size_t getGrowElementCount()
+    {
+        const size_t count = GROW_TARGET_SIZE / sizeof(Entry);
+        return count > MAGAZINE_SIZE ? count : MAGAZINE_SIZE;
+    }
+
+    // Constructs the next batch of elements in the lowest chunk that is not complete, unless another thread has
+    // refilled the stacks meanwhile. The batch is kept small as this runs in allocate.
+    // @return true if there may be free elements in the stacks now
+    bool grow()
+    {
+        std::lock_guard<std::mutex> lock(_chunkLock);
+        for (const auto& stack : _freeQueue)
+        {
+            if (!stack.empty())
+            {
+                return true;
+            }
+        }
+
+        for (size_t chunk = 0; chunk < _committedChunks.size(); ++chunk)
+        {
+            if (_constructedCounts[chunk] < getChunkElementCount(chunk))
+            {
+                _growPeak = std::max(_growPeak.load(), getInUseCount());
+                constructElements(chunk, getGrowElementCount());
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // caller holds _chunkLock or is the constructor
+    void constructElements(const size_t chunk, const size_t count)
+    {
+        const size_t begin = chunk * _chunkElementCount + _constructedCounts[chunk];
+        const size_t end = begin + std::min(count, getChunkElementCount(chunk) - _constructedCounts[chunk]);
+        if (begin == end)
+        {
+            return;
+        }
+
+        concurrency::StackItem* items[QCOUNT][MAGAZINE_SIZE];
+        size_t itemCounts[QCOUNT] = {0};
+        for (size_t i = begin; i < end; ++i)
+        {
+            const auto index = i % QCOUNT;
+            items[index][itemCounts[index]++] = new (&_elements[i]) Entry();
+            if (itemCounts[index] == MAGAZINE_SIZE)
+            {
+                _freeQueue[index].push(items[index], itemCounts[index]);
+                itemCounts[index] = 0;
+            }
+        }
+        for (size_t index = 0; index < QCOUNT; ++index)
+        {
+            _freeQueue[index].push(items[index], itemCounts[index]);
+        }
+
+        if (!_committedChunks[chunk])
+        {
+            _committedChunks[chunk] = true;
+            _committedChunkCount.fetch_add(1);
+        }
+        _constructedCounts[chunk] += end - begin;
+        _constructedCount.fetch_add(end - begin);
+    }
+
+    void releaseChunk(const size_t chunk)
+    {
+        const size_t chunkBegin = chunk * _chunkElementCount * sizeof(Entry);
+        const bool isLastChunk = (chunk + 1 == _committedChunks.size());
+        const size_t chunkEnd = (isLastChunk ? getMappedSize(_size) : chunkBegin + _chunkElementCount * sizeof(Entry));
+        const size_t begin = (chunkBegin + _pageSize - 1) / _pageSize * _pageSize;
+        const size_t end = chunkEnd / _pageSize * _pageSize;
+        if (end > begin)
+        {
+            madvise(getRegion() + begin, end - begin, MADV_DONTNEED);
+        }
+
+        _committedChunks[chunk] = false;
+        _committedChunkCount.fetch_sub(1);
+        _constructedCount.fetch_sub(_constructedCounts[chunk]);
+        _constructedCounts[chunk] = 0;
+    }
+
     Deleter _deleter;
     std::string _name;
     Entry* _elements;
@@ -216,7 +616,21 @@ private:
     uint64_t _cacheLineSeparator3[5];
     const size_t _size;
     const size_t _originalElementCount;
-    std::atomic_uint32_t _count;
+    Magazine* _magazines;
+
+    size_t _pageSize;
+    size_t _chunkElementCount;
+    std::mutex _chunkLock;
+    std::vector<bool> _committedChunks;
+    std::vector<size_t> _constructedCounts;
+    // per chunk, constructed elements that are out of the shared stacks
+    std::unique_ptr<std::atomic_uint32_t[]> _chunkUseCounts;
+    std::atomic_size_t _committedChunkCount;
+    std::atomic_size_t _constructedCount;
+    std::atomic_size_t _growPeak; // elements in use when the pool last grew
+    size_t _inUsePeaks[WATERMARK_WINDOW];
+    size_t _reclaimCount;
+    bool _reclaimable;
 };
 
 } // namespace memory
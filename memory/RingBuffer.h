@@ -2,6 +2,7 @@
 
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <sys/mman.h>
 #include <unistd.h>
@@ -107,13 +108,11 @@ public:
     }
 
     /**
-     * Reads size elements from the buffer and adds each element of the read data to mixedData, scaled with scaleFactor.
-     * Does not move the read head.
+     * Gets the size elements at the read head without copying them or moving the read head. The elements may wrap
+     * around the end of the buffer, so they are returned as two spans. The second span is empty if they do not.
      */
-    bool addToMix(T* mixedData, const size_t size, const T scaleFactor)
+    bool peek(const T*& first, size_t& firstSize, const T*& second, size_t& secondSize, const size_t size)
     {
-        assert(mixedData);
-        assert(scaleFactor != 0);
 #ifdef DEBUG
         utils::ScopedReentrancyBlocker reentrancyBlocker(_reentrancyCount);
 #endif
@@ -124,65 +123,18 @@ public:
             return false;
         }
 
+        first = &_data[_readHead];
         if (_readHead + size > S)
         {
-            const auto remaining = S - _readHead;
-            for (auto i = _readHead; i < _readHead + remaining; ++i)
-            {
-                mixedData[i - _readHead] += _data[i] / scaleFactor;
-            }
-            for (size_t i = 0; i < size - remaining; ++i)
-            {
-                mixedData[remaining + i] += _data[i] / scaleFactor;
-            }
-        }
-        else
-        {
-            for (auto i = _readHead; i < _readHead + size; ++i)
-            {
-                mixedData[i - _readHead] += _data[i] / scaleFactor;
-            }
-        }
-
-        return true;
-    }
-
-    /**
-     * Reads size elements from the buffer and subtracts each element of the read data to mixedData, scaled with
-     * scaleFactor. Does not move the read head.
-     */
-    bool removeFromMix(T* mixedData, const size_t size, const T scaleFactor)
-    {
-        assert(mixedData);
-        assert(scaleFactor != 0);
-#ifdef DEBUG
-        utils::ScopedReentrancyBlocker reentrancyBlocker(_reentrancyCount);
-#endif
-
-        const auto currentLength = _length;
-        if (currentLength == 0 || currentLength < size)
-        {
-            return false;
-        }
-
-        if (_readHead + size > S)
-        {
-            const auto remaining = S - _readHead;
-            for (auto i = _readHead; i < _readHead + remaining; ++i)
-            {
-                mixedData[i - _readHead] -= _data[i] / scaleFactor;
-            }
-            for (size_t i = 0; i < size - remaining; ++i)
-            {
-                mixedData[remaining + i] -= _data[i] / scaleFactor;
-            }
+            firstSize = S - _readHead;
+            second = &_data[0];
+            secondSize = size - firstSize;
         }
         else
         {
-            for (auto i = _readHead; i < _readHead + size; ++i)
-            {
-                mixedData[i - _readHead] -= _data[i] / scaleFactor;
-            }
+            firstSize = size;
+            second = nullptr;
+            secondSize = 0;
         }
 
         return true;
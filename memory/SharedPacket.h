@@ -0,0 +1,161 @@
+#pragma once
+
+#include "memory/PacketPoolAllocator.h"
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+namespace memory
+{
+
+namespace detail
+{
+struct SharedPacketBlock
+{
+    explicit SharedPacketBlock(UniquePacket packet) : refCount(1), packet(std::move(packet)) {}
+
+    std::atomic_uint32_t refCount;
+    UniquePacket packet;
+};
+} // namespace detail
+
+using SharedPacketPoolAllocator = PoolAllocator<sizeof(detail::SharedPacketBlock)>;
+
+/**
+ * Reference counted read only packet. Used when the same inbound packet is fanned out to several receivers. The
+ * packet is returned to its own pool when the last reference is dropped. Receivers that need to modify the packet
+ * take a private copy with makeUniquePacket, which hands over the packet itself if it is the last reference.
+ */
+class SharedPacket
+{
+public:
+    SharedPacket() : _block(nullptr), _allocator(nullptr) {}
+
+    SharedPacket(detail::SharedPacketBlock* block, SharedPacketPoolAllocator* allocator)
+        : _block(block),
+          _allocator(allocator)
+    {
+    }
+
+    SharedPacket(const SharedPacket& rhs) : _block(rhs._block), _allocator(rhs._allocator)
+    {
+        if (_block)
+        {
+            _block->refCount.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    SharedPacket(SharedPacket&& rhs)
+        : _block(std::exchange(rhs._block, nullptr)),
+          _allocator(std::exchange(rhs._allocator, nullptr))
+    {
+    }
+
+    SharedPacket& operator=(const SharedPacket& rhs)
+    {
+        if (this != &rhs)
+        {
+            SharedPacket copy(rhs);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    SharedPacket& operator=(SharedPacket&& rhs)
+    {
+        if (this != &rhs)
+        {
+            reset();
+            swap(rhs);
+        }
+        return *this;
+    }
+
+    ~SharedPacket() { reset(); }
+
+    const Packet* get() const { return _block ? _block->packet.get() : nullptr; }
+    const Packet& operator*() const { return *_block->packet; }
+    const Packet* operator->() const { return _block->packet.get(); }
+    explicit operator bool() const { return _block != nullptr; }
+
+    bool isUnique() const { return _block && _block->refCount.load(std::memory_order_acquire) == 1; }
+
+    void reset()
+    {
+        if (_block && _block->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            _block->~SharedPacketBlock();
+            _allocator->free(_block);
+        }
+        _block = nullptr;
+        _allocator = nullptr;
+    }
+
+    /**
+     * Releases the packet if this is the only reference. Returns empty UniquePacket otherwise.
+     */
+    UniquePacket tryTake()
+    {
+        if (!isUnique())
+        {
+            return UniquePacket();
+        }
+
+        auto packet = std::move(_block->packet);
+        reset();
+        return packet;
+    }
+
+private:
+    void swap(SharedPacket& rhs)
+    {
+        std::swap(_block, rhs._block);
+        std::swap(_allocator, rhs._allocator);
+    }
+
+    detail::SharedPacketBlock* _block;
+    SharedPacketPoolAllocator* _allocator;
+};
+
+inline SharedPacket makeSharedPacket(SharedPacketPoolAllocator& allocator, UniquePacket packet)
+{
+    if (!packet)
+    {
+        return SharedPacket();
+    }
+
+    auto pointer = allocator.allocate();
+    assert(pointer);
+    if (!pointer)
+    {
+        logger::error("Unable to allocate shared packet, no space left in pool %s",
+            "SharedPacketPoolAllocator",
+            allocator.getName().c_str());
+        return SharedPacket();
+    }
+
+    auto block = new (pointer) detail::SharedPacketBlock(std::move(packet));
+    return SharedPacket(block, &allocator);
+}
+
+/**
+ * Produces a packet the caller can modify. The shared packet is handed over without copy if this was the last
+ * reference to it, otherwise the content is copied into a packet from allocator.
+ */
+inline UniquePacket makeUniquePacket(PacketPoolAllocator& allocator, SharedPacket&& sharedPacket)
+{
+    if (!sharedPacket)
+    {
+        return UniquePacket();
+    }
+    if (sharedPacket.isUnique())
+    {
+        return sharedPacket.tryTake();
+    }
+
+    auto packet = makeUniquePacket(allocator, *sharedPacket);
+    sharedPacket.reset();
+    return packet;
+}
+
+} // namespace memory
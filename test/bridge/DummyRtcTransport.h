@@ -57,6 +57,8 @@ public:
     uint32_t getUplinkEstimateKbps() const override { return 0; }
     uint32_t getDownlinkEstimateKbps() const override { return 0; }
     uint64_t getRtt() const override { return 0; }
+    transport::SrtpClient::Profile getSrtpProfile() const override { return transport::SrtpClient::Profile::NONE; }
+    utils::LatencyHistogram::Snapshot collectForwardLatency() override { return utils::LatencyHistogram::Snapshot(); }
     transport::PacketCounters getCumulativeReceiveCounters(uint32_t ssrc) const override
     {
         return transport::PacketCounters();
@@ -1086,3 +1086,24 @@ TEST_F(EngineStreamDirectorTest, highQualitySsrc_HasNoPinTarget_OverEstimatedKbp
 
     EXPECT_FALSE(_engineStreamDirector->shouldForwardSsrc(1, 11));
 }
+
+TEST_F(EngineStreamDirectorTest, versionChangesWhenForwardingDecisionMayChange)
+{
+    addActiveVideoSender(1, 1);
+    addActiveVideoSender(2, 7);
+    addActiveVideoSender(3, 13);
+
+    auto version = _engineStreamDirector->getVersion();
+    EXPECT_TRUE(_engineStreamDirector->shouldForwardSsrc(1, 9));
+
+    _engineStreamDirector->setUplinkEstimateKbps(1, 500, 10 * utils::Time::sec);
+    EXPECT_NE(version, _engineStreamDirector->getVersion());
+    EXPECT_FALSE(_engineStreamDirector->shouldForwardSsrc(1, 9));
+
+    version = _engineStreamDirector->getVersion();
+    _engineStreamDirector->setUplinkEstimateKbps(1, 501, 11 * utils::Time::sec);
+    EXPECT_EQ(version, _engineStreamDirector->getVersion());
+
+    _engineStreamDirector->pin(1, 2);
+    EXPECT_NE(version, _engineStreamDirector->getVersion());
+}
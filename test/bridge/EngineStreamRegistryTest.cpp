@@ -0,0 +1,155 @@
+#include "bridge/engine/EngineStreamRegistry.h"
+#include "bridge/engine/EngineAudioStream.h"
+#include "jobmanager/JobManager.h"
+#include "test/bridge/DummyRtcTransport.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+
+namespace
+{
+
+void threadFunction(jobmanager::JobManager* jobManager)
+{
+    auto job = jobManager->wait();
+    while (job)
+    {
+        job->run();
+        jobManager->freeJob(job);
+        job = jobManager->wait();
+    }
+}
+
+class ConnectableRtcTransport : public DummyRtcTransport
+{
+public:
+    ConnectableRtcTransport(jobmanager::JobQueue& jobQueue) : DummyRtcTransport(jobQueue), _connected(false) {}
+
+    bool isConnected() override { return _connected; }
+
+    bool _connected;
+};
+
+} // namespace
+
+class EngineStreamRegistryTest : public ::testing::Test
+{
+    void SetUp() override
+    {
+        _jobManager = std::make_unique<jobmanager::JobManager>();
+        _jobQueue = std::make_unique<jobmanager::JobQueue>(*_jobManager);
+        for (size_t i = 0; i < 4; ++i)
+        {
+            _transports.emplace_back(std::make_unique<ConnectableRtcTransport>(*_jobQueue));
+            _streams.emplace_back(std::make_unique<bridge::EngineAudioStream>(std::to_string(i),
+                i,
+                i,
+                utils::Optional<uint32_t>(i),
+                *_transports.back(),
+                i % 2 == 0,
+                bridge::RtpMap(),
+                i == 3));
+        }
+    }
+
+    void TearDown() override
+    {
+        _streams.clear();
+        _transports.clear();
+
+        auto thread = std::make_unique<std::thread>(threadFunction, _jobManager.get());
+        _jobQueue.reset();
+        _jobManager->stop();
+        thread->join();
+        _jobManager.reset();
+    }
+
+protected:
+    std::unique_ptr<jobmanager::JobManager> _jobManager;
+    std::unique_ptr<jobmanager::JobQueue> _jobQueue;
+    std::vector<std::unique_ptr<ConnectableRtcTransport>> _transports;
+    std::vector<std::unique_ptr<bridge::EngineAudioStream>> _streams;
+};
+
+TEST_F(EngineStreamRegistryTest, addCopiesHotFields)
+{
+    bridge::EngineStreamRegistry<bridge::EngineAudioStream> registry(16);
+    _transports[1]->_connected = true;
+    for (auto& stream : _streams)
+    {
+        registry.add(stream.get(), stream->_audioMixed);
+    }
+
+    ASSERT_EQ(4, registry.size());
+    for (size_t i = 0; i < registry.size(); ++i)
+    {
+        EXPECT_EQ(_streams[i].get(), registry.getStream(i));
+        EXPECT_EQ(i, registry.getEndpointIdHash(i));
+        EXPECT_EQ(_transports[i].get(), registry.getTransport(i));
+        EXPECT_EQ(_jobQueue.get(), &registry.getJobQueue(i));
+        EXPECT_EQ(i == 1, registry.isConnected(i));
+        EXPECT_EQ(i % 2 == 0, registry.isMixed(i));
+        EXPECT_EQ(i == 3, registry.isSsrcRewrite(i));
+    }
+}
+
+TEST_F(EngineStreamRegistryTest, removeMovesLastStreamIntoSlot)
+{
+    bridge::EngineStreamRegistry<bridge::EngineAudioStream> registry(16);
+    for (auto& stream : _streams)
+    {
+        registry.add(stream.get(), stream->_audioMixed);
+    }
+
+    EXPECT_TRUE(registry.remove(_streams[1].get()));
+    EXPECT_FALSE(registry.remove(_streams[1].get()));
+    ASSERT_EQ(3, registry.size());
+    EXPECT_EQ(registry.size(), registry.find(_streams[1].get()));
+
+    EXPECT_EQ(1, registry.find(_streams[3].get()));
+    EXPECT_EQ(_transports[3].get(), registry.getTransport(1));
+    EXPECT_EQ(3, registry.getEndpointIdHash(1));
+    EXPECT_TRUE(registry.isSsrcRewrite(1));
+    EXPECT_FALSE(registry.isMixed(1));
+
+    registry.clear();
+    EXPECT_EQ(0, registry.size());
+}
+
+TEST_F(EngineStreamRegistryTest, refreshConnectedKeepsOtherFlags)
+{
+    bridge::EngineStreamRegistry<bridge::EngineAudioStream> registry(16);
+    for (auto& stream : _streams)
+    {
+        registry.add(stream.get(), stream->_audioMixed);
+    }
+
+    _transports[0]->_connected = true;
+    _transports[3]->_connected = true;
+    EXPECT_FALSE(registry.isConnected(0));
+    registry.refreshConnected();
+    EXPECT_TRUE(registry.isConnected(0));
+    EXPECT_TRUE(registry.isMixed(0));
+    EXPECT_TRUE(registry.isConnected(3));
+    EXPECT_TRUE(registry.isSsrcRewrite(3));
+
+    _transports[3]->_connected = false;
+    registry.refreshConnected();
+    EXPECT_FALSE(registry.isConnected(3));
+    EXPECT_TRUE(registry.isSsrcRewrite(3));
+}
+
+TEST_F(EngineStreamRegistryTest, findsExistingOutboundContexts)
+{
+    bridge::EngineStreamRegistry<bridge::EngineAudioStream> registry(16);
+    registry.add(_streams[0].get(), true);
+
+    EXPECT_EQ(nullptr, registry.findOutboundContext(0, 1234));
+
+    memory::PacketPoolAllocator allocator(64, "EngineStreamRegistryTest");
+    _streams[0]->_ssrcOutboundContexts.emplace(1234, 1234, allocator, bridge::RtpMap());
+    auto* context = registry.findOutboundContext(0, 1234);
+    ASSERT_NE(nullptr, context);
+    EXPECT_EQ(1234, context->_ssrc);
+    _streams[0]->_ssrcOutboundContexts.erase(1234);
+}
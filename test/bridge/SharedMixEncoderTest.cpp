@@ -0,0 +1,160 @@
+#include "bridge/engine/SharedMixEncoder.h"
+#include "bridge/engine/SsrcOutboundContext.h"
+#include "jobmanager/JobManager.h"
+#include "jobmanager/WorkerThread.h"
+#include "rtp/RtpHeader.h"
+#include "test/bridge/DummyRtcTransport.h"
+#include "utils/Time.h"
+#include <atomic>
+#include <gtest/gtest.h>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+// Jobs running on other threads than the test are held back in getJobQueue until the gate is opened
+class SendingRtcTransport : public DummyRtcTransport
+{
+public:
+    SendingRtcTransport(jobmanager::JobQueue& jobQueue)
+        : DummyRtcTransport(jobQueue),
+          _testThread(std::this_thread::get_id()),
+          _gateOpen(false)
+    {
+        _jobCounter = 0;
+    }
+
+    jobmanager::JobQueue& getJobQueue() override
+    {
+        while (std::this_thread::get_id() != _testThread && !_gateOpen.load())
+        {
+            utils::Time::nanoSleep(utils::Time::ms);
+        }
+        return _jobQueue;
+    }
+
+    void protectAndSend(memory::UniquePacket packet) override
+    {
+        const auto rtpHeader = rtp::RtpHeader::fromPacket(*packet);
+        std::lock_guard<std::mutex> locker(_lock);
+        _sent.push_back(std::make_pair(rtpHeader->sequenceNumber.get(), rtpHeader->timestamp.get()));
+    }
+
+    size_t getSentCount()
+    {
+        std::lock_guard<std::mutex> locker(_lock);
+        return _sent.size();
+    }
+
+    const std::thread::id _testThread;
+    std::atomic_bool _gateOpen;
+    std::mutex _lock;
+    std::vector<std::pair<uint16_t, uint32_t>> _sent;
+};
+
+} // namespace
+
+class SharedMixEncoderTest : public ::testing::Test
+{
+public:
+    SharedMixEncoderTest()
+        : _sendAllocator(1024, "SharedMixEncoderTest"),
+          _audioAllocator(256, "SharedMixEncoderTestAudio"),
+          _sharedPacketAllocator(256, "SharedMixEncoderTestShared"),
+          _rtpMap(bridge::RtpMap::Format::OPUS)
+    {
+    }
+
+    void SetUp() override
+    {
+        utils::Time::initialize();
+        for (int i = 0; i < 2; ++i)
+        {
+            _workerThreads.push_back(std::make_unique<jobmanager::WorkerThread>(_jobManager));
+        }
+        for (size_t i = 0; i < samples; ++i)
+        {
+            _pcmData[i] = static_cast<int16_t>((i * 37) % 2000);
+        }
+    }
+
+    void TearDown() override
+    {
+        _jobManager.stop();
+        for (auto& workerThread : _workerThreads)
+        {
+            workerThread->stop();
+        }
+    }
+
+    memory::UniqueAudioPacket makeOwnFrame(const uint32_t ssrc)
+    {
+        auto packet = memory::makeUniquePacket(_audioAllocator);
+        auto rtpHeader = rtp::RtpHeader::create(*packet);
+        rtpHeader->ssrc = ssrc;
+        std::memcpy(rtpHeader->getPayload(), _pcmData, sizeof(_pcmData));
+        packet->setLength(rtpHeader->headerLength() + sizeof(_pcmData));
+        return packet;
+    }
+
+protected:
+    static const size_t samples = 960;
+
+    jobmanager::JobManager _jobManager;
+    std::vector<std::unique_ptr<jobmanager::WorkerThread>> _workerThreads;
+    memory::PacketPoolAllocator _sendAllocator;
+    memory::AudioPacketPoolAllocator _audioAllocator;
+    memory::SharedPacketPoolAllocator _sharedPacketAllocator;
+    bridge::RtpMap _rtpMap;
+    int16_t _pcmData[samples];
+};
+
+TEST_F(SharedMixEncoderTest, listenerLeavingSharedMixKeepsPacketsInOrder)
+{
+    const uint32_t ssrc = 1234;
+    const uint32_t sharedFrameCount = 4;
+    const uint32_t frameCount = 20;
+    auto transportQueue = std::make_unique<jobmanager::JobQueue>(_jobManager);
+    SendingRtcTransport transport(*transportQueue);
+    bridge::SsrcOutboundContext outboundContext(ssrc, _sendAllocator, _rtpMap);
+
+    {
+        bridge::SharedMixEncoder encoder(_jobManager, _audioAllocator, _sendAllocator, _sharedPacketAllocator, 8);
+        // the shared frames are still queued when the listener leaves the shared mix
+        for (uint32_t frame = 0; frame < frameCount; ++frame)
+        {
+            const uint64_t rtpTimestamp = frame * 10;
+            if (frame < sharedFrameCount)
+            {
+                ASSERT_TRUE(encoder.beginFrame());
+                encoder.addListener(outboundContext, transport);
+                encoder.encodeFrame(_pcmData, samples, rtpTimestamp, 30);
+            }
+            else
+            {
+                EXPECT_TRUE(encoder.postOwnFrame(makeOwnFrame(ssrc),
+                    outboundContext,
+                    transport,
+                    rtpTimestamp,
+                    utils::Optional<int>(30),
+                    frame == sharedFrameCount));
+            }
+        }
+        EXPECT_FALSE(encoder.beginFrame());
+        EXPECT_EQ(0u, transport.getSentCount());
+        transport._gateOpen = true;
+    }
+    transportQueue.reset();
+
+    ASSERT_EQ(frameCount, transport.getSentCount());
+    EXPECT_EQ(0u, outboundContext._framesOnSharedMixQueue.load());
+    EXPECT_NE(nullptr, outboundContext._opusEncoder.get());
+    for (uint32_t i = 0; i < frameCount; ++i)
+    {
+        EXPECT_EQ(i, transport._sent[i].first);
+        EXPECT_EQ(i * 10 * 48, transport._sent[i].second);
+    }
+}
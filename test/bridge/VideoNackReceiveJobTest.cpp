@@ -1,5 +1,4 @@
 #include "bridge/engine/VideoNackReceiveJob.h"
-#include "bridge/engine/PacketCache.h"
 #include "bridge/engine/SsrcOutboundContext.h"
 #include "jobmanager/JobManager.h"
 #include "memory/PacketPoolAllocator.h"
@@ -39,8 +38,7 @@ class VideoNackReceiveJobTest : public ::testing::Test
         _ssrcOutboundContext = std::make_unique<bridge::SsrcOutboundContext>(outboundSsrc,
             *_allocator,
             bridge::RtpMap(bridge::RtpMap::Format::VP8));
-
-        _packetCache = std::make_unique<bridge::PacketCache>("VideoNackReceiveJobTest", outboundSsrc);
+        _ssrcOutboundContext->_rewriteHistory = std::make_unique<bridge::VideoRewriteHistory>();
     }
 
     void TearDown() override
@@ -61,7 +59,6 @@ protected:
 
     std::unique_ptr<memory::PacketPoolAllocator> _allocator;
     std::unique_ptr<bridge::SsrcOutboundContext> _ssrcOutboundContext;
-    std::unique_ptr<bridge::PacketCache> _packetCache;
 };
 
 TEST_F(VideoNackReceiveJobTest, nacksNotAlreadyRespondedToAreHandled)
@@ -73,7 +70,7 @@ TEST_F(VideoNackReceiveJobTest, nacksNotAlreadyRespondedToAreHandled)
 
     auto videoNackReceiveJob = std::make_unique<bridge::VideoNackReceiveJob>(*_ssrcOutboundContext,
         *_transport,
-        *_packetCache,
+        *_ssrcOutboundContext,
         pid,
         blp,
         outboundFeedbackSsrc,
@@ -91,7 +88,7 @@ TEST_F(VideoNackReceiveJobTest, nacksNotAlreadyRespondedToAreHandled)
 
     videoNackReceiveJob = std::make_unique<bridge::VideoNackReceiveJob>(*_ssrcOutboundContext,
         *_transport,
-        *_packetCache,
+        *_ssrcOutboundContext,
         pid,
         blp,
         outboundFeedbackSsrc,
@@ -113,7 +110,7 @@ TEST_F(VideoNackReceiveJobTest, nacksAlreadyRespondedToWithinRttAreIgnored)
 
     auto videoNackReceiveJob = std::make_unique<bridge::VideoNackReceiveJob>(*_ssrcOutboundContext,
         *_transport,
-        *_packetCache,
+        *_ssrcOutboundContext,
         pid,
         blp,
         outboundFeedbackSsrc,
@@ -123,7 +120,7 @@ TEST_F(VideoNackReceiveJobTest, nacksAlreadyRespondedToWithinRttAreIgnored)
 
     videoNackReceiveJob = std::make_unique<bridge::VideoNackReceiveJob>(*_ssrcOutboundContext,
         *_transport,
-        *_packetCache,
+        *_ssrcOutboundContext,
         pid,
         blp,
         outboundFeedbackSsrc,
@@ -143,7 +140,7 @@ TEST_F(VideoNackReceiveJobTest, nacksAlreadyRespondedToOutsideRttAreHandled)
 
     auto videoNackReceiveJob = std::make_unique<bridge::VideoNackReceiveJob>(*_ssrcOutboundContext,
         *_transport,
-        *_packetCache,
+        *_ssrcOutboundContext,
         pid,
         blp,
         outboundFeedbackSsrc,
@@ -155,7 +152,7 @@ TEST_F(VideoNackReceiveJobTest, nacksAlreadyRespondedToOutsideRttAreHandled)
 
     videoNackReceiveJob = std::make_unique<bridge::VideoNackReceiveJob>(*_ssrcOutboundContext,
         *_transport,
-        *_packetCache,
+        *_ssrcOutboundContext,
         pid,
         blp,
         outboundFeedbackSsrc,
@@ -0,0 +1,102 @@
+#include "bridge/engine/VideoPacketCache.h"
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <memory>
+
+class VideoPacketCacheTest : public ::testing::Test
+{
+    void SetUp() override
+    {
+        _packetAllocator = std::make_unique<memory::PacketPoolAllocator>(16, "VideoPacketCacheTest");
+        _packetCache = std::make_shared<bridge::VideoPacketCache>("VideoPacketCache", 1);
+    }
+
+    void TearDown() override
+    {
+        _packetCache.reset();
+        _packetAllocator.reset();
+    }
+
+protected:
+    std::unique_ptr<memory::PacketPoolAllocator> _packetAllocator;
+    std::shared_ptr<bridge::VideoPacketCache> _packetCache;
+
+    memory::UniquePacket makeUniquePacket(const uint32_t extendedSequenceNumber)
+    {
+        auto packet = memory::makeUniquePacket(*_packetAllocator);
+        memset(packet->get(), 0, packet->size);
+        reinterpret_cast<uint32_t*>(packet->get())[0] = extendedSequenceNumber;
+        packet->setLength(sizeof(uint32_t));
+        return packet;
+    }
+
+    bool verifyPacket(const memory::Packet& packet, const uint32_t extendedSequenceNumber)
+    {
+        return packet.getLength() == sizeof(uint32_t) &&
+            reinterpret_cast<const uint32_t*>(packet.get())[0] == extendedSequenceNumber;
+    }
+};
+
+TEST_F(VideoPacketCacheTest, addPacket)
+{
+    auto packet = makeUniquePacket(70000);
+    _packetCache->add(*packet, 70000);
+
+    auto cachedPacket = _packetCache->get(70000, *_packetAllocator);
+    ASSERT_TRUE(cachedPacket);
+    EXPECT_TRUE(verifyPacket(*cachedPacket, 70000));
+
+    EXPECT_FALSE(_packetCache->get(70001, *_packetAllocator));
+}
+
+TEST_F(VideoPacketCacheTest, oldPacketsAreReplaced)
+{
+    for (uint32_t i = 0; i < bridge::VideoPacketCache::maxPackets + 1; ++i)
+    {
+        auto packet = makeUniquePacket(i);
+        _packetCache->add(*packet, i);
+    }
+
+    EXPECT_FALSE(_packetCache->get(0, *_packetAllocator));
+
+    auto cachedPacket = _packetCache->get(1, *_packetAllocator);
+    ASSERT_TRUE(cachedPacket);
+    EXPECT_TRUE(verifyPacket(*cachedPacket, 1));
+
+    cachedPacket = _packetCache->get(bridge::VideoPacketCache::maxPackets, *_packetAllocator);
+    ASSERT_TRUE(cachedPacket);
+    EXPECT_TRUE(verifyPacket(*cachedPacket, bridge::VideoPacketCache::maxPackets));
+}
+
+TEST_F(VideoPacketCacheTest, rewriteHistoryMatchesOutboundSequenceNumber)
+{
+    auto rewriteHistory = std::make_unique<bridge::VideoRewriteHistory>();
+    EXPECT_EQ(nullptr, rewriteHistory->get(100));
+
+    rewriteHistory->add({_packetCache, 70000, 1234, 100, 10, 2, 3});
+    const auto record = rewriteHistory->get(100);
+    ASSERT_NE(nullptr, record);
+    EXPECT_EQ(70000u, record->extendedSequenceNumber);
+    EXPECT_EQ(1234u, record->timestamp);
+    EXPECT_EQ(10u, record->picId);
+
+    const auto wrappedSequenceNumber = static_cast<uint16_t>(100 + bridge::VideoPacketCache::maxPackets);
+    rewriteHistory->add({_packetCache, 70512, 1234, wrappedSequenceNumber, 11, 2, 3});
+    EXPECT_EQ(nullptr, rewriteHistory->get(100));
+}
+
+TEST_F(VideoPacketCacheTest, rewriteHistoryKeepsCacheAlive)
+{
+    auto rewriteHistory = std::make_unique<bridge::VideoRewriteHistory>();
+    auto packet = makeUniquePacket(7);
+    _packetCache->add(*packet, 7);
+    rewriteHistory->add({_packetCache, 7, 1234, 100, 10, 2, 3});
+    packet.reset();
+    _packetCache.reset();
+
+    const auto record = rewriteHistory->get(100);
+    ASSERT_NE(nullptr, record);
+    auto cachedPacket = record->packetCache->get(record->extendedSequenceNumber, *_packetAllocator);
+    ASSERT_TRUE(cachedPacket);
+    EXPECT_TRUE(verifyPacket(*cachedPacket, 7));
+}
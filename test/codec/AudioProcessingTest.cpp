@@ -22,4 +22,45 @@ TEST(AudioProcess, audiolevel)
     auto dB = codec::computeAudioLevel(data, samples);
     double dBrms = 20 * std::log10(amplitude / (double(0x8000) * std::sqrt(2)));
     EXPECT_EQ(static_cast<int>(dBrms), -dB);
-}
\ No newline at end of file
+}
+namespace
+{
+int referenceAudioLevel(const int16_t* payload, int count)
+{
+    const double overload = 0x8000;
+    double rms = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        double sample = double(payload[i]);
+        rms += sample * sample;
+    }
+    rms /= (overload * overload);
+    rms = count ? std::sqrt(rms / count) : 0;
+    rms = std::max(rms, 1e-9);
+
+    return -std::max(-127, static_cast<int>(20 * std::log10(rms)));
+}
+} // namespace
+
+TEST(AudioProcess, audiolevelMatchesFloatingPoint)
+{
+    const double PI = 3.14159;
+    const int samples = 963; // not a multiple of the vector width
+    int16_t data[samples];
+
+    EXPECT_EQ(127, codec::computeAudioLevel(data, 0));
+    for (double amplitude = 0; amplitude <= 0x8000; amplitude = amplitude * 1.07 + 1)
+    {
+        for (int i = 0; i < samples; ++i)
+        {
+            data[i] = std::max(-32768.0, std::min(32767.0, sin(2 * PI * i * 400 / 48000.0) * amplitude));
+        }
+        EXPECT_EQ(referenceAudioLevel(data, samples), codec::computeAudioLevel(data, samples));
+    }
+
+    for (int i = 0; i < samples; ++i)
+    {
+        data[i] = (i % 2) ? -32768 : 32767;
+    }
+    EXPECT_EQ(0, codec::computeAudioLevel(data, samples));
+}
@@ -0,0 +1,212 @@
+#include "codec/MixKernels.h"
+#include "logger/Logger.h"
+#include "memory/RingBuffer.h"
+#include "utils/Time.h"
+#include <array>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+namespace
+{
+const size_t samplesPerIteration = 960;
+const int32_t scaleFactor = 4;
+
+std::vector<int16_t> makeSamples(std::mt19937& generator, const size_t count)
+{
+    std::uniform_int_distribution<int> distribution(INT16_MIN, INT16_MAX);
+    std::vector<int16_t> samples(count);
+    for (auto& sample : samples)
+    {
+        sample = static_cast<int16_t>(distribution(generator));
+    }
+    return samples;
+}
+} // namespace
+
+TEST(MixKernels, addAndRemoveIsExact)
+{
+    std::mt19937 generator(1);
+    const size_t count = 37; // not a multiple of the vector width
+    const auto first = makeSamples(generator, count);
+    const auto second = makeSamples(generator, count);
+
+    std::vector<int32_t> mix(count, 0);
+    codec::mixAdd(mix.data(), first.data(), count);
+    codec::mixAdd(mix.data(), second.data(), count);
+
+    std::vector<int16_t> withoutSecond(count);
+    codec::mixSubtractAndLimit(mix.data(), second.data(), withoutSecond.data(), count, 1);
+    for (size_t i = 0; i < count; ++i)
+    {
+        EXPECT_EQ(static_cast<int32_t>(first[i]) + second[i], mix[i]);
+        EXPECT_EQ(codec::softLimit(first[i]), withoutSecond[i]);
+    }
+}
+
+TEST(MixKernels, limiterPassesQuietSamplesAndSaturatesLoud)
+{
+    std::array<int32_t, 8> mix({0, 100, -100, 24000, -24000, 40000, -40000, 10000000});
+    std::array<int16_t, 8> limited({});
+    codec::mixLimit(mix.data(), limited.data(), mix.size(), 1);
+
+    EXPECT_EQ(0, limited[0]);
+    EXPECT_EQ(100, limited[1]);
+    EXPECT_EQ(-100, limited[2]);
+    EXPECT_EQ(24000, limited[3]);
+    EXPECT_EQ(-24000, limited[4]);
+    EXPECT_GT(limited[5], 24576);
+    EXPECT_LT(limited[5], 32767);
+    EXPECT_EQ(-limited[5], limited[6]);
+    EXPECT_GT(limited[7], limited[5]);
+    EXPECT_LE(limited[7], 32767);
+}
+
+TEST(MixKernels, vectorMatchesScalar)
+{
+    std::mt19937 generator(2);
+    const size_t contributors = 50;
+    std::vector<int32_t> mix(samplesPerIteration + 5, 0);
+    std::vector<int16_t> lastContributor;
+    for (size_t i = 0; i < contributors; ++i)
+    {
+        lastContributor = makeSamples(generator, mix.size());
+        codec::mixAdd(mix.data(), lastContributor.data(), mix.size());
+    }
+
+    std::vector<int16_t> limited(mix.size());
+    std::vector<int16_t> withoutLast(mix.size());
+    codec::mixLimit(mix.data(), limited.data(), mix.size(), scaleFactor);
+    codec::mixSubtractAndLimit(mix.data(), lastContributor.data(), withoutLast.data(), mix.size(), scaleFactor);
+    for (size_t i = 0; i < mix.size(); ++i)
+    {
+        EXPECT_EQ(codec::softLimit(mix[i] * (1.0f / scaleFactor)), limited[i]);
+        EXPECT_EQ(codec::softLimit((mix[i] - lastContributor[i]) * (1.0f / scaleFactor)), withoutLast[i]);
+    }
+}
+
+TEST(MixKernels, sumOfSquares)
+{
+    std::mt19937 generator(4);
+    auto samples = makeSamples(generator, samplesPerIteration + 3);
+    samples[0] = INT16_MIN;
+    samples[1] = INT16_MIN;
+
+    uint64_t expected = 0;
+    for (const auto sample : samples)
+    {
+        expected += static_cast<int64_t>(sample) * sample;
+    }
+    EXPECT_EQ(expected, codec::sumOfSquares(samples.data(), samples.size()));
+}
+
+TEST(MixKernels, addRingBufferToMix)
+{
+    using namespace memory;
+
+    RingBuffer<int16_t, 8> ringBuffer;
+
+    std::array<int16_t, 4> writeData({0, 2, 4, 6});
+
+    auto result = ringBuffer.write(&writeData[0], 4);
+    EXPECT_TRUE(result);
+
+    std::array<int32_t, 4> mixAccumulator({1, 1, 1, 1});
+    result = codec::addToMix(ringBuffer, mixAccumulator.data(), 4);
+    EXPECT_TRUE(result);
+
+    EXPECT_EQ(1, mixAccumulator[0]);
+    EXPECT_EQ(3, mixAccumulator[1]);
+    EXPECT_EQ(5, mixAccumulator[2]);
+    EXPECT_EQ(7, mixAccumulator[3]);
+}
+
+TEST(MixKernels, removeRingBufferFromMix)
+{
+    using namespace memory;
+
+    RingBuffer<int16_t, 8> ringBuffer;
+
+    std::array<int16_t, 4> writeData({0, 2, 4, 6});
+
+    auto result = ringBuffer.write(&writeData[0], 4);
+    EXPECT_TRUE(result);
+
+    std::array<int32_t, 4> mixAccumulator({2, 4, 6, 8});
+    std::array<int16_t, 4> outData({});
+    result = codec::removeFromMix(ringBuffer, mixAccumulator.data(), outData.data(), 4, 2);
+    EXPECT_TRUE(result);
+
+    EXPECT_EQ(1, outData[0]);
+    EXPECT_EQ(1, outData[1]);
+    EXPECT_EQ(1, outData[2]);
+    EXPECT_EQ(1, outData[3]);
+}
+
+TEST(MixKernels, ringBufferMixAcrossWrap)
+{
+    using namespace memory;
+
+    RingBuffer<int16_t, 8> ringBuffer;
+
+    std::array<int16_t, 6> writeData({1, 2, 3, 4, 5, 6});
+    EXPECT_TRUE(ringBuffer.write(&writeData[0], 6));
+    ringBuffer.drop(6);
+    EXPECT_TRUE(ringBuffer.write(&writeData[0], 6));
+
+    std::array<int32_t, 6> mixAccumulator({10, 10, 10, 10, 10, 10});
+    EXPECT_TRUE(codec::addToMix(ringBuffer, mixAccumulator.data(), 6));
+    for (size_t i = 0; i < mixAccumulator.size(); ++i)
+    {
+        EXPECT_EQ(10 + writeData[i], mixAccumulator[i]);
+    }
+
+    std::array<int16_t, 6> outData({});
+    EXPECT_TRUE(codec::removeFromMix(ringBuffer, mixAccumulator.data(), outData.data(), 6, 1));
+    for (auto sample : outData)
+    {
+        EXPECT_EQ(10, sample);
+    }
+}
+
+TEST(MixKernelsBenchmark, DISABLED_contributors)
+{
+    std::mt19937 generator(3);
+    std::vector<int32_t> mix(samplesPerIteration);
+    std::vector<int16_t> out(samplesPerIteration);
+    const auto iterations = 200;
+
+    for (const size_t contributors : {10, 50, 100, 250, 500})
+    {
+        std::vector<std::vector<int16_t>> buffers;
+        for (size_t i = 0; i < contributors; ++i)
+        {
+            buffers.push_back(makeSamples(generator, samplesPerIteration));
+        }
+
+        const auto start = utils::Time::getAbsoluteTime();
+        for (int iteration = 0; iteration < iterations; ++iteration)
+        {
+            std::fill(mix.begin(), mix.end(), 0);
+            for (const auto& buffer : buffers)
+            {
+                codec::mixAdd(mix.data(), buffer.data(), samplesPerIteration);
+            }
+            codec::mixLimit(mix.data(), out.data(), samplesPerIteration, scaleFactor);
+            for (const auto& buffer : buffers)
+            {
+                codec::mixSubtractAndLimit(mix.data(), buffer.data(), out.data(), samplesPerIteration, scaleFactor);
+            }
+        }
+        const auto elapsed = utils::Time::getAbsoluteTime() - start;
+
+        // every contributor is added once and removed once per iteration
+        const double samples = 2.0 * contributors * samplesPerIteration * iterations;
+        logger::info("%s %zu contributors %.2f samples/ns, %.1fus per mix iteration",
+            "MixKernelsBenchmark",
+            codec::getMixKernelName(),
+            contributors,
+            samples / elapsed,
+            elapsed / (1000.0 * iterations));
+    }
+}
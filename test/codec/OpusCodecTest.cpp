@@ -3,6 +3,7 @@
 #include "codec/OpusEncoder.h"
 #include "logger/Logger.h"
 #include <cmath>
+#include <cstring>
 #include <gtest/gtest.h>
 
 namespace codec
@@ -100,3 +101,20 @@ TEST_F(OpusTest, seqSkip)
     auto dB = codec::computeAudioLevel(_pcmData, samples);
     EXPECT_EQ(static_cast<int>(-24), -dB);
 }
+
+TEST_F(OpusTest, copiedStateContinuesEncoding)
+{
+    codec::OpusEncoder encoder;
+    codec::OpusEncoder copy;
+    for (int i = 0; i < 5; ++i)
+    {
+        EXPECT_GT(encoder.encode(_pcmData, samples, _opusData, samples), 0);
+    }
+
+    ASSERT_TRUE(copy.copyState(encoder));
+    uint8_t copyData[samples];
+    const auto opusBytes = encoder.encode(_pcmData, samples, _opusData, samples);
+    ASSERT_GT(opusBytes, 0);
+    ASSERT_EQ(opusBytes, copy.encode(_pcmData, samples, copyData, samples));
+    EXPECT_EQ(0, std::memcmp(_opusData, copyData, opusBytes));
+}
@@ -2,8 +2,10 @@
 #include "concurrency/Semaphore.h"
 #include "jobmanager/JobQueue.h"
 #include "jobmanager/WorkerThread.h"
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <ctime>
 #include <gtest/gtest.h>
 #include <memory>
 #include <random>
@@ -247,6 +249,82 @@ TEST_F(JobManagerTest, serialJobQueueFull)
     EXPECT_EQ(counter.load(), 0);
 }
 
+TEST_F(JobManagerTest, serialJobQueuesShareSlab)
+{
+    auto& slab = jobManager.getSerialJobSlab();
+    const auto allocatedBefore = slab.getAllocatedCount();
+
+    std::atomic_int counter(0);
+    Semaphore sem;
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        jobManager.template addJob<BlockingJob>(sem);
+    }
+
+    {
+        std::vector<std::unique_ptr<JobQueue>> serialJobQueues;
+        for (int i = 0; i < 1000; ++i)
+        {
+            serialJobQueues.emplace_back(std::make_unique<JobQueue>(jobManager));
+            EXPECT_TRUE(serialJobQueues.back()->addJob<NoJob>(counter));
+        }
+
+        EXPECT_EQ(allocatedBefore + 1000, slab.getAllocatedCount());
+        EXPECT_EQ(allocatedBefore + 1000, jobManager.getMetrics().serialJobCells);
+
+        for (int i = 0; i < numWorkers; ++i)
+        {
+            sem.post();
+        }
+    }
+
+    EXPECT_EQ(0, counter.load());
+    // the cell of the last StopJob is returned just after the queue destructor has been released
+    for (int i = 0; i < 100 && slab.getAllocatedCount() != allocatedBefore; ++i)
+    {
+        utils::Time::usleep(1000);
+    }
+    EXPECT_EQ(allocatedBefore, slab.getAllocatedCount());
+}
+
+TEST_F(JobManagerTest, backedUpSerialJobQueueLeavesReserve)
+{
+    auto& slab = jobManager.getSerialJobSlab();
+    const size_t guaranteedJobs = JobManager::guaranteedSerialJobs;
+    const size_t reserve = JobManager::serialJobSlabReserve;
+
+    std::atomic_int counter(0);
+    Semaphore sem;
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        jobManager.template addJob<BlockingJob>(sem);
+    }
+
+    {
+        JobQueue backedUpQueue(jobManager, JobManager::serialJobSlabSize);
+        JobQueue otherQueue(jobManager);
+        while (backedUpQueue.addJob<NoJob>(counter))
+            ;
+
+        EXPECT_GT(backedUpQueue.getCount(), guaranteedJobs);
+        EXPECT_LE(slab.getFreeCount(), reserve);
+        EXPECT_GE(slab.getFreeCount(), reserve - guaranteedJobs);
+
+        for (size_t i = 0; i < guaranteedJobs; ++i)
+        {
+            EXPECT_TRUE(otherQueue.addJob<NoJob>(counter));
+        }
+        EXPECT_FALSE(otherQueue.addJob<NoJob>(counter));
+
+        for (int i = 0; i < numWorkers; ++i)
+        {
+            sem.post();
+        }
+    }
+
+    EXPECT_EQ(0, counter.load());
+}
+
 class TimerJob : public Job
 {
 public:
@@ -279,3 +357,155 @@ TEST_F(JobManagerTest, timers)
     end = utils::Time::getAbsoluteTime();
     EXPECT_NEAR(end - start, timeout * 3, 30 * ms);
 }
+
+class PostingJob : public Job
+{
+public:
+    PostingJob(JobManager& jobManager,
+        std::atomic_int& counter,
+        std::atomic_bool& posted,
+        std::atomic_bool& finished,
+        Semaphore& blockSem,
+        int count)
+        : _jobManager(jobManager),
+          _counter(counter),
+          _posted(posted),
+          _finished(finished),
+          _blockSem(blockSem),
+          _count(count)
+    {
+    }
+
+    void run() override
+    {
+        for (int i = 0; i < _count; ++i)
+        {
+            _jobManager.addJob<NoJob>(_counter);
+        }
+        _posted = true;
+        _blockSem.wait();
+        _finished = true;
+    }
+
+private:
+    JobManager& _jobManager;
+    std::atomic_int& _counter;
+    std::atomic_bool& _posted;
+    std::atomic_bool& _finished;
+    Semaphore& _blockSem;
+    const int _count;
+};
+
+TEST_F(JobManagerTest, localJobsAreStolenFromBusyWorker)
+{
+    std::atomic_int counter(0);
+    std::atomic_bool posted(false);
+    std::atomic_bool finished(false);
+    Semaphore sem;
+    jobManager.addJob<PostingJob>(jobManager, counter, posted, finished, sem, 100);
+
+    for (int i = 0; i < 100 && (!posted.load() || counter.load() != 0); ++i)
+    {
+        utils::Time::usleep(10000);
+    }
+    EXPECT_TRUE(posted.load());
+    EXPECT_EQ(counter.load(), 0);
+
+    sem.post();
+    while (!finished.load())
+    {
+        utils::Time::usleep(1000);
+    }
+}
+
+namespace
+{
+
+struct LatencyJob : public Job
+{
+    LatencyJob(uint64_t postTime, std::vector<uint64_t>& latencies, size_t index, std::atomic_int& completed)
+        : postTime(postTime),
+          latencies(latencies),
+          index(index),
+          completed(completed)
+    {
+    }
+
+    void run() override
+    {
+        latencies[index] = utils::Time::getAbsoluteTime() - postTime;
+        ++completed;
+    }
+
+    const uint64_t postTime;
+    std::vector<uint64_t>& latencies;
+    const size_t index;
+    std::atomic_int& completed;
+};
+
+uint64_t getProcessCpuTime()
+{
+    timespec cpuTime = {};
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpuTime);
+    return static_cast<uint64_t>(cpuTime.tv_sec) * utils::Time::sec + cpuTime.tv_nsec;
+}
+
+void measureIdleStrategy(JobManager::IdleStrategy idleStrategy, const char* name)
+{
+    const size_t jobCount = 2000;
+    JobManager jobManager(idleStrategy);
+    std::vector<std::unique_ptr<WorkerThread>> workers;
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        workers.emplace_back(std::make_unique<WorkerThread>(jobManager));
+    }
+    utils::Time::nanoSleep(100 * utils::Time::ms);
+
+    const auto idleStart = utils::Time::getAbsoluteTime();
+    const auto idleCpuStart = getProcessCpuTime();
+    utils::Time::nanoSleep(utils::Time::sec);
+    const double idleCpu =
+        double(getProcessCpuTime() - idleCpuStart) / (utils::Time::getAbsoluteTime() - idleStart);
+
+    std::vector<uint64_t> latencies(jobCount, 0);
+    std::atomic_int completed(0);
+    std::default_random_engine generator(jobCount);
+    std::uniform_int_distribution<uint32_t> gapDistribution(50, 1000);
+    for (size_t i = 0; i < jobCount; ++i)
+    {
+        jobManager.addJob<LatencyJob>(utils::Time::getAbsoluteTime(), latencies, i, completed);
+        utils::Time::usleep(gapDistribution(generator));
+    }
+    for (int i = 0; i < 100 && completed.load() != jobCount; ++i)
+    {
+        utils::Time::usleep(10000);
+    }
+    EXPECT_EQ(completed.load(), jobCount);
+
+    std::sort(latencies.begin(), latencies.end());
+    const auto metrics = jobManager.getMetrics();
+    logger::info("%s job start latency p50 %.1fus p99 %.1fus max %.1fus, idle cpu %.1f%%, wakeups %" PRIu64
+                 ", parks %" PRIu64,
+        "JobManagerBenchmark",
+        name,
+        latencies[jobCount / 2] / 1000.0,
+        latencies[jobCount * 99 / 100] / 1000.0,
+        latencies.back() / 1000.0,
+        idleCpu * 100,
+        metrics.wakeups,
+        metrics.parks);
+
+    jobManager.stop();
+    for (auto& worker : workers)
+    {
+        worker->stop();
+    }
+}
+
+} // namespace
+
+TEST(JobManagerBenchmark, DISABLED_idleStrategies)
+{
+    measureIdleStrategy(JobManager::IdleStrategy::Backoff, "backoff");
+    measureIdleStrategy(JobManager::IdleStrategy::SpinThenPark, "spinThenPark");
+}
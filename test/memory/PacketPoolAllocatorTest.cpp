@@ -0,0 +1,79 @@
+#include "memory/PacketPoolAllocator.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace
+{
+const size_t fullCapacity = memory::Packet::size;
+}
+
+TEST(PacketPoolAllocatorTest, picksSmallestClassWithHeadroom)
+{
+    memory::PacketPoolAllocator allocator(16, "PacketPoolAllocatorTest", 16);
+    uint8_t data[fullCapacity];
+    std::memset(data, 0xA5, sizeof(data));
+
+    auto stun = memory::makeUniquePacket(allocator, data, 60);
+    auto report = memory::makeUniquePacket(allocator, data, 256 - memory::PacketPoolAllocator::growthHeadroom + 1);
+    auto video = memory::makeUniquePacket(allocator, data, 1200);
+    auto received = memory::makeUniquePacket(allocator);
+    ASSERT_TRUE(stun && report && video && received);
+
+    EXPECT_EQ(256u, stun->getCapacity());
+    EXPECT_EQ(512u, report->getCapacity());
+    EXPECT_EQ(fullCapacity, video->getCapacity());
+    EXPECT_EQ(fullCapacity, received->getCapacity());
+    EXPECT_EQ(0, std::memcmp(data, stun->get(), stun->getLength()));
+    EXPECT_EQ(0, std::memcmp(data, report->get(), report->getLength()));
+    EXPECT_FALSE(memory::PacketPoolAllocator::isCorrupt(stun.get()));
+    EXPECT_FALSE(memory::PacketPoolAllocator::isCorrupt(report.get()));
+
+    // appending beyond the capacity of the class is refused
+    stun->append(data, 256);
+    EXPECT_EQ(60u, stun->getLength());
+    stun->append(data, memory::PacketPoolAllocator::growthHeadroom);
+    EXPECT_EQ(60u + memory::PacketPoolAllocator::growthHeadroom, stun->getLength());
+
+    auto copy = memory::makeUniquePacket(allocator, *video);
+    ASSERT_TRUE(copy);
+    EXPECT_EQ(fullCapacity, copy->getCapacity());
+    EXPECT_EQ(1200u, copy->getLength());
+}
+
+TEST(PacketPoolAllocatorTest, depletedClassFallsBackToLargerClass)
+{
+    memory::PacketPoolAllocator allocator(1024, "PacketPoolAllocatorTest", 8);
+    const size_t smallCount = allocator.getElementCount(memory::PacketPoolAllocator::SMALL);
+    const size_t mediumCount = allocator.getElementCount(memory::PacketPoolAllocator::MEDIUM);
+    const size_t fullSize = allocator.size();
+    uint8_t data[100] = {0};
+
+    std::vector<memory::UniquePacket> packets;
+    for (size_t i = 0; i < smallCount + mediumCount + 1; ++i)
+    {
+        packets.push_back(memory::makeUniquePacket(allocator, data, sizeof(data)));
+        ASSERT_TRUE(packets.back());
+    }
+
+    EXPECT_EQ(256u, packets.front()->getCapacity());
+    EXPECT_EQ(512u, packets[smallCount]->getCapacity());
+    EXPECT_EQ(fullCapacity, packets.back()->getCapacity());
+
+    // every packet goes back to the class it came from
+    packets.clear();
+    auto packet = memory::makeUniquePacket(allocator, data, sizeof(data));
+    EXPECT_EQ(256u, packet->getCapacity());
+    packet.reset();
+    EXPECT_EQ(fullSize, allocator.size());
+    EXPECT_EQ(0u, allocator.countAllocatedItems());
+}
+
+TEST(PacketPoolAllocatorTest, fullSizeOnlyWithoutSizeClasses)
+{
+    memory::PacketPoolAllocator allocator(16, "PacketPoolAllocatorTest");
+    uint8_t data[20] = {0};
+    auto packet = memory::makeUniquePacket(allocator, data, sizeof(data));
+    ASSERT_TRUE(packet);
+    EXPECT_EQ(fullCapacity, packet->getCapacity());
+    EXPECT_EQ(0u, allocator.getElementCount(memory::PacketPoolAllocator::SMALL));
+}
@@ -0,0 +1,109 @@
+#include "memory/PageMapping.h"
+#include "memory/PoolAllocator.h"
+#include <cstring>
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+class PolicyScope
+{
+public:
+    explicit PolicyScope(memory::HugePages hugePages) : _previous(memory::getMappingPolicy())
+    {
+        memory::MappingPolicy policy;
+        policy.hugePages = hugePages;
+        memory::setMappingPolicy(policy);
+    }
+    ~PolicyScope() { memory::setMappingPolicy(_previous); }
+
+private:
+    memory::MappingPolicy _previous;
+};
+
+struct Data
+{
+    char data[1000];
+};
+} // namespace
+
+TEST(PageMappingTest, mappedSizeRoundsLargeMappingsToHugePages)
+{
+    const size_t pageSize = getpagesize();
+    const size_t hugePageSize = memory::getHugePageSize();
+    EXPECT_EQ(pageSize, memory::getMappedSize(1));
+    EXPECT_EQ(2 * pageSize, memory::getMappedSize(pageSize + 1));
+    EXPECT_EQ(hugePageSize, memory::getMappedSize(hugePageSize));
+    EXPECT_EQ(2 * hugePageSize, memory::getMappedSize(hugePageSize + 1));
+}
+
+TEST(PageMappingTest, smallMappingsUseBasePages)
+{
+    PolicyScope policy(memory::HugePages::EXPLICIT);
+    size_t pageSize = 0;
+    auto* address = memory::mapPages(64 * 1024, false, &pageSize);
+    ASSERT_NE(nullptr, address);
+    EXPECT_EQ(static_cast<size_t>(getpagesize()), pageSize);
+    memory::unmapPages(address, 64 * 1024);
+}
+
+TEST(PageMappingTest, hugePagePolicies)
+{
+    const size_t hugePageSize = memory::getHugePageSize();
+    for (auto hugePages : {memory::HugePages::OFF, memory::HugePages::TRANSPARENT, memory::HugePages::EXPLICIT})
+    {
+        PolicyScope policy(hugePages);
+        size_t pageSize = 0;
+        const size_t size = 2 * hugePageSize + 100;
+        auto* address = reinterpret_cast<uint8_t*>(memory::mapPages(size, true, &pageSize));
+        ASSERT_NE(nullptr, address);
+        if (hugePages == memory::HugePages::OFF)
+        {
+            EXPECT_EQ(static_cast<size_t>(getpagesize()), pageSize);
+        }
+        else
+        {
+            // explicit falls back to transparent huge pages when none are reserved
+            EXPECT_GE(pageSize, static_cast<size_t>(getpagesize()));
+        }
+        std::memset(address, 0xAB, size);
+        EXPECT_EQ(0xAB, address[size - 1]);
+        memory::unmapPages(address, size);
+    }
+}
+
+TEST(PageMappingTest, vectorWithPageAllocator)
+{
+    PolicyScope policy(memory::HugePages::TRANSPARENT);
+    const size_t hugePageSize = memory::getHugePageSize();
+    std::vector<uint64_t, memory::PageAllocator<uint64_t>> values(hugePageSize / sizeof(uint64_t), 7);
+    EXPECT_EQ(7u, values.back());
+    values.assign(values.size(), 9);
+    EXPECT_EQ(9u, values.front());
+}
+
+TEST(PageMappingTest, poolChunksFollowPageSize)
+{
+    PolicyScope policy(memory::HugePages::TRANSPARENT);
+    memory::PoolAllocator<sizeof(Data)> allocator(16 * 1024, "PageMappingTest");
+    EXPECT_LT(allocator.getCommittedCount(), allocator.size());
+    EXPECT_GE(allocator.getChunkSize() * sizeof(Data), 3 * allocator.getPageSize());
+
+    std::vector<void*> items;
+    for (auto item = allocator.allocate(); item; item = allocator.allocate())
+    {
+        std::memset(item, 1, sizeof(Data));
+        items.push_back(item);
+    }
+    EXPECT_EQ(allocator.getCommittedCount(), items.size());
+    for (auto item : items)
+    {
+        allocator.free(item);
+    }
+    for (int i = 0; i < 10; ++i)
+    {
+        allocator.reclaimIdleChunks();
+    }
+    EXPECT_LT(allocator.getCommittedCount(), items.size());
+}
@@ -155,6 +155,287 @@ TEST_F(PoolAllocatorTest, performance)
     }
 }
 
+TEST_F(PoolAllocatorTest, threadCacheReturnsAllElements)
+{
+    TestAllocator allocator(1024, "PoolAllocatorTest", true);
+    const auto elementCount = allocator.size();
+    std::vector<Data*> items;
+    for (auto item = allocator.allocate(); item; item = allocator.allocate())
+    {
+        items.push_back(reinterpret_cast<Data*>(item));
+    }
+    EXPECT_EQ(elementCount, items.size());
+
+    // freed on another thread, which keeps some in its magazine
+    std::thread freeThread([&allocator, &items] {
+        for (auto item : items)
+        {
+            allocator.free(item);
+        }
+    });
+    freeThread.join();
+
+    size_t count = 0;
+    for (auto item = allocator.allocate(); item; item = allocator.allocate())
+    {
+        ++count;
+    }
+    EXPECT_GE(count, elementCount - 32);
+    EXPECT_LT(count, elementCount);
+}
+
+TEST_F(PoolAllocatorTest, threadCacheCounters)
+{
+    TestAllocator allocator(1024, "PoolAllocatorTest", true);
+    const auto elementCount = allocator.size();
+    std::vector<std::unique_ptr<std::thread>> threads;
+    for (size_t i = 0; i < 8; ++i)
+    {
+        threads.emplace_back(std::make_unique<std::thread>(threadFunction, &allocator, i));
+    }
+    for (auto& thread : threads)
+    {
+        thread->join();
+    }
+
+    std::vector<void*> items;
+    for (int i = 0; i < 100; ++i)
+    {
+        items.push_back(allocator.allocate());
+    }
+    EXPECT_EQ(100u, allocator.countAllocatedItems());
+    for (auto item : items)
+    {
+        allocator.free(item);
+    }
+    EXPECT_EQ(elementCount, allocator.size());
+    EXPECT_EQ(0u, allocator.countAllocatedItems());
+}
+
+TEST_F(PoolAllocatorTest, commitsChunksOnDemand)
+{
+    TestAllocator allocator(4096, "PoolAllocatorTest");
+    const auto elementCount = allocator.size();
+    EXPECT_LT(allocator.getCommittedCount(), allocator.getChunkSize());
+    EXPECT_LT(allocator.getChunkSize(), elementCount);
+
+    std::vector<Data*> items;
+    for (auto item = allocator.allocate(); item; item = allocator.allocate())
+    {
+        items.push_back(reinterpret_cast<Data*>(item));
+        std::memset(item, static_cast<int>(items.size()), sizeof(Data));
+    }
+    EXPECT_EQ(elementCount, items.size());
+    EXPECT_EQ(elementCount, allocator.getCommittedCount());
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        EXPECT_EQ(static_cast<char>(i + 1), items[i]->data[sizeof(Data) - 1]);
+        allocator.free(items[i]);
+    }
+    EXPECT_EQ(elementCount, allocator.size());
+}
+
+TEST_F(PoolAllocatorTest, reclaimsIdleChunksWhenPeakHasPassed)
+{
+    TestAllocator allocator(4096, "PoolAllocatorTest");
+    const auto chunkElementCount = allocator.getChunkSize();
+    std::vector<void*> items;
+    for (auto item = allocator.allocate(); item; item = allocator.allocate())
+    {
+        items.push_back(item);
+    }
+    const auto elementCount = items.size();
+
+    // the chunks are busy
+    EXPECT_EQ(0u, allocator.reclaimIdleChunks());
+    for (auto item : items)
+    {
+        allocator.free(item);
+    }
+    items.clear();
+
+    // the peak is kept in the watermark for a number of calls
+    size_t calls = 0;
+    for (; calls < 20 && allocator.reclaimIdleChunks() == 0; ++calls)
+    {
+        EXPECT_EQ(elementCount, allocator.getCommittedCount());
+    }
+    EXPECT_GT(calls, 0u);
+    EXPECT_LT(calls, 20u);
+    EXPECT_EQ(chunkElementCount, allocator.getCommittedCount());
+    EXPECT_EQ(0u, allocator.reclaimIdleChunks());
+    EXPECT_EQ(elementCount, allocator.size());
+
+    // released chunks are committed again
+    for (auto item = allocator.allocate(); item; item = allocator.allocate())
+    {
+        std::memset(item, 1, sizeof(Data));
+        items.push_back(item);
+    }
+    EXPECT_EQ(elementCount, items.size());
+    for (auto item : items)
+    {
+        allocator.free(item);
+    }
+}
+
+TEST_F(PoolAllocatorTest, reclaimKeepsRoomForSteadyLoad)
+{
+    TestAllocator allocator(4096, "PoolAllocatorTest");
+    const auto chunkElementCount = allocator.getChunkSize();
+    std::vector<void*> items;
+    for (auto item = allocator.allocate(); item; item = allocator.allocate())
+    {
+        items.push_back(item);
+    }
+    const auto elementCount = items.size();
+
+    const size_t inUseCount = chunkElementCount * 5 / 2;
+    for (size_t i = inUseCount; i < items.size(); ++i)
+    {
+        allocator.free(items[i]);
+    }
+    items.resize(inUseCount);
+
+    size_t released = 0;
+    for (size_t i = 0; i < 20; ++i)
+    {
+        released += allocator.reclaimIdleChunks();
+        for (size_t j = 0; j < 100; ++j)
+        {
+            allocator.free(items[j]);
+            items[j] = allocator.allocate();
+            ASSERT_NE(nullptr, items[j]);
+        }
+    }
+    EXPECT_GT(released, 0u);
+    EXPECT_GE(allocator.getCommittedCount(), inUseCount + inUseCount / 4);
+    EXPECT_LT(allocator.getCommittedCount(), elementCount);
+
+    for (auto item : items)
+    {
+        allocator.free(item);
+    }
+}
+
+TEST_F(PoolAllocatorTest, reclaimDoesNotDepleteConcurrentAllocations)
+{
+    memory::PoolAllocator<64> allocator(64 * 1024, "PoolAllocatorTest");
+    const auto elementCount = allocator.size();
+    std::atomic_bool running(true);
+    std::thread reclaimThread([&allocator, &running] {
+        while (running)
+        {
+            allocator.reclaimIdleChunks();
+        }
+    });
+
+    // bursts up to the ceiling while idle chunks are being searched and released
+    std::vector<void*> items;
+    for (size_t i = 0; i < 20; ++i)
+    {
+        for (auto item = allocator.allocate(); item; item = allocator.allocate())
+        {
+            items.push_back(item);
+        }
+        EXPECT_EQ(elementCount, items.size());
+        for (auto item : items)
+        {
+            allocator.free(item);
+        }
+        items.clear();
+        utils::Time::nanoSleep(utils::Time::ms);
+    }
+    running = false;
+    reclaimThread.join();
+}
+
+TEST_F(PoolAllocatorTest, committedRegionIsNotReclaimed)
+{
+    TestAllocator allocator(4096, "PoolAllocatorTest");
+    allocator.commitRegion();
+    EXPECT_EQ(allocator.size(), allocator.getCommittedCount());
+    EXPECT_EQ(0u, allocator.reclaimIdleChunks());
+    EXPECT_EQ(allocator.size(), allocator.getCommittedCount());
+}
+
+namespace
+{
+// half of the threads allocate and hand the elements to the other half to free, like receive and send threads
+size_t runHandoverBenchmark(TestAllocator& allocator, const size_t threadPairs)
+{
+    std::atomic_bool running(true);
+    std::atomic_size_t operations(0);
+    std::vector<std::unique_ptr<concurrency::MpmcQueue<void*>>> queues;
+    std::vector<std::unique_ptr<std::thread>> threads;
+    for (size_t i = 0; i < threadPairs; ++i)
+    {
+        queues.emplace_back(std::make_unique<concurrency::MpmcQueue<void*>>(1024));
+        auto& queue = *queues.back();
+        threads.emplace_back(std::make_unique<std::thread>([&allocator, &queue, &running, &operations] {
+            size_t count = 0;
+            while (running)
+            {
+                auto item = allocator.allocate();
+                if (item && !queue.push(item))
+                {
+                    allocator.free(item);
+                }
+                ++count;
+            }
+            operations += count;
+        }));
+        threads.emplace_back(std::make_unique<std::thread>([&allocator, &queue, &running, &operations] {
+            size_t count = 0;
+            void* item = nullptr;
+            while (running)
+            {
+                if (queue.pop(item))
+                {
+                    allocator.free(item);
+                    ++count;
+                }
+            }
+            operations += count;
+        }));
+    }
+
+    utils::Time::nanoSleep(utils::Time::sec * 2);
+    running = false;
+    for (auto& thread : threads)
+    {
+        thread->join();
+    }
+    for (auto& queue : queues)
+    {
+        for (void* item = nullptr; queue->pop(item);)
+        {
+            allocator.free(item);
+        }
+    }
+    return operations;
+}
+} // namespace
+
+TEST_F(PoolAllocatorTest, DISABLED_threadCacheThroughput)
+{
+    for (size_t threadPairs : {1, 4, 8})
+    {
+        TestAllocator sharedAllocator(4096 * 40, "PoolAllocatorTest");
+        TestAllocator cachedAllocator(4096 * 40, "PoolAllocatorTest", true);
+
+        const auto sharedOperations = runHandoverBenchmark(sharedAllocator, threadPairs);
+        const auto cachedOperations = runHandoverBenchmark(cachedAllocator, threadPairs);
+        logger::info("%zu thread pairs, shared stacks %.1f Mops/s, thread cache %.1f Mops/s",
+            "PoolAllocatorTest",
+            threadPairs,
+            sharedOperations / 2.0e6,
+            cachedOperations / 2.0e6);
+        EXPECT_EQ(0u, sharedAllocator.countAllocatedItems());
+        EXPECT_EQ(0u, cachedAllocator.countAllocatedItems());
+    }
+}
+
 TEST(PoolAllocatorBasic, leakReport)
 {
     {
@@ -93,44 +93,33 @@ TEST_F(RingbufferTest, insertSilence)
     EXPECT_EQ(0, outData[1]);
 }
 
-TEST_F(RingbufferTest, addToMix)
+TEST_F(RingbufferTest, peekSplitsAtWrap)
 {
     using namespace memory;
 
     RingBuffer<int16_t, 8> ringBuffer;
 
-    std::array<int16_t, 4> writeData({0, 2, 4, 6});
-
-    auto result = ringBuffer.write(&writeData[0], 4);
-    EXPECT_TRUE(result);
-
-    std::array<int16_t, 4> mixedData({1, 1, 1, 1});
-    result = ringBuffer.addToMix(mixedData.data(), 4, 2);
-    EXPECT_TRUE(result);
-
-    EXPECT_EQ(1, mixedData[0]);
-    EXPECT_EQ(2, mixedData[1]);
-    EXPECT_EQ(3, mixedData[2]);
-    EXPECT_EQ(4, mixedData[3]);
-}
-
-TEST_F(RingbufferTest, removeFromMix)
-{
-    using namespace memory;
-
-    RingBuffer<int16_t, 8> ringBuffer;
-
-    std::array<int16_t, 4> writeData({0, 2, 4, 6});
-
-    auto result = ringBuffer.write(&writeData[0], 4);
-    EXPECT_TRUE(result);
-
-    std::array<int16_t, 4> mixedData({1, 2, 3, 4});
-    result = ringBuffer.removeFromMix(mixedData.data(), 4, 2);
-    EXPECT_TRUE(result);
-
-    EXPECT_EQ(1, mixedData[0]);
-    EXPECT_EQ(1, mixedData[1]);
-    EXPECT_EQ(1, mixedData[2]);
-    EXPECT_EQ(1, mixedData[3]);
+    std::array<int16_t, 6> writeData({1, 2, 3, 4, 5, 6});
+    EXPECT_TRUE(ringBuffer.write(&writeData[0], 6));
+
+    const int16_t* first = nullptr;
+    const int16_t* second = nullptr;
+    size_t firstSize = 0;
+    size_t secondSize = 0;
+    EXPECT_TRUE(ringBuffer.peek(first, firstSize, second, secondSize, 6));
+    EXPECT_EQ(6u, firstSize);
+    EXPECT_EQ(0u, secondSize);
+    EXPECT_EQ(1, first[0]);
+
+    ringBuffer.drop(6);
+    EXPECT_TRUE(ringBuffer.write(&writeData[0], 6));
+    EXPECT_FALSE(ringBuffer.peek(first, firstSize, second, secondSize, 7));
+    EXPECT_TRUE(ringBuffer.peek(first, firstSize, second, secondSize, 6));
+    ASSERT_EQ(2u, firstSize);
+    ASSERT_EQ(4u, secondSize);
+    EXPECT_EQ(1, first[0]);
+    EXPECT_EQ(2, first[1]);
+    EXPECT_EQ(3, second[0]);
+    EXPECT_EQ(6, second[3]);
+    EXPECT_EQ(6u, ringBuffer.getLength());
 }
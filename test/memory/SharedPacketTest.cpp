@@ -0,0 +1,62 @@
+#include "memory/SharedPacket.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+
+memory::UniquePacket makeTestPacket(memory::PacketPoolAllocator& allocator, const char* content)
+{
+    return memory::makeUniquePacket(allocator, content, std::strlen(content) + 1);
+}
+
+} // namespace
+
+TEST(SharedPacketTest, lastReferenceReturnsPacketToPool)
+{
+    memory::PacketPoolAllocator packetAllocator(16, "SharedPacketTestPackets");
+    memory::SharedPacketPoolAllocator sharedAllocator(16, "SharedPacketTestShared");
+    const auto packetPoolSize = packetAllocator.size();
+    const auto sharedPoolSize = sharedAllocator.size();
+
+    {
+        auto sharedPacket = memory::makeSharedPacket(sharedAllocator, makeTestPacket(packetAllocator, "abc"));
+        ASSERT_TRUE(sharedPacket);
+        EXPECT_TRUE(sharedPacket.isUnique());
+
+        auto copy = sharedPacket;
+        EXPECT_FALSE(sharedPacket.isUnique());
+        EXPECT_EQ(sharedPacket.get(), copy.get());
+
+        sharedPacket.reset();
+        EXPECT_TRUE(copy.isUnique());
+        EXPECT_STREQ("abc", reinterpret_cast<const char*>(copy->get()));
+    }
+
+    EXPECT_EQ(packetPoolSize, packetAllocator.size());
+    EXPECT_EQ(sharedPoolSize, sharedAllocator.size());
+}
+
+TEST(SharedPacketTest, makeUniqueCopiesUntilLastReference)
+{
+    memory::PacketPoolAllocator packetAllocator(16, "SharedPacketTestPackets");
+    memory::SharedPacketPoolAllocator sharedAllocator(16, "SharedPacketTestShared");
+
+    auto sharedPacket = memory::makeSharedPacket(sharedAllocator, makeTestPacket(packetAllocator, "abc"));
+    auto receiver1 = sharedPacket;
+    auto receiver2 = sharedPacket;
+    sharedPacket.reset();
+    const auto* original = receiver1.get();
+
+    auto packet1 = memory::makeUniquePacket(packetAllocator, std::move(receiver1));
+    ASSERT_TRUE(packet1);
+    EXPECT_NE(original, packet1.get());
+    EXPECT_FALSE(receiver1);
+
+    packet1->get()[0] = 'x';
+    EXPECT_STREQ("abc", reinterpret_cast<const char*>(receiver2->get()));
+
+    auto packet2 = memory::makeUniquePacket(packetAllocator, std::move(receiver2));
+    ASSERT_TRUE(packet2);
+    EXPECT_EQ(original, packet2.get());
+    EXPECT_STREQ("abc", reinterpret_cast<const char*>(packet2->get()));
+}
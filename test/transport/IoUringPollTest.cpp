@@ -0,0 +1,349 @@
+#include "logger/Logger.h"
+#include "memory/PacketPoolAllocator.h"
+#include "transport/RtcSocket.h"
+#include "transport/RtcePoll.h"
+#include "utils/Time.h"
+#include <atomic>
+#include <gtest/gtest.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <vector>
+
+namespace
+{
+// Counts datagrams and gives access to the cpu time of the Rtce thread that delivers them.
+class CountingListener : public transport::RtcePoll::IEventListener
+{
+public:
+    CountingListener(bool datagramReceiver, memory::PacketPoolAllocator& allocator)
+        : _datagramReceiver(datagramReceiver),
+          _allocator(allocator),
+          started(false),
+          stopped(false),
+          datagrams(0),
+          bytes(0),
+          _rtceClock(CLOCK_THREAD_CPUTIME_ID)
+    {
+    }
+
+    void onSocketPollStarted(int fd) override
+    {
+        pthread_getcpuclockid(pthread_self(), &_rtceClock);
+        started = true;
+    }
+    void onSocketPollStopped(int fd) override { stopped = true; }
+    void onSocketWriteable(int fd) override {}
+    void onSocketShutdown(int fd) override {}
+
+    // recvmmsg into pool packets like the epoll path in BaseUdpEndpoint, but inline on the Rtce thread
+    void onSocketReadable(int fd) override
+    {
+        const int batchSize = 64;
+        mmsghdr headers[batchSize];
+        iovec buffers[batchSize];
+        transport::RawSockAddress sources[batchSize];
+        memory::UniquePacket packets[batchSize];
+        for (int count = batchSize; count == batchSize;)
+        {
+            for (int i = 0; i < batchSize; ++i)
+            {
+                if (!packets[i])
+                {
+                    packets[i] = memory::makeUniquePacket(_allocator);
+                }
+                buffers[i].iov_base = packets[i]->get();
+                buffers[i].iov_len = memory::Packet::size;
+                std::memset(&headers[i], 0, sizeof(headers[i]));
+                headers[i].msg_hdr.msg_name = &sources[i];
+                headers[i].msg_hdr.msg_namelen = sizeof(sources[i]);
+                headers[i].msg_hdr.msg_iov = &buffers[i];
+                headers[i].msg_hdr.msg_iovlen = 1;
+            }
+
+            count = ::recvmmsg(fd, headers, batchSize, MSG_DONTWAIT, nullptr);
+            for (int i = 0; i < count; ++i)
+            {
+                packets[i]->setLength(headers[i].msg_len);
+                onSocketDatagram(fd, transport::SocketAddress(&sources[i].gen, nullptr), std::move(packets[i]));
+            }
+        }
+    }
+
+    bool isDatagramReceiver() const override { return _datagramReceiver; }
+
+    void onSocketDatagram(int fd, const transport::SocketAddress& source, memory::UniquePacket packet) override
+    {
+        bytes += packet->getLength();
+        ++datagrams;
+    }
+
+    bool waitForDatagrams(uint32_t count, uint64_t timeout)
+    {
+        const auto start = utils::Time::getAbsoluteTime();
+        while (datagrams < count && utils::Time::diff(start, utils::Time::getAbsoluteTime()) < timeout)
+        {
+            utils::Time::nanoSleep(utils::Time::ms);
+        }
+        return datagrams >= count;
+    }
+
+    uint64_t getRtceCpuTime() const
+    {
+        timespec cpuTime;
+        clock_gettime(_rtceClock, &cpuTime);
+        return cpuTime.tv_sec * utils::Time::sec + cpuTime.tv_nsec;
+    }
+
+private:
+    const bool _datagramReceiver;
+    memory::PacketPoolAllocator& _allocator;
+    clockid_t _rtceClock;
+
+public:
+    std::atomic_bool started;
+    std::atomic_bool stopped;
+    std::atomic_uint32_t datagrams;
+    std::atomic_uint64_t bytes;
+};
+
+bool waitFor(const std::atomic_bool& flag)
+{
+    for (int i = 0; i < 1000 && !flag; ++i)
+    {
+        utils::Time::nanoSleep(utils::Time::ms);
+    }
+    return flag;
+}
+
+void sendBurst(transport::RtcSocket& sender, const transport::SocketAddress& target, size_t count, size_t size)
+{
+    const size_t batchSize = 64;
+    std::vector<uint8_t> payload(size, 0xAB);
+    transport::SocketAddress destination(target);
+    transport::RtcSocket::Message messages[batchSize];
+    for (size_t sent = 0; sent < count;)
+    {
+        const auto batch = std::min(batchSize, count - sent);
+        for (size_t i = 0; i < batch; ++i)
+        {
+            messages[i].fragmentCount = 0;
+            messages[i].target = &destination;
+            messages[i].add(payload.data(), payload.size());
+        }
+        sender.sendMultiple(messages, batch);
+        sent += batch;
+    }
+}
+} // namespace
+
+struct IoUringPollTest : public ::testing::Test
+{
+    memory::PacketPoolAllocator allocator;
+    transport::RtcSocket sender;
+    transport::RtcSocket receiver;
+    transport::SocketAddress receiverAddress;
+
+    IoUringPollTest() : allocator(4096, "IoUringPollTest") {}
+
+    void SetUp() override
+    {
+        sender.open(transport::SocketAddress::parse("127.0.0.1"), 11021);
+        receiver.open(transport::SocketAddress::parse("127.0.0.1"), 11022);
+        receiver.setReceiveBuffer(4 * 1024 * 1024);
+        receiverAddress = transport::SocketAddress::parse("127.0.0.1", 11022);
+    }
+
+    void TearDown() override
+    {
+        sender.close();
+        receiver.close();
+    }
+};
+
+TEST_F(IoUringPollTest, deliversDatagrams)
+{
+    auto poll = transport::createIoUringPoll(allocator);
+    if (!poll)
+    {
+        logger::info("io_uring not supported", "IoUringPollTest");
+        return;
+    }
+
+    CountingListener listener(true, allocator);
+    poll->add(receiver.fd(), &listener);
+    ASSERT_TRUE(waitFor(listener.started));
+
+    sendBurst(sender, receiverAddress, 100, 200);
+    EXPECT_TRUE(listener.waitForDatagrams(100, utils::Time::sec));
+    EXPECT_EQ(100 * 200, listener.bytes);
+
+    poll->remove(receiver.fd(), &listener);
+    EXPECT_TRUE(waitFor(listener.stopped));
+    poll.reset();
+    EXPECT_EQ(0, allocator.countAllocatedItems());
+}
+
+TEST_F(IoUringPollTest, deliversFullSizeDatagrams)
+{
+    auto poll = transport::createIoUringPoll(allocator);
+    if (!poll)
+    {
+        logger::info("io_uring not supported", "IoUringPollTest");
+        return;
+    }
+
+    CountingListener listener(true, allocator);
+    poll->add(receiver.fd(), &listener);
+    ASSERT_TRUE(waitFor(listener.started));
+
+    const size_t size = memory::Packet::size - 1;
+    sendBurst(sender, receiverAddress, 10, size);
+    EXPECT_TRUE(listener.waitForDatagrams(10, utils::Time::sec));
+    EXPECT_EQ(10 * size, listener.bytes);
+
+    poll->remove(receiver.fd(), &listener);
+    EXPECT_TRUE(waitFor(listener.stopped));
+    poll.reset();
+    EXPECT_EQ(0, allocator.countAllocatedItems());
+}
+
+TEST_F(IoUringPollTest, discardsOversizedDatagrams)
+{
+    auto poll = transport::createIoUringPoll(allocator);
+    if (!poll)
+    {
+        return;
+    }
+
+    CountingListener listener(true, allocator);
+    poll->add(receiver.fd(), &listener);
+    ASSERT_TRUE(waitFor(listener.started));
+
+    sendBurst(sender, receiverAddress, 5, memory::Packet::size + 100);
+    sendBurst(sender, receiverAddress, 5, 100);
+    EXPECT_TRUE(listener.waitForDatagrams(5, utils::Time::sec));
+    utils::Time::nanoSleep(10 * utils::Time::ms);
+    EXPECT_EQ(5, listener.datagrams);
+    EXPECT_EQ(5 * 100, listener.bytes);
+
+    poll->remove(receiver.fd(), &listener);
+    EXPECT_TRUE(waitFor(listener.stopped));
+    poll.reset();
+    EXPECT_EQ(0, allocator.countAllocatedItems());
+}
+
+// Stopping with sockets still registered cancels their receive operations and returns the receive buffers
+TEST_F(IoUringPollTest, stopReleasesRegisteredSockets)
+{
+    auto poll = transport::createIoUringPoll(allocator);
+    if (!poll)
+    {
+        return;
+    }
+
+    CountingListener listener(true, allocator);
+    poll->add(receiver.fd(), &listener);
+    ASSERT_TRUE(waitFor(listener.started));
+    sendBurst(sender, receiverAddress, 10, 100);
+    EXPECT_TRUE(listener.waitForDatagrams(10, utils::Time::sec));
+
+    poll.reset();
+    EXPECT_EQ(0, allocator.countAllocatedItems());
+}
+
+TEST_F(IoUringPollTest, signalsReadableToPollListeners)
+{
+    auto poll = transport::createIoUringPoll(allocator);
+    if (!poll)
+    {
+        return;
+    }
+
+    CountingListener listener(false, allocator);
+    poll->add(receiver.fd(), &listener);
+    ASSERT_TRUE(waitFor(listener.started));
+
+    sendBurst(sender, receiverAddress, 10, 100);
+    EXPECT_TRUE(listener.waitForDatagrams(10, utils::Time::sec));
+    sendBurst(sender, receiverAddress, 10, 100);
+    EXPECT_TRUE(listener.waitForDatagrams(20, utils::Time::sec));
+
+    poll->remove(receiver.fd(), &listener);
+    EXPECT_TRUE(waitFor(listener.stopped));
+}
+
+TEST_F(IoUringPollTest, sendsDatagrams)
+{
+    auto poll = transport::createIoUringPoll(allocator);
+    if (!poll)
+    {
+        return;
+    }
+
+    const size_t count = 50;
+    transport::RtcePoll::OutboundDatagram datagrams[count];
+    for (size_t i = 0; i < count; ++i)
+    {
+        datagrams[i].target = receiverAddress;
+        datagrams[i].packet = memory::makeUniquePacket(allocator);
+        std::memset(datagrams[i].packet->get(), static_cast<int>(i), 300);
+        datagrams[i].packet->setLength(300);
+    }
+    EXPECT_EQ(count, poll->sendDatagrams(sender.fd(), datagrams, count));
+    EXPECT_FALSE(datagrams[0].packet);
+
+    uint8_t buffer[1500];
+    for (size_t i = 0; i < count; ++i)
+    {
+        timeval timeout{1, 0};
+        setsockopt(receiver.fd(), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        ASSERT_EQ(300, ::recv(receiver.fd(), buffer, sizeof(buffer), 0));
+        EXPECT_EQ(i, buffer[0]);
+    }
+
+    poll.reset();
+    EXPECT_EQ(0, allocator.countAllocatedItems());
+}
+
+// Compares packets per second per core on the Rtce thread between epoll with recvmmsg and io_uring recvmsg
+TEST_F(IoUringPollTest, DISABLED_benchmarkReceive)
+{
+    const size_t count = 200000;
+    const size_t packetSize = 200;
+    for (const bool ioUring : {false, true})
+    {
+        auto poll = ioUring ? transport::createIoUringPoll(allocator) : transport::createRtcePoll();
+        if (!poll)
+        {
+            continue;
+        }
+
+        CountingListener listener(ioUring, allocator);
+        poll->add(receiver.fd(), &listener);
+        ASSERT_TRUE(waitFor(listener.started));
+
+        const auto start = utils::Time::getAbsoluteTime();
+        const auto startCpuTime = listener.getRtceCpuTime();
+        for (size_t sent = 0; sent < count; sent += 1000)
+        {
+            sendBurst(sender, receiverAddress, 1000, packetSize);
+            // keep the socket buffer from overflowing so both backends see the same load
+            listener.waitForDatagrams(sent, 10 * utils::Time::ms);
+        }
+        listener.waitForDatagrams(count, utils::Time::sec);
+        const auto elapsed = utils::Time::diff(start, utils::Time::getAbsoluteTime());
+        const double cpuTime = listener.getRtceCpuTime() - startCpuTime;
+
+        logger::info("%s received %u/%zu, %.0f pps, %.0f pps per core",
+            "IoUringPollBenchmark",
+            ioUring ? "io_uring" : "epoll",
+            listener.datagrams.load(),
+            count,
+            listener.datagrams * static_cast<double>(utils::Time::sec) / elapsed,
+            listener.datagrams * static_cast<double>(utils::Time::sec) / std::max(1.0, cpuTime));
+
+        poll->remove(receiver.fd(), &listener);
+        EXPECT_TRUE(waitFor(listener.stopped));
+    }
+}
@@ -167,3 +167,178 @@ TEST_F(Ipv6Test, sendLastBad)
     EXPECT_EQ(packets[2].errorCode, EINVAL);
 #endif
 }
+
+TEST_F(Ipv6Test, sendSegmented)
+{
+    using namespace transport;
+
+    if (!sender.enableSegmentationOffload())
+    {
+        return; // kernel without UDP GSO
+    }
+
+    std::array<RtcSocket::Message, 10> packets;
+    std::array<char, 200> data;
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        data[i] = static_cast<char>(i);
+    }
+
+    for (int i = 0; i < 5; ++i)
+    {
+        packets[i].add(data.data(), 200);
+        packets[i].target = &goodTarget;
+    }
+    packets[5].add(data.data(), 120);
+    packets[5].target = &goodTarget;
+    packets[6].add(data.data(), 200);
+    packets[6].target = &goodTarget;
+
+    int rcSend = sender.sendMultiple(packets.data(), 7);
+    EXPECT_EQ(rcSend, 0);
+    EXPECT_TRUE(sender.isSegmentationOffloadEnabled());
+    EXPECT_EQ(sender.getSentDatagramCount(), 7u);
+    EXPECT_EQ(sender.getSendCallCount(), 1u);
+    utils::Time::usleep(50000);
+
+    mmsghdr messageHeader[8];
+    ReceivedMessage recvMessages[8];
+    for (int i = 0; i < 8; ++i)
+    {
+        recvMessages[i].link(messageHeader[i]);
+    }
+
+    const int flags = MSG_DONTWAIT;
+    for (int i = 0; i < 7; ++i)
+    {
+        ssize_t byteCount = ::recvmsg(receiver.fd(), &messageHeader[i].msg_hdr, flags);
+        EXPECT_EQ(byteCount, packets[i].getLength());
+        EXPECT_EQ(0, std::memcmp(recvMessages[i].packet, data.data(), byteCount));
+    }
+    EXPECT_EQ(::recvmsg(receiver.fd(), &messageHeader[7].msg_hdr, flags), -1);
+}
+
+TEST_F(Ipv6Test, receiveCoalesced)
+{
+    using namespace transport;
+
+    if (!sender.enableSegmentationOffload() || !receiver.enableReceiveOffload())
+    {
+        return; // kernel without UDP GSO/GRO
+    }
+
+    std::array<RtcSocket::Message, 4> packets;
+    std::array<char, 200> data;
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        data[i] = static_cast<char>(i);
+    }
+    for (auto& packet : packets)
+    {
+        packet.add(data.data(), data.size());
+        packet.target = &goodTarget;
+    }
+
+    EXPECT_EQ(sender.sendMultiple(packets.data(), packets.size()), 0);
+    utils::Time::usleep(50000);
+
+    std::array<char, 4096> buffer;
+    iovec ioBuffer = {buffer.data(), buffer.size()};
+    RawSockAddress sourceAddress;
+    union
+    {
+        cmsghdr alignment;
+        uint8_t data[CMSG_SPACE(sizeof(int))];
+    } control;
+    msghdr header = {&sourceAddress, sizeof(sourceAddress), &ioBuffer, 1, control.data, sizeof(control.data), 0};
+
+    const auto byteCount = ::recvmsg(receiver.fd(), &header, MSG_DONTWAIT);
+    EXPECT_EQ(byteCount, 800);
+    EXPECT_EQ(RtcSocket::getReceivedSegmentSize(header), 200);
+}
+
+TEST_F(Ipv6Test, reusePortSteering)
+{
+    using namespace transport;
+
+    const uint32_t shardCount = 4;
+    RtcSocket shards[shardCount];
+    for (auto& shard : shards)
+    {
+        ASSERT_EQ(0, shard.open(SocketAddress::parse("127.0.0.1"), 11030, SOCK_DGRAM, true));
+    }
+    if (!shards[0].attachReusePortSteering(shardCount))
+    {
+        return; // kernel without SO_ATTACH_REUSEPORT_CBPF
+    }
+
+    const auto target = SocketAddress::parse("127.0.0.1", 11030);
+    std::array<uint32_t, shardCount> remotesPerShard = {0};
+    for (uint16_t port = 11031; port < 11031 + 16; ++port)
+    {
+        RtcSocket remote;
+        remote.open(SocketAddress::parse("127.0.0.1"), port);
+        for (int i = 0; i < 5; ++i)
+        {
+            remote.sendTo("steer", 5, target);
+        }
+        utils::Time::nanoSleep(utils::Time::ms * 2);
+
+        // every datagram from one remote lands on the same socket
+        int owner = -1;
+        for (uint32_t i = 0; i < shardCount; ++i)
+        {
+            char buffer[16];
+            int received = 0;
+            while (::recv(shards[i].fd(), buffer, sizeof(buffer), MSG_DONTWAIT) > 0)
+            {
+                ++received;
+            }
+            if (received > 0)
+            {
+                EXPECT_EQ(5, received);
+                EXPECT_EQ(-1, owner);
+                owner = i;
+            }
+        }
+        ASSERT_NE(-1, owner);
+        ++remotesPerShard[owner];
+    }
+
+    EXPECT_GT(std::count_if(remotesPerShard.begin(), remotesPerShard.end(), [](uint32_t n) { return n > 0; }), 2);
+    EXPECT_EQ(0u, shards[0].getDropCount());
+}
+
+TEST_F(Ipv6Test, receiveTimestamps)
+{
+    using namespace transport;
+
+    if (!receiver.enableReceiveTimestamps())
+    {
+        return; // kernel without SO_TIMESTAMPING
+    }
+    utils::Time::usleep(20000); // the kernel turns on stamping in a deferred work item
+
+    timespec before = {};
+    clock_gettime(CLOCK_REALTIME, &before);
+    EXPECT_EQ(0, sender.sendTo("stamp", 5, goodTarget));
+    utils::Time::usleep(20000);
+
+    std::array<char, 64> buffer;
+    iovec ioBuffer = {buffer.data(), buffer.size()};
+    RawSockAddress sourceAddress;
+    union
+    {
+        cmsghdr alignment;
+        uint8_t data[CMSG_SPACE(3 * sizeof(timespec))];
+    } control;
+    msghdr header = {&sourceAddress, sizeof(sourceAddress), &ioBuffer, 1, control.data, sizeof(control.data), 0};
+
+    EXPECT_EQ(5, ::recvmsg(receiver.fd(), &header, MSG_DONTWAIT));
+    timespec after = {};
+    clock_gettime(CLOCK_REALTIME, &after);
+
+    const auto timestamp = RtcSocket::getReceiveTimestamp(header);
+    EXPECT_GE(timestamp, before.tv_sec * utils::Time::sec + before.tv_nsec);
+    EXPECT_LE(timestamp, after.tv_sec * utils::Time::sec + after.tv_nsec);
+}
@@ -0,0 +1,150 @@
+#include "transport/RtcSocket.h"
+#include "transport/RtcePoll.h"
+#include "utils/Time.h"
+#include <atomic>
+#include <gtest/gtest.h>
+
+namespace
+{
+class StartListener : public transport::RtcePoll::IEventListener
+{
+public:
+    StartListener() : started(0), stopped(0) {}
+
+    void onSocketPollStarted(int fd) override { ++started; }
+    void onSocketPollStopped(int fd) override { ++stopped; }
+    void onSocketReadable(int fd) override {}
+    void onSocketWriteable(int fd) override {}
+    void onSocketShutdown(int fd) override {}
+
+    bool waitFor(const std::atomic_uint32_t& counter, uint32_t count, uint64_t timeout)
+    {
+        const auto start = utils::Time::getAbsoluteTime();
+        while (counter < count && utils::Time::diff(start, utils::Time::getAbsoluteTime()) < timeout)
+        {
+            utils::Time::nanoSleep(utils::Time::ms / 10);
+        }
+        return counter >= count;
+    }
+
+    std::atomic_uint32_t started;
+    std::atomic_uint32_t stopped;
+};
+} // namespace
+
+TEST(RtcePollTest, registrationWakesPollThread)
+{
+    auto poll = transport::createRtcePoll();
+    transport::RtcSocket socket;
+    socket.open(transport::SocketAddress::parse("127.0.0.1"), 0);
+    StartListener listener;
+
+    // let the poll thread enter its wait, registration must wake it rather than wait for the poll timeout
+    utils::Time::nanoSleep(20 * utils::Time::ms);
+    poll->add(socket.fd(), &listener);
+    EXPECT_TRUE(listener.waitFor(listener.started, 1, 5 * utils::Time::sec));
+
+    poll->remove(socket.fd(), &listener);
+    EXPECT_TRUE(listener.waitFor(listener.stopped, 1, 5 * utils::Time::sec));
+
+    poll.reset();
+}
+
+TEST(RtcePollTest, groupSpreadsSockets)
+{
+    const size_t threadCount = 3;
+    std::vector<std::unique_ptr<transport::RtcePoll>> polls;
+    for (size_t i = 0; i < threadCount; ++i)
+    {
+        polls.push_back(transport::createRtcePoll());
+    }
+    auto poll = transport::createRtcePollGroup(std::move(polls));
+
+    transport::RtcSocket sockets[2 * threadCount];
+    StartListener listener;
+    for (auto& socket : sockets)
+    {
+        socket.open(transport::SocketAddress::parse("127.0.0.1"), 0);
+        EXPECT_TRUE(poll->add(socket.fd(), &listener));
+    }
+    // socket counts are updated before the started callbacks
+    EXPECT_TRUE(listener.waitFor(listener.started, 2 * threadCount, 5 * utils::Time::sec));
+
+    const auto metrics = poll->getThreadMetrics(utils::Time::getAbsoluteTime());
+    ASSERT_EQ(threadCount, metrics.size());
+    for (const auto& threadMetrics : metrics)
+    {
+        EXPECT_EQ(2, threadMetrics.sockets);
+    }
+
+    for (auto& socket : sockets)
+    {
+        EXPECT_TRUE(poll->remove(socket.fd(), &listener));
+    }
+    EXPECT_TRUE(listener.waitFor(listener.stopped, 2 * threadCount, 5 * utils::Time::sec));
+    EXPECT_FALSE(poll->remove(sockets[0].fd(), &listener));
+}
+
+TEST(RtcePollTest, groupSendsThroughAssignedPoll)
+{
+    memory::PacketPoolAllocator allocator(4096, "RtcePollTest");
+    std::vector<std::unique_ptr<transport::RtcePoll>> polls;
+    for (size_t i = 0; i < 2; ++i)
+    {
+        auto ioUringPoll = transport::createIoUringPoll(allocator);
+        if (!ioUringPoll)
+        {
+            return;
+        }
+        polls.push_back(std::move(ioUringPoll));
+    }
+    auto poll = transport::createRtcePollGroup(std::move(polls));
+    EXPECT_TRUE(poll->canSendDatagrams());
+
+    transport::RtcSocket receiver;
+    receiver.open(transport::SocketAddress::parse("127.0.0.1"), 11031);
+    transport::RtcSocket sockets[2];
+    StartListener listener;
+    for (auto& socket : sockets)
+    {
+        socket.open(transport::SocketAddress::parse("127.0.0.1"), 0);
+        EXPECT_TRUE(poll->add(socket.fd(), &listener));
+    }
+    EXPECT_TRUE(listener.waitFor(listener.started, 2, 5 * utils::Time::sec));
+
+    for (auto& socket : sockets)
+    {
+        transport::RtcePoll::OutboundDatagram datagram;
+        datagram.target = transport::SocketAddress::parse("127.0.0.1", 11031);
+        datagram.packet = memory::makeUniquePacket(allocator);
+        datagram.packet->setLength(100);
+        EXPECT_EQ(1, poll->sendDatagrams(socket.fd(), &datagram, 1));
+    }
+
+    uint8_t buffer[200];
+    timeval timeout{1, 0};
+    setsockopt(receiver.fd(), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    EXPECT_EQ(100, ::recv(receiver.fd(), buffer, sizeof(buffer), 0));
+    EXPECT_EQ(100, ::recv(receiver.fd(), buffer, sizeof(buffer), 0));
+
+    for (auto& socket : sockets)
+    {
+        EXPECT_TRUE(poll->remove(socket.fd(), &listener));
+    }
+    EXPECT_TRUE(listener.waitFor(listener.stopped, 2, 5 * utils::Time::sec));
+    poll.reset();
+    EXPECT_EQ(0, allocator.countAllocatedItems());
+}
+
+TEST(RtcePollTest, epollGroupDoesNotSendDatagrams)
+{
+    std::vector<std::unique_ptr<transport::RtcePoll>> polls;
+    polls.push_back(transport::createRtcePoll());
+    polls.push_back(transport::createRtcePoll());
+    auto poll = transport::createRtcePollGroup(std::move(polls));
+    EXPECT_FALSE(poll->canSendDatagrams());
+
+    transport::RtcePoll::OutboundDatagram datagram;
+    datagram.packet = nullptr;
+    EXPECT_EQ(0, poll->sendDatagrams(3, &datagram, 1));
+}
@@ -62,7 +62,21 @@ struct SrtpTest : public ::testing::Test, public transport::SrtpClient::IEvents
         _dtls = std::make_unique<transport::SslDtls>();
         assert(_dtls->isInitialized());
         _factory = std::make_unique<transport::SrtpClientFactory>(*_dtls);
+        createClients();
 
+        auto header = rtp::RtpHeader::create(_audioPacket);
+        _audioPacket.setLength(rtp::MIN_RTP_HEADER_SIZE + 160);
+        auto payload = header->getPayload();
+        for (size_t i = 0; i < _audioPacket.getLength() - header->headerLength(); ++i)
+        {
+            payload[i] = i;
+        }
+    }
+
+    void createClients()
+    {
+        _ep1.reset();
+        _ep2.reset();
         _srtp1 = _factory->create(this);
         _srtp2 = _factory->create(this);
         _ep1 = std::make_unique<FakeSrtpEndpoint>(*_srtp1, *_srtp2, _allocator);
@@ -70,13 +84,6 @@ struct SrtpTest : public ::testing::Test, public transport::SrtpClient::IEvents
 
         _srtp1->setRemoteDtlsFingerprint("sha-256", _dtls->getLocalFingerprint(), true);
         _srtp2->setRemoteDtlsFingerprint("sha-256", _dtls->getLocalFingerprint(), false);
-
-        auto header = rtp::RtpHeader::create(_audioPacket);
-        auto payload = header->getPayload();
-        for (size_t i = 0; i < _audioPacket.getLength() - header->headerLength(); ++i)
-        {
-            payload[i] = i;
-        }
     }
 
     void connect()
@@ -179,3 +186,100 @@ TEST_F(SrtpTest, seqDuplicate)
     EXPECT_TRUE(_srtp2->unprotect(*packet));
     EXPECT_FALSE(_srtp2->unprotect(*packetCopy));
 }
+
+TEST_F(SrtpTest, batchProtect)
+{
+    connect();
+
+    const size_t count = 16;
+    memory::UniquePacket packets[count];
+    memory::Packet* batch[count];
+    for (size_t i = 0; i < count; ++i)
+    {
+        packets[i] = memory::makeUniquePacket(_allocator, _audioPacket);
+        auto header = rtp::RtpHeader::fromPacket(*packets[i]);
+        header->ssrc = 1234;
+        header->timestamp = i * 160;
+        header->sequenceNumber = 100 + i;
+        batch[i] = packets[i].get();
+    }
+
+    EXPECT_EQ(count, _srtp1->protect(batch, count));
+    // replaying one of them makes it fail in the unprotect batch
+    auto replayed = memory::makeUniquePacket(_allocator, *packets[3]);
+    EXPECT_EQ(count, _srtp2->unprotect(batch, count));
+    for (size_t i = 0; i < count; ++i)
+    {
+        ASSERT_EQ(packets[i].get(), batch[i]);
+        EXPECT_TRUE(isDataValid(rtp::RtpHeader::fromPacket(*packets[i])->getPayload()));
+    }
+    memory::Packet* replayBatch[] = {replayed.get()};
+    EXPECT_EQ(0u, _srtp2->unprotect(replayBatch, 1));
+    EXPECT_EQ(nullptr, replayBatch[0]);
+
+    // a packet that fails is removed from the batch
+    auto tooLong = memory::makeUniquePacket(_allocator, _audioPacket);
+    tooLong->setLength(tooLong->getCapacity());
+    memory::Packet* failingBatch[] = {tooLong.get()};
+    EXPECT_EQ(0u, _srtp1->protect(failingBatch, 1));
+    EXPECT_EQ(nullptr, failingBatch[0]);
+}
+
+TEST_F(SrtpTest, prefersGcmProfile)
+{
+    connect();
+    ASSERT_TRUE(_srtp1->isDtlsConnected());
+    // without GCM support in libsrtp the AES-CM profiles are the only ones offered
+    const auto expectedProfile = _dtls->isSrtpGcmSupported() ? transport::SrtpClient::Profile::AEAD_AES_128_GCM
+                                                             : transport::SrtpClient::Profile::AES128_CM_SHA1_80;
+    EXPECT_EQ(expectedProfile, _srtp1->getProfile());
+    EXPECT_EQ(expectedProfile, _srtp2->getProfile());
+
+    auto packet = memory::makeUniquePacket(_allocator, _audioPacket);
+    const auto length = packet->getLength();
+    EXPECT_TRUE(_srtp1->protect(*packet));
+    EXPECT_EQ(length + (_dtls->isSrtpGcmSupported() ? 16 : 10), packet->getLength());
+    EXPECT_TRUE(_srtp2->unprotect(*packet));
+    EXPECT_TRUE(isDataValid(rtp::RtpHeader::fromPacket(*packet)->getPayload()));
+}
+
+TEST_F(SrtpTest, DISABLED_protectThroughput)
+{
+    const size_t count = 200000;
+    const size_t batchSize = 32;
+    for (const auto* profileName :
+        {"SRTP_AES128_CM_SHA1_80", "SRTP_AES128_CM_SHA1_32", "SRTP_AEAD_AES_128_GCM", "SRTP_AEAD_AES_256_GCM"})
+    {
+        SSL_CTX_set_tlsext_use_srtp(_dtls->getSslContext(), profileName);
+        createClients();
+        connect();
+        ASSERT_TRUE(_srtp1->isDtlsConnected());
+
+        memory::Packet packets[batchSize];
+        memory::Packet* batch[batchSize];
+        uint16_t sequenceNumber = 0;
+        const auto start = utils::Time::getAbsoluteTime();
+        for (size_t sent = 0; sent < count; sent += batchSize)
+        {
+            for (size_t i = 0; i < batchSize; ++i)
+            {
+                packets[i] = _audioPacket;
+                packets[i].setLength(1200);
+                auto header = rtp::RtpHeader::fromPacket(packets[i]);
+                header->ssrc = 1;
+                header->sequenceNumber = sequenceNumber++;
+                batch[i] = &packets[i];
+            }
+            EXPECT_EQ(batchSize, _srtp1->protect(batch, batchSize));
+        }
+        const auto elapsed = utils::Time::diff(start, utils::Time::getAbsoluteTime());
+
+        logger::info("%s %s protected %zu packets, %.0f pps, %.0f Mbps",
+            "SrtpBenchmark",
+            profileName,
+            transport::toString(_srtp1->getProfile()),
+            count,
+            count * static_cast<double>(utils::Time::sec) / elapsed,
+            count * 1200 * 8.0 * 1000 / elapsed);
+    }
+}
@@ -0,0 +1,301 @@
+#include "transport/TcpEndpoint.h"
+#include "jobmanager/WorkerThread.h"
+#include "logger/Logger.h"
+#include "memory/PacketPoolAllocator.h"
+#include "rtp/RtpHeader.h"
+#include "transport/RtcePoll.h"
+#include "utils/Time.h"
+#include <arpa/inet.h>
+#include <gtest/gtest.h>
+#include <map>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace transport;
+
+namespace
+{
+template <typename T>
+bool waitFor(const T& predicate)
+{
+    for (int i = 0; i < 2000 && !predicate(); ++i)
+    {
+        utils::Time::nanoSleep(utils::Time::ms);
+    }
+    return predicate();
+}
+
+struct ReceivedPacket
+{
+    uint32_t ssrc;
+    uint32_t timestamp;
+    uint16_t sequenceNumber;
+    size_t length;
+};
+} // namespace
+
+// Connects a TcpEndpoint to a plain listening socket and parses the RFC 4571 framed stream on the other end
+struct TcpEndpointTest : public ::testing::Test
+{
+    jobmanager::JobManager jobManager;
+    std::vector<std::unique_ptr<jobmanager::WorkerThread>> workerThreads;
+    memory::PacketPoolAllocator allocator;
+    std::unique_ptr<RtcePoll> rtcePoll;
+    int listenSocket;
+    int peerSocket;
+    SocketAddress serverAddress;
+    std::vector<uint8_t> stream;
+
+    TcpEndpointTest()
+        : allocator(4096, "TcpEndpointTest"),
+          rtcePoll(createRtcePoll()),
+          listenSocket(-1),
+          peerSocket(-1)
+    {
+    }
+
+    void SetUp() override
+    {
+        utils::Time::initialize();
+        for (int i = 0; i < 2; ++i)
+        {
+            workerThreads.push_back(std::make_unique<jobmanager::WorkerThread>(jobManager));
+        }
+
+        listenSocket = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ASSERT_EQ(0, ::bind(listenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)));
+        socklen_t addressLength = sizeof(address);
+        ::getsockname(listenSocket, reinterpret_cast<sockaddr*>(&address), &addressLength);
+        serverAddress = SocketAddress(reinterpret_cast<sockaddr*>(&address));
+        ASSERT_EQ(0, ::listen(listenSocket, 4));
+    }
+
+    void TearDown() override
+    {
+        if (peerSocket != -1)
+        {
+            ::close(peerSocket);
+        }
+        ::close(listenSocket);
+        jobManager.stop();
+        rtcePoll->stop();
+        for (auto& workerThread : workerThreads)
+        {
+            workerThread->stop();
+        }
+    }
+
+    void acceptPeer()
+    {
+        peerSocket = ::accept(listenSocket, nullptr, nullptr);
+        timeval timeout{0, 100000};
+        setsockopt(peerSocket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    }
+
+    memory::UniquePacket makeRtpPacket(uint32_t ssrc, uint32_t timestamp, uint16_t sequenceNumber, size_t length)
+    {
+        auto packet = memory::makeUniquePacket(allocator);
+        packet->setLength(length);
+        std::memset(packet->get(), static_cast<int>(sequenceNumber & 0xFF), length);
+        auto header = rtp::RtpHeader::create(*packet);
+        header->ssrc = ssrc;
+        header->timestamp = timestamp;
+        header->sequenceNumber = sequenceNumber;
+        header->payloadType = 100;
+        return packet;
+    }
+
+    // reads from the peer socket until the endpoint has nothing pending and the socket is drained
+    std::vector<ReceivedPacket> readStream(TcpEndpoint& endpoint)
+    {
+        uint8_t buffer[64 * 1024];
+        for (int idleReads = 0; idleReads < 5;)
+        {
+            const auto received = ::recv(peerSocket, buffer, sizeof(buffer), 0);
+            if (received > 0)
+            {
+                stream.insert(stream.end(), buffer, buffer + received);
+                idleReads = 0;
+            }
+            else if (endpoint.getPendingBytes() == 0)
+            {
+                ++idleReads;
+            }
+        }
+
+        std::vector<ReceivedPacket> packets;
+        size_t offset = 0;
+        while (offset + 2 <= stream.size())
+        {
+            const size_t length = (stream[offset] << 8) | stream[offset + 1];
+            if (offset + 2 + length > stream.size())
+            {
+                break;
+            }
+            // the stream is not aligned for RtpHeader
+            memory::Packet packet;
+            packet.append(&stream[offset + 2], length);
+            const auto header = rtp::RtpHeader::fromPacket(packet);
+            EXPECT_TRUE(header);
+            if (header)
+            {
+                packets.push_back({header->ssrc, header->timestamp, header->sequenceNumber, length});
+                EXPECT_EQ(header->sequenceNumber.get() & 0xFF, packet.get()[length - 1]);
+            }
+            offset += 2 + length;
+        }
+        EXPECT_EQ(stream.size(), offset);
+        return packets;
+    }
+
+    void closeEndpoint(TcpEndpoint& endpoint)
+    {
+        endpoint.closePort();
+        EXPECT_TRUE(waitFor([&]() { return endpoint.getState() == Endpoint::State::CLOSED; }));
+    }
+};
+
+TEST_F(TcpEndpointTest, coalescesFramedPackets)
+{
+    TcpEndpoint endpoint(jobManager, allocator, SocketAddress::parse("127.0.0.1"), *rtcePoll);
+    endpoint.connect(serverAddress);
+    acceptPeer();
+    ASSERT_NE(-1, peerSocket);
+    ASSERT_TRUE(waitFor([&]() { return endpoint.getState() == Endpoint::State::CONNECTED; }));
+
+    const uint16_t count = 300;
+    for (uint16_t i = 0; i < count; ++i)
+    {
+        endpoint.sendTo(serverAddress, makeRtpPacket(1, i / 3, i, 100 + (i * 7) % 1100));
+    }
+
+    const auto packets = readStream(endpoint);
+    ASSERT_EQ(count, packets.size());
+    for (uint16_t i = 0; i < count; ++i)
+    {
+        EXPECT_EQ(i, packets[i].sequenceNumber);
+        EXPECT_EQ(100 + (i * 7) % 1100, packets[i].length);
+    }
+    EXPECT_EQ(0u, endpoint.getDroppedPacketCount());
+
+    closeEndpoint(endpoint);
+}
+
+TEST_F(TcpEndpointTest, dropsWholeVideoFramesWhenSaturated)
+{
+    int receiveBuffer = 4096;
+    setsockopt(listenSocket, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+
+    TcpEndpoint endpoint(jobManager, allocator, SocketAddress::parse("127.0.0.1"), *rtcePoll);
+    endpoint.configureBufferSizes(4096, 4096);
+    endpoint.connect(serverAddress);
+    acceptPeer();
+    ASSERT_NE(-1, peerSocket);
+    ASSERT_TRUE(waitFor([&]() { return endpoint.getState() == Endpoint::State::CONNECTED; }));
+
+    const uint32_t frameCount = 100;
+    const uint32_t packetsPerFrame = 5;
+    const uint32_t videoSsrc = 1000;
+    const uint32_t audioSsrc = 2000;
+    uint16_t videoSequenceNumber = 0;
+    for (uint32_t frame = 0; frame < frameCount; ++frame)
+    {
+        for (uint32_t i = 0; i < packetsPerFrame; ++i)
+        {
+            endpoint.sendTo(serverAddress, makeRtpPacket(videoSsrc, frame * 3000, videoSequenceNumber++, 1000));
+        }
+        endpoint.sendTo(serverAddress, makeRtpPacket(audioSsrc, frame * 960, frame, 100));
+    }
+    ASSERT_TRUE(waitFor([&]() { return endpoint.getPendingBytes() < 64 * 1024; }));
+
+    const auto packets = readStream(endpoint);
+    std::map<uint32_t, uint32_t> videoFrames;
+    uint32_t audioPackets = 0;
+    for (const auto& packet : packets)
+    {
+        if (packet.ssrc == videoSsrc)
+        {
+            ++videoFrames[packet.timestamp];
+        }
+        else if (packet.ssrc == audioSsrc)
+        {
+            ++audioPackets;
+        }
+    }
+
+    EXPECT_EQ(frameCount, audioPackets);
+    EXPECT_LT(videoFrames.size(), frameCount);
+    for (const auto& frame : videoFrames)
+    {
+        EXPECT_EQ(packetsPerFrame, frame.second);
+    }
+    EXPECT_EQ((frameCount - videoFrames.size()) * packetsPerFrame, endpoint.getDroppedPacketCount());
+
+    closeEndpoint(endpoint);
+}
+
+TEST_F(TcpEndpointTest, keepsDroppedFrameStateWhileManySsrcsAreSent)
+{
+    int receiveBuffer = 4096;
+    setsockopt(listenSocket, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+
+    TcpEndpoint endpoint(jobManager, allocator, SocketAddress::parse("127.0.0.1"), *rtcePoll);
+    endpoint.configureBufferSizes(4096, 4096);
+    endpoint.connect(serverAddress);
+    acceptPeer();
+    ASSERT_NE(-1, peerSocket);
+    ASSERT_TRUE(waitFor([&]() { return endpoint.getState() == Endpoint::State::CONNECTED; }));
+
+    // more single packet ssrcs in the middle of every fourth frame than there are frame states
+    const uint32_t frameCount = 100;
+    const uint32_t packetsPerFrame = 5;
+    const uint32_t videoSsrc = 1000;
+    const uint32_t audioSsrcCount = 20;
+    uint16_t videoSequenceNumber = 0;
+    for (uint32_t frame = 0; frame < frameCount; ++frame)
+    {
+        for (uint32_t i = 0; i < packetsPerFrame; ++i)
+        {
+            endpoint.sendTo(serverAddress, makeRtpPacket(videoSsrc, frame * 3000, videoSequenceNumber++, 1000));
+            if (frame % 4 == 0 && i == packetsPerFrame / 2)
+            {
+                for (uint32_t audioSsrc = 2000; audioSsrc < 2000 + audioSsrcCount; ++audioSsrc)
+                {
+                    endpoint.sendTo(serverAddress, makeRtpPacket(audioSsrc, frame * 960, frame, 16));
+                }
+            }
+        }
+    }
+    ASSERT_TRUE(waitFor([&]() { return endpoint.getPendingBytes() < 64 * 1024; }));
+
+    const auto packets = readStream(endpoint);
+    std::map<uint32_t, uint32_t> videoFrames;
+    uint32_t audioPackets = 0;
+    for (const auto& packet : packets)
+    {
+        if (packet.ssrc == videoSsrc)
+        {
+            ++videoFrames[packet.timestamp];
+        }
+        else
+        {
+            ++audioPackets;
+        }
+    }
+
+    EXPECT_EQ(frameCount / 4 * audioSsrcCount, audioPackets);
+    EXPECT_LT(videoFrames.size(), frameCount);
+    for (const auto& frame : videoFrames)
+    {
+        EXPECT_EQ(packetsPerFrame, frame.second);
+    }
+    EXPECT_EQ((frameCount - videoFrames.size()) * packetsPerFrame, endpoint.getDroppedPacketCount());
+
+    closeEndpoint(endpoint);
+}
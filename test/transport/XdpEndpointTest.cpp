@@ -0,0 +1,318 @@
+#include "transport/XdpEndpoint.h"
+#include "jobmanager/WorkerThread.h"
+#include "logger/Logger.h"
+#include "memory/PacketPoolAllocator.h"
+#include "transport/RtcePoll.h"
+#include "utils/Time.h"
+#include <arpa/inet.h>
+#include <atomic>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <mutex>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace transport;
+
+namespace
+{
+const char* localInterface = "xdptest0";
+const char* remoteInterface = "xdptest1";
+
+struct RecordingListener : public Endpoint::IEvents
+{
+    RecordingListener() : rtpCount(0), portClosed(false) {}
+
+    void onRtpReceived(Endpoint& endpoint,
+        const SocketAddress& source,
+        const SocketAddress& target,
+        memory::UniquePacket packet) override
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        lastSource = source;
+        lastPayload.assign(packet->get(), packet->get() + packet->getLength());
+        ++rtpCount;
+    }
+
+    void onDtlsReceived(Endpoint&, const SocketAddress&, const SocketAddress&, memory::UniquePacket) override {}
+    void onRtcpReceived(Endpoint&, const SocketAddress&, const SocketAddress&, memory::UniquePacket) override {}
+    void onIceReceived(Endpoint&, const SocketAddress&, const SocketAddress&, memory::UniquePacket) override {}
+    void onPortClosed(Endpoint& endpoint) override { portClosed = true; }
+    void onUnregistered(Endpoint& endpoint) override {}
+
+    std::mutex mutex;
+    SocketAddress lastSource;
+    std::vector<uint8_t> lastPayload;
+    std::atomic_uint32_t rtpCount;
+    std::atomic_bool portClosed;
+};
+
+template <typename T>
+bool waitFor(const T& predicate)
+{
+    for (int i = 0; i < 1000 && !predicate(); ++i)
+    {
+        utils::Time::nanoSleep(utils::Time::ms);
+    }
+    return predicate();
+}
+
+uint16_t checksum(const std::vector<uint8_t>& data, uint32_t sum)
+{
+    for (size_t i = 0; i + 1 < data.size(); i += 2)
+    {
+        sum += (data[i] << 8) | data[i + 1];
+    }
+    if (data.size() & 1)
+    {
+        sum += data.back() << 8;
+    }
+    while (sum >> 16)
+    {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return ~sum & 0xFFFF;
+}
+
+std::vector<uint8_t> makeRtpPayload(uint16_t sequenceNumber, size_t length)
+{
+    std::vector<uint8_t> payload(length, 0xCD);
+    payload[0] = 0x80;
+    payload[1] = 100;
+    payload[2] = sequenceNumber >> 8;
+    payload[3] = sequenceNumber & 0xFF;
+    return payload;
+}
+} // namespace
+
+// Talks to an XdpEndpoint on one end of a veth pair with raw ethernet frames on the other end. Needs root.
+struct XdpEndpointTest : public ::testing::Test
+{
+    jobmanager::JobManager jobManager;
+    std::vector<std::unique_ptr<jobmanager::WorkerThread>> workerThreads;
+    memory::PacketPoolAllocator allocator;
+    std::unique_ptr<RtcePoll> rtcePoll;
+    int rawSocket;
+    uint8_t localMac[6];
+    uint8_t remoteMac[6];
+
+    XdpEndpointTest() : allocator(4096, "XdpEndpointTest"), rtcePoll(createRtcePoll()), rawSocket(-1) {}
+
+    void SetUp() override
+    {
+        utils::Time::initialize();
+        for (int i = 0; i < 2; ++i)
+        {
+            workerThreads.push_back(std::make_unique<jobmanager::WorkerThread>(jobManager));
+        }
+
+        const std::string command = std::string("ip link add ") + localInterface + " type veth peer name " +
+            remoteInterface + " > /dev/null 2>&1 && ip link set " + localInterface + " up && ip link set " +
+            remoteInterface + " up";
+        if (0 != std::system(command.c_str()))
+        {
+            return;
+        }
+
+        rawSocket = ::socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+        sockaddr_ll address;
+        std::memset(&address, 0, sizeof(address));
+        address.sll_family = AF_PACKET;
+        address.sll_protocol = htons(ETH_P_ALL);
+        address.sll_ifindex = if_nametoindex(remoteInterface);
+        ::bind(rawSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        timeval timeout{0, 100000};
+        setsockopt(rawSocket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+        readMac(localInterface, localMac);
+        readMac(remoteInterface, remoteMac);
+    }
+
+    void TearDown() override
+    {
+        if (rawSocket != -1)
+        {
+            ::close(rawSocket);
+            std::system((std::string("ip link del ") + localInterface + " > /dev/null 2>&1").c_str());
+        }
+        jobManager.stop();
+        rtcePoll->stop();
+        for (auto& workerThread : workerThreads)
+        {
+            workerThread->stop();
+        }
+    }
+
+    void readMac(const char* interfaceName, uint8_t* mac)
+    {
+        ifreq request;
+        std::memset(&request, 0, sizeof(request));
+        std::strncpy(request.ifr_name, interfaceName, IFNAMSIZ - 1);
+        ioctl(rawSocket, SIOCGIFHWADDR, &request);
+        std::memcpy(mac, request.ifr_hwaddr.sa_data, 6);
+    }
+
+    std::vector<uint8_t> makeFrame(const SocketAddress& source,
+        const SocketAddress& destination,
+        const std::vector<uint8_t>& payload)
+    {
+        const bool isIpv4 = (source.getFamily() == AF_INET);
+        const size_t ipLength = (isIpv4 ? 20 : 40);
+        const size_t udpLength = 8 + payload.size();
+        std::vector<uint8_t> frame(14 + ipLength + udpLength, 0);
+        std::memcpy(&frame[0], localMac, 6);
+        std::memcpy(&frame[6], remoteMac, 6);
+        uint8_t* ip = &frame[14];
+        if (isIpv4)
+        {
+            frame[12] = 0x08;
+            ip[0] = 0x45;
+            ip[2] = (20 + udpLength) >> 8;
+            ip[3] = (20 + udpLength) & 0xFF;
+            ip[8] = 64;
+            ip[9] = IPPROTO_UDP;
+            std::memcpy(ip + 12, &source.getIpv4()->sin_addr, 4);
+            std::memcpy(ip + 16, &destination.getIpv4()->sin_addr, 4);
+            const auto sum = checksum(std::vector<uint8_t>(ip, ip + 20), 0);
+            ip[10] = sum >> 8;
+            ip[11] = sum & 0xFF;
+        }
+        else
+        {
+            frame[12] = 0x86;
+            frame[13] = 0xDD;
+            ip[0] = 0x60;
+            ip[4] = udpLength >> 8;
+            ip[5] = udpLength & 0xFF;
+            ip[6] = IPPROTO_UDP;
+            ip[7] = 64;
+            std::memcpy(ip + 8, &source.getIpv6()->sin6_addr, 16);
+            std::memcpy(ip + 24, &destination.getIpv6()->sin6_addr, 16);
+        }
+        uint8_t* udp = ip + ipLength;
+        udp[0] = source.getPort() >> 8;
+        udp[1] = source.getPort() & 0xFF;
+        udp[2] = destination.getPort() >> 8;
+        udp[3] = destination.getPort() & 0xFF;
+        udp[4] = udpLength >> 8;
+        udp[5] = udpLength & 0xFF;
+        std::memcpy(udp + 8, payload.data(), payload.size());
+        return frame;
+    }
+
+    // next UDP frame to port on the remote end of the veth pair
+    std::vector<uint8_t> receiveFrame(uint16_t port)
+    {
+        uint8_t buffer[2048];
+        for (int i = 0; i < 20; ++i)
+        {
+            const auto length = ::recv(rawSocket, buffer, sizeof(buffer), 0);
+            if (length < 42)
+            {
+                continue;
+            }
+            const size_t udpOffset = (buffer[12] == 0x08 ? 34 : 54);
+            const uint16_t destinationPort = (buffer[udpOffset + 2] << 8) | buffer[udpOffset + 3];
+            if (length >= static_cast<ssize_t>(udpOffset + 8) && destinationPort == port)
+            {
+                return std::vector<uint8_t>(buffer, buffer + length);
+            }
+        }
+        return std::vector<uint8_t>();
+    }
+
+    void testEcho(const SocketAddress& localIp, const SocketAddress& remotePort)
+    {
+        if (rawSocket == -1)
+        {
+            logger::info("no veth pair, skipping", "XdpEndpointTest");
+            return;
+        }
+
+        const auto localPort = SocketAddress(localIp, 11050);
+        RecordingListener listener;
+        {
+            const auto anyAddress = SocketAddress::parse(localIp.getFamily() == AF_INET ? "0.0.0.0" : "::", 11050);
+            XdpEndpoint endpoint(jobManager, 16, allocator, anyAddress, *rtcePoll);
+            if (!endpoint.openXdpSocket(localInterface, 0, true))
+            {
+                logger::info("AF_XDP not supported, skipping", "XdpEndpointTest");
+                return;
+            }
+            endpoint.registerDefaultListener(&listener);
+            endpoint.registerListener(remotePort, &listener);
+            endpoint.start();
+            ASSERT_TRUE(waitFor([&]() { return endpoint.getState() == Endpoint::State::CONNECTED; }));
+
+            const auto payload = makeRtpPayload(1, 300);
+            const auto frame = makeFrame(remotePort, localPort, payload);
+            ASSERT_EQ(static_cast<ssize_t>(frame.size()), ::send(rawSocket, frame.data(), frame.size(), 0));
+            ASSERT_TRUE(waitFor([&]() { return listener.rtpCount == 1; }));
+            {
+                std::lock_guard<std::mutex> lock(listener.mutex);
+                EXPECT_EQ(remotePort, listener.lastSource);
+                EXPECT_EQ(payload, listener.lastPayload);
+            }
+
+            const auto reply = makeRtpPayload(2, 500);
+            endpoint.sendTo(remotePort, memory::makeUniquePacket(allocator, reply.data(), reply.size()));
+            const auto replyFrame = receiveFrame(remotePort.getPort());
+            ASSERT_FALSE(replyFrame.empty());
+
+            // the reply retraces the path of the received frame
+            const auto expectedFrame = makeFrame(localPort, remotePort, reply);
+            ASSERT_EQ(expectedFrame.size(), replyFrame.size());
+            EXPECT_EQ(0, std::memcmp(replyFrame.data(), remoteMac, 6));
+            EXPECT_EQ(0, std::memcmp(replyFrame.data() + 6, localMac, 6));
+            const size_t udpOffset = replyFrame.size() - reply.size() - 8;
+            EXPECT_EQ(0, std::memcmp(replyFrame.data() + udpOffset, expectedFrame.data() + udpOffset, 6));
+            EXPECT_EQ(0, std::memcmp(replyFrame.data() + udpOffset + 8, reply.data(), reply.size()));
+            if (localIp.getFamily() == AF_INET)
+            {
+                EXPECT_EQ(0, checksum(std::vector<uint8_t>(&replyFrame[14], &replyFrame[34]), 0));
+                EXPECT_EQ(0, std::memcmp(&replyFrame[26], &expectedFrame[26], 8));
+            }
+            else
+            {
+                EXPECT_EQ(0, std::memcmp(&replyFrame[22], &expectedFrame[22], 32));
+                const std::vector<uint8_t> pseudoHeader(&replyFrame[22], &replyFrame[54]);
+                const std::vector<uint8_t> udp(&replyFrame[54], replyFrame.data() + replyFrame.size());
+                const uint32_t pseudoSum = (0xFFFF & ~checksum(pseudoHeader, 0)) + udp.size() + IPPROTO_UDP;
+                EXPECT_EQ(0, checksum(udp, pseudoSum));
+            }
+
+            endpoint.closePort();
+            EXPECT_TRUE(waitFor([&]() { return listener.portClosed.load(); }));
+        }
+        EXPECT_EQ(0, allocator.countAllocatedItems());
+    }
+};
+
+TEST_F(XdpEndpointTest, echoIpv4)
+{
+    testEcho(SocketAddress::parse("10.77.0.1"), SocketAddress::parse("10.77.0.2", 5004));
+}
+
+TEST_F(XdpEndpointTest, echoIpv6)
+{
+    testEcho(SocketAddress::parse("fd00:77::1"), SocketAddress::parse("fd00:77::2", 5004));
+}
+
+TEST_F(XdpEndpointTest, fallsBackToUdpEndpoint)
+{
+    std::unique_ptr<UdpEndpoint> endpoint(createXdpEndpoint(jobManager,
+        16,
+        allocator,
+        SocketAddress::parse("127.0.0.1", 11051),
+        *rtcePoll,
+        0,
+        true));
+    ASSERT_TRUE(endpoint);
+    EXPECT_TRUE(endpoint->isGood());
+    EXPECT_EQ(nullptr, dynamic_cast<XdpEndpoint*>(endpoint.get()));
+}
@@ -0,0 +1,57 @@
+#include "utils/LatencyHistogram.h"
+#include "utils/Time.h"
+#include <gtest/gtest.h>
+
+TEST(LatencyHistogram, bucketBoundsCoverValues)
+{
+    for (uint64_t value = 0; value < 5000000; value += 1 + value / 64)
+    {
+        const auto bucket = utils::LatencyHistogram::bucketOf(value);
+        ASSERT_LT(bucket, utils::LatencyHistogram::bucketCount);
+        EXPECT_GE(utils::LatencyHistogram::bucketUpperBound(bucket), value);
+        EXPECT_LE(utils::LatencyHistogram::bucketUpperBound(bucket), value + value / 8);
+        if (bucket > 0)
+        {
+            EXPECT_LT(utils::LatencyHistogram::bucketUpperBound(bucket - 1), value);
+        }
+    }
+}
+
+TEST(LatencyHistogram, percentiles)
+{
+    utils::LatencyHistogram histogram;
+    EXPECT_EQ(0u, histogram.snapshot().getPercentile(0.5));
+
+    for (int i = 0; i < 990; ++i)
+    {
+        histogram.record(100 * utils::Time::us);
+    }
+    for (int i = 0; i < 9; ++i)
+    {
+        histogram.record(2 * utils::Time::ms);
+    }
+    histogram.record(40 * utils::Time::ms);
+
+    const auto snapshot = histogram.snapshot();
+    EXPECT_EQ(1000u, snapshot.getCount());
+    EXPECT_NEAR(100, snapshot.getPercentile(0.5), 100 / 8);
+    EXPECT_NEAR(100, snapshot.getPercentile(0.99), 100 / 8);
+    EXPECT_NEAR(2000, snapshot.getPercentile(0.995), 2000 / 8);
+    EXPECT_NEAR(40000, snapshot.getPercentile(0.9999), 40000 / 8);
+}
+
+TEST(LatencyHistogram, collectResets)
+{
+    utils::LatencyHistogram histogram;
+    histogram.record(utils::Time::ms);
+    histogram.record(utils::Time::ms);
+
+    auto sum = histogram.collect();
+    EXPECT_EQ(2u, sum.getCount());
+    EXPECT_EQ(0u, histogram.snapshot().getCount());
+
+    histogram.record(utils::Time::sec);
+    sum += histogram.collect();
+    EXPECT_EQ(3u, sum.getCount());
+    EXPECT_NEAR(utils::Time::sec / utils::Time::us, sum.getPercentile(0.999), utils::Time::sec / utils::Time::us / 8);
+}
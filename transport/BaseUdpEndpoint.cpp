@@ -34,6 +34,18 @@ private:
     int _fd;
 };
 
+class ReceiveDatagramsJob : public jobmanager::Job
+{
+public:
+    ReceiveDatagramsJob(BaseUdpEndpoint& endpoint, int fd) : _endpoint(endpoint), _fd(fd) {}
+
+    void run() override { _endpoint.internalReceiveDatagrams(_fd); }
+
+private:
+    BaseUdpEndpoint& _endpoint;
+    int _fd;
+};
+
 class ClosePortJob : public jobmanager::Job
 {
 public:
@@ -65,7 +77,11 @@ BaseUdpEndpoint::BaseUdpEndpoint(const char* name,
       _isShared(isShared),
       _defaultListener(nullptr),
       _receiveTracker(utils::Time::ms * 100),
-      _sendTracker(utils::Time::ms * 100)
+      _sendTracker(utils::Time::ms * 100),
+      _pollingSockets(0),
+      _receiveCalls(0),
+      _receivedDatagrams(0),
+      _receiveTimestamps(false)
 {
     _pendingRead.clear();
     _pendingSend.clear();
@@ -81,6 +97,10 @@ void BaseUdpEndpoint::internalClosePort(int countDown)
 {
     if (countDown > 0)
     {
+        if (_pollingSockets.fetch_sub(1) > 1)
+        {
+            return; // other receive shards are still polled
+        }
         if (!_sendJobs.addJob<ClosePortJob>(*this, 0))
         {
             logger::error("failed to add close port job", _name.c_str());
@@ -90,6 +110,10 @@ void BaseUdpEndpoint::internalClosePort(int countDown)
     {
         logger::info("closing %s", _name.c_str(), _socket.getBoundPort().toString().c_str());
         _socket.close();
+        for (auto& shard : _shards)
+        {
+            shard->socket.close();
+        }
         _state = State::CLOSED;
         const auto defaultListener = _defaultListener.load();
         if (defaultListener)
@@ -122,6 +146,33 @@ void BaseUdpEndpoint::sendTo(const transport::SocketAddress& target, memory::Uni
     }
 }
 
+void BaseUdpEndpoint::sendMultipleTo(const transport::SocketAddress& target,
+    memory::UniquePacket* packets,
+    const size_t count)
+{
+    if (target.getFamily() != _localPort.getFamily())
+    {
+        logger::debug("incompatible target address", _name.c_str());
+        return;
+    }
+
+    bool queued = false;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (!packets[i])
+        {
+            continue;
+        }
+        assert(!memory::PacketPoolAllocator::isCorrupt(packets[i].get()));
+        queued |= _sendQueue.push({target, std::move(packets[i])});
+    }
+
+    if (queued && !_pendingSend.test_and_set())
+    {
+        _sendJobs.addJob<SendJob>(*this);
+    }
+}
+
 void BaseUdpEndpoint::internalSend()
 {
     _pendingSend.clear(); // intend to send all
@@ -136,11 +187,7 @@ void BaseUdpEndpoint::internalSend()
         size_t byteCount = 0;
         for (; count < batchSize && _sendQueue.pop(packetInfo[count]); ++count)
         {
-            messages[count].fragmentCount = 0;
-            auto& packet = packetInfo[count].packet;
-            messages[count].target = &packetInfo[count].target;
-            messages[count].add(packet->get(), packet->getLength());
-            byteCount += packet->getLength();
+            byteCount += packetInfo[count].packet->getLength();
         }
         packetCounter += count;
         if (count == 0)
@@ -150,8 +197,35 @@ void BaseUdpEndpoint::internalSend()
         }
 
         const auto sendTimestamp = utils::Time::getAbsoluteTime();
-        auto errorCount = _socket.sendMultiple(messages, count);
-        for (size_t i = 0; errorCount > 0 && i < count; ++i)
+        for (size_t i = 0; i < count; ++i)
+        {
+            const auto receiveTime = packetInfo[i].packet->getReceiveTime();
+            if (receiveTime != 0)
+            {
+                _forwardLatency.record(std::max(int64_t(0), utils::Time::diff(receiveTime, sendTimestamp)));
+            }
+        }
+        const auto submitted = sendDirect(packetInfo, count);
+        if (submitted == count)
+        {
+            _sendTracker.update(byteCount, sendTimestamp);
+            continue;
+        }
+
+        for (size_t i = submitted; i < count; ++i)
+        {
+            messages[i].fragmentCount = 0;
+            messages[i].target = &packetInfo[i].target;
+            messages[i].add(packetInfo[i].packet->get(), packetInfo[i].packet->getLength());
+        }
+
+        const bool segmented = _socket.isSegmentationOffloadEnabled();
+        auto errorCount = _socket.sendMultiple(messages + submitted, count - submitted);
+        if (segmented && !_socket.isSegmentationOffloadEnabled())
+        {
+            logger::warn("UDP GSO rejected by kernel or NIC, sending separate datagrams", _name.c_str());
+        }
+        for (size_t i = submitted; errorCount > 0 && i < count; ++i)
         {
             const auto rc = messages[i].errorCode;
             if (rc == EMSGSIZE)
@@ -192,6 +266,11 @@ void BaseUdpEndpoint::internalSend()
     }
 }
 
+size_t BaseUdpEndpoint::sendDirect(OutboundPacket* packets, const size_t count)
+{
+    return _epoll.sendDatagrams(_socket.fd(), packets, count);
+}
+
 bool BaseUdpEndpoint::openPort(uint16_t port)
 {
     _socket.close();
@@ -219,6 +298,13 @@ void BaseUdpEndpoint::closePort()
         {
             logger::error("Failed to request epoll unregistration", _name.c_str());
         }
+        for (auto& shard : _shards)
+        {
+            if (!_epoll.remove(shard->socket.fd(), this))
+            {
+                logger::error("Failed to request epoll unregistration", _name.c_str());
+            }
+        }
     }
 }
 
@@ -232,7 +318,7 @@ void BaseUdpEndpoint::onSocketPollStarted(int fd)
 
 void BaseUdpEndpoint::onSocketPollStopped(int fd)
 {
-    if (!_receiveJobs.addJob<ClosePortJob>(*this, 1))
+    if (!getReceiveJobs(fd).addJob<ClosePortJob>(*this, 1))
     {
         logger::error("failed to add poll stop job", _name.c_str());
     }
@@ -240,20 +326,242 @@ void BaseUdpEndpoint::onSocketPollStopped(int fd)
 
 void BaseUdpEndpoint::onSocketReadable(int fd)
 {
-    if (!_pendingRead.test_and_set())
+    if (!getPendingRead(fd).test_and_set())
+    {
+        if (!getReceiveJobs(fd).addJob<ReceiveJob>(*this, fd))
+        {
+            logger::warn("receive queue full", _name.c_str());
+        }
+    }
+}
+
+jobmanager::JobQueue& BaseUdpEndpoint::getReceiveJobs(const int fd)
+{
+    for (auto& shard : _shards)
+    {
+        if (shard->socket.fd() == fd)
+        {
+            return shard->receiveJobs;
+        }
+    }
+    return _receiveJobs;
+}
+
+std::atomic_flag& BaseUdpEndpoint::getPendingRead(const int fd)
+{
+    for (auto& shard : _shards)
     {
-        if (!_receiveJobs.addJob<ReceiveJob>(*this, fd))
+        if (shard->socket.fd() == fd)
         {
+            return shard->pendingRead;
+        }
+    }
+    return _pendingRead;
+}
+
+std::unique_ptr<BaseUdpEndpoint::InboundQueue>& BaseUdpEndpoint::getInboundQueue(const int fd)
+{
+    for (auto& shard : _shards)
+    {
+        if (shard->socket.fd() == fd)
+        {
+            return shard->inboundQueue;
+        }
+    }
+    return _inboundQueue;
+}
+
+uint8_t* BaseUdpEndpoint::getCoalescedBuffers(const int fd)
+{
+    for (auto& shard : _shards)
+    {
+        if (shard->socket.fd() == fd)
+        {
+            return shard->coalescedBuffers.get();
+        }
+    }
+    return _coalescedBuffers.get();
+}
+
+// Called on the Rtce thread when the network backend receives on behalf of the socket. The packet is handed to the
+// receive job queue, like the readable event of the epoll backend, so unregistering a listener on that queue still
+// guarantees it is not called anymore.
+void BaseUdpEndpoint::onSocketDatagram(int fd, const SocketAddress& source, memory::UniquePacket packet)
+{
+    const auto receiveTime = utils::Time::getAbsoluteTime();
+    _receivedDatagrams.fetch_add(1, std::memory_order_relaxed);
+    _receiveTracker.update(packet->getLength(), receiveTime);
+    if (packet->getReceiveTime() == 0)
+    {
+        packet->setReceiveTime(receiveTime);
+    }
+
+    auto& inboundQueue = getInboundQueue(fd);
+    if (!inboundQueue)
+    {
+        inboundQueue = std::make_unique<InboundQueue>(inboundQueueSize);
+    }
+    if (!inboundQueue->push({source, std::move(packet)}))
+    {
+        logger::warn("receive queue full", _name.c_str());
+    }
+
+    if (!getPendingRead(fd).test_and_set())
+    {
+        if (!getReceiveJobs(fd).addJob<ReceiveDatagramsJob>(*this, fd))
+        {
+            getPendingRead(fd).clear();
             logger::warn("receive queue full", _name.c_str());
         }
     }
 }
 
+void BaseUdpEndpoint::internalReceiveDatagrams(const int fd)
+{
+    getPendingRead(fd).clear(); // one extra job may be added after us
+    auto& inboundQueue = *getInboundQueue(fd);
+    InboundPacket datagrams[inboundBatchSize];
+    for (uint32_t dispatched = 0; dispatched < inboundQueueSize;)
+    {
+        size_t count = 0;
+        for (; count < inboundBatchSize && inboundQueue.pop(datagrams[count]); ++count) {}
+        if (count == 0)
+        {
+            break;
+        }
+        dispatchReceivedPackets(datagrams, count);
+        dispatched += count;
+    }
+
+    if (!inboundQueue.empty() && !getPendingRead(fd).test_and_set())
+    {
+        if (!getReceiveJobs(fd).addJob<ReceiveDatagramsJob>(*this, fd))
+        {
+            getPendingRead(fd).clear();
+        }
+    }
+}
+
+void BaseUdpEndpoint::dispatchReceivedPackets(InboundPacket* datagrams, const size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        dispatchReceivedPacket(datagrams[i].source, std::move(datagrams[i].packet));
+    }
+}
+
+bool BaseUdpEndpoint::enableSegmentationOffload()
+{
+    if (!_socket.enableSegmentationOffload())
+    {
+        logger::info("UDP GSO not supported", _name.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool BaseUdpEndpoint::enableReceiveOffload()
+{
+#ifdef __APPLE__
+    return false;
+#else
+    if (!_socket.enableReceiveOffload())
+    {
+        logger::info("UDP GRO not supported", _name.c_str());
+        return false;
+    }
+    for (auto& shard : _shards)
+    {
+        shard->socket.enableReceiveOffload();
+        shard->coalescedBuffers.reset(new uint8_t[coalescedBatchSize * coalescedBufferSize]);
+    }
+    _coalescedBuffers.reset(new uint8_t[coalescedBatchSize * coalescedBufferSize]);
+    return true;
+#endif
+}
+
+bool BaseUdpEndpoint::enableReceiveTimestamps()
+{
+    if (!_socket.enableReceiveTimestamps())
+    {
+        logger::info("SO_TIMESTAMPING not supported", _name.c_str());
+        return false;
+    }
+    for (auto& shard : _shards)
+    {
+        shard->socket.enableReceiveTimestamps();
+    }
+    _receiveTimestamps = true;
+    return true;
+}
+
+// All sockets in a SO_REUSEPORT group must set the option before bind, so the first socket is opened again.
+bool BaseUdpEndpoint::openReceiveShards(const uint32_t count)
+{
+    if (count <= 1)
+    {
+        return true;
+    }
+#ifdef __APPLE__
+    return false;
+#else
+    if (_state != Endpoint::State::CREATED || !_shards.empty())
+    {
+        return false;
+    }
+
+    if (0 != _socket.open(_localPort, _localPort.getPort(), SOCK_DGRAM, true))
+    {
+        logger::error("failed to reopen %s for SO_REUSEPORT", _name.c_str(), _localPort.toString().c_str());
+        _state = Endpoint::State::CLOSED;
+        return false;
+    }
+    if (_coalescedBuffers)
+    {
+        _socket.enableReceiveOffload();
+    }
+
+    for (uint32_t i = 1; i < count; ++i)
+    {
+        auto shard = std::make_unique<ReceiveShard>(_receiveJobs.getJobManager());
+        if (0 != shard->socket.open(_localPort, _localPort.getPort(), SOCK_DGRAM, true))
+        {
+            logger::error("failed to open receive shard %u on %s", _name.c_str(), i, _localPort.toString().c_str());
+            _shards.clear();
+            return false;
+        }
+        if (_coalescedBuffers)
+        {
+            shard->socket.enableReceiveOffload();
+            shard->coalescedBuffers.reset(new uint8_t[coalescedBatchSize * coalescedBufferSize]);
+        }
+        _shards.push_back(std::move(shard));
+    }
+
+    if (!_socket.attachReusePortSteering(count))
+    {
+        logger::warn("SO_REUSEPORT steering program rejected, kernel hash decides the socket", _name.c_str());
+    }
+    return true;
+#endif
+}
+
 EndpointMetrics BaseUdpEndpoint::getMetrics(uint64_t timestamp) const
 {
-    return EndpointMetrics(_sendQueue.size(),
+    EndpointMetrics metrics(_sendQueue.size(),
         _receiveTracker.get(timestamp, utils::Time::sec) * 8 * utils::Time::ms,
         _sendTracker.get(timestamp, utils::Time::sec) * 8 * utils::Time::ms);
+    metrics.sendCalls = _socket.getSendCallCount();
+    metrics.sentDatagrams = _socket.getSentDatagramCount();
+    metrics.receiveCalls = _receiveCalls.load(std::memory_order_relaxed);
+    metrics.receivedDatagrams = _receivedDatagrams.load(std::memory_order_relaxed);
+    metrics.forwardLatency = _forwardLatency.snapshot();
+    metrics.socketDrops.push_back(_socket.getDropCount());
+    for (auto& shard : _shards)
+    {
+        metrics.socketDrops.push_back(shard->socket.getDropCount());
+    }
+    return metrics;
 }
 
 namespace
@@ -266,10 +574,36 @@ struct mmsghdr
 };
 #endif
 
+// room for the UDP_GRO segment size and a SCM_TIMESTAMPING message
+struct ControlBuffer
+{
+    alignas(cmsghdr) uint8_t data[CMSG_SPACE(sizeof(int)) + CMSG_SPACE(3 * sizeof(timespec))];
+};
+
+uint64_t getRealTime()
+{
+    timespec timeSpec = {};
+    clock_gettime(CLOCK_REALTIME, &timeSpec);
+    return static_cast<uint64_t>(timeSpec.tv_sec) * utils::Time::sec + static_cast<uint64_t>(timeSpec.tv_nsec);
+}
+
+// Kernel stamps are taken on the realtime clock. They are moved to utils::Time by their age at receiveTime, which is
+// read together with realTime. Datagrams without a stamp get receiveTime.
+uint64_t getLocalReceiveTime(const msghdr& header, const uint64_t receiveTime, const uint64_t realTime)
+{
+    const auto kernelTime = RtcSocket::getReceiveTimestamp(header);
+    if (kernelTime == 0 || kernelTime > realTime || realTime - kernelTime > receiveTime)
+    {
+        return receiveTime;
+    }
+    return receiveTime - (realTime - kernelTime);
+}
+
 struct ReceivedMessage
 {
     transport::RawSockAddress src_addr;
     iovec iobuffer;
+    ControlBuffer control;
     memory::UniquePacket packet;
 
     bool link(mmsghdr& header, memory::UniquePacket packetPtr)
@@ -282,8 +616,8 @@ struct ReceivedMessage
         iobuffer.iov_base = packet->get();
         iobuffer.iov_len = memory::Packet::size;
 
-        header.msg_hdr.msg_control = nullptr;
-        header.msg_hdr.msg_controllen = 0;
+        header.msg_hdr.msg_control = control.data;
+        header.msg_hdr.msg_controllen = sizeof(control.data);
         header.msg_hdr.msg_flags = MSG_DONTWAIT;
         header.msg_hdr.msg_iov = &iobuffer;
         header.msg_hdr.msg_iovlen = 1;
@@ -299,12 +633,18 @@ struct ReceivedMessage
 
 void BaseUdpEndpoint::internalReceive(const int fd, const uint32_t batchSize)
 {
+    if (_coalescedBuffers)
+    {
+        internalReceiveCoalesced(fd);
+        return;
+    }
+
     ReceivedMessage receiveMessage[batchSize];
     mmsghdr messageHeader[batchSize];
 
     const int flags = MSG_DONTWAIT;
 
-    _pendingRead.clear(); // one extra job may be added after us
+    getPendingRead(fd).clear(); // one extra job may be added after us
     uint32_t packetCount = 0;
     uint32_t limit = 1;
     while (true)
@@ -326,7 +666,9 @@ void BaseUdpEndpoint::internalReceive(const int fd, const uint32_t batchSize)
         if (packetCount == 1)
         {
             ssize_t byteCount = ::recvmsg(fd, &messageHeader[0].msg_hdr, flags);
-            _receiveTracker.update(byteCount, utils::Time::getAbsoluteTime());
+            const auto receiveTime = utils::Time::getAbsoluteTime();
+            _receiveCalls.fetch_add(1, std::memory_order_relaxed);
+            _receiveTracker.update(byteCount, receiveTime);
             if (byteCount <= 0)
             {
                 break;
@@ -336,7 +678,11 @@ void BaseUdpEndpoint::internalReceive(const int fd, const uint32_t batchSize)
                 byteCount = 0; // Attack with Jumbo frame. Discard
             }
 
+            _receivedDatagrams.fetch_add(1, std::memory_order_relaxed);
             receiveMessage[0].packet->setLength(byteCount);
+            receiveMessage[0].packet->setReceiveTime(_receiveTimestamps
+                    ? getLocalReceiveTime(messageHeader[0].msg_hdr, receiveTime, getRealTime())
+                    : receiveTime);
             dispatchReceivedPacket(SocketAddress(&receiveMessage[0].src_addr.gen, nullptr),
                 std::move(receiveMessage[0].packet));
             packetCount = 0;
@@ -351,11 +697,14 @@ void BaseUdpEndpoint::internalReceive(const int fd, const uint32_t batchSize)
 #else
             const auto count = ::recvmmsg(fd, messageHeader, packetCount, flags, nullptr);
 #endif
+            _receiveCalls.fetch_add(1, std::memory_order_relaxed);
             if (count <= 0)
             {
                 break;
             }
+            _receivedDatagrams.fetch_add(count, std::memory_order_relaxed);
             const auto receiveTime = utils::Time::getAbsoluteTime();
+            const auto realTime = _receiveTimestamps ? getRealTime() : 0;
             for (int i = 0; i < count; ++i)
             {
                 _receiveTracker.update(messageHeader[i].msg_len, receiveTime);
@@ -367,6 +716,9 @@ void BaseUdpEndpoint::internalReceive(const int fd, const uint32_t batchSize)
                 {
                     receiveMessage[i].packet->setLength(0); // Attack with Jumbo frame. Discard.
                 }
+                receiveMessage[i].packet->setReceiveTime(_receiveTimestamps
+                        ? getLocalReceiveTime(messageHeader[i].msg_hdr, receiveTime, realTime)
+                        : receiveTime);
                 dispatchReceivedPacket(SocketAddress(&receiveMessage[i].src_addr.gen, nullptr),
                     std::move(receiveMessage[i].packet));
             }
@@ -388,6 +740,86 @@ void BaseUdpEndpoint::internalReceive(const int fd, const uint32_t batchSize)
     }
 }
 
+// Receives datagrams the kernel has coalesced with UDP_GRO and splits them into pool packets by the segment size.
+void BaseUdpEndpoint::internalReceiveCoalesced(const int fd)
+{
+#ifndef __APPLE__
+    mmsghdr messageHeader[coalescedBatchSize];
+    iovec ioBuffer[coalescedBatchSize];
+    transport::RawSockAddress sourceAddress[coalescedBatchSize];
+    ControlBuffer control[coalescedBatchSize];
+
+    auto coalescedBuffers = getCoalescedBuffers(fd);
+    getPendingRead(fd).clear(); // one extra job may be added after us
+    while (true)
+    {
+        for (size_t i = 0; i < coalescedBatchSize; ++i)
+        {
+            ioBuffer[i].iov_base = &coalescedBuffers[i * coalescedBufferSize];
+            ioBuffer[i].iov_len = coalescedBufferSize;
+
+            auto& header = messageHeader[i].msg_hdr;
+            header.msg_name = &sourceAddress[i];
+            header.msg_namelen = sizeof(sourceAddress[i]);
+            header.msg_iov = &ioBuffer[i];
+            header.msg_iovlen = 1;
+            header.msg_control = control[i].data;
+            header.msg_controllen = sizeof(control[i].data);
+            header.msg_flags = 0;
+            messageHeader[i].msg_len = 0;
+        }
+
+        const auto count = ::recvmmsg(fd, messageHeader, coalescedBatchSize, MSG_DONTWAIT, nullptr);
+        _receiveCalls.fetch_add(1, std::memory_order_relaxed);
+        if (count <= 0)
+        {
+            break;
+        }
+
+        const auto receiveTime = utils::Time::getAbsoluteTime();
+        const auto realTime = _receiveTimestamps ? getRealTime() : 0;
+        for (int i = 0; i < count; ++i)
+        {
+            const size_t length = messageHeader[i].msg_len;
+            _receiveTracker.update(length, receiveTime);
+            const auto segmentReceiveTime = _receiveTimestamps
+                ? getLocalReceiveTime(messageHeader[i].msg_hdr, receiveTime, realTime)
+                : receiveTime;
+            const int segmentSize = RtcSocket::getReceivedSegmentSize(messageHeader[i].msg_hdr);
+            const size_t stride = (segmentSize > 0 ? segmentSize : length);
+            const SocketAddress source(&sourceAddress[i].gen, nullptr);
+            const uint8_t* data = reinterpret_cast<const uint8_t*>(ioBuffer[i].iov_base);
+
+            for (size_t offset = 0; offset < length; offset += stride)
+            {
+                _receivedDatagrams.fetch_add(1, std::memory_order_relaxed);
+                const auto segmentLength = std::min(stride, length - offset);
+                if (segmentLength >= memory::Packet::size)
+                {
+                    continue; // Attack with Jumbo frame. Discard
+                }
+
+                auto packet = memory::makeUniquePacket(_allocator);
+                if (!packet)
+                {
+                    logger::warn("cannot receive, packet allocator depleted", _socket.getBoundPort().toString().c_str());
+                    break;
+                }
+                std::memcpy(packet->get(), data + offset, segmentLength);
+                packet->setLength(segmentLength);
+                packet->setReceiveTime(segmentReceiveTime);
+                dispatchReceivedPacket(source, std::move(packet));
+            }
+        }
+
+        if (count < static_cast<int>(coalescedBatchSize))
+        {
+            break;
+        }
+    }
+#endif
+}
+
 // used when routing is not possible and there is a single owner of the endpoint
 void BaseUdpEndpoint::registerDefaultListener(IEvents* defaultListener)
 {
@@ -400,13 +832,23 @@ void BaseUdpEndpoint::start()
     if (_state == Endpoint::State::CREATED)
     {
         _state = Endpoint::State::CONNECTING;
+        _pollingSockets = 1 + _shards.size();
         _epoll.add(_socket.fd(), this);
+        for (auto& shard : _shards)
+        {
+            _epoll.add(shard->socket.fd(), this);
+        }
     }
 }
 
 bool BaseUdpEndpoint::configureBufferSizes(size_t sendBufferSize, size_t receiveBufferSize)
 {
-    return (0 == _socket.setSendBuffer(sendBufferSize)) && (0 == _socket.setReceiveBuffer(receiveBufferSize));
+    bool success = (0 == _socket.setSendBuffer(sendBufferSize)) && (0 == _socket.setReceiveBuffer(receiveBufferSize));
+    for (auto& shard : _shards)
+    {
+        success &= (0 == shard->socket.setReceiveBuffer(receiveBufferSize));
+    }
+    return success;
 }
 
 } // namespace transport
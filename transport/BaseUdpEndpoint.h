@@ -6,11 +6,12 @@
 #include "transport/Endpoint.h"
 #include "transport/RtcSocket.h"
 #include "transport/RtcePoll.h"
+#include "utils/LatencyHistogram.h"
 #include "utils/Trackers.h"
 
 namespace transport
 {
-class BaseUdpEndpoint : public Endpoint, RtcePoll::IEventListener
+class BaseUdpEndpoint : public Endpoint, protected RtcePoll::IEventListener
 {
 public:
     BaseUdpEndpoint(const char* name,
@@ -22,6 +23,7 @@ public:
         bool isShared);
 
     void sendTo(const transport::SocketAddress& target, memory::UniquePacket packet) override;
+    void sendMultipleTo(const transport::SocketAddress& target, memory::UniquePacket* packets, size_t count) override;
 
     void registerDefaultListener(IEvents* defaultListener) override;
 
@@ -32,6 +34,18 @@ public:
     SocketAddress getLocalPort() const override { return _socket.getBoundPort(); }
 
     bool configureBufferSizes(size_t sendBufferSize, size_t receiveBufferSize) override;
+    bool enableSegmentationOffload();
+    virtual bool enableReceiveOffload();
+    /**
+     * Stamps received packets with the time the kernel took the datagram off the driver rather than the time it was
+     * read from the socket, so forward latency includes the time spent in the receive queue.
+     */
+    bool enableReceiveTimestamps();
+    /**
+     * Receives on count SO_REUSEPORT sockets bound to the port, each with its own receive job queue. Every remote is
+     * steered to one socket by its source address and port. Sending stays on the first socket. Call before start.
+     */
+    bool openReceiveShards(uint32_t count);
 
     bool isShared() const override { return _isShared; }
 
@@ -48,6 +62,9 @@ public:
 public: // internal job interface
     // called on receiveJobs threads
     virtual void internalReceive(int fd, uint32_t batchSize);
+    void internalReceiveCoalesced(int fd);
+    // dispatches the datagrams the network backend has received on fd
+    void internalReceiveDatagrams(int fd);
     virtual void dispatchReceivedPacket(const SocketAddress& srcAddress, memory::UniquePacket packet) = 0;
     // called on sendJobs threads
     virtual void internalSend();
@@ -65,12 +82,27 @@ protected:
     void onSocketReadable(int fd) override;
     void onSocketShutdown(int fd) override {}
     void onSocketWriteable(int fd) override {}
+    bool isDatagramReceiver() const override { return !_coalescedBuffers; }
+    void onSocketDatagram(int fd, const SocketAddress& source, memory::UniquePacket packet) override;
 
-    struct OutboundPacket
+    using OutboundPacket = RtcePoll::OutboundDatagram;
+    struct InboundPacket
     {
-        transport::SocketAddress target;
+        SocketAddress source;
         memory::UniquePacket packet;
     };
+    using InboundQueue = concurrency::MpmcQueue<InboundPacket>;
+    static const uint32_t inboundQueueSize = 1024;
+    // datagrams taken from the inbound queue at a time
+    static const size_t inboundBatchSize = 64;
+    // dispatches datagrams in order, by default one by one
+    virtual void dispatchReceivedPackets(InboundPacket* datagrams, size_t count);
+    /**
+     * Sends datagrams without the socket, by default through the network backend. Packets that were accepted are
+     * moved out and the accepted datagrams are gathered at the start of the array.
+     * @return number of datagrams accepted. internalSend sends the rest on the socket.
+     */
+    virtual size_t sendDirect(OutboundPacket* packets, size_t count);
 
     jobmanager::JobQueue _receiveJobs;
     jobmanager::JobQueue _sendJobs;
@@ -86,5 +118,40 @@ protected:
     std::atomic<IEvents*> _defaultListener;
     utils::RateTracker<10> _receiveTracker;
     utils::RateTracker<10> _sendTracker;
+
+    // receive socket beyond the first in a SO_REUSEPORT group
+    struct ReceiveShard
+    {
+        explicit ReceiveShard(jobmanager::JobManager& jobManager) : receiveJobs(jobManager, 16) { pendingRead.clear(); }
+
+        RtcSocket socket;
+        jobmanager::JobQueue receiveJobs;
+        std::atomic_flag pendingRead = ATOMIC_FLAG_INIT;
+        std::unique_ptr<InboundQueue> inboundQueue;
+        std::unique_ptr<uint8_t[]> coalescedBuffers;
+    };
+    std::vector<std::unique_ptr<ReceiveShard>> _shards;
+    std::atomic_uint32_t _pollingSockets;
+
+    jobmanager::JobQueue& getReceiveJobs(int fd);
+    std::atomic_flag& getPendingRead(int fd);
+    std::unique_ptr<InboundQueue>& getInboundQueue(int fd);
+    uint8_t* getCoalescedBuffers(int fd);
+
+    // Datagrams received by the network backend wait here for the receive job queue of their socket, so listeners
+    // are only called from receive jobs. Created by the Rtce thread on the first datagram.
+    std::unique_ptr<InboundQueue> _inboundQueue;
+
+    // UDP GRO receive buffers of the first socket, only allocated when receive offload is enabled. Receive shards
+    // are read concurrently and have their own.
+    static const size_t coalescedBatchSize = 8;
+    static const size_t coalescedBufferSize = 64 * 1024;
+    std::unique_ptr<uint8_t[]> _coalescedBuffers;
+    std::atomic_uint64_t _receiveCalls;
+    std::atomic_uint64_t _receivedDatagrams;
+
+    std::atomic_bool _receiveTimestamps;
+    // time from receive to handing a forwarded packet to the kernel or network backend
+    utils::LatencyHistogram _forwardLatency;
 };
 } // namespace transport
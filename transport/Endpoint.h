@@ -39,6 +39,19 @@ public:
             const SocketAddress& target,
             memory::UniquePacket packet) = 0;
 
+        // consecutive RTCP packets from one source, in the order they arrived
+        virtual void onRtcpBatchReceived(Endpoint& endpoint,
+            const SocketAddress& source,
+            const SocketAddress& target,
+            memory::UniquePacket* packets,
+            size_t count)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                onRtcpReceived(endpoint, source, target, std::move(packets[i]));
+            }
+        }
+
         virtual void onIceReceived(Endpoint& endpoint,
             const SocketAddress& source,
             const SocketAddress& target,
@@ -51,6 +64,17 @@ public:
     virtual ~Endpoint(){};
 
     virtual void sendTo(const transport::SocketAddress& target, memory::UniquePacket packet) = 0;
+    // Sends count packets to the same target. Null packets in the array are skipped.
+    virtual void sendMultipleTo(const transport::SocketAddress& target, memory::UniquePacket* packets, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (packets[i])
+            {
+                sendTo(target, std::move(packets[i]));
+            }
+        }
+    }
 
     virtual void registerListener(const std::string& stunUserName, IEvents* listener) = 0;
     virtual void registerListener(const SocketAddress& remotePort, IEvents* listener) = 0;
@@ -1,4 +1,6 @@
+#include "utils/LatencyHistogram.h"
 #include <cstdint>
+#include <vector>
 
 #pragma once
 
@@ -8,6 +10,10 @@ struct EndpointMetrics
         : sendQueue(sQueue)
         , receiveKbps(rKbps)
         , sendKbps(sKbs)
+        , sendCalls(0)
+        , sentDatagrams(0)
+        , receiveCalls(0)
+        , receivedDatagrams(0)
     { }
 
     EndpointMetrics() : EndpointMetrics(0, 0.0, 0.0) { }
@@ -17,12 +23,27 @@ struct EndpointMetrics
         sendQueue += rhs.sendQueue;
         receiveKbps += rhs.receiveKbps;
         sendKbps += rhs.sendKbps;
+        sendCalls += rhs.sendCalls;
+        sentDatagrams += rhs.sentDatagrams;
+        receiveCalls += rhs.receiveCalls;
+        receivedDatagrams += rhs.receivedDatagrams;
+        socketDrops.insert(socketDrops.end(), rhs.socketDrops.cbegin(), rhs.socketDrops.cend());
+        forwardLatency += rhs.forwardLatency;
         return *this;
     }
 
     uint32_t sendQueue;
     double receiveKbps;
     double sendKbps;
+    // cumulative, datagrams per call shows how much sendmmsg, recvmmsg, GSO and GRO batch
+    uint64_t sendCalls;
+    uint64_t sentDatagrams;
+    uint64_t receiveCalls;
+    uint64_t receivedDatagrams;
+    // cumulative kernel drops, one entry per receive socket. Sums keep the entries of every endpoint.
+    std::vector<uint32_t> socketDrops;
+    // cumulative time from receive to send of forwarded packets
+    utils::LatencyHistogram::Snapshot forwardLatency;
 };
 
 inline EndpointMetrics operator+(const EndpointMetrics& lhs, const EndpointMetrics& rhs)
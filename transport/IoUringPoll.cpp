@@ -0,0 +1,947 @@
+#include "transport/RtcePoll.h"
+#include "concurrency/SafeQueue.h"
+#include "concurrency/ScopedSpinLocker.h"
+#include "concurrency/ThreadUtils.h"
+#include "logger/Logger.h"
+#include "memory/PoolAllocator.h"
+#include "utils/Time.h"
+#include "utils/Trackers.h"
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// provided buffer rings need linux 6.0 headers. IORING_REGISTER_PBUF_RING is an enum.
+#if defined(IORING_RECV_MULTISHOT) && defined(IORING_ENTER_EXT_ARG)
+#define IO_URING_POLL_SUPPORTED 1
+#endif
+
+namespace transport
+{
+
+#ifdef IO_URING_POLL_SUPPORTED
+
+namespace
+{
+
+// Minimal io_uring wrapper on the raw syscalls. Submission queue entries may be prepared from several threads while
+// holding the lock passed by the caller. Completions are only consumed from the Rtce thread.
+class IoUring
+{
+public:
+    IoUring()
+        : _fd(-1),
+          _ring(MAP_FAILED),
+          _ringSize(0),
+          _sqes(static_cast<io_uring_sqe*>(MAP_FAILED)),
+          _sqeCount(0),
+          _sqeTail(0)
+    {
+    }
+
+    ~IoUring()
+    {
+        if (_sqes != MAP_FAILED)
+        {
+            munmap(_sqes, _sqeCount * sizeof(io_uring_sqe));
+        }
+        if (_ring != MAP_FAILED)
+        {
+            munmap(_ring, _ringSize);
+        }
+        if (_fd != -1)
+        {
+            ::close(_fd);
+        }
+    }
+
+    bool init(const uint32_t sqEntries, const uint32_t cqEntries)
+    {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        params.flags = IORING_SETUP_CQSIZE;
+        params.cq_entries = cqEntries;
+        _fd = syscall(__NR_io_uring_setup, sqEntries, &params);
+        if (_fd < 0)
+        {
+            return false;
+        }
+
+        const uint32_t requiredFeatures = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+        if ((params.features & requiredFeatures) != requiredFeatures)
+        {
+            return false;
+        }
+
+        _ringSize = std::max(params.sq_off.array + params.sq_entries * sizeof(uint32_t),
+            params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+        _ring = mmap(nullptr, _ringSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQ_RING);
+        _sqeCount = params.sq_entries;
+        _sqes = static_cast<io_uring_sqe*>(mmap(nullptr,
+            _sqeCount * sizeof(io_uring_sqe),
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE,
+            _fd,
+            IORING_OFF_SQES));
+        if (_ring == MAP_FAILED || _sqes == MAP_FAILED)
+        {
+            return false;
+        }
+
+        auto ring = static_cast<uint8_t*>(_ring);
+        _sqHead = reinterpret_cast<std::atomic_uint32_t*>(ring + params.sq_off.head);
+        _sqTail = reinterpret_cast<std::atomic_uint32_t*>(ring + params.sq_off.tail);
+        _sqMask = *reinterpret_cast<uint32_t*>(ring + params.sq_off.ring_mask);
+        auto sqArray = reinterpret_cast<uint32_t*>(ring + params.sq_off.array);
+        for (uint32_t i = 0; i < _sqeCount; ++i)
+        {
+            sqArray[i] = i;
+        }
+
+        _cqHead = reinterpret_cast<std::atomic_uint32_t*>(ring + params.cq_off.head);
+        _cqTail = reinterpret_cast<std::atomic_uint32_t*>(ring + params.cq_off.tail);
+        _cqMask = *reinterpret_cast<uint32_t*>(ring + params.cq_off.ring_mask);
+        _cqes = reinterpret_cast<io_uring_cqe*>(ring + params.cq_off.cqes);
+        _sqeTail = _sqTail->load();
+        return true;
+    }
+
+    // caller holds the submission lock
+    io_uring_sqe* getSqe()
+    {
+        if (_sqeTail - _sqHead->load(std::memory_order_acquire) >= _sqeCount)
+        {
+            return nullptr;
+        }
+        auto sqe = &_sqes[_sqeTail & _sqMask];
+        std::memset(sqe, 0, sizeof(*sqe));
+        ++_sqeTail;
+        return sqe;
+    }
+
+    // caller holds the submission lock. Makes the prepared entries visible to the kernel.
+    void publish() { _sqTail->store(_sqeTail, std::memory_order_release); }
+
+    // May be called without the lock with the number of entries this thread published. Returns how many entries the
+    // kernel consumed. It may consume fewer than count if it runs short of resources, and the rest stay queued.
+    uint32_t submit(const uint32_t count)
+    {
+        uint32_t submitted = 0;
+        for (uint32_t attempt = 0; submitted < count && attempt < maxSubmitAttempts; ++attempt)
+        {
+            const int rc = syscall(__NR_io_uring_enter, _fd, count - submitted, 0, 0, nullptr, 0);
+            if (rc > 0)
+            {
+                submitted += rc;
+            }
+            else if (rc < 0 && errno != EINTR && errno != EAGAIN)
+            {
+                break;
+            }
+        }
+        return submitted;
+    }
+
+    int wait(const uint64_t timeoutNs)
+    {
+        __kernel_timespec timeout;
+        timeout.tv_sec = timeoutNs / utils::Time::sec;
+        timeout.tv_nsec = timeoutNs % utils::Time::sec;
+        io_uring_getevents_arg arg;
+        std::memset(&arg, 0, sizeof(arg));
+        arg.sigmask_sz = _NSIG / 8;
+        arg.ts = reinterpret_cast<uint64_t>(&timeout);
+        return syscall(__NR_io_uring_enter,
+            _fd,
+            0,
+            1,
+            IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+            &arg,
+            sizeof(arg));
+    }
+
+    template <typename F>
+    uint32_t forEachCompletion(F&& handler)
+    {
+        auto head = _cqHead->load(std::memory_order_relaxed);
+        const auto tail = _cqTail->load(std::memory_order_acquire);
+        uint32_t count = 0;
+        for (; head != tail; ++head, ++count)
+        {
+            handler(_cqes[head & _cqMask]);
+            _cqHead->store(head + 1, std::memory_order_release);
+        }
+        return count;
+    }
+
+    bool registerBufferRing(io_uring_buf_ring* bufferRing, const uint32_t entries, const uint16_t groupId)
+    {
+        io_uring_buf_reg registration;
+        std::memset(&registration, 0, sizeof(registration));
+        registration.ring_addr = reinterpret_cast<uint64_t>(bufferRing);
+        registration.ring_entries = entries;
+        registration.bgid = groupId;
+        return syscall(__NR_io_uring_register, _fd, IORING_REGISTER_PBUF_RING, &registration, 1) == 0;
+    }
+
+private:
+    static const uint32_t maxSubmitAttempts = 4;
+
+    int _fd;
+    void* _ring;
+    size_t _ringSize;
+    io_uring_sqe* _sqes;
+    uint32_t _sqeCount;
+    uint32_t _sqeTail;
+    uint32_t _sqMask;
+    std::atomic_uint32_t* _sqHead;
+    std::atomic_uint32_t* _sqTail;
+    uint32_t _cqMask;
+    std::atomic_uint32_t* _cqHead;
+    std::atomic_uint32_t* _cqTail;
+    io_uring_cqe* _cqes;
+};
+
+} // namespace
+
+class IoUringPoll : public RtcePoll
+{
+public:
+    explicit IoUringPoll(memory::PacketPoolAllocator& allocator);
+    ~IoUringPoll();
+
+    bool init();
+
+    void run() override;
+    void stop() override;
+
+    bool add(int fd, RtcePoll::IEventListener* listener) override;
+    bool remove(int fd, RtcePoll::IEventListener* listener) override;
+    bool isRunning() const override { return _running; }
+
+    size_t sendDatagrams(int fd, OutboundDatagram* datagrams, size_t count) override;
+    bool canSendDatagrams() const override { return true; }
+    std::vector<ThreadMetrics> getThreadMetrics(uint64_t timestamp) const override;
+
+private:
+    static const uint32_t ringEntries = 1024;
+    static const uint32_t completionEntries = 16 * 1024;
+    static const uint32_t receiveBufferCount = 1024; // power of 2
+    // recvmsg operations kept in flight per datagram socket
+    static const uint32_t receiveDepth = 32;
+    static const uint16_t receiveBufferGroup = 0;
+    static const size_t maxPendingSends = 8 * 1024;
+
+    // low bits of user_data tell what the completion belongs to
+    enum Operation : uint64_t
+    {
+        Ignore = 0,
+        Poll = 1,
+        Receive = 2,
+        Send = 3
+    };
+    static const uint64_t operationMask = 7;
+
+    struct Registration;
+
+    // The kernel picks a pool packet from the provided buffer ring for the payload, and writes the source address and
+    // flags to the msghdr of the operation. Multishot recvmsg would put its header in front of the payload instead.
+    struct ReceiveOperation
+    {
+        Registration* registration;
+        bool armed;
+        msghdr header;
+        sockaddr_in6 source;
+    };
+
+    struct Registration
+    {
+        Registration(RtcePoll::IEventListener* listener, int fd, bool datagram)
+            : listener(listener),
+              fd(fd),
+              datagram(datagram),
+              active(true),
+              armedCount(0)
+        {
+            if (datagram)
+            {
+                receives.reset(new ReceiveOperation[receiveDepth]);
+                for (uint32_t i = 0; i < receiveDepth; ++i)
+                {
+                    receives[i].registration = this;
+                    receives[i].armed = false;
+                }
+            }
+        }
+
+        RtcePoll::IEventListener* listener;
+        int fd;
+        bool datagram;
+        bool active;
+        uint32_t armedCount; // operations the kernel still owns
+        bool isStream = false;
+        std::unique_ptr<ReceiveOperation[]> receives;
+    };
+
+    struct SendRequest
+    {
+        msghdr header;
+        iovec ioVector;
+        SocketAddress target;
+        memory::UniquePacket packet;
+    };
+
+    struct SocketRegistration
+    {
+        SocketRegistration() : registration(true), listener(nullptr), fd(-1) {}
+        SocketRegistration(bool registration, RtcePoll::IEventListener* listener, int fd)
+            : registration(registration),
+              listener(listener),
+              fd(fd)
+        {
+        }
+
+        bool registration;
+        RtcePoll::IEventListener* listener;
+        int fd;
+    };
+
+    void listenSocketEvents(RtcePoll::IEventListener* listener, int fd);
+    void unlistenSocketEvents(int fd);
+    void arm(Registration& registration);
+    bool armReceive(ReceiveOperation& operation);
+    void cancel(Registration& registration);
+    void cancelOperation(Registration& registration, uint64_t userData);
+    void retire(Registration* registration);
+    void onCompletion(const io_uring_cqe& completion);
+    void onPollCompletion(Registration& registration, const io_uring_cqe& completion);
+    void onReceiveCompletion(ReceiveOperation& operation, const io_uring_cqe& completion);
+    void onArmCompleted(Registration* registration, const io_uring_cqe& completion);
+    void provideBuffer(uint16_t bufferId);
+    void publishBuffers();
+    void submitPending();
+    void wakeUp();
+
+    memory::PacketPoolAllocator& _allocator;
+    IoUring _ring;
+    std::atomic_flag _submitLock = ATOMIC_FLAG_INIT;
+    // entries prepared by the Rtce thread and entries a short submit left in the queue
+    std::atomic_uint32_t _unsubmittedCount;
+
+    io_uring_buf_ring* _bufferRing;
+    uint16_t _bufferTail;
+    // pool packets the kernel receives into, indexed by buffer id
+    memory::UniquePacket _receiveBuffers[receiveBufferCount];
+    std::vector<uint16_t> _missingBuffers;
+    bool _ringReceive;
+
+    memory::PoolAllocator<sizeof(SendRequest)> _sendRequestAllocator;
+    std::atomic_uint32_t _pendingSends;
+
+    concurrency::LockFullQueue<SocketRegistration, 2500> _pendingRegistrations;
+    std::unordered_map<int, std::unique_ptr<Registration>> _registrations;
+    // cancelled registrations waiting for the kernel to finish their operations
+    uint32_t _retiringCount;
+    std::atomic_uint32_t _socketCount;
+    utils::RateTracker<10> _eventRate;
+
+    std::atomic_bool _running;
+    std::unique_ptr<std::thread> _networkThread;
+};
+
+IoUringPoll::IoUringPoll(memory::PacketPoolAllocator& allocator)
+    : _allocator(allocator),
+      _unsubmittedCount(0),
+      _bufferRing(static_cast<io_uring_buf_ring*>(MAP_FAILED)),
+      _bufferTail(0),
+      _ringReceive(true),
+      _sendRequestAllocator(maxPendingSends, "IoUringSends"),
+      _pendingSends(0),
+      _retiringCount(0),
+      _socketCount(0),
+      _eventRate(utils::Time::ms * 100),
+      _running(false)
+{
+    _registrations.reserve(1000);
+    _missingBuffers.reserve(receiveBufferCount);
+}
+
+IoUringPoll::~IoUringPoll()
+{
+    if (_running)
+    {
+        stop();
+    }
+    if (_bufferRing != MAP_FAILED)
+    {
+        munmap(_bufferRing, receiveBufferCount * sizeof(io_uring_buf));
+    }
+}
+
+bool IoUringPoll::init()
+{
+    if (!_ring.init(ringEntries, completionEntries))
+    {
+        return false;
+    }
+
+    _bufferRing = static_cast<io_uring_buf_ring*>(mmap(nullptr,
+        receiveBufferCount * sizeof(io_uring_buf),
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS,
+        -1,
+        0));
+    if (_bufferRing == MAP_FAILED)
+    {
+        return false;
+    }
+    _bufferRing->tail = 0;
+    if (!_ring.registerBufferRing(_bufferRing, receiveBufferCount, receiveBufferGroup))
+    {
+        logger::info("provided buffer rings not supported, using poll for datagram sockets", "IoUringPoll");
+        _ringReceive = false;
+    }
+    else
+    {
+        for (uint16_t i = 0; i < receiveBufferCount; ++i)
+        {
+            provideBuffer(i);
+        }
+        publishBuffers();
+    }
+
+    _running = true;
+    _networkThread = std::make_unique<std::thread>([this]() { this->run(); });
+    return true;
+}
+
+void IoUringPoll::stop()
+{
+    _running = false;
+    wakeUp();
+    _networkThread->join();
+}
+
+// a nop completion ends the wait in the Rtce thread
+void IoUringPoll::wakeUp()
+{
+    {
+        concurrency::ScopedSpinLocker locker(_submitLock);
+        auto sqe = _ring.getSqe();
+        if (!sqe)
+        {
+            return; // the thread will pick up the full queue anyway
+        }
+        sqe->opcode = IORING_OP_NOP;
+        sqe->user_data = Operation::Ignore;
+        _ring.publish();
+    }
+    if (_ring.submit(1) == 0)
+    {
+        _unsubmittedCount.fetch_add(1);
+    }
+}
+
+void IoUringPoll::provideBuffer(const uint16_t bufferId)
+{
+    auto packet = memory::makeUniquePacket(_allocator);
+    if (!packet)
+    {
+        _missingBuffers.push_back(bufferId);
+        return;
+    }
+
+    // bufs is a flexible array member that C++ places after an empty struct, so index from the ring start
+    auto& buffer = reinterpret_cast<io_uring_buf*>(_bufferRing)[_bufferTail & (receiveBufferCount - 1)];
+    buffer.addr = reinterpret_cast<uint64_t>(packet->get());
+    buffer.len = memory::Packet::size;
+    buffer.bid = bufferId;
+    ++_bufferTail;
+    _receiveBuffers[bufferId] = std::move(packet);
+}
+
+void IoUringPoll::publishBuffers()
+{
+    __atomic_store_n(&_bufferRing->tail, _bufferTail, __ATOMIC_RELEASE);
+}
+
+// Rtce thread only
+void IoUringPoll::submitPending()
+{
+    const auto count = _unsubmittedCount.exchange(0);
+    const auto submitted = _ring.submit(count);
+    if (submitted < count)
+    {
+        _unsubmittedCount.fetch_add(count - submitted);
+        logger::warn("io_uring submitted %u of %u entries, err %d", "IoUringPoll", submitted, count, errno);
+    }
+}
+
+void IoUringPoll::arm(Registration& registration)
+{
+    concurrency::ScopedSpinLocker locker(_submitLock);
+    auto sqe = _ring.getSqe();
+    if (!sqe)
+    {
+        logger::error("io_uring submission queue full, fd %d not armed", "IoUringPoll", registration.fd);
+        return;
+    }
+
+    sqe->fd = registration.fd;
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->poll32_events = POLLIN | (registration.isStream ? POLLOUT | POLLHUP | POLLRDHUP : 0);
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->user_data = reinterpret_cast<uint64_t>(&registration) | Operation::Poll;
+    _ring.publish();
+    ++_unsubmittedCount;
+    ++registration.armedCount;
+}
+
+bool IoUringPoll::armReceive(ReceiveOperation& operation)
+{
+    auto& registration = *operation.registration;
+    concurrency::ScopedSpinLocker locker(_submitLock);
+    auto sqe = _ring.getSqe();
+    if (!sqe)
+    {
+        logger::error("io_uring submission queue full, fd %d not armed", "IoUringPoll", registration.fd);
+        return false;
+    }
+
+    std::memset(&operation.header, 0, sizeof(operation.header));
+    operation.header.msg_name = &operation.source;
+    operation.header.msg_namelen = sizeof(operation.source);
+    sqe->opcode = IORING_OP_RECVMSG;
+    sqe->fd = registration.fd;
+    sqe->addr = reinterpret_cast<uint64_t>(&operation.header);
+    sqe->len = 1;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = receiveBufferGroup;
+    sqe->user_data = reinterpret_cast<uint64_t>(&operation) | Operation::Receive;
+    _ring.publish();
+    ++_unsubmittedCount;
+    operation.armed = true;
+    ++registration.armedCount;
+    return true;
+}
+
+void IoUringPoll::cancel(Registration& registration)
+{
+    for (uint32_t i = 0; registration.receives && i < receiveDepth; ++i)
+    {
+        if (registration.receives[i].armed)
+        {
+            cancelOperation(registration, reinterpret_cast<uint64_t>(&registration.receives[i]) | Operation::Receive);
+        }
+    }
+    if (!registration.datagram)
+    {
+        cancelOperation(registration, reinterpret_cast<uint64_t>(&registration) | Operation::Poll);
+    }
+}
+
+void IoUringPoll::cancelOperation(Registration& registration, const uint64_t userData)
+{
+    concurrency::ScopedSpinLocker locker(_submitLock);
+    auto sqe = _ring.getSqe();
+    if (!sqe)
+    {
+        logger::error("io_uring submission queue full, fd %d not cancelled", "IoUringPoll", registration.fd);
+        return;
+    }
+
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = userData;
+    sqe->user_data = Operation::Ignore;
+    _ring.publish();
+    ++_unsubmittedCount;
+}
+
+// The registration is deleted when the kernel reports the last of its cancelled operations as finished.
+void IoUringPoll::retire(Registration* registration)
+{
+    registration->active = false;
+    if (registration->armedCount == 0)
+    {
+        delete registration;
+        return;
+    }
+    ++_retiringCount;
+    cancel(*registration);
+}
+
+void IoUringPoll::listenSocketEvents(RtcePoll::IEventListener* listener, int fd)
+{
+    if (fd == -1)
+    {
+        return;
+    }
+
+    if (_registrations.find(fd) != _registrations.end())
+    {
+        unlistenSocketEvents(fd);
+    }
+
+    uint32_t socketType = 0;
+    socklen_t dataLength = sizeof(socketType);
+    if (-1 == getsockopt(fd, SOL_SOCKET, SO_TYPE, &socketType, &dataLength))
+    {
+        return;
+    }
+
+    const bool datagram = _ringReceive && socketType == SOCK_DGRAM && listener->isDatagramReceiver();
+    auto registration = std::make_unique<Registration>(listener, fd, datagram);
+    registration->isStream = (socketType == SOCK_STREAM);
+    if (datagram)
+    {
+        for (uint32_t i = 0; i < receiveDepth && armReceive(registration->receives[i]); ++i) {}
+    }
+    else
+    {
+        arm(*registration);
+    }
+    if (registration->armedCount == 0)
+    {
+        return;
+    }
+    _registrations.emplace(fd, std::move(registration));
+    listener->onSocketPollStarted(fd);
+}
+
+void IoUringPoll::unlistenSocketEvents(int fd)
+{
+    auto it = _registrations.find(fd);
+    if (it == _registrations.end())
+    {
+        return;
+    }
+
+    auto registration = it->second.release();
+    _registrations.erase(it);
+    retire(registration);
+}
+
+void IoUringPoll::run()
+{
+    concurrency::setThreadName("Rtce");
+
+    while (_running)
+    {
+        SocketRegistration message;
+        while (_pendingRegistrations.pop(message))
+        {
+            if (message.registration)
+            {
+                listenSocketEvents(message.listener, message.fd);
+            }
+            else
+            {
+                unlistenSocketEvents(message.fd);
+                message.listener->onSocketPollStopped(message.fd);
+            }
+        }
+
+        if (!_missingBuffers.empty())
+        {
+            auto missingBuffers = std::move(_missingBuffers);
+            _missingBuffers.clear();
+            for (auto bufferId : missingBuffers)
+            {
+                provideBuffer(bufferId);
+            }
+            publishBuffers();
+        }
+
+        _socketCount = _registrations.size();
+        submitPending();
+        const auto rc = _ring.wait(100 * utils::Time::ms);
+        if (rc < 0 && errno != EINTR && errno != ETIME && errno != EAGAIN)
+        {
+            logger::error("failed to wait for io_uring completions. err: %d", "IoUringPoll", errno);
+        }
+
+        const auto completions =
+            _ring.forEachCompletion([this](const io_uring_cqe& completion) { onCompletion(completion); });
+        if (completions > 0)
+        {
+            _eventRate.update(completions, utils::Time::getAbsoluteTime());
+        }
+        publishBuffers();
+    }
+
+    for (auto& registration : _registrations)
+    {
+        retire(registration.second.release());
+    }
+    _registrations.clear();
+
+    // In flight sends own packets that must be returned to the pool before it goes away, and registrations are
+    // deleted as their cancelled operations complete.
+    const auto stopTime = utils::Time::getAbsoluteTime();
+    while ((_pendingSends.load() > 0 || _retiringCount > 0) &&
+        utils::Time::diff(stopTime, utils::Time::getAbsoluteTime()) < utils::Time::sec)
+    {
+        submitPending();
+        _ring.wait(10 * utils::Time::ms);
+        _ring.forEachCompletion([this](const io_uring_cqe& completion) { onCompletion(completion); });
+    }
+    if (_retiringCount > 0)
+    {
+        logger::warn("%u registrations still have io_uring operations after stop", "IoUringPoll", _retiringCount);
+    }
+}
+
+void IoUringPoll::onCompletion(const io_uring_cqe& completion)
+{
+    const auto operation = completion.user_data & operationMask;
+    if (operation == Operation::Send)
+    {
+        auto request = reinterpret_cast<SendRequest*>(completion.user_data & ~operationMask);
+        if (completion.res < 0)
+        {
+            logger::debug("err (%d) failed sending to %s",
+                "IoUringPoll",
+                -completion.res,
+                request->target.toString().c_str());
+        }
+        request->~SendRequest();
+        _sendRequestAllocator.free(request);
+        _pendingSends.fetch_sub(1);
+        return;
+    }
+
+    if (operation == Operation::Poll)
+    {
+        auto registration = reinterpret_cast<Registration*>(completion.user_data & ~operationMask);
+        onPollCompletion(*registration, completion);
+        if (!(completion.flags & IORING_CQE_F_MORE))
+        {
+            onArmCompleted(registration, completion);
+        }
+    }
+    else if (operation == Operation::Receive)
+    {
+        auto& receive = *reinterpret_cast<ReceiveOperation*>(completion.user_data & ~operationMask);
+        receive.armed = false;
+        onReceiveCompletion(receive, completion);
+        onArmCompleted(receive.registration, completion);
+    }
+}
+
+void IoUringPoll::onPollCompletion(Registration& registration, const io_uring_cqe& completion)
+{
+    if (!registration.active || completion.res <= 0)
+    {
+        return;
+    }
+
+    // same event order as the epoll backend
+    const auto events = static_cast<uint32_t>(completion.res);
+    const bool hangup = (events & (POLLHUP | POLLRDHUP | POLLERR)) != 0;
+    if (events & POLLIN)
+    {
+        registration.listener->onSocketReadable(registration.fd);
+        if (hangup)
+        {
+            registration.listener->onSocketShutdown(registration.fd);
+        }
+    }
+    if (events & POLLOUT)
+    {
+        if (hangup)
+        {
+            registration.listener->onSocketShutdown(registration.fd);
+        }
+        else
+        {
+            registration.listener->onSocketWriteable(registration.fd);
+        }
+    }
+}
+
+// The payload is already in a pool packet, which is handed on and replaced in the buffer ring.
+void IoUringPoll::onReceiveCompletion(ReceiveOperation& operation, const io_uring_cqe& completion)
+{
+    if (!(completion.flags & IORING_CQE_F_BUFFER))
+    {
+        return;
+    }
+
+    const auto bufferId = static_cast<uint16_t>(completion.flags >> IORING_CQE_BUFFER_SHIFT);
+    if (bufferId >= receiveBufferCount)
+    {
+        return;
+    }
+    auto packet = std::move(_receiveBuffers[bufferId]);
+    provideBuffer(bufferId);
+    auto& registration = *operation.registration;
+    if (!packet || completion.res <= 0 || !registration.active)
+    {
+        return;
+    }
+
+    const auto payloadLength = static_cast<size_t>(completion.res);
+    if ((operation.header.msg_flags & MSG_TRUNC) || payloadLength >= memory::Packet::size)
+    {
+        return; // Attack with Jumbo frame. Discard
+    }
+
+    packet->setLength(payloadLength);
+    const SocketAddress source(reinterpret_cast<const sockaddr*>(&operation.source), nullptr);
+    registration.listener->onSocketDatagram(registration.fd, source, std::move(packet));
+}
+
+// An operation has ended. Re-arm it if the socket is still registered, otherwise release the registration after its
+// last operation.
+void IoUringPoll::onArmCompleted(Registration* registration, const io_uring_cqe& completion)
+{
+    --registration->armedCount;
+    if (!registration->active)
+    {
+        if (registration->armedCount == 0)
+        {
+            --_retiringCount;
+            delete registration;
+        }
+        return;
+    }
+
+    if (registration->datagram && completion.res == -EINVAL)
+    {
+        logger::info("recvmsg with provided buffers not supported, using poll for datagram sockets", "IoUringPoll");
+        _ringReceive = false;
+        registration->datagram = false;
+    }
+    else if (completion.res < 0 && completion.res != -ENOBUFS && completion.res != -ECANCELED)
+    {
+        logger::warn("io_uring operation on fd %d ended, err %d", "IoUringPoll", registration->fd, -completion.res);
+    }
+
+    if (!registration->datagram)
+    {
+        // switches to poll once the receive operations have ended
+        if (registration->armedCount == 0)
+        {
+            arm(*registration);
+        }
+        return;
+    }
+
+    const auto operation = reinterpret_cast<ReceiveOperation*>(completion.user_data & ~operationMask);
+    armReceive(*operation);
+}
+
+bool IoUringPoll::add(int fd, RtcePoll::IEventListener* listener)
+{
+    if (!_pendingRegistrations.push(SocketRegistration{true, listener, fd}))
+    {
+        return false;
+    }
+    wakeUp();
+    return true;
+}
+
+// You must await the notifyClosed callback after this
+bool IoUringPoll::remove(int fd, RtcePoll::IEventListener* listener)
+{
+    if (!_pendingRegistrations.push(SocketRegistration{false, listener, fd}))
+    {
+        return false;
+    }
+    wakeUp();
+    return true;
+}
+
+std::vector<RtcePoll::ThreadMetrics> IoUringPoll::getThreadMetrics(const uint64_t timestamp) const
+{
+    ThreadMetrics metrics;
+    metrics.sockets = _socketCount;
+    metrics.eventsPerSecond = _eventRate.get(timestamp, utils::Time::sec) * utils::Time::sec;
+    return {metrics};
+}
+
+size_t IoUringPoll::sendDatagrams(int fd, OutboundDatagram* datagrams, const size_t count)
+{
+    size_t accepted = 0;
+    {
+        concurrency::ScopedSpinLocker locker(_submitLock);
+        for (; accepted < count; ++accepted)
+        {
+            auto& datagram = datagrams[accepted];
+            auto memory = _sendRequestAllocator.allocate();
+            if (!memory)
+            {
+                break;
+            }
+            auto sqe = _ring.getSqe();
+            if (!sqe)
+            {
+                _sendRequestAllocator.free(memory);
+                break;
+            }
+
+            auto request = new (memory) SendRequest();
+            request->target = datagram.target;
+            request->packet = std::move(datagram.packet);
+            request->ioVector.iov_base = request->packet->get();
+            request->ioVector.iov_len = request->packet->getLength();
+            std::memset(&request->header, 0, sizeof(request->header));
+            request->header.msg_name = const_cast<sockaddr*>(request->target.getSockAddr());
+            request->header.msg_namelen = request->target.getSockAddrSize();
+            request->header.msg_iov = &request->ioVector;
+            request->header.msg_iovlen = 1;
+
+            sqe->opcode = IORING_OP_SENDMSG;
+            sqe->fd = fd;
+            sqe->addr = reinterpret_cast<uint64_t>(&request->header);
+            sqe->len = 1;
+            sqe->msg_flags = MSG_NOSIGNAL;
+            sqe->user_data = reinterpret_cast<uint64_t>(request) | Operation::Send;
+        }
+        _ring.publish();
+    }
+
+    _pendingSends.fetch_add(accepted);
+    const auto submitted = _ring.submit(accepted);
+    if (submitted < accepted)
+    {
+        // the rest stay in the submission queue and go with the next batch of the Rtce thread
+        _unsubmittedCount.fetch_add(accepted - submitted);
+        logger::warn("io_uring submitted %u of %zu sends, err %d", "IoUringPoll", submitted, accepted, errno);
+    }
+    return accepted;
+}
+
+std::unique_ptr<RtcePoll> createIoUringPoll(memory::PacketPoolAllocator& allocator)
+{
+    auto poll = std::make_unique<IoUringPoll>(allocator);
+    if (!poll->init())
+    {
+        return nullptr;
+    }
+    return std::move(poll);
+}
+
+#else
+
+std::unique_ptr<RtcePoll> createIoUringPoll(memory::PacketPoolAllocator& allocator)
+{
+    return nullptr;
+}
+
+#endif
+
+} // namespace transport
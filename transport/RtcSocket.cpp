@@ -1,16 +1,32 @@
 #include "RtcSocket.h"
 
 #include "utils/StdExtensions.h"
+#include <cstring>
 #include <errno.h>
 #include <fcntl.h>
 #include <ifaddrs.h>
 #include <net/if.h>
 #include <netdb.h>
+#include <netinet/udp.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <unistd.h>
+#ifdef __linux__
+#include <linux/errqueue.h>
+#include <linux/filter.h>
+#include <linux/net_tstamp.h>
+#include <linux/sock_diag.h>
+#endif
+
+#if defined(__linux__) && !defined(UDP_SEGMENT)
+#define UDP_SEGMENT 103
+#endif
+#if defined(__linux__) && !defined(UDP_GRO)
+#define UDP_GRO 104
+#endif
+
 namespace transport
 {
 void RtcSocket::Message::add(const void* data, size_t len)
@@ -21,9 +37,25 @@ void RtcSocket::Message::add(const void* data, size_t len)
     ++fragmentCount;
 }
 
-RtcSocket::RtcSocket() : _boundPort(SocketAddress::parse("0.0.0.0")), _fd(-1), _type(SOCK_DGRAM) {}
+RtcSocket::RtcSocket()
+    : _boundPort(SocketAddress::parse("0.0.0.0")),
+      _fd(-1),
+      _type(SOCK_DGRAM),
+      _segmentationOffload(false),
+      _sendCalls(0),
+      _sentDatagrams(0)
+{
+}
 
-RtcSocket::RtcSocket(int fd, const SocketAddress& localPort) : _boundPort(localPort), _fd(fd), _type(SOCK_STREAM) {}
+RtcSocket::RtcSocket(int fd, const SocketAddress& localPort)
+    : _boundPort(localPort),
+      _fd(fd),
+      _type(SOCK_STREAM),
+      _segmentationOffload(false),
+      _sendCalls(0),
+      _sentDatagrams(0)
+{
+}
 
 RtcSocket::~RtcSocket()
 {
@@ -44,7 +76,7 @@ void RtcSocket::close()
     }
 }
 
-int RtcSocket::open(const SocketAddress& address, uint16_t port, int socketType)
+int RtcSocket::open(const SocketAddress& address, uint16_t port, int socketType, bool reusePort)
 {
     close();
     _type = socketType;
@@ -63,7 +95,7 @@ int RtcSocket::open(const SocketAddress& address, uint16_t port, int socketType)
     {
         flags = 0;
     }
-    if (socketType == SOCK_STREAM)
+    if (socketType == SOCK_STREAM || reusePort)
     {
         int val = 1;
         ::setsockopt(_fd, SOL_SOCKET, SO_REUSEPORT, &val, sizeof(val));
@@ -201,6 +233,11 @@ int RtcSocket::sendAggregate(const void* buf0, size_t length0, size_t& bytesSent
     return sendAggregate(buffers, 1, bytesSent, target);
 }
 
+int RtcSocket::sendStream(const struct iovec* buffers, uint16_t count, size_t& bytesSent)
+{
+    return sendAggregate(buffers, count, bytesSent, SocketAddress());
+}
+
 namespace
 {
 size_t lengthOf(const msghdr& header)
@@ -266,11 +303,11 @@ int RtcSocket::sendMultiple(Message* messages, const size_t count)
         return 0;
     }
     assert(count <= 500);
+
+#ifdef __APPLE__
     int errorCount = 0;
     const int maxSendAttempts = 2;
     int attemptsLeft = maxSendAttempts;
-
-#ifdef __APPLE__
     for (size_t sendCursor = 0; sendCursor < count;)
     {
         msghdr singleMessage = {const_cast<sockaddr*>(messages[sendCursor].target->getSockAddr()),
@@ -284,6 +321,7 @@ int RtcSocket::sendMultiple(Message* messages, const size_t count)
         const auto totalLength = static_cast<ssize_t>(lengthOf(singleMessage));
         ssize_t rc = 0;
         rc = ::sendmsg(_fd, &singleMessage, MSG_DONTWAIT | MSG_NOSIGNAL);
+        _sendCalls.fetch_add(1, std::memory_order_relaxed);
         if (rc != totalLength)
         {
             const int errorCode = errno;
@@ -297,6 +335,10 @@ int RtcSocket::sendMultiple(Message* messages, const size_t count)
                 messages[sendCursor].errorCode = errorCode;
             }
         }
+        else
+        {
+            _sentDatagrams.fetch_add(1, std::memory_order_relaxed);
+        }
         attemptsLeft = maxSendAttempts;
         ++sendCursor;
     }
@@ -304,6 +346,20 @@ int RtcSocket::sendMultiple(Message* messages, const size_t count)
     return errorCount;
 
 #else
+    if (_segmentationOffload.load(std::memory_order_relaxed))
+    {
+        return sendSegmented(messages, count);
+    }
+    return sendUnsegmented(messages, count);
+#endif
+}
+
+#ifndef __APPLE__
+int RtcSocket::sendUnsegmented(Message* messages, const size_t count)
+{
+    int errorCount = 0;
+    const int maxSendAttempts = 2;
+    int attemptsLeft = maxSendAttempts;
     mmsghdr items[count];
     const auto addressSize = static_cast<socklen_t>(messages[0].target->getSockAddrSize());
     for (size_t i = 0; i < count; ++i)
@@ -323,6 +379,11 @@ int RtcSocket::sendMultiple(Message* messages, const size_t count)
     {
         const auto remainingCount = count - sendCursor;
         int rc = ::sendmmsg(_fd, items + sendCursor, remainingCount, MSG_DONTWAIT | MSG_NOSIGNAL);
+        _sendCalls.fetch_add(1, std::memory_order_relaxed);
+        if (rc > 0)
+        {
+            _sentDatagrams.fetch_add(rc, std::memory_order_relaxed);
+        }
         if (rc == static_cast<int>(remainingCount))
         {
             return errorCount;
@@ -348,9 +409,252 @@ int RtcSocket::sendMultiple(Message* messages, const size_t count)
         attemptsLeft = maxSendAttempts;
     }
 
+    return errorCount;
+}
+#endif
+
+bool RtcSocket::enableSegmentationOffload()
+{
+#ifdef UDP_SEGMENT
+    int segmentSize = 0;
+    socklen_t optionLength = sizeof(segmentSize);
+    if (_type != SOCK_DGRAM || ::getsockopt(_fd, SOL_UDP, UDP_SEGMENT, &segmentSize, &optionLength) != 0)
+    {
+        return false;
+    }
+    _segmentationOffload = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool RtcSocket::enableReceiveOffload()
+{
+#ifdef UDP_GRO
+    const int enable = 1;
+    return _type == SOCK_DGRAM && ::setsockopt(_fd, SOL_UDP, UDP_GRO, &enable, sizeof(enable)) == 0;
+#else
+    return false;
+#endif
+}
+
+bool RtcSocket::attachReusePortSteering(const uint32_t groupSize)
+{
+#if defined(__linux__) && defined(SO_ATTACH_REUSEPORT_CBPF)
+    // The program runs with the packet positioned at the UDP payload. Address fields are read relative to the network
+    // header, assuming IPv4 without options. For IPv6 the low word of the source address is used.
+    const bool ipv6 = (_boundPort.getFamily() == AF_INET6);
+    const uint32_t sourceAddressOffset = ipv6 ? 20 : 12;
+    const uint32_t sourcePortOffset = ipv6 ? 40 : 20;
+    sock_filter program[] = {
+        BPF_STMT(BPF_LD | BPF_W | BPF_ABS, static_cast<uint32_t>(SKF_NET_OFF) + sourceAddressOffset),
+        BPF_STMT(BPF_MISC | BPF_TAX, 0),
+        BPF_STMT(BPF_LD | BPF_H | BPF_ABS, static_cast<uint32_t>(SKF_NET_OFF) + sourcePortOffset),
+        BPF_STMT(BPF_ALU | BPF_XOR | BPF_X, 0),
+        BPF_STMT(BPF_ALU | BPF_MUL | BPF_K, 0x9E3779B1), // spread similar addresses
+        BPF_STMT(BPF_ALU | BPF_RSH | BPF_K, 16),
+        BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, groupSize),
+        BPF_STMT(BPF_RET | BPF_A, 0)};
+    sock_fprog filter;
+    filter.len = std::size(program);
+    filter.filter = program;
+    return groupSize > 0 && _type == SOCK_DGRAM &&
+        ::setsockopt(_fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &filter, sizeof(filter)) == 0;
+#else
+    return false;
+#endif
+}
+
+uint32_t RtcSocket::getDropCount() const
+{
+#if defined(__linux__) && defined(SO_MEMINFO)
+    uint32_t memoryInfo[SK_MEMINFO_VARS] = {0};
+    socklen_t length = sizeof(memoryInfo);
+    if (::getsockopt(_fd, SOL_SOCKET, SO_MEMINFO, memoryInfo, &length) == 0)
+    {
+        return memoryInfo[SK_MEMINFO_DROPS];
+    }
+#endif
+    return 0;
+}
+
+int RtcSocket::getReceivedSegmentSize(const msghdr& header)
+{
+#ifdef UDP_GRO
+    for (auto controlMessage = CMSG_FIRSTHDR(&header); controlMessage;
+         controlMessage = CMSG_NXTHDR(const_cast<msghdr*>(&header), controlMessage))
+    {
+        if (controlMessage->cmsg_level == SOL_UDP && controlMessage->cmsg_type == UDP_GRO)
+        {
+            int segmentSize = 0;
+            std::memcpy(&segmentSize, CMSG_DATA(controlMessage), sizeof(segmentSize));
+            return segmentSize;
+        }
+    }
+#endif
+    return 0;
+}
+
+bool RtcSocket::enableReceiveTimestamps()
+{
+#if defined(__linux__) && defined(SO_TIMESTAMPING)
+    const int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    return _type == SOCK_DGRAM && ::setsockopt(_fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) == 0;
+#else
+    return false;
+#endif
+}
+
+uint64_t RtcSocket::getReceiveTimestamp(const msghdr& header)
+{
+#if defined(__linux__) && defined(SO_TIMESTAMPING)
+    for (auto controlMessage = CMSG_FIRSTHDR(&header); controlMessage;
+         controlMessage = CMSG_NXTHDR(const_cast<msghdr*>(&header), controlMessage))
+    {
+        if (controlMessage->cmsg_level == SOL_SOCKET && controlMessage->cmsg_type == SCM_TIMESTAMPING)
+        {
+            // software stamp in ts[0], ts[2] would be the raw hardware stamp
+            scm_timestamping timestamps;
+            std::memcpy(&timestamps, CMSG_DATA(controlMessage), sizeof(timestamps));
+            return static_cast<uint64_t>(timestamps.ts[0].tv_sec) * 1000000000ull + timestamps.ts[0].tv_nsec;
+        }
+    }
 #endif
+    return 0;
+}
+
+#ifndef __APPLE__
+// Groups consecutive messages of equal length to the same target into one datagram buffer that the kernel, or the
+// NIC, splits into segments. Only the last message in a group may be shorter. A group that is rejected is resent as
+// separate datagrams. If the rejection means GSO is not available on this path, GSO is turned off for the socket.
+int RtcSocket::sendSegmented(Message* messages, const size_t count)
+{
+    const size_t maxSegments = 64;
+    const size_t maxSegmentedLength = 65000;
+    const size_t maxFragments = std::size(messages[0].fragments);
+    union ControlBuffer
+    {
+        cmsghdr alignment;
+        uint8_t data[CMSG_SPACE(sizeof(uint16_t))];
+    };
+
+    mmsghdr items[count];
+    iovec fragments[count * maxFragments];
+    ControlBuffer control[count];
+    size_t groupStart[count];
+    size_t groupSize[count];
+
+    const auto addressSize = static_cast<socklen_t>(messages[0].target->getSockAddrSize());
+    size_t groupCount = 0;
+    size_t fragmentCursor = 0;
+    for (size_t i = 0; i < count; ++groupCount)
+    {
+        const auto segmentSize = messages[i].getLength();
+        size_t size = 1;
+        size_t totalLength = segmentSize;
+        while (i + size < count && size < maxSegments && *messages[i + size].target == *messages[i].target)
+        {
+            const auto length = messages[i + size].getLength();
+            if (length > segmentSize || length == 0 || totalLength + length > maxSegmentedLength)
+            {
+                break;
+            }
+            ++size;
+            totalLength += length;
+            if (length < segmentSize)
+            {
+                break;
+            }
+        }
+
+        msghdr& header = items[groupCount].msg_hdr;
+        header.msg_name = const_cast<sockaddr*>(messages[i].target->getSockAddr());
+        header.msg_namelen = addressSize;
+        header.msg_iov = &fragments[fragmentCursor];
+        header.msg_iovlen = 0;
+        for (size_t j = i; j < i + size; ++j)
+        {
+            for (int f = 0; f < messages[j].fragmentCount; ++f)
+            {
+                fragments[fragmentCursor++] = messages[j].fragments[f];
+                ++header.msg_iovlen;
+            }
+        }
+        header.msg_control = nullptr;
+        header.msg_controllen = 0;
+        header.msg_flags = 0;
+        if (size > 1)
+        {
+            header.msg_control = control[groupCount].data;
+            header.msg_controllen = sizeof(control[groupCount].data);
+            auto controlMessage = CMSG_FIRSTHDR(&header);
+            controlMessage->cmsg_level = SOL_UDP;
+            controlMessage->cmsg_type = UDP_SEGMENT;
+            controlMessage->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+            const auto gsoSize = static_cast<uint16_t>(segmentSize);
+            std::memcpy(CMSG_DATA(controlMessage), &gsoSize, sizeof(gsoSize));
+        }
+        items[groupCount].msg_len = 0;
+
+        groupStart[groupCount] = i;
+        groupSize[groupCount] = size;
+        i += size;
+    }
+
+    int errorCount = 0;
+    const int maxSendAttempts = 2;
+    int attemptsLeft = maxSendAttempts;
+    for (size_t sendCursor = 0; sendCursor < groupCount;)
+    {
+        const auto remainingCount = groupCount - sendCursor;
+        const int rc = ::sendmmsg(_fd, items + sendCursor, remainingCount, MSG_DONTWAIT | MSG_NOSIGNAL);
+        _sendCalls.fetch_add(1, std::memory_order_relaxed);
+        if (rc > 0)
+        {
+            for (int i = 0; i < rc; ++i)
+            {
+                _sentDatagrams.fetch_add(groupSize[sendCursor + i], std::memory_order_relaxed);
+            }
+            sendCursor += rc;
+            attemptsLeft = maxSendAttempts;
+            continue;
+        }
+
+        const int errorCode = (rc < 0 ? errno : EAGAIN);
+        if (--attemptsLeft > 0 && (errorCode == EAGAIN || errorCode == EWOULDBLOCK))
+        {
+            continue;
+        }
+
+        auto* groupMessages = &messages[groupStart[sendCursor]];
+        const auto groupMessageCount = groupSize[sendCursor];
+        if (errorCode == EAGAIN || errorCode == EWOULDBLOCK || groupMessageCount == 1)
+        {
+            for (size_t i = 0; i < groupMessageCount; ++i)
+            {
+                groupMessages[i].errorCode = errorCode;
+            }
+            errorCount += groupMessageCount;
+        }
+        else if (errorCode == EIO || errorCode == EOPNOTSUPP || errorCode == ENOPROTOOPT)
+        {
+            // GSO not available on this route or NIC
+            _segmentationOffload = false;
+            return errorCount + sendUnsegmented(groupMessages, count - groupStart[sendCursor]);
+        }
+        else
+        {
+            // resent separately to report the failing datagram, typically EMSGSIZE or EINVAL
+            errorCount += sendUnsegmented(groupMessages, groupMessageCount);
+        }
+        ++sendCursor;
+        attemptsLeft = maxSendAttempts;
+    }
+
     return errorCount;
 }
+#endif
 
 int RtcSocket::listen(int backlog)
 {
@@ -1,5 +1,7 @@
 #pragma once
 #include "utils/SocketAddress.h"
+#include <atomic>
+#include <cstdint>
 #include <sys/socket.h>
 
 namespace transport
@@ -37,7 +39,8 @@ public:
     void detachHandle();
     void close();
 
-    int open(const SocketAddress& address, uint16_t port, int socketType = SOCK_DGRAM);
+    // reusePort lets several datagram sockets bind the same port, see attachReusePortSteering
+    int open(const SocketAddress& address, uint16_t port, int socketType = SOCK_DGRAM, bool reusePort = false);
 
     int listen(int backlog);
     int accept(RtcSocket& serverSocket, SocketAddress& peerAddress);
@@ -63,6 +66,46 @@ public:
 
     int sendMultiple(Message* messages, size_t count);
 
+    // Writes the buffers to a connected stream socket in one sendmsg. Returns EAGAIN if only bytesSent were taken.
+    int sendStream(const struct iovec* buffers, uint16_t count, size_t& bytesSent);
+
+    /**
+     * Sends consecutive messages to the same target as one UDP_SEGMENT (GSO) buffer in sendMultiple. Disabled again
+     * if the kernel or NIC rejects segmented sends.
+     * @return false if the kernel does not support UDP GSO.
+     */
+    bool enableSegmentationOffload();
+    bool isSegmentationOffloadEnabled() const { return _segmentationOffload.load(std::memory_order_relaxed); }
+
+    /**
+     * Lets the kernel coalesce consecutive datagrams from the same sender into one buffer (UDP_GRO). The segment size
+     * is reported in a UDP_GRO control message on receive.
+     * @return false if the kernel does not support UDP GRO.
+     */
+    bool enableReceiveOffload();
+    /** @return segment size from the UDP_GRO control message in header, 0 if the datagram was not coalesced. */
+    static int getReceivedSegmentSize(const msghdr& header);
+
+    /**
+     * Has the kernel stamp each datagram with the time it came off the driver (SO_TIMESTAMPING, software stamps).
+     * Hardware stamps are not requested as the NIC clock is not the system clock.
+     * @return false if the kernel does not support receive timestamps.
+     */
+    bool enableReceiveTimestamps();
+    /** @return CLOCK_REALTIME ns from the SCM_TIMESTAMPING control message in header, 0 if the datagram has none. */
+    static uint64_t getReceiveTimestamp(const msghdr& header);
+
+    /**
+     * Steers datagrams among the groupSize sockets bound with reusePort on this port by a hash of the source address
+     * and port, so each remote sticks to one socket. The index follows the order the sockets were bound in.
+     */
+    bool attachReusePortSteering(uint32_t groupSize);
+    // cumulative datagrams dropped by the kernel, typically on a full receive buffer
+    uint32_t getDropCount() const;
+
+    uint64_t getSendCallCount() const { return _sendCalls.load(std::memory_order_relaxed); }
+    uint64_t getSentDatagramCount() const { return _sentDatagrams.load(std::memory_order_relaxed); }
+
     SocketAddress getBoundPort() const { return _boundPort; }
     int fd() { return _fd; }
 
@@ -76,9 +119,15 @@ private:
         size_t& bytesSent,
         const SocketAddress& target);
 
+    int sendUnsegmented(Message* messages, size_t count);
+    int sendSegmented(Message* messages, size_t count);
+
     SocketAddress _boundPort;
     int _fd;
     int _type;
+    std::atomic_bool _segmentationOffload;
+    std::atomic_uint64_t _sendCalls;
+    std::atomic_uint64_t _sentDatagrams;
 };
 
 } // namespace transport
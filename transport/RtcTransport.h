@@ -8,7 +8,9 @@
 #include "transport/RtpReceiveState.h"
 #include "transport/RtpSenderState.h"
 #include "transport/Transport.h"
+#include "transport/dtls/SrtpClient.h"
 #include "transport/ice/IceSession.h"
+#include "utils/LatencyHistogram.h"
 #include "webrtc/DataStreamTransport.h"
 #include <unordered_map>
 #include <vector>
@@ -80,6 +82,9 @@ public:
     virtual uint32_t getPacingQueueCount() const = 0;
     virtual uint32_t getRtxPacingQueueCount() const = 0;
     virtual uint64_t getRtt() const = 0;
+    virtual SrtpClient::Profile getSrtpProfile() const = 0;
+    // time from receive to send of forwarded RTP sent since the previous call
+    virtual utils::LatencyHistogram::Snapshot collectForwardLatency() = 0;
     virtual PacketCounters getCumulativeReceiveCounters(uint32_t ssrc) const = 0;
     virtual PacketCounters getCumulativeAudioReceiveCounters() const = 0;
     virtual PacketCounters getCumulativeVideoReceiveCounters() const = 0;
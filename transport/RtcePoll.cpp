@@ -1,4 +1,6 @@
 #include "RtcePoll.h"
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <fcntl.h>
 #include <netdb.h>
@@ -8,12 +10,17 @@
 #include <sys/event.h>
 #else
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
 #endif
 #include "concurrency/SafeQueue.h"
 #include "concurrency/ThreadUtils.h"
 #include "logger/Logger.h"
+#include "utils/Time.h"
+#include "utils/Trackers.h"
 #include <ifaddrs.h>
+#include <mutex>
 #include <net/if.h>
+#include <sys/resource.h>
 #include <sys/socket.h>
 #include <thread>
 #include <unordered_map>
@@ -34,8 +41,11 @@ public:
     bool remove(int fd, RtcePoll::IEventListener* listener) override;
     bool isRunning() const override { return _running; }
 
+    std::vector<ThreadMetrics> getThreadMetrics(uint64_t timestamp) const override;
+
 private:
     int _kernel_fd;
+    int _wakeupFd;
 #ifdef __APPLE__
     std::vector<struct kevent> _firedEvents;
 #else
@@ -45,6 +55,7 @@ private:
     bool listenSocketEvents(RtcePoll::IEventListener* listener, int fd);
     bool unlistenSocketEvents(int fd);
     void awaitSocketEvents(int64_t timeoutMs);
+    void wakeUp();
 
     struct SocketRegistration
     {
@@ -64,12 +75,21 @@ private:
 
     concurrency::LockFullQueue<SocketRegistration, 2500> _pendingRegistrations;
     std::unordered_map<int, SocketRegistration> _monitoredSockets;
+    std::atomic_uint32_t _socketCount;
+    utils::RateTracker<10> _eventRate;
 
     std::atomic_bool _running;
     std::unique_ptr<std::thread> _networkThread;
 };
 
-RtcePollImpl::RtcePollImpl() : _kernel_fd(-1), _firedEvents(100), _running(false), _networkThread(nullptr)
+RtcePollImpl::RtcePollImpl()
+    : _kernel_fd(-1),
+      _wakeupFd(-1),
+      _firedEvents(100),
+      _socketCount(0),
+      _eventRate(utils::Time::ms * 100),
+      _running(false),
+      _networkThread(nullptr)
 {
     _monitoredSockets.reserve(1000);
 #ifdef __APPLE__
@@ -83,6 +103,25 @@ RtcePollImpl::RtcePollImpl() : _kernel_fd(-1), _firedEvents(100), _running(false
         return; // failed to init
     }
 
+    // wakes the Rtce thread when registrations are queued
+#ifdef __APPLE__
+    struct kevent userEvent;
+    EV_SET(&userEvent, 0, EVFILT_USER, EV_ADD | EV_CLEAR, 0, 0, nullptr);
+    if (0 != kevent(_kernel_fd, &userEvent, 1, nullptr, 0, nullptr))
+    {
+        logger::warn("failed to add wakeup event, err %d", "RtcePoll", errno);
+    }
+#else
+    _wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    struct epoll_event wakeupEvent;
+    wakeupEvent.events = EPOLLIN;
+    wakeupEvent.data.ptr = nullptr;
+    if (_wakeupFd == -1 || epoll_ctl(_kernel_fd, EPOLL_CTL_ADD, _wakeupFd, &wakeupEvent))
+    {
+        logger::warn("failed to add wakeup event, err %d", "RtcePoll", errno);
+    }
+#endif
+
     _running = true;
     _networkThread = std::make_unique<std::thread>([this]() { this->run(); });
 }
@@ -97,14 +136,32 @@ RtcePollImpl::~RtcePollImpl()
     {
         ::close(_kernel_fd);
     }
+    if (_wakeupFd != -1)
+    {
+        ::close(_wakeupFd);
+    }
 }
 
 void RtcePollImpl::stop()
 {
     _running = false;
+    wakeUp();
     _networkThread->join();
 }
 
+void RtcePollImpl::wakeUp()
+{
+#ifdef __APPLE__
+    struct kevent userEvent;
+    EV_SET(&userEvent, 0, EVFILT_USER, 0, NOTE_TRIGGER, 0, nullptr);
+    kevent(_kernel_fd, &userEvent, 1, nullptr, 0, nullptr);
+#else
+    const uint64_t one = 1;
+    auto rc = ::write(_wakeupFd, &one, sizeof(one));
+    (void)rc; // counter is full only if the Rtce thread is already awake
+#endif
+}
+
 bool RtcePollImpl::listenSocketEvents(RtcePoll::IEventListener* listener, int fd)
 {
     if (fd == -1)
@@ -208,10 +265,6 @@ void RtcePollImpl::run()
 
     while (_running)
     {
-        if (_monitoredSockets.empty())
-        {
-            _pendingRegistrations.waitForItems(5000);
-        }
         SocketRegistration message;
         while (_pendingRegistrations.pop(message))
         {
@@ -219,12 +272,14 @@ void RtcePollImpl::run()
             {
                 if (listenSocketEvents(message.listener, message.fd))
                 {
+                    _socketCount = _monitoredSockets.size();
                     message.listener->onSocketPollStarted(message.fd);
                 }
             }
             else
             {
                 unlistenSocketEvents(message.fd);
+                _socketCount = _monitoredSockets.size();
                 message.listener->onSocketPollStopped(message.fd);
             }
         }
@@ -233,10 +288,7 @@ void RtcePollImpl::run()
     }
 }
 
-/*
-    On Mac we could add a user event to wake it up when there are pending registrations.
-    But it does not seem to be that easy on linux unless you create some in mem file and close it.
-*/
+// Registrations and stop wake the thread through the user event on Mac and an eventfd on linux.
 void RtcePollImpl::awaitSocketEvents(int64_t timeoutMs)
 {
 #ifdef __APPLE__
@@ -248,11 +300,19 @@ void RtcePollImpl::awaitSocketEvents(int64_t timeoutMs)
 #else
     auto event_count = epoll_wait(_kernel_fd, _firedEvents.data(), _firedEvents.size(), timeoutMs);
 #endif
+    if (event_count > 0)
+    {
+        _eventRate.update(event_count, utils::Time::getAbsoluteTime());
+    }
     for (int i = 0; i < event_count; ++i)
     {
         auto& event = _firedEvents[i];
 #ifdef __APPLE__
-        if (event.filter == EVFILT_READ)
+        if (event.filter == EVFILT_USER)
+        {
+            continue;
+        }
+        else if (event.filter == EVFILT_READ)
         {
             if ((event.flags & EV_EOF) == EV_EOF)
             {
@@ -277,6 +337,13 @@ void RtcePollImpl::awaitSocketEvents(int64_t timeoutMs)
 #else
         // on linux the hup event is signalled after readable if client calls recv on socket if at all
         auto socketRegistration = reinterpret_cast<const SocketRegistration*>(event.data.ptr);
+        if (!socketRegistration)
+        {
+            uint64_t wakeups = 0;
+            auto rc = ::read(_wakeupFd, &wakeups, sizeof(wakeups));
+            (void)rc;
+            continue;
+        }
 
         if ((event.events & EPOLLIN) == EPOLLIN)
         {
@@ -312,18 +379,205 @@ void RtcePollImpl::awaitSocketEvents(int64_t timeoutMs)
 
 bool RtcePollImpl::add(int fd, RtcePoll::IEventListener* listener)
 {
-    return _pendingRegistrations.push(SocketRegistration{true, listener, fd});
+    if (!_pendingRegistrations.push(SocketRegistration{true, listener, fd}))
+    {
+        return false;
+    }
+    wakeUp();
+    return true;
 }
 
 // You must await the notifyClosed callback after this
 bool RtcePollImpl::remove(int fd, RtcePoll::IEventListener* listener)
 {
-    return _pendingRegistrations.push(SocketRegistration{false, listener, fd});
+    if (!_pendingRegistrations.push(SocketRegistration{false, listener, fd}))
+    {
+        return false;
+    }
+    wakeUp();
+    return true;
+}
+
+std::vector<RtcePoll::ThreadMetrics> RtcePollImpl::getThreadMetrics(const uint64_t timestamp) const
+{
+    ThreadMetrics metrics;
+    metrics.sockets = _socketCount;
+    metrics.eventsPerSecond = _eventRate.get(timestamp, utils::Time::sec) * utils::Time::sec;
+    return {metrics};
 }
 
+class RtcePollGroup : public RtcePoll
+{
+public:
+    explicit RtcePollGroup(std::vector<std::unique_ptr<RtcePoll>> polls)
+        : _polls(std::move(polls)),
+          _sendsDatagrams(false),
+          _fdTableSize(getFdTableSize()),
+          _pollByFd(new std::atomic_uint8_t[_fdTableSize]()),
+          _assignedSockets(_polls.size(), 0)
+    {
+        assert(_polls.size() < 0xFF);
+        for (auto& poll : _polls)
+        {
+            _sendsDatagrams |= poll->canSendDatagrams();
+        }
+    }
+
+    void run() override {}
+
+    void stop() override
+    {
+        for (auto& poll : _polls)
+        {
+            poll->stop();
+        }
+    }
+
+    bool isRunning() const override
+    {
+        return std::all_of(_polls.cbegin(), _polls.cend(), [](const std::unique_ptr<RtcePoll>& poll) {
+            return poll->isRunning();
+        });
+    }
+
+    bool add(int fd, RtcePoll::IEventListener* listener) override
+    {
+        std::lock_guard<std::mutex> locker(_lock);
+        auto it = _assignments.find(fd);
+        if (it != _assignments.end())
+        {
+            return _polls[it->second]->add(fd, listener);
+        }
+
+        const auto index = selectPoll();
+        if (!_polls[index]->add(fd, listener))
+        {
+            return false;
+        }
+        _assignments.emplace(fd, index);
+        setPollIndex(fd, index + 1);
+        ++_assignedSockets[index];
+        return true;
+    }
+
+    bool remove(int fd, RtcePoll::IEventListener* listener) override
+    {
+        std::lock_guard<std::mutex> locker(_lock);
+        auto it = _assignments.find(fd);
+        if (it == _assignments.end())
+        {
+            return false;
+        }
+        const auto index = it->second;
+        _assignments.erase(it);
+        setPollIndex(fd, 0);
+        --_assignedSockets[index];
+        return _polls[index]->remove(fd, listener);
+    }
+
+    size_t sendDatagrams(int fd, OutboundDatagram* datagrams, size_t count) override
+    {
+        if (!_sendsDatagrams)
+        {
+            return 0;
+        }
+        return _polls[findPoll(fd)]->sendDatagrams(fd, datagrams, count);
+    }
+
+    bool canSendDatagrams() const override { return _sendsDatagrams; }
+
+    std::vector<ThreadMetrics> getThreadMetrics(uint64_t timestamp) const override
+    {
+        std::vector<ThreadMetrics> metrics;
+        for (auto& poll : _polls)
+        {
+            const auto pollMetrics = poll->getThreadMetrics(timestamp);
+            metrics.insert(metrics.end(), pollMetrics.cbegin(), pollMetrics.cend());
+        }
+        return metrics;
+    }
+
+private:
+    // least event rate first, then fewest sockets. Sockets are counted here as the poll threads pick them up later.
+    size_t selectPoll() const
+    {
+        const auto timestamp = utils::Time::getAbsoluteTime();
+        size_t bestIndex = 0;
+        double bestRate = 0;
+        for (size_t i = 0; i < _polls.size(); ++i)
+        {
+            double eventRate = 0;
+            for (const auto& metrics : _polls[i]->getThreadMetrics(timestamp))
+            {
+                eventRate += metrics.eventsPerSecond;
+            }
+
+            if (i == 0 || eventRate < bestRate ||
+                (eventRate == bestRate && _assignedSockets[i] < _assignedSockets[bestIndex]))
+            {
+                bestRate = eventRate;
+                bestIndex = i;
+            }
+        }
+        return bestIndex;
+    }
+
+    // one byte per descriptor up to the open file limit
+    static size_t getFdTableSize()
+    {
+        const size_t maxTableSize = 1024 * 1024;
+        rlimit limit;
+        if (getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur == RLIM_INFINITY)
+        {
+            return maxTableSize;
+        }
+        return std::min(maxTableSize, static_cast<size_t>(limit.rlim_cur));
+    }
+
+    // caller holds the lock
+    void setPollIndex(int fd, size_t indexPlusOne)
+    {
+        if (fd >= 0 && static_cast<size_t>(fd) < _fdTableSize)
+        {
+            _pollByFd[fd].store(static_cast<uint8_t>(indexPlusOne), std::memory_order_release);
+        }
+    }
+
+    // Lock free for descriptors in the table. Descriptors above the limit at start are looked up under the lock.
+    size_t findPoll(int fd)
+    {
+        if (fd >= 0 && static_cast<size_t>(fd) < _fdTableSize)
+        {
+            const auto indexPlusOne = _pollByFd[fd].load(std::memory_order_acquire);
+            return indexPlusOne == 0 ? 0 : indexPlusOne - 1;
+        }
+
+        std::lock_guard<std::mutex> locker(_lock);
+        auto it = _assignments.find(fd);
+        return it == _assignments.end() ? 0 : it->second;
+    }
+
+    std::vector<std::unique_ptr<RtcePoll>> _polls;
+    bool _sendsDatagrams;
+    std::mutex _lock;
+    std::unordered_map<int, size_t> _assignments;
+    const size_t _fdTableSize;
+    std::unique_ptr<std::atomic_uint8_t[]> _pollByFd;
+    std::vector<uint32_t> _assignedSockets;
+};
+
 std::unique_ptr<RtcePoll> createRtcePoll()
 {
     return std::make_unique<RtcePollImpl>();
 }
 
+std::unique_ptr<RtcePoll> createRtcePollGroup(std::vector<std::unique_ptr<RtcePoll>> polls)
+{
+    if (polls.size() == 1)
+    {
+        return std::move(polls.front());
+    }
+    return std::make_unique<RtcePollGroup>(std::move(polls));
+}
+
 } // namespace transport
\ No newline at end of file
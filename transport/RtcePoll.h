@@ -1,5 +1,9 @@
 #pragma once
+#include "memory/PacketPoolAllocator.h"
+#include "utils/SocketAddress.h"
+#include <cstddef>
 #include <memory>
+#include <vector>
 namespace transport
 {
 
@@ -18,7 +22,25 @@ public:
         virtual void onSocketReadable(int fd) = 0;
         virtual void onSocketWriteable(int fd) = 0;
         virtual void onSocketShutdown(int fd) = 0;
+
+        // Backends that receive on behalf of datagram sockets deliver the packets to onSocketDatagram instead of
+        // signalling readable, if the listener accepts it.
+        virtual bool isDatagramReceiver() const { return false; }
+        virtual void onSocketDatagram(int fd, const SocketAddress& source, memory::UniquePacket packet) {}
+    };
+
+    struct OutboundDatagram
+    {
+        SocketAddress target;
+        memory::UniquePacket packet;
+    };
+
+    struct ThreadMetrics
+    {
+        uint32_t sockets = 0;
+        double eventsPerSecond = 0;
     };
+
     virtual ~RtcePoll() = default;
 
     virtual void run() = 0;
@@ -28,8 +50,31 @@ public:
     virtual bool remove(int fd, IEventListener* listener) = 0;
 
     virtual bool isRunning() const = 0;
+
+    /**
+     * Hands datagrams to the backend for sending on fd. Packets are moved out of the datagrams that were accepted.
+     * @return number of datagrams accepted from the start of the array. The caller sends the rest itself.
+     */
+    virtual size_t sendDatagrams(int fd, OutboundDatagram* datagrams, size_t count) { return 0; }
+    virtual bool canSendDatagrams() const { return false; }
+
+    // one entry per network thread
+    virtual std::vector<ThreadMetrics> getThreadMetrics(uint64_t timestamp) const = 0;
 };
 
 std::unique_ptr<RtcePoll> createRtcePoll();
 
-} // namespace transport
\ No newline at end of file
+/**
+ * Spreads sockets over several pollers, each with its own Rtce thread. A new socket goes to the poller with the
+ * lowest event rate, so a busy shared port does not delay the sockets on the other threads.
+ */
+std::unique_ptr<RtcePoll> createRtcePollGroup(std::vector<std::unique_ptr<RtcePoll>> polls);
+
+/**
+ * io_uring backend. Datagram sockets receive with recvmsg straight into packets from allocator and sends are
+ * submitted as batches of sendmsg operations. Other sockets use multishot poll.
+ * @return nullptr if io_uring is not available.
+ */
+std::unique_ptr<RtcePoll> createIoUringPoll(memory::PacketPoolAllocator& allocator);
+
+} // namespace transport
@@ -5,9 +5,12 @@
 #include "memory/PacketPoolAllocator.h"
 #include "rtp/RtcpHeader.h"
 #include "rtp/RtpHeader.h"
+#include "utils/Time.h"
 #include <arpa/inet.h>
+#include <algorithm>
 #include <cstdint>
 #include <sys/socket.h>
+#include <sys/uio.h>
 namespace transport
 {
 namespace
@@ -15,19 +18,12 @@ namespace
 class SendJob : public jobmanager::Job
 {
 public:
-    SendJob(TcpEndpoint& endpoint, memory::UniquePacket packet, const transport::SocketAddress& target)
-        : _endpoint(endpoint),
-          _packet(std::move(packet)),
-          _target(target)
-    {
-    }
+    explicit SendJob(TcpEndpoint& endpoint) : _endpoint(endpoint) {}
 
-    void run() override { _endpoint.internalSendTo(_target, std::move(_packet)); }
+    void run() override { _endpoint.internalSend(); }
 
 private:
     TcpEndpoint& _endpoint;
-    memory::UniquePacket _packet;
-    transport::SocketAddress _target;
 };
 
 class ContinueSendJob : public jobmanager::Job
@@ -142,7 +138,14 @@ TcpEndpoint::TcpEndpoint(jobmanager::JobManager& jobManager,
       _sendJobs(jobManager, 512),
       _allocator(allocator),
       _defaultListener(nullptr),
-      _epoll(epoll)
+      _epoll(epoll),
+      _sendQueue(1024),
+      _pendingBytes(0),
+      _droppedPackets(0),
+      _outputRing(new uint8_t[outputRingSize]),
+      _ringHead(0),
+      _ringTail(0),
+      _videoFramePacketCount(0)
 {
     logger::info("accepted %s-%s", _name.c_str(), localPort.toString().c_str(), peerPort.toString().c_str());
 }
@@ -159,7 +162,14 @@ TcpEndpoint::TcpEndpoint(jobmanager::JobManager& jobManager,
       _sendJobs(jobManager, 512),
       _allocator(allocator),
       _defaultListener(nullptr),
-      _epoll(epoll)
+      _epoll(epoll),
+      _sendQueue(1024),
+      _pendingBytes(0),
+      _droppedPackets(0),
+      _outputRing(new uint8_t[outputRingSize]),
+      _ringHead(0),
+      _ringTail(0),
+      _videoFramePacketCount(0)
 {
     int rc = _socket.open(localInterface, 0, SOCK_STREAM);
     if (rc)
@@ -227,33 +237,61 @@ void TcpEndpoint::sendStunTo(const transport::SocketAddress& target,
 
 void TcpEndpoint::sendTo(const transport::SocketAddress& target, memory::UniquePacket packet)
 {
+    if (!packet)
+    {
+        return;
+    }
+
     assert(!memory::PacketPoolAllocator::isCorrupt(packet.get()));
     if (_state == State::CONNECTING || _state == State::CONNECTED)
     {
-        if (!_sendJobs.addJob<SendJob>(*this, std::move(packet), target))
+        const auto framedLength = packet->getLength() + sizeof(uint16_t);
+        _pendingBytes.fetch_add(framedLength);
+        if (!_sendQueue.push(std::move(packet)))
         {
-            logger::warn("failed to add SendJob", _name.c_str());
+            _pendingBytes.fetch_sub(framedLength);
+            ++_droppedPackets;
+            logger::warn("send queue full", _name.c_str());
+            return;
+        }
+
+        if (!_pendingSend.test_and_set())
+        {
+            if (!_sendJobs.addJob<SendJob>(*this))
+            {
+                _pendingSend.clear();
+                logger::warn("failed to add SendJob", _name.c_str());
+            }
         }
     }
 }
 
-void TcpEndpoint::internalSendTo(const transport::SocketAddress& target, memory::UniquePacket packet)
+void TcpEndpoint::internalSend()
 {
+    _pendingSend.clear(); // intend to send all
     if (_state == State::CONNECTING)
     {
-        if (!_pendingStunRequest)
-        {
-            _pendingStunRequest = std::move(packet);
-        }
-        else
+        for (memory::UniquePacket packet; _sendQueue.pop(packet);)
         {
-            logger::warn("discarding pending packet on tcp endpoint", _name.c_str());
+            if (!_pendingStunRequest)
+            {
+                _pendingStunRequest = std::move(packet);
+            }
+            else
+            {
+                logger::warn("discarding pending packet on tcp endpoint", _name.c_str());
+                discardPacket(*packet);
+            }
         }
         return;
     }
     else if (_state != State::CONNECTED)
     {
-        logger::debug("discarding packet. Socket not open", _name.c_str());
+        for (memory::UniquePacket packet; _sendQueue.pop(packet);)
+        {
+            logger::debug("discarding packet. Socket not open", _name.c_str());
+            discardPacket(*packet);
+        }
         return;
     }
 
@@ -262,7 +300,18 @@ void TcpEndpoint::internalSendTo(const transport::SocketAddress& target, memory:
         continueSend();
     }
 
-    sendPacket(*packet);
+    for (memory::UniquePacket packet; _sendQueue.pop(packet);)
+    {
+        if (shouldDropVideoFrame(*packet) || !appendToOutputRing(*packet))
+        {
+            discardPacket(*packet);
+        }
+        else if (getOutputRingLevel() >= flushRingLevel)
+        {
+            flushOutputRing();
+        }
+    }
+    flushOutputRing();
 }
 
 void TcpEndpoint::continueSend()
@@ -271,59 +320,153 @@ void TcpEndpoint::continueSend()
     if (_pendingStunRequest && _state == State::CONNECTED)
     {
         // stun requests are always created on own allocator in SendStunRequest
-        sendPacket(*_pendingStunRequest);
-
+        if (!appendToOutputRing(*_pendingStunRequest))
+        {
+            discardPacket(*_pendingStunRequest);
+        }
         _pendingStunRequest.reset();
+        flushOutputRing();
     }
 }
 
-void TcpEndpoint::sendPacket(const memory::Packet& packet)
+bool TcpEndpoint::appendToOutputRing(const memory::Packet& packet)
 {
-    if (_remainder.getLength() > 0)
+    const auto framedLength = packet.getLength() + sizeof(uint16_t);
+    if (outputRingSize - getOutputRingLevel() < framedLength)
     {
-        size_t bytesSent;
-        auto rc = _socket.sendAggregate(_remainder.get(), _remainder.getLength(), bytesSent);
-        if (bytesSent < _remainder.getLength())
+        flushOutputRing();
+        if (outputRingSize - getOutputRingLevel() < framedLength)
         {
-            std::memmove(_remainder.get(),
-                reinterpret_cast<uint8_t*>(_remainder.get()) + bytesSent,
-                _remainder.getLength() - bytesSent);
-            _remainder.setLength(_remainder.getLength() - bytesSent);
-            logger::warn("discarding packet, err %d %s", _name.c_str(), rc, _socket.explain(rc));
-            return;
+            logger::debug("output ring full, %zu bytes pending", _name.c_str(), getOutputRingLevel());
+            return false;
         }
-        else
+    }
+
+    nwuint16_t shim(packet.getLength());
+    writeToOutputRing(&shim, sizeof(shim));
+    writeToOutputRing(packet.get(), packet.getLength());
+    return true;
+}
+
+void TcpEndpoint::writeToOutputRing(const void* data, const size_t length)
+{
+    const auto tailIndex = _ringTail % outputRingSize;
+    const auto firstLength = std::min(length, outputRingSize - tailIndex);
+    std::memcpy(_outputRing.get() + tailIndex, data, firstLength);
+    std::memcpy(_outputRing.get(), reinterpret_cast<const uint8_t*>(data) + firstLength, length - firstLength);
+    _ringTail += length;
+}
+
+// Writes as much of the ring as the socket takes in one sendmsg. The remainder stays in the ring until the
+// socket signals writeable again.
+void TcpEndpoint::flushOutputRing()
+{
+    const auto level = getOutputRingLevel();
+    if (level == 0)
+    {
+        return;
+    }
+
+    const auto headIndex = _ringHead % outputRingSize;
+    const auto firstLength = std::min(level, outputRingSize - headIndex);
+    const struct iovec buffers[2] = {{_outputRing.get() + headIndex, firstLength},
+        {_outputRing.get(), level - firstLength}};
+
+    size_t bytesSent = 0;
+    const auto rc = _socket.sendStream(buffers, level > firstLength ? 2 : 1, bytesSent);
+    _ringHead += bytesSent;
+    _pendingBytes.fetch_sub(bytesSent);
+    if (_ringHead == _ringTail)
+    {
+        // keep the next flush in one contiguous buffer
+        _ringHead = 0;
+        _ringTail = 0;
+    }
+
+    if (rc != 0 && rc != EAGAIN && rc != EWOULDBLOCK)
+    {
+        logger::debug("send failed, %zu bytes pending, err %d %s", _name.c_str(), level, rc, _socket.explain(rc));
+    }
+}
+
+// The first packet of a frame decides whether the whole frame is dropped, so the receiver never gets a partial
+// frame from us. Only ssrcs that send frames of several packets, i.e. video, are dropped.
+bool TcpEndpoint::shouldDropVideoFrame(const memory::Packet& packet)
+{
+    if (!rtp::isRtpPacket(packet))
+    {
+        return false;
+    }
+    const auto* rtpHeader = rtp::RtpHeader::fromPacket(packet);
+    if (!rtpHeader)
+    {
+        return false;
+    }
+
+    const uint32_t ssrc = rtpHeader->ssrc;
+    const uint32_t timestamp = rtpHeader->timestamp;
+    VideoFrameState* frame = nullptr;
+    for (auto& state : _videoFrames)
+    {
+        if (state.lastUsed != 0 && state.ssrc == ssrc)
+        {
+            frame = &state;
+            break;
+        }
+    }
+    if (!frame)
+    {
+        frame = findEvictableVideoFrameState();
+        if (frame)
         {
-            _remainder.setLength(0);
+            *frame = VideoFrameState();
+            frame->ssrc = ssrc;
+            frame->timestamp = timestamp;
+            frame->lastUsed = ++_videoFramePacketCount;
         }
+        return false;
     }
 
-    size_t bytesSent = 0;
-    nwuint16_t shim(packet.getLength());
-    auto rc = _socket.sendAggregate(&shim, sizeof(uint16_t), packet.get(), packet.getLength(), bytesSent);
-    if (bytesSent <= 1)
+    frame->lastUsed = ++_videoFramePacketCount;
+    if (frame->timestamp == timestamp)
     {
-        auto data = reinterpret_cast<uint8_t*>(&shim);
-        _remainder.append(data + bytesSent, sizeof(shim) - bytesSent);
-        _remainder.append(packet.get(), packet.getLength());
-        logger::debug("partial packet sent %zu / %zu, err %d %s",
-            _name.c_str(),
-            bytesSent,
-            packet.getLength(),
-            rc,
-            _socket.explain(rc));
+        frame->multiPacketFrames = true;
+        return frame->dropping;
     }
-    else if (bytesSent < packet.getLength() + sizeof(shim))
+
+    frame->timestamp = timestamp;
+    frame->dropping = frame->multiPacketFrames && getOutputRingLevel() > saturatedRingLevel;
+    return frame->dropping;
+}
+
+// Least recently used state that is not dropping a frame, preferring ssrcs with single packet frames. Returns nullptr
+// if all states are dropping, in which case the new ssrc is not tracked.
+TcpEndpoint::VideoFrameState* TcpEndpoint::findEvictableVideoFrameState()
+{
+    VideoFrameState* candidate = nullptr;
+    for (auto& state : _videoFrames)
     {
-        bytesSent -= sizeof(uint16_t);
-        _remainder.append(packet.get() + bytesSent, packet.getLength() - bytesSent);
-        logger::debug("partial packet sent %zu / %zu, err %d %s",
-            _name.c_str(),
-            bytesSent,
-            packet.getLength(),
-            rc,
-            _socket.explain(rc));
+        if (state.lastUsed == 0)
+        {
+            return &state;
+        }
+        if (state.dropping)
+        {
+            continue;
+        }
+        if (!candidate || (candidate->multiPacketFrames && !state.multiPacketFrames) ||
+            (candidate->multiPacketFrames == state.multiPacketFrames && state.lastUsed < candidate->lastUsed))
+        {
+            candidate = &state;
+        }
     }
+    return candidate;
+}
+
+void TcpEndpoint::discardPacket(const memory::Packet& packet)
+{
+    _pendingBytes.fetch_sub(packet.getLength() + sizeof(uint16_t));
+    ++_droppedPackets;
 }
 
 // starts a sequence to
@@ -430,6 +573,15 @@ void TcpEndpoint::onSocketWriteable(int fd)
             logger::warn("failed to add ContinueSendJob", _name.c_str());
         }
     }
+    else if (fd == _depacketizer.fd && _state == State::CONNECTED && !_pendingSend.test_and_set())
+    {
+        // socket buffer has room again for what is left in the output ring
+        if (!_sendJobs.addJob<SendJob>(*this))
+        {
+            _pendingSend.clear();
+            logger::warn("failed to add SendJob", _name.c_str());
+        }
+    }
 }
 
 void TcpEndpoint::unregisterListener(IEvents* listener)
@@ -454,6 +606,7 @@ void TcpEndpoint::internalReceive(int fd)
         {
             break;
         }
+        packet->setReceiveTime(utils::Time::getAbsoluteTime());
 
         TcpEndpoint::IEvents* listener = _defaultListener;
         if (!listener)
@@ -1,10 +1,13 @@
 #pragma once
+#include "concurrency/MpmcQueue.h"
 #include "jobmanager/JobQueue.h"
 #include "memory/PacketPoolAllocator.h"
 #include "transport/Endpoint.h"
 #include "transport/RtcSocket.h"
 #include "transport/RtcePoll.h"
 #include "utils/SocketAddress.h"
+#include <array>
+#include <memory>
 
 namespace transport
 {
@@ -113,13 +116,17 @@ public:
         return EndpointMetrics(_receiveJobs.getCount(), 0.0, 0.0);
     }
 
+    // framed bytes accepted by sendTo and not yet written to the socket
+    size_t getPendingBytes() const { return _pendingBytes.load(std::memory_order_relaxed); }
+    uint32_t getDroppedPacketCount() const { return _droppedPackets.load(std::memory_order_relaxed); }
+
 public:
     // internal job interface
     // called on receiveJobs threads
     void internalReceive(int fd);
 
     // called on sendJobs threads
-    void internalSendTo(const transport::SocketAddress& target, memory::UniquePacket packet);
+    void internalSend();
     void continueSend();
     void internalUnregisterListener(IEvents* listener);
     void internalClosePort(int countDown);
@@ -138,7 +145,33 @@ private:
     void onSocketWriteable(int fd) override;
     void onSocketShutdown(int fd) override;
 
-    void sendPacket(const memory::Packet& packet);
+    // RFC 4571 framed packets are coalesced here and written with one sendmsg per flush
+    static const size_t outputRingSize = 128 * 1024;
+    // the ring is flushed when it reaches this level, so it only grows beyond it if the socket buffer is full
+    static const size_t flushRingLevel = outputRingSize / 8;
+    // when more than this is waiting for the socket, new video frames are dropped
+    static const size_t saturatedRingLevel = outputRingSize / 4;
+
+    // frame states of the most recently sent ssrcs. A state is only evicted when it is not dropping a frame, and
+    // states of ssrcs with multi packet frames are evicted after the others.
+    static const size_t videoFrameStateCount = 16;
+
+    struct VideoFrameState
+    {
+        uint32_t ssrc = 0;
+        uint32_t timestamp = 0;
+        uint64_t lastUsed = 0;
+        bool multiPacketFrames = false;
+        bool dropping = false;
+    };
+
+    bool appendToOutputRing(const memory::Packet& packet);
+    void writeToOutputRing(const void* data, size_t length);
+    void flushOutputRing();
+    size_t getOutputRingLevel() const { return _ringTail - _ringHead; }
+    bool shouldDropVideoFrame(const memory::Packet& packet);
+    VideoFrameState* findEvictableVideoFrameState();
+    void discardPacket(const memory::Packet& packet);
 
     jobmanager::JobQueue _receiveJobs;
     jobmanager::JobQueue _sendJobs;
@@ -150,7 +183,18 @@ private:
 
     RtcePoll& _epoll;
     memory::UniquePacket _pendingStunRequest;
-    memory::Packet _remainder;
+
+    concurrency::MpmcQueue<memory::UniquePacket> _sendQueue;
+    std::atomic_flag _pendingSend = ATOMIC_FLAG_INIT;
+    std::atomic_size_t _pendingBytes;
+    std::atomic_uint32_t _droppedPackets;
+
+    // accessed on sendJobs thread only. Head and tail are stream positions, the ring index is position % size.
+    std::unique_ptr<uint8_t[]> _outputRing;
+    size_t _ringHead;
+    size_t _ringTail;
+    std::array<VideoFrameState, videoFrameStateCount> _videoFrames;
+    uint64_t _videoFramePacketCount;
 };
 
 } // namespace transport
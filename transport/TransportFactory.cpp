@@ -6,7 +6,10 @@
 #include "transport/TcpEndpoint.h"
 #include "transport/TcpServerEndpoint.h"
 #include "transport/UdpEndpoint.h"
+#include "transport/XdpEndpoint.h"
 #include "utils/MersienneRandom.h"
+#include <set>
+#include <string>
 
 namespace transport
 {
@@ -49,13 +52,40 @@ public:
 #endif
         if (config.ice.singlePort != 0)
         {
+            // an interface queue takes one AF_XDP socket and one XDP program
+            std::set<std::string> xdpInterfaces;
             for (uint32_t portOffset = 0; portOffset < std::max(1u, config.ice.sharedPorts.get()); ++portOffset)
             {
                 _sharedEndpoints.push_back(std::vector<Endpoint*>());
                 for (SocketAddress portAddress : interfaces)
                 {
                     portAddress.setPort(config.ice.singlePort + portOffset);
-                    auto endPoint = new UdpEndpoint(jobManager, 1024, _mainAllocator, portAddress, _rtcePoll, true);
+                    const bool useXdp = config.ice.xdp && xdpInterfaces.insert(portAddress.getName()).second;
+                    if (config.ice.xdp && !useXdp)
+                    {
+                        logger::error("AF_XDP is already used on interface %s queue %u, %s uses a UDP socket",
+                            "TransportFactory",
+                            portAddress.getName().c_str(),
+                            config.ice.xdpQueue.get(),
+                            portAddress.toString().c_str());
+                    }
+                    UdpEndpoint* endPoint = useXdp
+                        ? createXdpEndpoint(jobManager,
+                              1024,
+                              _mainAllocator,
+                              portAddress,
+                              _rtcePoll,
+                              config.ice.xdpQueue,
+                              false)
+                        : new UdpEndpoint(jobManager, 1024, _mainAllocator, portAddress, _rtcePoll, true);
+
+                    if (endPoint->isGood() && !endPoint->openReceiveShards(config.ice.sharedPortSockets))
+                    {
+                        logger::warn("failed to open %u SO_REUSEPORT sockets on %s",
+                            "TransportFactory",
+                            config.ice.sharedPortSockets.get(),
+                            portAddress.toString().c_str());
+                    }
 
                     if (endPoint->isGood())
                     {
@@ -65,6 +95,18 @@ public:
                         {
                             logger::error("failed to set socket send buffer %d", "TransportFactory", errno);
                         }
+                        if (config.ice.udpSegmentationOffload)
+                        {
+                            endPoint->enableSegmentationOffload();
+                        }
+                        if (config.ice.udpReceiveOffload)
+                        {
+                            endPoint->enableReceiveOffload();
+                        }
+                        if (config.ice.receiveTimestamps)
+                        {
+                            endPoint->enableReceiveTimestamps();
+                        }
                         logger::info("opened main media port at %s",
                             "TransportFactory",
                             portAddress.toString().c_str());
@@ -227,6 +269,10 @@ public:
             logger::error("failed to set socket send buffer %d", "TransportFactory", errno);
             return false;
         }
+        if (_config.ice.receiveTimestamps)
+        {
+            rtpEndpoint->enableReceiveTimestamps();
+        }
 
         return true;
     }
@@ -263,6 +309,10 @@ public:
             logger::error("failed to set socket send buffer %d", "TransportFactory", errno);
             return false;
         }
+        if (_config.ice.receiveTimestamps)
+        {
+            rtpEndpoint->enableReceiveTimestamps();
+        }
 
         return true;
     }
@@ -419,6 +469,11 @@ public:
         return metrics;
     }
 
+    std::vector<RtcePoll::ThreadMetrics> getNetworkThreadMetrics() const override
+    {
+        return _rtcePoll.getThreadMetrics(utils::Time::getAbsoluteTime());
+    }
+
     bool isGood() const override { return _good; }
 
     void maintenance(uint64_t timestamp) override
@@ -2,6 +2,7 @@
 
 #include "memory/PacketPoolAllocator.h"
 #include "transport/EndpointMetrics.h"
+#include "transport/RtcePoll.h"
 #include "transport/ice/IceSession.h"
 #include <memory>
 
@@ -31,7 +32,6 @@ namespace transport
 
 class SrtpClientFactory;
 class RecordingTransport;
-class RtcePoll;
 class RtcTransport;
 class SocketAddress;
 
@@ -55,6 +55,7 @@ public:
         const uint8_t aesKey[32],
         const uint8_t salt[12]) = 0;
     virtual EndpointMetrics getSharedUdpEndpointsMetrics() const = 0;
+    virtual std::vector<RtcePoll::ThreadMetrics> getNetworkThreadMetrics() const = 0;
     virtual bool isGood() const = 0;
 
     virtual void maintenance(uint64_t timestamp) = 0;
@@ -68,6 +68,57 @@ private:
     void (TransportImpl::*_receiveMethod)(Endpoint&, const SocketAddress&, memory::UniquePacket packet, uint64_t);
 };
 
+// Holds a batch of RTCP packets from one endpoint as raw pointers to fit in a job.
+class RtcpBatchReceiveJob : public jobmanager::Job
+{
+public:
+    static const size_t maxBatchSize = 8;
+
+    RtcpBatchReceiveJob(TransportImpl& transport, memory::UniquePacket* packets, size_t count)
+        : _transport(transport),
+          _deleter(packets[0].get_deleter()),
+          _timestamp(utils::Time::getAbsoluteTime()),
+          _count(count)
+    {
+        assert(count <= maxBatchSize);
+        for (size_t i = 0; i < count; ++i)
+        {
+            _packets[i] = packets[i].release();
+        }
+    }
+
+    ~RtcpBatchReceiveJob()
+    {
+        for (size_t i = 0; i < _count; ++i)
+        {
+            if (_packets[i])
+            {
+                _deleter(_packets[i]);
+            }
+        }
+    }
+
+    void run() override
+    {
+        DBGCHECK_SINGLETHREADED(_transport._singleThreadMutex);
+
+        memory::UniquePacket packets[maxBatchSize];
+        for (size_t i = 0; i < _count; ++i)
+        {
+            packets[i] = memory::UniquePacket(_packets[i], _deleter);
+            _packets[i] = nullptr;
+        }
+        _transport.internalRtcpBatchReceived(packets, _count, _timestamp);
+    }
+
+private:
+    TransportImpl& _transport;
+    memory::PacketPoolAllocator::Deleter _deleter;
+    uint64_t _timestamp;
+    uint32_t _count;
+    memory::Packet* _packets[maxBatchSize];
+};
+
 class IceDisconnectJob : public jobmanager::Job
 {
 public:
@@ -905,19 +956,97 @@ void TransportImpl::onRtcpReceived(Endpoint& endpoint,
     }
 }
 
+// Packets are posted in jobs of up to RtcpBatchReceiveJob::maxBatchSize and unprotected together in the job.
+void TransportImpl::onRtcpBatchReceived(Endpoint& endpoint,
+    const SocketAddress& source,
+    const SocketAddress& target,
+    memory::UniquePacket* packets,
+    const size_t count)
+{
+    for (size_t i = 0; i < count; i += RtcpBatchReceiveJob::maxBatchSize)
+    {
+        const auto batchSize = std::min(count - i, RtcpBatchReceiveJob::maxBatchSize);
+        if (!_jobQueue.addJob<RtcpBatchReceiveJob>(*this, packets + i, batchSize))
+        {
+            logger::warn("job queue full RTCP", _loggableId.c_str());
+        }
+    }
+}
+
 void TransportImpl::internalRtcpReceived(Endpoint& endpoint,
     const SocketAddress& source,
     memory::UniquePacket packet,
     uint64_t timestamp)
+{
+    if (!isRtcpAccepted(*packet, timestamp))
+    {
+        return;
+    }
+
+    const auto now = std::chrono::system_clock::now();
+    const bool unprotected = unprotect(*packet);
+    onRtcpUnprotected(std::move(packet), unprotected, timestamp, now);
+}
+
+void TransportImpl::internalRtcpBatchReceived(memory::UniquePacket* packets, const size_t count, uint64_t timestamp)
+{
+    memory::Packet* batch[RtcpBatchReceiveJob::maxBatchSize];
+    size_t batchSize = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (isRtcpAccepted(*packets[i], timestamp))
+        {
+            packets[batchSize] = std::move(packets[i]);
+            batch[batchSize] = packets[batchSize].get();
+            ++batchSize;
+        }
+    }
+    if (batchSize == 0)
+    {
+        return;
+    }
+
+    const auto now = std::chrono::system_clock::now();
+    if (_srtpClient && _srtpClient->isInitialized())
+    {
+        _srtpClient->unprotect(batch, batchSize);
+    }
+    else
+    {
+        std::fill(batch, batch + batchSize, nullptr);
+    }
+
+    for (size_t i = 0; i < batchSize; ++i)
+    {
+        onRtcpUnprotected(std::move(packets[i]), batch[i] != nullptr, timestamp, now);
+    }
+}
+
+// Counts the packet and tells whether the transport is ready to handle RTCP.
+bool TransportImpl::isRtcpAccepted(const memory::Packet& packet, const uint64_t timestamp)
 {
     ++_inboundMetrics.packetCount;
-    _inboundMetrics.bytesCount += packet->getLength();
+    _inboundMetrics.bytesCount += packet.getLength();
     if (!_srtpClient->isDtlsConnected())
     {
         logger::debug("RTCP received, dtls not connected yet", _loggableId.c_str());
-        return;
+        return false;
+    }
+
+    if (!_dataReceiver.load())
+    {
+        return false;
     }
 
+    _bwe->onUnmarkedTraffic(packet.getLength(), timestamp);
+    return true;
+}
+
+void TransportImpl::onRtcpUnprotected(memory::UniquePacket packet,
+    const bool unprotected,
+    const uint64_t timestamp,
+    const std::chrono::system_clock::time_point& now)
+{
     auto* dataReceiver = _dataReceiver.load();
     if (!dataReceiver)
     {
@@ -925,11 +1054,7 @@ void TransportImpl::internalRtcpReceived(Endpoint& endpoint,
     }
 
     const auto receiveTime = timestamp;
-
-    _bwe->onUnmarkedTraffic(packet->getLength(), timestamp);
-
-    const auto now = std::chrono::system_clock::now();
-    if (unprotect(*packet) && rtp::isValidRtcpPacket(*packet))
+    if (unprotected && rtp::isValidRtcpPacket(*packet))
     {
         rtp::CompoundRtcpPacket compound(packet->get(), packet->getLength());
         for (auto& report : compound)
@@ -1512,14 +1637,64 @@ void TransportImpl::protectAndSend(memory::UniquePacket packet)
 
 void TransportImpl::protectAndSendRtp(uint64_t timestamp, memory::UniquePacket packet)
 {
-    const auto* rtpHeader = rtp::RtpHeader::fromPacket(*packet);
+    prepareRtpForSend(timestamp, *packet);
+    doProtectAndSend(timestamp, std::move(packet), _peerRtpPort, _selectedRtp);
+}
+
+// Protects the packets in one pass through the srtp context and queues them on the endpoint together
+void TransportImpl::protectAndSendRtp(uint64_t timestamp, memory::UniquePacket* packets, const size_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    assert(count <= maxSendBatchSize);
+    memory::Packet* protectBatch[maxSendBatchSize];
+    for (size_t i = 0; i < count; ++i)
+    {
+        prepareRtpForSend(timestamp, *packets[i]);
+        _outboundMetrics.bytesCount += packets[i]->getLength();
+        ++_outboundMetrics.packetCount;
+        assert(packets[i]->getLength() + 24 <= _config.mtu);
+        protectBatch[i] = packets[i].get();
+    }
+
+    if (!_selectedRtp)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            packets[i].reset();
+        }
+        return;
+    }
+
+    _srtpClient->protect(protectBatch, count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (protectBatch[i])
+        {
+            _sendRateTracker.update(packets[i]->getLength(), timestamp);
+        }
+        else
+        {
+            packets[i].reset();
+        }
+    }
+
+    _selectedRtp->sendMultipleTo(_peerRtpPort, packets, count);
+}
+
+void TransportImpl::prepareRtpForSend(uint64_t timestamp, memory::Packet& packet)
+{
+    const auto* rtpHeader = rtp::RtpHeader::fromPacket(packet);
     const auto payloadType = rtpHeader->payloadType;
     const auto isAudio = (payloadType <= 8 || payloadType == _audio.payloadType);
     const uint32_t rtpFrequency = isAudio ? _audio.rtpFrequency : 90000;
 
     if (_absSendTimeExtensionId)
     {
-        rtp::setTransmissionTimestamp(*packet, _absSendTimeExtensionId, timestamp);
+        rtp::setTransmissionTimestamp(packet, _absSendTimeExtensionId, timestamp);
     }
 
     auto& ssrcState = getOutboundSsrc(rtpHeader->ssrc, rtpFrequency);
@@ -1533,9 +1708,13 @@ void TransportImpl::protectAndSendRtp(uint64_t timestamp, memory::UniquePacket p
             ssrcState.getSentSequenceNumber() & 0xFFFFu);
     }
 
-    ssrcState.onRtpSent(timestamp, *packet);
-    _rateController.onRtpSent(timestamp, rtpHeader->ssrc, rtpHeader->sequenceNumber, packet->getLength());
-    doProtectAndSend(timestamp, std::move(packet), _peerRtpPort, _selectedRtp);
+    if (packet.getReceiveTime() != 0)
+    {
+        _forwardLatency.record(std::max(int64_t(0), utils::Time::diff(packet.getReceiveTime(), timestamp)));
+    }
+
+    ssrcState.onRtpSent(timestamp, packet);
+    _rateController.onRtpSent(timestamp, rtpHeader->ssrc, rtpHeader->sequenceNumber, packet.getLength());
 }
 
 // Send sender reports and receiver reports as needed for the inbound and outbound ssrcs.
@@ -1742,7 +1921,7 @@ void TransportImpl::appendRemb(memory::Packet& rtcpPacket,
         remb.addSsrc(activeInbound[i]);
     }
     rtcpPacket.setLength(rtcpPacket.getLength() + remb.header.size());
-    assert(!memory::PacketPoolAllocator::isCorrupt(rtcpPacket.get()));
+    assert(!memory::PacketPoolAllocator::isCorrupt(&rtcpPacket));
 }
 
 void TransportImpl::sendRtcp(memory::UniquePacket rtcpPacket, const uint64_t timestamp)
@@ -2372,6 +2551,11 @@ uint64_t TransportImpl::getRtt() const
     return (static_cast<uint64_t>(_rttNtp) * utils::Time::sec) >> 16;
 }
 
+SrtpClient::Profile TransportImpl::getSrtpProfile() const
+{
+    return _srtpClient ? _srtpClient->getProfile() : SrtpClient::Profile::NONE;
+}
+
 void TransportImpl::setRtxProbeSource(const uint32_t ssrc, uint32_t* sequenceCounter, const uint16_t payloadType)
 {
     _rtxProbeSsrc = ssrc;
@@ -2390,16 +2574,22 @@ void TransportImpl::runTick(uint64_t timestamp)
 
 void TransportImpl::doRunTick(const uint64_t timestamp)
 {
+    memory::UniquePacket batch[maxSendBatchSize];
+    size_t batchCount = 0;
+
     if (!_config.rctl.enable || !_config.bwe.useUplinkEstimate)
     {
-        while (!_rtxPacingQueue.empty())
+        while (!_pacingQueue.empty() || !_rtxPacingQueue.empty())
         {
-            protectAndSendRtp(timestamp, _rtxPacingQueue.fetchBack());
-        }
-        while (!_pacingQueue.empty())
-        {
-            protectAndSendRtp(timestamp, _pacingQueue.fetchBack());
+            auto& pacingQueue = _rtxPacingQueue.empty() ? _pacingQueue : _rtxPacingQueue;
+            batch[batchCount++] = pacingQueue.fetchBack();
+            if (batchCount == maxSendBatchSize)
+            {
+                protectAndSendRtp(timestamp, batch, batchCount);
+                batchCount = 0;
+            }
         }
+        protectAndSendRtp(timestamp, batch, batchCount);
         _pacingInUse = false;
         return;
     }
@@ -2415,15 +2605,20 @@ void TransportImpl::doRunTick(const uint64_t timestamp)
 
         if (pacingQueue->back()->getLength() + _config.ipOverhead <= budget)
         {
-            memory::UniquePacket packet(pacingQueue->fetchBack());
-            budget -= packet->getLength() + _config.ipOverhead;
-            protectAndSendRtp(timestamp, std::move(packet));
+            batch[batchCount] = pacingQueue->fetchBack();
+            budget -= batch[batchCount]->getLength() + _config.ipOverhead;
+            if (++batchCount == maxSendBatchSize)
+            {
+                protectAndSendRtp(timestamp, batch, batchCount);
+                batchCount = 0;
+            }
         }
         else
         {
             break;
         }
     }
+    protectAndSendRtp(timestamp, batch, batchCount);
 
     sendPadding(timestamp);
 
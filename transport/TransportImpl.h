@@ -17,6 +17,7 @@
 #include "utils/Optional.h"
 #include "utils/SocketAddress.h"
 #include "utils/SsrcGenerator.h"
+#include <chrono>
 #include <cstdint>
 #include <iostream>
 #include <memory>
@@ -152,6 +153,8 @@ public: // Transport
     uint32_t getPacingQueueCount() const override;
     uint32_t getRtxPacingQueueCount() const override;
     uint64_t getRtt() const override;
+    SrtpClient::Profile getSrtpProfile() const override;
+    utils::LatencyHistogram::Snapshot collectForwardLatency() override { return _forwardLatency.collect(); }
     PacketCounters getCumulativeReceiveCounters(uint32_t ssrc) const override;
     PacketCounters getCumulativeAudioReceiveCounters() const override;
     PacketCounters getCumulativeVideoReceiveCounters() const override;
@@ -200,6 +203,12 @@ public: // end point callbacks
         const SocketAddress& target,
         memory::UniquePacket packet) override;
 
+    void onRtcpBatchReceived(Endpoint& endpoint,
+        const SocketAddress& source,
+        const SocketAddress& target,
+        memory::UniquePacket* packets,
+        size_t count) override;
+
     void onIceReceived(Endpoint& endpoint,
         const SocketAddress& source,
         const SocketAddress& target,
@@ -253,6 +262,7 @@ public: // end point callbacks
         const SocketAddress& source,
         memory::UniquePacket packet,
         uint64_t timestamp);
+    void internalRtcpBatchReceived(memory::UniquePacket* packets, size_t count, uint64_t timestamp);
 
     void onServerPortClosed(ServerEndpoint& endpoint) override {}
     void onServerPortUnregistered(ServerEndpoint& endpoint) override;
@@ -263,7 +273,18 @@ private:
     friend class ConnectSctpJob;
     friend class RunTickJob;
 
+    // paced packets are protected and handed to the endpoint in batches of up to this size
+    static const size_t maxSendBatchSize = 32;
+
+    bool isRtcpAccepted(const memory::Packet& packet, uint64_t timestamp);
+    void onRtcpUnprotected(memory::UniquePacket packet,
+        bool unprotected,
+        uint64_t timestamp,
+        const std::chrono::system_clock::time_point& now);
+
+    void prepareRtpForSend(uint64_t timestamp, memory::Packet& packet);
     void protectAndSendRtp(uint64_t timestamp, memory::UniquePacket packet);
+    void protectAndSendRtp(uint64_t timestamp, memory::UniquePacket* packets, size_t count);
     void doProtectAndSend(uint64_t timestamp,
         memory::UniquePacket packet,
         const SocketAddress& target,
@@ -352,6 +373,7 @@ private:
     ChannelMetrics _outboundMetrics;
     uint32_t _outboundRembEstimateKbps;
     utils::RateTracker<10> _sendRateTracker; // B/ns
+    utils::LatencyHistogram _forwardLatency;
     uint64_t _lastLogTimestamp;
     std::atomic_uint32_t _rttNtp;
 
@@ -1,5 +1,6 @@
 #pragma once
 #include "utils/StdExtensions.h"
+#include <algorithm>
 #include <cinttypes>
 
 namespace transport
@@ -11,6 +12,7 @@ struct TransportStats
         std::memset(&lossGroup, 0, std::size(lossGroup) * sizeof(uint16_t));
         std::memset(&rttGroup, 0, std::size(rttGroup) * sizeof(uint16_t));
         std::memset(&bandwidthEstimateGroup, 0, 10 * sizeof(uint16_t));
+        std::memset(&srtpProfileGroup, 0, std::size(srtpProfileGroup) * sizeof(uint16_t));
     }
 
     TransportStats& operator+=(const TransportStats& b)
@@ -24,6 +26,10 @@ struct TransportStats
         {
             bandwidthEstimateGroup[i] += b.bandwidthEstimateGroup[i];
         }
+        for (size_t i = 0; i < std::size(srtpProfileGroup); ++i)
+        {
+            srtpProfileGroup[i] += b.srtpProfileGroup[i];
+        }
         return *this;
     }
 
@@ -72,8 +78,14 @@ struct TransportStats
         ++bandwidthEstimateGroup[std::size(bandwidthEstimateGroup) - 1];
     }
 
+    void addSrtpProfileGroup(size_t profile)
+    {
+        ++srtpProfileGroup[std::min(profile, std::size(srtpProfileGroup) - 1)];
+    }
+
     uint16_t lossGroup[6]; // < 0,1,2,4,8, 100%
     uint16_t rttGroup[6]; // < 0.1, 0.2, 0.4, 0.8, 1.6, longer
     uint16_t bandwidthEstimateGroup[10]; // < 125k, 250k, 500k, 1M, 2M, 4M, 8M, 16M, 32M, more
+    uint16_t srtpProfileGroup[5]; // none, aes128 cm sha1 80, aes128 cm sha1 32, aead aes128 gcm, aead aes256 gcm
 };
 } // namespace transport
\ No newline at end of file
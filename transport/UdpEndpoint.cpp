@@ -15,15 +15,21 @@ using namespace transport;
 class UnRegisterListenerJob : public jobmanager::Job
 {
 public:
-    UnRegisterListenerJob(UdpEndpoint& endpoint, Endpoint::IEvents* listener) : _endpoint(endpoint), _listener(listener)
+    UnRegisterListenerJob(UdpEndpoint& endpoint,
+        Endpoint::IEvents* listener,
+        const std::shared_ptr<std::atomic_uint32_t>& pendingQueues)
+        : _endpoint(endpoint),
+          _listener(listener),
+          _pendingQueues(pendingQueues)
     {
     }
 
-    void run() override { _endpoint.internalUnregisterListener(_listener); }
+    void run() override { _endpoint.internalUnregisterListener(_listener, *_pendingQueues); }
 
 private:
     UdpEndpoint& _endpoint;
     Endpoint::IEvents* _listener;
+    std::shared_ptr<std::atomic_uint32_t> _pendingQueues;
 };
 
 class UnRegisterStunListenerJob : public jobmanager::Job
@@ -51,7 +57,18 @@ UdpEndpoint::UdpEndpoint(jobmanager::JobManager& jobManager,
     const SocketAddress& localPort,
     RtcePoll& epoll,
     bool isShared)
-    : BaseUdpEndpoint("UdpEndpoint", jobManager, maxSessionCount, allocator, localPort, epoll, isShared),
+    : UdpEndpoint("UdpEndpoint", jobManager, maxSessionCount, allocator, localPort, epoll, isShared)
+{
+}
+
+UdpEndpoint::UdpEndpoint(const char* name,
+    jobmanager::JobManager& jobManager,
+    size_t maxSessionCount,
+    memory::PacketPoolAllocator& allocator,
+    const SocketAddress& localPort,
+    RtcePoll& epoll,
+    bool isShared)
+    : BaseUdpEndpoint(name, jobManager, maxSessionCount, allocator, localPort, epoll, isShared),
       _iceListeners(maxSessionCount * 2),
       _dtlsListeners(maxSessionCount * 16),
       _iceResponseListeners(maxSessionCount * 64)
@@ -86,11 +103,23 @@ void UdpEndpoint::sendStunTo(const transport::SocketAddress& target,
     sendTo(target, memory::makeUniquePacket(_allocator, data, len));
 }
 
+// With receive shards the listener may be in use on any of the receive queues. Each queue removes it and the last
+// one to do so reports it unregistered.
 void UdpEndpoint::unregisterListener(IEvents* listener)
 {
-    if (!_receiveJobs.addJob<UnRegisterListenerJob>(*this, listener))
+    auto pendingQueues = std::make_shared<std::atomic_uint32_t>(1 + _shards.size());
+    if (!_receiveJobs.addJob<UnRegisterListenerJob>(*this, listener, pendingQueues))
     {
         logger::error("failed to post unregister job", _name.c_str());
+        pendingQueues->fetch_sub(1);
+    }
+    for (auto& shard : _shards)
+    {
+        if (!shard->receiveJobs.addJob<UnRegisterListenerJob>(*this, listener, pendingQueues))
+        {
+            logger::error("failed to post unregister job", _name.c_str());
+            pendingQueues->fetch_sub(1);
+        }
     }
 }
 
@@ -102,7 +131,7 @@ void UdpEndpoint::cancelStunTransaction(__uint128_t transactionId)
     }
 }
 
-void UdpEndpoint::internalUnregisterListener(IEvents* listener)
+void UdpEndpoint::internalUnregisterListener(IEvents* listener, std::atomic_uint32_t& pendingQueues)
 {
     // Hashmap allows erasing elements while iterating.
     logger::debug("unregister %p", _name.c_str(), listener);
@@ -130,7 +159,10 @@ void UdpEndpoint::internalUnregisterListener(IEvents* listener)
         }
     }
 
-    listener->onUnregistered(*this);
+    if (pendingQueues.fetch_sub(1) == 1)
+    {
+        listener->onUnregistered(*this);
+    }
 }
 
 void UdpEndpoint::internalUnregisterStunListener(__uint128_t transactionId)
@@ -238,6 +270,50 @@ void UdpEndpoint::dispatchReceivedPacket(const SocketAddress& srcAddress, memory
     // unexpected packet that can come from anywhere. We do not log as it facilitates DoS
 }
 
+// Consecutive RTCP packets from the same source are handed to their listener together, so it can unprotect them as a
+// batch. Everything else is dispatched one by one, and the order of the datagrams is kept.
+void UdpEndpoint::dispatchReceivedPackets(InboundPacket* datagrams, const size_t count)
+{
+    memory::UniquePacket rtcpBatch[inboundBatchSize];
+    size_t rtcpCount = 0;
+    IEvents* rtcpListener = nullptr;
+    SocketAddress rtcpSource;
+    for (size_t i = 0; i <= count; ++i)
+    {
+        IEvents* listener = nullptr;
+        if (i < count)
+        {
+            const auto& packet = *datagrams[i].packet;
+            if (rtp::isRtcpPacket(packet.get(), packet.getLength()) &&
+                rtp::RtcpReport::fromPtr(packet.get(), packet.getLength()))
+            {
+                listener = findListener(_dtlsListeners, datagrams[i].source);
+            }
+        }
+
+        if (rtcpCount > 0 && (!listener || listener != rtcpListener || datagrams[i].source != rtcpSource))
+        {
+            rtcpListener->onRtcpBatchReceived(*this, rtcpSource, _socket.getBoundPort(), rtcpBatch, rtcpCount);
+            rtcpCount = 0;
+        }
+        if (i == count)
+        {
+            break;
+        }
+
+        if (listener)
+        {
+            rtcpListener = listener;
+            rtcpSource = datagrams[i].source;
+            rtcpBatch[rtcpCount++] = std::move(datagrams[i].packet);
+        }
+        else
+        {
+            dispatchReceivedPacket(datagrams[i].source, std::move(datagrams[i].packet));
+        }
+    }
+}
+
 void UdpEndpoint::registerListener(const std::string& stunUserName, IEvents* listener)
 {
     _iceListeners.emplace(stunUserName, listener);
@@ -32,9 +32,20 @@ public:
 public: // internal job interface
     void dispatchReceivedPacket(const SocketAddress& srcAddress, memory::UniquePacket packet) override;
 
-    void internalUnregisterListener(IEvents* listener);
+    void internalUnregisterListener(IEvents* listener, std::atomic_uint32_t& pendingQueues);
     void internalUnregisterStunListener(__uint128_t transactionId);
 
+protected:
+    void dispatchReceivedPackets(InboundPacket* datagrams, size_t count) override;
+
+    UdpEndpoint(const char* name,
+        jobmanager::JobManager& jobManager,
+        size_t maxSessionCount,
+        memory::PacketPoolAllocator& allocator,
+        const SocketAddress& localPort,
+        RtcePoll& epoll,
+        bool isShared);
+
 private:
     concurrency::MpmcHashmap32<std::string, IEvents*> _iceListeners;
     concurrency::MpmcHashmap32<SocketAddress, IEvents*> _dtlsListeners;
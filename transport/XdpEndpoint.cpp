@@ -0,0 +1,1028 @@
+#include "transport/XdpEndpoint.h"
+#include "logger/Logger.h"
+#include "utils/Time.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+
+#if defined(__linux__) && __has_include(<linux/if_xdp.h>)
+#include <linux/bpf.h>
+#include <linux/if_ether.h>
+#include <linux/if_link.h>
+#include <linux/if_xdp.h>
+#include <net/if.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// unaligned chunks let the UMEM frames sit wherever the pool allocator put its packets, linux 5.4
+#if defined(XDP_UMEM_UNALIGNED_CHUNK_FLAG) && defined(XSK_UNALIGNED_BUF_OFFSET_SHIFT) && defined(BPF_JMP32)
+#define AF_XDP_SUPPORTED 1
+#endif
+
+namespace transport
+{
+namespace
+{
+const size_t ethernetHeaderLength = 14;
+const size_t ipv4HeaderLength = 20;
+const size_t ipv6HeaderLength = 40;
+const size_t udpHeaderLength = 8;
+
+uint32_t sumWords(const uint8_t* data, size_t length, uint32_t sum)
+{
+    for (; length > 1; data += 2, length -= 2)
+    {
+        uint16_t word;
+        std::memcpy(&word, data, sizeof(word));
+        sum += word;
+    }
+    if (length > 0)
+    {
+        uint16_t word = 0;
+        std::memcpy(&word, data, 1);
+        sum += word;
+    }
+    return sum;
+}
+
+// ones complement of the ones complement sum. The byte order of the words does not matter as long as the
+// result is stored in the same order.
+uint16_t finishChecksum(uint32_t sum)
+{
+    while (sum >> 16)
+    {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return ~static_cast<uint16_t>(sum);
+}
+
+void store16(uint8_t* data, uint16_t hostValue)
+{
+    const uint16_t value = htons(hostValue);
+    std::memcpy(data, &value, sizeof(value));
+}
+
+uint16_t read16(const uint8_t* data)
+{
+    uint16_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return ntohs(value);
+}
+} // namespace
+
+#ifdef AF_XDP_SUPPORTED
+
+namespace
+{
+int bpf(int command, bpf_attr& attributes)
+{
+    return syscall(__NR_bpf, command, &attributes, sizeof(attributes));
+}
+
+bpf_insn makeInstruction(uint8_t code, uint8_t dst, uint8_t src, int16_t offset, int32_t immediate)
+{
+    bpf_insn instruction;
+    std::memset(&instruction, 0, sizeof(instruction));
+    instruction.code = code;
+    instruction.dst_reg = dst;
+    instruction.src_reg = src;
+    instruction.off = offset;
+    instruction.imm = immediate;
+    return instruction;
+}
+
+int32_t load32(const void* data)
+{
+    int32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+/**
+ * XDP program that redirects UDP datagrams for the local port to the AF_XDP socket of the receive queue. Everything
+ * else, including IP fragments, IPv4 options, IPv6 extension headers and frames that would not fit in a pool packet,
+ * goes on to the kernel stack.
+ */
+class RedirectProgram
+{
+public:
+    RedirectProgram(const SocketAddress& localPort, int xskMapFd, size_t maxFrameLength)
+    {
+        const bool isIpv4 = (localPort.getFamily() == AF_INET);
+        const size_t headerLength =
+            ethernetHeaderLength + (isIpv4 ? ipv4HeaderLength : ipv6HeaderLength) + udpHeaderLength;
+        const uint8_t* destinationIp = isIpv4
+            ? reinterpret_cast<const uint8_t*>(&localPort.getIpv4()->sin_addr)
+            : reinterpret_cast<const uint8_t*>(&localPort.getIpv6()->sin6_addr);
+        const size_t ipLength = (isIpv4 ? 4 : 16);
+        const bool anyAddress = std::all_of(destinationIp, destinationIp + ipLength, [](uint8_t b) { return b == 0; });
+
+        // r2 = data, r3 = data_end
+        add(BPF_LDX | BPF_MEM | BPF_W, BPF_REG_2, BPF_REG_1, offsetof(xdp_md, data), 0);
+        add(BPF_LDX | BPF_MEM | BPF_W, BPF_REG_3, BPF_REG_1, offsetof(xdp_md, data_end), 0);
+        add(BPF_ALU64 | BPF_MOV | BPF_X, BPF_REG_4, BPF_REG_2, 0, 0);
+        add(BPF_ALU64 | BPF_ADD | BPF_K, BPF_REG_4, 0, 0, headerLength);
+        addPassJump(BPF_JMP | BPF_JGT | BPF_X, BPF_REG_4, BPF_REG_3, 0);
+        add(BPF_ALU64 | BPF_MOV | BPF_X, BPF_REG_4, BPF_REG_2, 0, 0);
+        add(BPF_ALU64 | BPF_ADD | BPF_K, BPF_REG_4, 0, 0, maxFrameLength + 1);
+        addPassJump(BPF_JMP | BPF_JLE | BPF_X, BPF_REG_4, BPF_REG_3, 0);
+
+        // constants are compared as loaded from the frame, i.e. in network byte order
+        addLoad(BPF_H, 12);
+        addPassJump(BPF_JMP32 | BPF_JNE | BPF_K, BPF_REG_5, 0, htons(isIpv4 ? ETH_P_IP : ETH_P_IPV6));
+        size_t destinationIpOffset = 0;
+        if (isIpv4)
+        {
+            addLoad(BPF_B, ethernetHeaderLength);
+            addPassJump(BPF_JMP32 | BPF_JNE | BPF_K, BPF_REG_5, 0, 0x45);
+            addLoad(BPF_B, ethernetHeaderLength + 9);
+            addPassJump(BPF_JMP32 | BPF_JNE | BPF_K, BPF_REG_5, 0, IPPROTO_UDP);
+            addLoad(BPF_H, ethernetHeaderLength + 6);
+            add(BPF_ALU64 | BPF_AND | BPF_K, BPF_REG_5, 0, 0, htons(0x3FFF));
+            addPassJump(BPF_JMP32 | BPF_JNE | BPF_K, BPF_REG_5, 0, 0);
+            destinationIpOffset = ethernetHeaderLength + 16;
+        }
+        else
+        {
+            addLoad(BPF_B, ethernetHeaderLength + 6);
+            addPassJump(BPF_JMP32 | BPF_JNE | BPF_K, BPF_REG_5, 0, IPPROTO_UDP);
+            destinationIpOffset = ethernetHeaderLength + 24;
+        }
+        for (size_t i = 0; !anyAddress && i < ipLength; i += 4)
+        {
+            addLoad(BPF_W, destinationIpOffset + i);
+            addPassJump(BPF_JMP32 | BPF_JNE | BPF_K, BPF_REG_5, 0, load32(destinationIp + i));
+        }
+        addLoad(BPF_H, headerLength - udpHeaderLength + 2);
+        addPassJump(BPF_JMP32 | BPF_JNE | BPF_K, BPF_REG_5, 0, htons(localPort.getPort()));
+
+        // return bpf_redirect_map(&xskMap, ctx->rx_queue_index, XDP_PASS)
+        add(BPF_LDX | BPF_MEM | BPF_W, BPF_REG_2, BPF_REG_1, offsetof(xdp_md, rx_queue_index), 0);
+        add(BPF_LD | BPF_DW | BPF_IMM, BPF_REG_1, BPF_PSEUDO_MAP_FD, 0, xskMapFd);
+        add(0, 0, 0, 0, 0);
+        add(BPF_ALU64 | BPF_MOV | BPF_K, BPF_REG_3, 0, 0, XDP_PASS);
+        add(BPF_JMP | BPF_CALL, 0, 0, 0, BPF_FUNC_redirect_map);
+        add(BPF_JMP | BPF_EXIT, 0, 0, 0, 0);
+
+        const auto passIndex = _instructions.size();
+        add(BPF_ALU64 | BPF_MOV | BPF_K, BPF_REG_0, 0, 0, XDP_PASS);
+        add(BPF_JMP | BPF_EXIT, 0, 0, 0, 0);
+        for (auto jumpIndex : _passJumps)
+        {
+            _instructions[jumpIndex].off = passIndex - jumpIndex - 1;
+        }
+    }
+
+    const bpf_insn* data() const { return _instructions.data(); }
+    size_t size() const { return _instructions.size(); }
+
+private:
+    void add(uint8_t code, uint8_t dst, uint8_t src, int16_t offset, int32_t immediate)
+    {
+        _instructions.push_back(makeInstruction(code, dst, src, offset, immediate));
+    }
+
+    // r5 = *(size *)(r2 + offset)
+    void addLoad(uint8_t size, size_t offset) { add(BPF_LDX | BPF_MEM | size, BPF_REG_5, BPF_REG_2, offset, 0); }
+
+    void addPassJump(uint8_t code, uint8_t dst, uint8_t src, int32_t immediate)
+    {
+        _passJumps.push_back(_instructions.size());
+        add(code, dst, src, 0, immediate);
+    }
+
+    std::vector<bpf_insn> _instructions;
+    std::vector<size_t> _passJumps;
+};
+
+} // namespace
+
+/**
+ * AF_XDP socket with its four rings. The fill and rx rings are used from the receive job, the tx and completion
+ * rings from the send job. Ring addresses are offsets into the UMEM, which is the region of the packet pool.
+ */
+class XdpSocket
+{
+public:
+    static const uint32_t ringSize = 1024;
+    static const uint32_t chunkSize = 2048; // smallest chunk size the kernel accepts
+    static const uint32_t frameHeadroom = XDP_PACKET_HEADROOM;
+
+    explicit XdpSocket(memory::PacketPoolAllocator& allocator)
+        : _allocator(allocator),
+          _fd(-1),
+          _xskMapFd(-1),
+          _programFd(-1),
+          _linkFd(-1)
+    {
+    }
+
+    ~XdpSocket()
+    {
+        for (int fd : {_linkFd, _programFd, _xskMapFd, _fd})
+        {
+            if (fd != -1)
+            {
+                ::close(fd);
+            }
+        }
+        for (auto* ring : {&_fill, &_completion, &_rx, &_tx})
+        {
+            ring->unmap();
+        }
+    }
+
+    bool open(const std::string& interfaceName,
+        uint32_t queueId,
+        bool genericMode,
+        const SocketAddress& localPort,
+        const char* loggableId)
+    {
+        const auto interfaceIndex = if_nametoindex(interfaceName.c_str());
+        if (interfaceIndex == 0)
+        {
+            logger::info("no interface '%s' for AF_XDP", loggableId, interfaceName.c_str());
+            return false;
+        }
+
+        _fd = ::socket(AF_XDP, SOCK_RAW, 0);
+        if (_fd < 0)
+        {
+            logger::info("AF_XDP socket not available, err %d", loggableId, errno);
+            return false;
+        }
+
+        // the kernel pins the UMEM pages, so the pool must not release any of them later
+        _allocator.commitRegion();
+        xdp_umem_reg umem;
+        std::memset(&umem, 0, sizeof(umem));
+        umem.addr = reinterpret_cast<uint64_t>(_allocator.getRegion());
+        umem.len = _allocator.getRegionSize();
+        umem.chunk_size = chunkSize;
+        umem.flags = XDP_UMEM_UNALIGNED_CHUNK_FLAG;
+        if (0 != setsockopt(_fd, SOL_XDP, XDP_UMEM_REG, &umem, sizeof(umem)))
+        {
+            logger::info("failed to register packet pool as UMEM, err %d", loggableId, errno);
+            return false;
+        }
+
+        const int size = ringSize;
+        for (int option : {XDP_UMEM_FILL_RING, XDP_UMEM_COMPLETION_RING, XDP_RX_RING, XDP_TX_RING})
+        {
+            if (0 != setsockopt(_fd, SOL_XDP, option, &size, sizeof(size)))
+            {
+                logger::info("failed to create AF_XDP ring, err %d", loggableId, errno);
+                return false;
+            }
+        }
+
+        xdp_mmap_offsets offsets;
+        socklen_t offsetsLength = sizeof(offsets);
+        if (0 != getsockopt(_fd, SOL_XDP, XDP_MMAP_OFFSETS, &offsets, &offsetsLength) ||
+            !_fill.map(_fd, offsets.fr, XDP_UMEM_PGOFF_FILL_RING, sizeof(uint64_t)) ||
+            !_completion.map(_fd, offsets.cr, XDP_UMEM_PGOFF_COMPLETION_RING, sizeof(uint64_t)) ||
+            !_rx.map(_fd, offsets.rx, XDP_PGOFF_RX_RING, sizeof(xdp_desc)) ||
+            !_tx.map(_fd, offsets.tx, XDP_PGOFF_TX_RING, sizeof(xdp_desc)))
+        {
+            logger::info("failed to map AF_XDP rings, err %d", loggableId, errno);
+            return false;
+        }
+
+        // The pool packets are not page aligned, which only copy mode can handle.
+        sockaddr_xdp address;
+        std::memset(&address, 0, sizeof(address));
+        address.sxdp_family = AF_XDP;
+        address.sxdp_flags = XDP_COPY;
+        address.sxdp_ifindex = interfaceIndex;
+        address.sxdp_queue_id = queueId;
+        if (0 != ::bind(_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)))
+        {
+            logger::info("failed to bind AF_XDP socket to %s queue %u, err %d",
+                loggableId,
+                interfaceName.c_str(),
+                queueId,
+                errno);
+            return false;
+        }
+
+        if (!loadProgram(queueId, localPort, loggableId))
+        {
+            return false;
+        }
+
+        for (const uint32_t mode : {XDP_FLAGS_DRV_MODE, XDP_FLAGS_SKB_MODE})
+        {
+            if (genericMode && mode != XDP_FLAGS_SKB_MODE)
+            {
+                continue;
+            }
+            bpf_attr attributes;
+            std::memset(&attributes, 0, sizeof(attributes));
+            attributes.link_create.prog_fd = _programFd;
+            attributes.link_create.target_ifindex = interfaceIndex;
+            attributes.link_create.attach_type = BPF_XDP;
+            attributes.link_create.flags = mode;
+            _linkFd = bpf(BPF_LINK_CREATE, attributes);
+            if (_linkFd >= 0)
+            {
+                logger::info("XDP program attached to %s in %s mode",
+                    loggableId,
+                    interfaceName.c_str(),
+                    mode == XDP_FLAGS_SKB_MODE ? "generic" : "driver");
+                return true;
+            }
+        }
+        logger::info("failed to attach XDP program to %s, err %d", loggableId, interfaceName.c_str(), errno);
+        return false;
+    }
+
+    int fd() const { return _fd; }
+
+    // Offset of the frame data in the UMEM. Unaligned mode keeps the headroom offset in the upper bits.
+    static uint64_t getFrameOffset(uint64_t address)
+    {
+        return (address & XSK_UNALIGNED_BUF_ADDR_MASK) + (address >> XSK_UNALIGNED_BUF_OFFSET_SHIFT);
+    }
+
+    uint32_t receive(xdp_desc* descriptors, uint32_t maxCount) { return _rx.consume(descriptors, maxCount); }
+    uint32_t getFillSpace() const { return _fill.getSpace(); }
+    bool isFillRingEmpty() const { return _fill.getSpace() == ringSize; }
+    void fill(const uint64_t* addresses, uint32_t count) { _fill.produce(addresses, count); }
+
+    uint32_t getTransmitSpace() const { return _tx.getSpace(); }
+    void transmit(const xdp_desc* descriptors, uint32_t count) { _tx.produce(descriptors, count); }
+    uint32_t complete(uint64_t* addresses, uint32_t maxCount) { return _completion.consume(addresses, maxCount); }
+
+    // Copy mode only sends when asked to and then a limited batch per call.
+    void kick()
+    {
+        for (int i = 0; i < 64 && _tx.getSpace() < ringSize; ++i)
+        {
+            if (::sendto(_fd, nullptr, 0, MSG_DONTWAIT, nullptr, 0) < 0 && errno != EAGAIN && errno != EBUSY &&
+                errno != ENOBUFS)
+            {
+                break;
+            }
+        }
+    }
+
+private:
+    bool loadProgram(uint32_t queueId, const SocketAddress& localPort, const char* loggableId)
+    {
+        bpf_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.map_type = BPF_MAP_TYPE_XSKMAP;
+        attributes.key_size = sizeof(uint32_t);
+        attributes.value_size = sizeof(int);
+        attributes.max_entries = queueId + 1;
+        _xskMapFd = bpf(BPF_MAP_CREATE, attributes);
+        if (_xskMapFd < 0)
+        {
+            logger::info("failed to create XSKMAP, err %d", loggableId, errno);
+            return false;
+        }
+
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.map_fd = _xskMapFd;
+        attributes.key = reinterpret_cast<uint64_t>(&queueId);
+        attributes.value = reinterpret_cast<uint64_t>(&_fd);
+        if (0 != bpf(BPF_MAP_UPDATE_ELEM, attributes))
+        {
+            logger::info("failed to add AF_XDP socket to XSKMAP, err %d", loggableId, errno);
+            return false;
+        }
+
+        RedirectProgram program(localPort, _xskMapFd, memory::Packet::size);
+        const char* license = "Apache-2.0";
+        char log[4096] = {0};
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.prog_type = BPF_PROG_TYPE_XDP;
+        attributes.expected_attach_type = BPF_XDP;
+        attributes.insns = reinterpret_cast<uint64_t>(program.data());
+        attributes.insn_cnt = program.size();
+        attributes.license = reinterpret_cast<uint64_t>(license);
+        attributes.log_buf = reinterpret_cast<uint64_t>(log);
+        attributes.log_size = sizeof(log);
+        attributes.log_level = 1;
+        _programFd = bpf(BPF_PROG_LOAD, attributes);
+        if (_programFd < 0)
+        {
+            logger::info("XDP program rejected, err %d %s", loggableId, errno, log);
+            return false;
+        }
+        return true;
+    }
+
+    // Single producer or single consumer ring shared with the kernel
+    class Ring
+    {
+    public:
+        Ring() : _producer(nullptr), _consumer(nullptr), _entries(nullptr), _map(nullptr), _mapSize(0) {}
+
+        bool map(int fd, const xdp_ring_offset& offsets, uint64_t pageOffset, size_t entrySize)
+        {
+            _mapSize = offsets.desc + ringSize * entrySize;
+            _map = mmap(nullptr, _mapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, pageOffset);
+            if (_map == MAP_FAILED)
+            {
+                _map = nullptr;
+                return false;
+            }
+            auto* base = reinterpret_cast<uint8_t*>(_map);
+            _producer = reinterpret_cast<uint32_t*>(base + offsets.producer);
+            _consumer = reinterpret_cast<uint32_t*>(base + offsets.consumer);
+            _entries = base + offsets.desc;
+            return true;
+        }
+
+        void unmap()
+        {
+            if (_map)
+            {
+                munmap(_map, _mapSize);
+                _map = nullptr;
+            }
+        }
+
+        uint32_t getSpace() const
+        {
+            return ringSize -
+                (__atomic_load_n(_producer, __ATOMIC_RELAXED) - __atomic_load_n(_consumer, __ATOMIC_ACQUIRE));
+        }
+
+        template <typename T>
+        void produce(const T* items, uint32_t count)
+        {
+            const auto producer = __atomic_load_n(_producer, __ATOMIC_RELAXED);
+            auto* entries = reinterpret_cast<T*>(_entries);
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                entries[(producer + i) & (ringSize - 1)] = items[i];
+            }
+            __atomic_store_n(_producer, producer + count, __ATOMIC_RELEASE);
+        }
+
+        template <typename T>
+        uint32_t consume(T* items, uint32_t maxCount)
+        {
+            const auto consumer = __atomic_load_n(_consumer, __ATOMIC_RELAXED);
+            const auto count = std::min(maxCount, __atomic_load_n(_producer, __ATOMIC_ACQUIRE) - consumer);
+            const auto* entries = reinterpret_cast<const T*>(_entries);
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                items[i] = entries[(consumer + i) & (ringSize - 1)];
+            }
+            __atomic_store_n(_consumer, consumer + count, __ATOMIC_RELEASE);
+            return count;
+        }
+
+    private:
+        uint32_t* _producer;
+        uint32_t* _consumer;
+        uint8_t* _entries;
+        void* _map;
+        size_t _mapSize;
+    };
+
+    memory::PacketPoolAllocator& _allocator;
+    int _fd;
+    int _xskMapFd;
+    int _programFd;
+    int _linkFd;
+    Ring _fill;
+    Ring _completion;
+    Ring _rx;
+    Ring _tx;
+};
+
+#else
+
+struct xdp_desc
+{
+    uint64_t addr;
+    uint32_t len;
+    uint32_t options;
+};
+
+class XdpSocket
+{
+public:
+    static const uint32_t ringSize = 1;
+    static const uint32_t chunkSize = 2048;
+    static const uint32_t frameHeadroom = 256;
+
+    explicit XdpSocket(memory::PacketPoolAllocator& allocator) {}
+    bool open(const std::string&, uint32_t, bool, const SocketAddress&, const char* loggableId)
+    {
+        logger::info("AF_XDP not supported on this platform", loggableId);
+        return false;
+    }
+    int fd() const { return -1; }
+    static uint64_t getFrameOffset(uint64_t address) { return address; }
+    uint32_t receive(xdp_desc* descriptors, uint32_t maxCount) { return 0; }
+    uint32_t getFillSpace() const { return 0; }
+    bool isFillRingEmpty() const { return false; }
+    void fill(const uint64_t* addresses, uint32_t count) {}
+    uint32_t getTransmitSpace() const { return 0; }
+    void transmit(const xdp_desc* descriptors, uint32_t count) {}
+    uint32_t complete(uint64_t* addresses, uint32_t maxCount) { return 0; }
+    void kick() {}
+};
+
+#endif
+
+namespace
+{
+class XdpReceiveJob : public jobmanager::Job
+{
+public:
+    explicit XdpReceiveJob(XdpEndpoint& endpoint) : _endpoint(endpoint) {}
+
+    void run() override { _endpoint.internalReceiveFrames(); }
+
+private:
+    XdpEndpoint& _endpoint;
+};
+
+class XdpReleaseJob : public jobmanager::Job
+{
+public:
+    explicit XdpReleaseJob(XdpEndpoint& endpoint) : _endpoint(endpoint) {}
+
+    void run() override { _endpoint.internalReleaseXdpSocket(); }
+
+private:
+    XdpEndpoint& _endpoint;
+};
+} // namespace
+
+XdpEndpoint::XdpEndpoint(jobmanager::JobManager& jobManager,
+    size_t maxSessionCount,
+    memory::PacketPoolAllocator& allocator,
+    const SocketAddress& localPort,
+    RtcePoll& epoll)
+    : UdpEndpoint("XdpEndpoint", jobManager, maxSessionCount, allocator, localPort, epoll, true),
+      _ipv4Identification(0),
+      _sentFramesInFlight(0),
+      _transmitClosed(false)
+{
+    _xdpPendingRead.clear();
+}
+
+XdpEndpoint::~XdpEndpoint()
+{
+    if (_xsk)
+    {
+        drainSentFrames();
+        releaseXdpSocket();
+    }
+}
+
+bool XdpEndpoint::openXdpSocket(const std::string& interfaceName, uint32_t queueId, bool genericMode)
+{
+    if (_state != Endpoint::State::CREATED || _xsk)
+    {
+        return false;
+    }
+
+    auto xsk = std::make_unique<XdpSocket>(_allocator);
+    if (!xsk->open(interfaceName, queueId, genericMode, _localPort, _name.c_str()))
+    {
+        return false;
+    }
+
+    _xsk = std::move(xsk);
+    _replyPaths.reset(new ReplyPath[replyPathCount]());
+    _kernelFrames.assign(_allocator.getRegionSize() / sizeof(memory::Packet) + 1, nullptr);
+    refillFrames();
+    logger::info("AF_XDP on %s queue %u for %s",
+        _name.c_str(),
+        interfaceName.c_str(),
+        queueId,
+        _localPort.toString().c_str());
+    return true;
+}
+
+// Called on the send job. Waits for the kernel to complete the frames on the tx ring.
+void XdpEndpoint::drainSentFrames()
+{
+    for (int i = 0; i < 100 && _sentFramesInFlight > 0; ++i)
+    {
+        _xsk->kick();
+        reclaimSentFrames();
+        if (_sentFramesInFlight > 0)
+        {
+            utils::Time::nanoSleep(utils::Time::ms);
+        }
+    }
+    if (_sentFramesInFlight > 0)
+    {
+        logger::warn("%u sent frames were not completed", _name.c_str(), _sentFramesInFlight);
+    }
+}
+
+// Called on the receive job, which owns the fill ring. Frames still owned by the kernel are returned to the pool once
+// the socket is closed.
+void XdpEndpoint::releaseXdpSocket()
+{
+    _xsk.reset();
+    for (auto& frame : _kernelFrames)
+    {
+        if (frame)
+        {
+            _allocator.free(frame);
+            frame = nullptr;
+        }
+    }
+    _unusableFrames.clear();
+}
+
+void XdpEndpoint::start()
+{
+    const bool starting = (_state == Endpoint::State::CREATED);
+    UdpEndpoint::start();
+    if (starting && _xsk)
+    {
+        ++_pollingSockets;
+        _epoll.add(_xsk->fd(), this);
+    }
+}
+
+void XdpEndpoint::closePort()
+{
+    const bool isPolled = _socket.isGood() && _xsk;
+    UdpEndpoint::closePort();
+    if (isPolled && !_epoll.remove(_xsk->fd(), this))
+    {
+        logger::error("Failed to request epoll unregistration", _name.c_str());
+    }
+}
+
+// The last close step runs on the send job. It stops transmitting on the AF_XDP socket and hands the release of the
+// socket and the receive frames to the receive job, which closes the port when done.
+void XdpEndpoint::internalClosePort(int countDown)
+{
+    if (countDown == 0 && _xsk && !_transmitClosed)
+    {
+        drainSentFrames();
+        _transmitClosed = true;
+        if (_receiveJobs.addJob<XdpReleaseJob>(*this))
+        {
+            return;
+        }
+        logger::error("failed to add XDP release job", _name.c_str());
+        releaseXdpSocket();
+    }
+    UdpEndpoint::internalClosePort(countDown);
+}
+
+void XdpEndpoint::internalReleaseXdpSocket()
+{
+    releaseXdpSocket();
+    UdpEndpoint::internalClosePort(0);
+}
+
+// Device GRO would merge the datagrams before the XDP program sees them and they would all take the socket path.
+bool XdpEndpoint::enableReceiveOffload()
+{
+    if (_xsk)
+    {
+        logger::info("UDP GRO is not used with AF_XDP", _name.c_str());
+        return false;
+    }
+    return UdpEndpoint::enableReceiveOffload();
+}
+
+void XdpEndpoint::onSocketReadable(int fd)
+{
+    if (!_xsk || fd != _xsk->fd())
+    {
+        UdpEndpoint::onSocketReadable(fd);
+        return;
+    }
+
+    // same queue as the socket so listener unregistration is in sync with both
+    if (!_xdpPendingRead.test_and_set())
+    {
+        if (!_receiveJobs.addJob<XdpReceiveJob>(*this))
+        {
+            logger::warn("receive queue full", _name.c_str());
+        }
+    }
+}
+
+void XdpEndpoint::internalReceiveFrames()
+{
+    _xdpPendingRead.clear(); // one extra job may be added after us
+    if (!_xsk)
+    {
+        return;
+    }
+
+    const uint32_t batchSize = 64;
+    xdp_desc descriptors[batchSize];
+    auto* umem = _allocator.getRegion();
+    for (uint32_t count = batchSize; count == batchSize;)
+    {
+        count = _xsk->receive(descriptors, batchSize);
+        const auto receiveTime = utils::Time::getAbsoluteTime();
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const auto offset = XdpSocket::getFrameOffset(descriptors[i].addr);
+            auto& kernelFrame = _kernelFrames[offset / sizeof(memory::Packet)];
+            assert(kernelFrame->get() == umem + offset);
+            memory::UniquePacket packet(kernelFrame, _allocator.getDeleter());
+            kernelFrame = nullptr;
+
+            _receiveTracker.update(descriptors[i].len, receiveTime);
+            SocketAddress source;
+            if (decapsulate(*packet, descriptors[i].len, source))
+            {
+                _receivedDatagrams.fetch_add(1, std::memory_order_relaxed);
+                packet->setReceiveTime(receiveTime);
+                dispatchReceivedPacket(source, std::move(packet));
+            }
+        }
+        refillFrames();
+    }
+}
+
+// The kernel writes a frame XDP_PACKET_HEADROOM after the fill address, so that is placed in front of the packet
+// data and the frame lands on the packet data.
+void XdpEndpoint::refillFrames()
+{
+    const uint32_t batchSize = 64;
+    uint64_t addresses[batchSize];
+    auto* umem = _allocator.getRegion();
+    for (auto space = _xsk->getFillSpace(); space > 0;)
+    {
+        uint32_t count = 0;
+        while (count < std::min(space, batchSize))
+        {
+            auto packet = memory::makeUniquePacket(_allocator);
+            if (!packet)
+            {
+                break;
+            }
+
+            const size_t offset = packet->get() - umem;
+            if (offset < XdpSocket::frameHeadroom ||
+                offset - XdpSocket::frameHeadroom + XdpSocket::chunkSize > _allocator.getRegionSize())
+            {
+                _unusableFrames.push_back(std::move(packet));
+                continue;
+            }
+            addresses[count++] = offset - XdpSocket::frameHeadroom;
+            _kernelFrames[offset / sizeof(memory::Packet)] = packet.release();
+        }
+
+        _xsk->fill(addresses, count);
+        if (count < std::min(space, batchSize))
+        {
+            break;
+        }
+        space -= count;
+    }
+}
+
+// Strips the ethernet, IP and UDP headers, leaving the UDP payload at the start of the packet.
+bool XdpEndpoint::decapsulate(memory::Packet& packet, size_t frameLength, SocketAddress& source)
+{
+    const uint8_t* frame = packet.get();
+    const bool isIpv4 = (_localPort.getFamily() == AF_INET);
+    const size_t headerLength =
+        ethernetHeaderLength + (isIpv4 ? ipv4HeaderLength : ipv6HeaderLength) + udpHeaderLength;
+    if (frameLength < headerLength || frameLength > memory::Packet::size)
+    {
+        return false;
+    }
+
+    const size_t udpLength = read16(frame + headerLength - udpHeaderLength + 4);
+    if (udpLength < udpHeaderLength || headerLength - udpHeaderLength + udpLength > frameLength)
+    {
+        return false;
+    }
+
+    const auto sourcePort = read16(frame + headerLength - udpHeaderLength);
+    if (isIpv4)
+    {
+        uint32_t sourceIp;
+        std::memcpy(&sourceIp, frame + ethernetHeaderLength + 12, sizeof(sourceIp));
+        source = SocketAddress(ntohl(sourceIp), sourcePort);
+    }
+    else
+    {
+        source = SocketAddress(frame + ethernetHeaderLength + 8, sourcePort);
+    }
+
+    learnReplyPath(frame, headerLength, source);
+
+    const size_t payloadLength = udpLength - udpHeaderLength;
+    std::memmove(packet.get(), frame + headerLength, payloadLength);
+    packet.setLength(payloadLength);
+    return true;
+}
+
+// Turns the headers of a received frame around into the headers for replying to the source.
+void XdpEndpoint::learnReplyPath(const uint8_t* frame, size_t headerLength, const SocketAddress& source)
+{
+    uint8_t header[maxHeaderLength];
+    std::memset(header, 0, sizeof(header));
+    std::memcpy(header, frame + 6, 6);
+    std::memcpy(header + 6, frame, 6);
+    std::memcpy(header + 12, frame + 12, 2);
+
+    uint8_t* ip = header + ethernetHeaderLength;
+    const uint8_t* receivedIp = frame + ethernetHeaderLength;
+    if (_localPort.getFamily() == AF_INET)
+    {
+        ip[0] = 0x45;
+        ip[8] = 64; // ttl
+        ip[9] = IPPROTO_UDP;
+        std::memcpy(ip + 12, receivedIp + 16, 4);
+        std::memcpy(ip + 16, receivedIp + 12, 4);
+    }
+    else
+    {
+        ip[0] = 0x60;
+        ip[6] = IPPROTO_UDP;
+        ip[7] = 64; // hop limit
+        std::memcpy(ip + 8, receivedIp + 24, 16);
+        std::memcpy(ip + 24, receivedIp + 8, 16);
+    }
+    uint8_t* udp = header + headerLength - udpHeaderLength;
+    const uint8_t* receivedUdp = frame + headerLength - udpHeaderLength;
+    std::memcpy(udp, receivedUdp + 2, 2);
+    std::memcpy(udp + 2, receivedUdp, 2);
+
+    auto& path = _replyPaths[std::hash<SocketAddress>()(source) % replyPathCount];
+    if (path.length == headerLength && 0 == std::memcmp(path.header, header, headerLength))
+    {
+        return;
+    }
+
+    const auto version = path.version.load(std::memory_order_relaxed);
+    path.version.store(version + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(path.header, header, headerLength);
+    path.length = headerLength;
+    path.version.store(version + 2, std::memory_order_release);
+}
+
+// Writes headers and payload into frame. Fails if the target has not been heard from or the datagram is too large.
+bool XdpEndpoint::encapsulate(const SocketAddress& target, const memory::Packet& payload, memory::Packet& frame)
+{
+    auto& path = _replyPaths[std::hash<SocketAddress>()(target) % replyPathCount];
+    const auto version = path.version.load(std::memory_order_acquire);
+    const size_t headerLength = path.length;
+    if ((version & 1) || headerLength == 0 || headerLength + payload.getLength() > memory::Packet::size)
+    {
+        return false;
+    }
+
+    uint8_t* header = frame.get();
+    std::memcpy(header, path.header, headerLength);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (path.version.load(std::memory_order_relaxed) != version)
+    {
+        return false;
+    }
+
+    uint8_t* ip = header + ethernetHeaderLength;
+    uint8_t* udp = header + headerLength - udpHeaderLength;
+    const bool isIpv4 = (target.getFamily() == AF_INET);
+    // the slot may belong to another remote
+    if (isIpv4 ? (0 != std::memcmp(ip + 16, &target.getIpv4()->sin_addr, 4) ||
+                     0 != std::memcmp(udp + 2, &target.getIpv4()->sin_port, 2))
+               : (0 != std::memcmp(ip + 24, &target.getIpv6()->sin6_addr, 16) ||
+                     0 != std::memcmp(udp + 2, &target.getIpv6()->sin6_port, 2)))
+    {
+        return false;
+    }
+
+    const size_t udpLength = udpHeaderLength + payload.getLength();
+    std::memcpy(header + headerLength, payload.get(), payload.getLength());
+    store16(udp + 4, udpLength);
+    if (isIpv4)
+    {
+        // the UDP checksum is optional over IPv4 and left out
+        store16(ip + 2, ipv4HeaderLength + udpLength);
+        store16(ip + 4, _ipv4Identification++);
+        const uint16_t checksum = finishChecksum(sumWords(ip, ipv4HeaderLength, 0));
+        std::memcpy(ip + 10, &checksum, sizeof(checksum));
+    }
+    else
+    {
+        store16(ip + 4, udpLength);
+        uint32_t sum = sumWords(ip + 8, 32, 0) + htons(udpLength) + htons(IPPROTO_UDP);
+        uint16_t checksum = finishChecksum(sumWords(udp, udpLength, sum));
+        checksum = (checksum == 0 ? 0xFFFF : checksum);
+        std::memcpy(udp + 6, &checksum, sizeof(checksum));
+    }
+    frame.setLength(headerLength + payload.getLength());
+    return true;
+}
+
+void XdpEndpoint::reclaimSentFrames()
+{
+    const uint32_t batchSize = 64;
+    uint64_t addresses[batchSize];
+    auto* umem = _allocator.getRegion();
+    for (uint32_t count = batchSize; count == batchSize;)
+    {
+        count = _xsk->complete(addresses, batchSize);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            _allocator.free(umem + addresses[i]);
+        }
+        _sentFramesInFlight -= count;
+    }
+}
+
+// Datagrams to remotes with a learned reply path are copied into pool packets with headers and handed to the tx
+// ring. The rest are gathered at the end of the array in their original order and go out on the socket.
+size_t XdpEndpoint::sendDirect(OutboundPacket* packets, const size_t count)
+{
+    if (_transmitClosed || !_xsk)
+    {
+        return UdpEndpoint::sendDirect(packets, count);
+    }
+
+    reclaimSentFrames();
+    if (_xsk->isFillRingEmpty() && !_xdpPendingRead.test_and_set())
+    {
+        // the receive job could not refill while the pool was depleted and no frames will arrive to trigger it
+        _receiveJobs.addJob<XdpReceiveJob>(*this);
+    }
+
+    const uint32_t batchSize = 64;
+    xdp_desc descriptors[batchSize];
+    uint32_t pending = 0;
+    auto* umem = _allocator.getRegion();
+    auto space = _xsk->getTransmitSpace();
+    for (size_t i = 0; i < count && space > 0; ++i)
+    {
+        auto frame = memory::makeUniquePacket(_allocator);
+        if (!frame || !encapsulate(packets[i].target, *packets[i].packet, *frame))
+        {
+            continue;
+        }
+
+        descriptors[pending].addr = frame->get() - umem;
+        descriptors[pending].len = frame->getLength();
+        descriptors[pending].options = 0;
+        frame.release();
+        packets[i].packet.reset();
+        --space;
+        if (++pending == batchSize)
+        {
+            _xsk->transmit(descriptors, pending);
+            _sentFramesInFlight += pending;
+            pending = 0;
+        }
+    }
+    _xsk->transmit(descriptors, pending);
+    _sentFramesInFlight += pending;
+    _xsk->kick();
+
+    size_t accepted = count;
+    for (size_t i = count; i-- > 0;)
+    {
+        if (packets[i].packet)
+        {
+            --accepted;
+            if (accepted != i)
+            {
+                packets[accepted] = std::move(packets[i]);
+            }
+        }
+    }
+    return accepted + UdpEndpoint::sendDirect(packets + accepted, count - accepted);
+}
+
+UdpEndpoint* createXdpEndpoint(jobmanager::JobManager& jobManager,
+    size_t maxSessionCount,
+    memory::PacketPoolAllocator& allocator,
+    const SocketAddress& localPort,
+    RtcePoll& epoll,
+    uint32_t queueId,
+    bool genericMode)
+{
+    auto endpoint = std::make_unique<XdpEndpoint>(jobManager, maxSessionCount, allocator, localPort, epoll);
+    if (endpoint->isGood() && endpoint->openXdpSocket(localPort.getName(), queueId, genericMode))
+    {
+        return endpoint.release();
+    }
+
+    logger::error("AF_XDP not available for %s, using UDP socket", "XdpEndpoint", localPort.toString().c_str());
+    endpoint.reset();
+    return new UdpEndpoint(jobManager, maxSessionCount, allocator, localPort, epoll, true);
+}
+
+} // namespace transport
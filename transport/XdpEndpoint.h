@@ -0,0 +1,99 @@
+#pragma once
+#include "transport/UdpEndpoint.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace transport
+{
+class XdpSocket;
+
+/**
+ * Shared UDP endpoint that receives and sends datagrams for its port through an AF_XDP socket, bypassing the
+ * kernel network stack. The packet pool doubles as the UMEM, so the kernel writes received frames straight into
+ * pool packets. Ethernet, IPv4/IPv6 and UDP headers are handled here. The reply headers for a remote are learned
+ * from the frames it sends us, so datagrams to remotes that have not been heard from yet go through the kernel
+ * socket, as does any traffic the XDP program passes on, e.g. fragments or frames arriving on other NIC queues.
+ */
+class XdpEndpoint : public UdpEndpoint
+{
+public:
+    XdpEndpoint(jobmanager::JobManager& jobManager,
+        size_t maxSessionCount,
+        memory::PacketPoolAllocator& allocator,
+        const SocketAddress& localPort,
+        RtcePoll& epoll);
+    ~XdpEndpoint();
+
+    /**
+     * Binds an AF_XDP socket to the NIC queue and attaches an XDP program that redirects datagrams for this port to
+     * it. Native driver mode is tried first unless genericMode is set. Call before start.
+     * @return false if AF_XDP or XDP is not available on the interface.
+     */
+    bool openXdpSocket(const std::string& interfaceName, uint32_t queueId, bool genericMode);
+    bool isXdpActive() const { return _xsk != nullptr; }
+
+    void start() override;
+    void closePort() override;
+    bool enableReceiveOffload() override;
+
+public: // internal job interface
+    void internalReceiveFrames();
+    void internalClosePort(int countDown) override;
+    void internalReleaseXdpSocket();
+
+protected:
+    void onSocketReadable(int fd) override;
+    // the io_uring backend must not recvmsg on the AF_XDP socket
+    bool isDatagramReceiver() const override { return false; }
+
+    size_t sendDirect(OutboundPacket* packets, size_t count) override;
+
+private:
+    static const size_t maxHeaderLength = 14 + 40 + 8;
+    static const size_t replyPathCount = 8192;
+
+    // Headers for sending to a remote, written by the receive job and read by the send job under a sequence lock.
+    struct ReplyPath
+    {
+        std::atomic_uint32_t version;
+        uint32_t length;
+        uint8_t header[maxHeaderLength];
+    };
+
+    bool decapsulate(memory::Packet& packet, size_t frameLength, SocketAddress& source);
+    void learnReplyPath(const uint8_t* frame, size_t headerLength, const SocketAddress& source);
+    bool encapsulate(const SocketAddress& target, const memory::Packet& payload, memory::Packet& frame);
+    void refillFrames();
+    void reclaimSentFrames();
+    void drainSentFrames();
+    void releaseXdpSocket();
+
+    std::unique_ptr<XdpSocket> _xsk;
+    std::atomic_flag _xdpPendingRead = ATOMIC_FLAG_INIT;
+    std::unique_ptr<ReplyPath[]> _replyPaths;
+    uint16_t _ipv4Identification;
+
+    // pool packets posted to the fill ring and not yet received, indexed by offset / sizeof(Packet)
+    std::vector<memory::Packet*> _kernelFrames;
+    // pool packets too close to the edges of the pool to serve as receive frames
+    std::vector<memory::UniquePacket> _unusableFrames;
+    uint32_t _sentFramesInFlight;
+    // set on the send job when closing, after which sends only go through the kernel socket
+    bool _transmitClosed;
+};
+
+/**
+ * Opens a shared port on localPort that uses AF_XDP on the interface of localPort. Only one endpoint can use AF_XDP
+ * per interface and queue, as the socket binds the queue and the program is attached to the interface.
+ * @return an XdpEndpoint, or a plain UdpEndpoint if AF_XDP is not supported.
+ */
+UdpEndpoint* createXdpEndpoint(jobmanager::JobManager& jobManager,
+    size_t maxSessionCount,
+    memory::PacketPoolAllocator& allocator,
+    const SocketAddress& localPort,
+    RtcePoll& epoll,
+    uint32_t queueId,
+    bool genericMode);
+
+} // namespace transport
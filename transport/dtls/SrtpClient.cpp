@@ -29,9 +29,13 @@ void sslInfoCallback(const SSL* ssl, int32_t where, int32_t)
 
 const auto MTU = 1500;
 
-const size_t srtpMasterKeyLength = 16;
-const size_t srtpSaltLength = 14;
-constexpr size_t keyingMaterialSize = srtpMasterKeyLength * 2 + srtpSaltLength * 2;
+// RFC 5764 and RFC 7714 master key and salt lengths per profile
+const size_t maxSrtpMasterKeyLength = SRTP_AES_256_KEY_LEN;
+const size_t maxSrtpSaltLength = SRTP_SALT_LEN;
+constexpr size_t maxKeyingMaterialSize = maxSrtpMasterKeyLength * 2 + maxSrtpSaltLength * 2;
+
+// authentication tag and SRTCP index appended by protect, without MKI
+const size_t maxProtectTrailerLength = 16 + 4;
 
 } // namespace
 
@@ -57,6 +61,25 @@ const char* toString(const SrtpClient::State state)
     }
 }
 
+const char* toString(const SrtpClient::Profile profile)
+{
+    switch (profile)
+    {
+    case SrtpClient::Profile::NONE:
+        return "NONE";
+    case SrtpClient::Profile::AES128_CM_SHA1_80:
+        return "SRTP_AES128_CM_SHA1_80";
+    case SrtpClient::Profile::AES128_CM_SHA1_32:
+        return "SRTP_AES128_CM_SHA1_32";
+    case SrtpClient::Profile::AEAD_AES_128_GCM:
+        return "SRTP_AEAD_AES_128_GCM";
+    case SrtpClient::Profile::AEAD_AES_256_GCM:
+        return "SRTP_AEAD_AES_256_GCM";
+    default:
+        return "unknown";
+    }
+}
+
 SrtpClient::SrtpClient(SslDtls& sslDtls, IEvents* eventListener)
     : _isInitialized(false),
       _state(State::IDLE),
@@ -68,6 +91,7 @@ SrtpClient::SrtpClient(SslDtls& sslDtls, IEvents* eventListener)
       _isDtlsClient(true),
       _remoteSrtp(nullptr),
       _localSrtp(nullptr),
+      _profile(Profile::NONE),
       _nullCipher(true),
       _eventSink(eventListener),
       _pendingPackets(32)
@@ -270,6 +294,11 @@ int64_t SrtpClient::processTimeout()
     return nextTimeout();
 }
 
+bool SrtpClient::isSrtpReady() const
+{
+    return _localSrtp && _remoteSrtp && _state == State::CONNECTED;
+}
+
 bool SrtpClient::unprotect(memory::Packet& packet)
 {
     assert(_isInitialized);
@@ -279,15 +308,53 @@ bool SrtpClient::unprotect(memory::Packet& packet)
         return true;
     }
 
-    if (!_localSrtp || !_remoteSrtp || _state != State::CONNECTED)
+    if (!isSrtpReady())
     {
         return false;
     }
 
-    // srtp_unprotect assumes data is word aligned
-    assert(reinterpret_cast<uintptr_t>(packet.get()) % 4 == 0);
+    DBGCHECK_SINGLETHREADED(_mutexGuard);
+    return unprotectPacket(packet);
+}
+
+size_t SrtpClient::unprotect(memory::Packet** packets, const size_t count)
+{
+    assert(_isInitialized);
+
+    if (_nullCipher)
+    {
+        return count;
+    }
+
+    if (!isSrtpReady())
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            packets[i] = nullptr;
+        }
+        return 0;
+    }
 
     DBGCHECK_SINGLETHREADED(_mutexGuard);
+    size_t unprotectedCount = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (unprotectPacket(*packets[i]))
+        {
+            ++unprotectedCount;
+        }
+        else
+        {
+            packets[i] = nullptr;
+        }
+    }
+    return unprotectedCount;
+}
+
+bool SrtpClient::unprotectPacket(memory::Packet& packet)
+{
+    // srtp_unprotect assumes data is word aligned
+    assert(reinterpret_cast<uintptr_t>(packet.get()) % 4 == 0);
 
     auto bufferLength = utils::checkedCast<int32_t>(packet.getLength());
     if (rtp::isRtpPacket(packet))
@@ -336,18 +403,66 @@ bool SrtpClient::protect(memory::Packet& packet)
         return true;
     }
 
-    if (!_localSrtp || !_remoteSrtp || _state != State::CONNECTED)
+    if (!isSrtpReady())
     {
         return false;
     }
 
-    // srtp_protect assumes data is word aligned
-    assert(reinterpret_cast<uintptr_t>(packet.get()) % 4 == 0);
+    DBGCHECK_SINGLETHREADED(_mutexGuard);
+    return protectPacket(packet);
+}
+
+size_t SrtpClient::protect(memory::Packet** packets, const size_t count)
+{
+    assert(_isInitialized);
+
+    if (_nullCipher)
+    {
+        return count;
+    }
+
+    if (!isSrtpReady())
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            packets[i] = nullptr;
+        }
+        return 0;
+    }
 
     DBGCHECK_SINGLETHREADED(_mutexGuard);
+    size_t protectedCount = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (protectPacket(*packets[i]))
+        {
+            ++protectedCount;
+        }
+        else
+        {
+            packets[i] = nullptr;
+        }
+    }
+    return protectedCount;
+}
+
+bool SrtpClient::protectPacket(memory::Packet& packet)
+{
+    // srtp_protect assumes data is word aligned
+    assert(reinterpret_cast<uintptr_t>(packet.get()) % 4 == 0);
 
     auto bufferLength = utils::checkedCast<int32_t>(packet.getLength());
     assert(bufferLength > 0);
+    // packets from the smaller pool size classes have less room than Packet::size
+    if (packet.getLength() + maxProtectTrailerLength > packet.getCapacity())
+    {
+        logger::warn("no room for srtp trailer, length %zu, capacity %zu",
+            _loggableId.c_str(),
+            packet.getLength(),
+            packet.getCapacity());
+        return false;
+    }
+
     if (rtp::isRtpPacket(packet))
     {
         const auto result = srtp_protect(_localSrtp, packet.get(), &bufferLength);
@@ -504,7 +619,45 @@ bool SrtpClient::createSrtp()
         return false;
     }
 
-    unsigned char keyingMaterial[keyingMaterialSize];
+    srtp_policy_t srtpPolicy;
+    memset(&srtpPolicy, 0, sizeof(srtpPolicy));
+
+    size_t srtpMasterKeyLength = SRTP_AES_128_KEY_LEN;
+    size_t srtpSaltLength = SRTP_SALT_LEN;
+    Profile profile = Profile::NONE;
+    switch (srtpProtectionProfile->id)
+    {
+    case SRTP_AES128_CM_SHA1_80:
+        srtp_crypto_policy_set_aes_cm_128_hmac_sha1_80(&srtpPolicy.rtp);
+        srtp_crypto_policy_set_aes_cm_128_hmac_sha1_80(&srtpPolicy.rtcp);
+        profile = Profile::AES128_CM_SHA1_80;
+        break;
+    case SRTP_AES128_CM_SHA1_32:
+        srtp_crypto_policy_set_aes_cm_128_hmac_sha1_32(&srtpPolicy.rtp);
+        srtp_crypto_policy_set_aes_cm_128_hmac_sha1_80(&srtpPolicy.rtcp);
+        profile = Profile::AES128_CM_SHA1_32;
+        break;
+    case SRTP_AEAD_AES_128_GCM:
+        srtp_crypto_policy_set_aes_gcm_128_16_auth(&srtpPolicy.rtp);
+        srtp_crypto_policy_set_aes_gcm_128_16_auth(&srtpPolicy.rtcp);
+        srtpMasterKeyLength = SRTP_AES_128_KEY_LEN;
+        srtpSaltLength = SRTP_AEAD_SALT_LEN;
+        profile = Profile::AEAD_AES_128_GCM;
+        break;
+    case SRTP_AEAD_AES_256_GCM:
+        srtp_crypto_policy_set_aes_gcm_256_16_auth(&srtpPolicy.rtp);
+        srtp_crypto_policy_set_aes_gcm_256_16_auth(&srtpPolicy.rtcp);
+        srtpMasterKeyLength = SRTP_AES_256_KEY_LEN;
+        srtpSaltLength = SRTP_AEAD_SALT_LEN;
+        profile = Profile::AEAD_AES_256_GCM;
+        break;
+    default:
+        logger::error("Unsupported srtp profile %s", _loggableId.c_str(), srtpProtectionProfile->name);
+        return false;
+    }
+
+    unsigned char keyingMaterial[maxKeyingMaterialSize];
+    const size_t keyingMaterialSize = srtpMasterKeyLength * 2 + srtpSaltLength * 2;
 
     if (SSL_export_keying_material(_ssl,
             keyingMaterial,
@@ -518,8 +671,8 @@ bool SrtpClient::createSrtp()
         return false;
     }
 
-    unsigned char clientWriteKey[srtpMasterKeyLength + srtpSaltLength];
-    unsigned char serverWriteKey[srtpMasterKeyLength + srtpSaltLength];
+    unsigned char clientWriteKey[maxSrtpMasterKeyLength + maxSrtpSaltLength];
+    unsigned char serverWriteKey[maxSrtpMasterKeyLength + maxSrtpSaltLength];
 
     {
         size_t offset = 0;
@@ -535,24 +688,6 @@ bool SrtpClient::createSrtp()
         std::memcpy(&(serverWriteKey[srtpMasterKeyLength]), &(keyingMaterial[offset]), srtpSaltLength);
     }
 
-    srtp_policy_t srtpPolicy;
-    memset(&srtpPolicy, 0, sizeof(srtpPolicy));
-
-    switch (srtpProtectionProfile->id)
-    {
-    case SRTP_AES128_CM_SHA1_80:
-        srtp_crypto_policy_set_aes_cm_128_hmac_sha1_80(&srtpPolicy.rtp);
-        srtp_crypto_policy_set_aes_cm_128_hmac_sha1_80(&srtpPolicy.rtcp);
-        break;
-    case SRTP_AES128_CM_SHA1_32:
-        srtp_crypto_policy_set_aes_cm_128_hmac_sha1_32(&srtpPolicy.rtp);
-        srtp_crypto_policy_set_aes_cm_128_hmac_sha1_80(&srtpPolicy.rtcp);
-        break;
-    default:
-        assert(false);
-        break;
-    }
-
     srtpPolicy.ssrc.value = 0;
     srtpPolicy.next = nullptr;
     srtpPolicy.ssrc.type = ssrc_any_outbound;
@@ -575,6 +710,8 @@ bool SrtpClient::createSrtp()
         return false;
     }
 
+    _profile = profile;
+    logger::info("srtp profile %s", _loggableId.c_str(), toString(profile));
     return true;
 }
 
@@ -28,6 +28,16 @@ public:
         FAILED
     };
 
+    // negotiated DTLS-SRTP protection profile
+    enum class Profile
+    {
+        NONE = 0,
+        AES128_CM_SHA1_80,
+        AES128_CM_SHA1_32,
+        AEAD_AES_128_GCM,
+        AEAD_AES_256_GCM
+    };
+
     class IEvents
     {
     public:
@@ -47,6 +57,14 @@ public:
 
     bool unprotect(memory::Packet& packet);
     bool protect(memory::Packet& packet);
+
+    /**
+     * Batch variants that check the session state once and then protect / unprotect the packets one by one, as
+     * libsrtp has no multi packet entry point. Packets that fail are set to nullptr in the array.
+     * @return number of packets that were protected / unprotected.
+     */
+    size_t unprotect(memory::Packet** packets, size_t count);
+    size_t protect(memory::Packet** packets, size_t count);
     void removeLocalSsrc(const uint32_t ssrc);
     bool setRemoteRolloverCounter(const uint32_t ssrc, const uint32_t rolloverCounter);
     bool setLocalRolloverCounter(const uint32_t ssrc, const uint32_t rolloverCounter);
@@ -60,11 +78,15 @@ public:
     int64_t processTimeout();
 
     State getState() const { return _state; }
+    Profile getProfile() const { return _profile; }
 
     bool unprotectApplicationData(memory::Packet& packet);
     void sendApplicationData(const void* data, size_t length);
 
 private:
+    bool isSrtpReady() const;
+    bool protectPacket(memory::Packet& packet);
+    bool unprotectPacket(memory::Packet& packet);
     void dtlsHandShake();
     void logSslError(const char* msg, int sslCode);
     bool _isInitialized;
@@ -80,6 +102,7 @@ private:
     std::atomic_bool _isDtlsClient;
     srtp_t _remoteSrtp;
     srtp_t _localSrtp;
+    std::atomic<Profile> _profile;
 
     bool _nullCipher;
 
@@ -96,4 +119,5 @@ private:
 };
 
 const char* toString(const SrtpClient::State state);
+const char* toString(const SrtpClient::Profile profile);
 } // namespace transport
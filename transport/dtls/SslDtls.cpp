@@ -3,6 +3,7 @@
 #include "logger/Logger.h"
 #include <cassert>
 #include <cstdint>
+#include <cstring>
 #include <openssl/asn1.h>
 #include <openssl/bn.h>
 #include <openssl/err.h>
@@ -166,21 +167,64 @@ long writeBioCtrl(BIO* bio, int32_t cmd, long num, void* ptr)
     }
 }
 
+// libsrtp built without a crypto library backend has no AES-GCM cipher, and creating a GCM session fails
+bool isSrtpProfileSupported(void (*setCryptoPolicy)(srtp_crypto_policy_t*))
+{
+    unsigned char key[SRTP_AES_256_KEY_LEN + SRTP_SALT_LEN];
+    std::memset(key, 0, sizeof(key));
+
+    srtp_policy_t srtpPolicy;
+    std::memset(&srtpPolicy, 0, sizeof(srtpPolicy));
+    setCryptoPolicy(&srtpPolicy.rtp);
+    setCryptoPolicy(&srtpPolicy.rtcp);
+    srtpPolicy.ssrc.type = ssrc_any_outbound;
+    srtpPolicy.key = key;
+
+    srtp_t session = nullptr;
+    if (srtp_create(&session, &srtpPolicy) != srtp_err_status_ok)
+    {
+        return false;
+    }
+    srtp_dealloc(session);
+    return true;
+}
+
 } // namespace
 
 namespace transport
 {
 
-SslDtls::SslDtls() : _sslContext(nullptr), _evpPkeyRsa(nullptr), _certificate(nullptr), _writeBioMethods(nullptr)
+SslDtls::SslDtls()
+    : _sslContext(nullptr),
+      _evpPkeyRsa(nullptr),
+      _certificate(nullptr),
+      _writeBioMethods(nullptr),
+      _srtpGcmSupported(false)
 {
     SSL_library_init();
     SSL_load_error_strings();
     OpenSSL_add_all_algorithms();
 
+    const auto srtpInitResult = srtp_init();
+    assert(srtpInitResult == srtp_err_status_ok);
+
     _sslContext = SSL_CTX_new(DTLS_method());
 
     SSL_CTX_set_verify(_sslContext, SSL_VERIFY_PEER | SSL_VERIFY_FAIL_IF_NO_PEER_CERT, ::verify);
-    SSL_CTX_set_tlsext_use_srtp(_sslContext, "SRTP_AES128_CM_SHA1_80:SRTP_AES128_CM_SHA1_32");
+    // As DTLS server, OpenSSL picks the first profile in this list that the client offers.
+    // The GCM profiles encrypt and authenticate in a single pass, so they go first if libsrtp supports them.
+    _srtpGcmSupported = isSrtpProfileSupported(srtp_crypto_policy_set_aes_gcm_128_16_auth) &&
+        isSrtpProfileSupported(srtp_crypto_policy_set_aes_gcm_256_16_auth);
+    if (_srtpGcmSupported)
+    {
+        SSL_CTX_set_tlsext_use_srtp(_sslContext,
+            "SRTP_AEAD_AES_128_GCM:SRTP_AEAD_AES_256_GCM:SRTP_AES128_CM_SHA1_80:SRTP_AES128_CM_SHA1_32");
+    }
+    else
+    {
+        logger::info("libsrtp has no AES-GCM support, offering AES-CM SRTP profiles only", "SslDtls");
+        SSL_CTX_set_tlsext_use_srtp(_sslContext, "SRTP_AES128_CM_SHA1_80:SRTP_AES128_CM_SHA1_32");
+    }
 
     _evpPkeyRsa = generateRsaKey();
     if (!_evpPkeyRsa)
@@ -214,9 +258,6 @@ SslDtls::SslDtls() : _sslContext(nullptr), _evpPkeyRsa(nullptr), _certificate(nu
     result = SSL_CTX_set_cipher_list(_sslContext, "HIGH:!aNULL:!MD5:!RC4");
     assert(result);
 
-    const auto srtpInitResult = srtp_init();
-    assert(srtpInitResult == srtp_err_status_ok);
-
     _writeBioMethods = BIO_meth_new(BIO_TYPE_BIO, "SrtpClient write BIO");
     assert(_writeBioMethods);
 
@@ -35,6 +35,8 @@ public:
     const std::string& getLocalFingerprint() const { return _localFingerprint; }
     SSL_CTX* getSslContext() const { return _sslContext; }
     BIO_METHOD* getWriteBioMethods() const { return _writeBioMethods; }
+    // AES-GCM SRTP profiles are only offered if libsrtp could create a GCM session at startup
+    bool isSrtpGcmSupported() const { return _srtpGcmSupported; }
 
 private:
     SSL_CTX* _sslContext;
@@ -42,6 +44,7 @@ private:
     X509* _certificate;
     std::string _localFingerprint;
     BIO_METHOD* _writeBioMethods;
+    bool _srtpGcmSupported;
 };
 
 inline bool isDtlsPacket(const void* data)
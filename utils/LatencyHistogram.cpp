@@ -0,0 +1,118 @@
+#include "utils/LatencyHistogram.h"
+#include <algorithm>
+#include <cstring>
+
+namespace utils
+{
+const size_t LatencyHistogram::linearBuckets;
+const size_t LatencyHistogram::subBucketBits;
+const size_t LatencyHistogram::maxMagnitude;
+const size_t LatencyHistogram::bucketCount;
+
+LatencyHistogram::Snapshot::Snapshot()
+{
+    std::memset(counts, 0, sizeof(counts));
+}
+
+LatencyHistogram::Snapshot& LatencyHistogram::Snapshot::operator+=(const Snapshot& other)
+{
+    for (size_t i = 0; i < bucketCount; ++i)
+    {
+        counts[i] += other.counts[i];
+    }
+    return *this;
+}
+
+uint64_t LatencyHistogram::Snapshot::getCount() const
+{
+    uint64_t count = 0;
+    for (size_t i = 0; i < bucketCount; ++i)
+    {
+        count += counts[i];
+    }
+    return count;
+}
+
+uint64_t LatencyHistogram::Snapshot::getPercentile(const double percentile) const
+{
+    const auto total = getCount();
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    const auto rank = std::max(uint64_t(1), static_cast<uint64_t>(percentile * total + 0.5));
+    uint64_t count = 0;
+    for (size_t i = 0; i < bucketCount; ++i)
+    {
+        count += counts[i];
+        if (count >= rank)
+        {
+            return bucketUpperBound(i);
+        }
+    }
+    return bucketUpperBound(bucketCount - 1);
+}
+
+LatencyHistogram::LatencyHistogram()
+{
+    for (auto& count : _counts)
+    {
+        count = 0;
+    }
+}
+
+size_t LatencyHistogram::bucketOf(const uint64_t valueUs)
+{
+    if (valueUs < linearBuckets)
+    {
+        return valueUs;
+    }
+
+    const size_t magnitude = 63 - __builtin_clzll(valueUs);
+    if (magnitude > maxMagnitude)
+    {
+        return bucketCount - 1;
+    }
+    const size_t subBucket = (valueUs >> (magnitude - subBucketBits)) & ((1 << subBucketBits) - 1);
+    return linearBuckets + ((magnitude - 4) << subBucketBits) + subBucket;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(const size_t bucket)
+{
+    if (bucket < linearBuckets)
+    {
+        return bucket;
+    }
+
+    const size_t magnitude = 4 + ((bucket - linearBuckets) >> subBucketBits);
+    const uint64_t subBucket = (bucket - linearBuckets) & ((1 << subBucketBits) - 1);
+    return (((1 << subBucketBits) + subBucket + 1) << (magnitude - subBucketBits)) - 1;
+}
+
+void LatencyHistogram::record(const uint64_t latencyNs)
+{
+    _counts[bucketOf(latencyNs / 1000)].fetch_add(1, std::memory_order_relaxed);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const
+{
+    Snapshot result;
+    for (size_t i = 0; i < bucketCount; ++i)
+    {
+        result.counts[i] = _counts[i].load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::collect()
+{
+    Snapshot result;
+    for (size_t i = 0; i < bucketCount; ++i)
+    {
+        result.counts[i] = _counts[i].exchange(0, std::memory_order_relaxed);
+    }
+    return result;
+}
+
+} // namespace utils